@@ -16,9 +16,19 @@
 #define _az_IOT_H
 
 #include <azure/iot/az_iot_adu_client.h>
+#include <azure/iot/az_iot_adu_client_download.h>
 #include <azure/iot/az_iot_common.h>
 #include <azure/iot/az_iot_hub_client.h>
+#include <azure/iot/az_iot_hub_client_commands_dispatch.h>
 #include <azure/iot/az_iot_hub_client_properties.h>
+#include <azure/iot/az_iot_hub_client_properties_tracker.h>
+#include <azure/iot/az_iot_hub_client_telemetry_batch.h>
+#include <azure/iot/az_iot_hub_client_telemetry_store.h>
+#include <azure/iot/az_iot_hub_client_twin_shadow.h>
+#include <azure/iot/az_iot_hub_gateway.h>
 #include <azure/iot/az_iot_provisioning_client.h>
+#include <azure/iot/az_iot_request_table.h>
+#include <azure/iot/az_iot_retry_backoff.h>
+#include <azure/iot/az_mqtt.h>
 
 #endif // _az_IOT_CORE_H
@@ -41,6 +41,13 @@ struct az_context
     int64_t expiration; // Time when context expires
     void const* key; // Pointers to the key & value (usually NULL)
     void const* value;
+    // Soonest expiration of this node and its parents when the node was created. Only valid while
+    // no context has been canceled since, which is the case while cancel_epoch (0 if not cached)
+    // matches the global cancellation counter.
+    int64_t min_expiration;
+    uint32_t cancel_epoch;
+    // Nearest parent node that has a key (or NULL), so value lookups skip expiration-only nodes.
+    az_context const* value_parent;
   } _internal;
 };
 
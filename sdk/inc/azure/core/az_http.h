@@ -131,6 +131,153 @@ typedef struct
   int32_t max_retries;
 } az_http_policy_retry_options;
 
+enum
+{
+  // Each power of two range of values is split into 2^3 = 8 linear sub-buckets, so a value is
+  // reported with at most 12.5% relative error.
+  _az_HTTP_HISTOGRAM_SUB_BUCKET_BITS = 3,
+  _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT = 1 << _az_HTTP_HISTOGRAM_SUB_BUCKET_BITS,
+
+  /// The number of buckets in an #az_http_histogram, covering values from 0 to `INT32_MAX`.
+  AZ_HTTP_HISTOGRAM_BUCKET_COUNT
+  = (31 - _az_HTTP_HISTOGRAM_SUB_BUCKET_BITS + 1) * _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT,
+};
+
+/**
+ * @brief A fixed-size histogram of non-negative values with log-linear buckets.
+ *
+ * @details Values below 8 each have their own bucket. Above that, every power of two range is
+ * split into 8 equal buckets. Use #az_http_histogram_get_value_at_percentile() to read percentiles.
+ */
+typedef struct
+{
+  /// Number of values recorded.
+  uint32_t count;
+
+  /// Largest value recorded.
+  int32_t max;
+
+  /// Number of values recorded in each bucket.
+  uint32_t buckets[AZ_HTTP_HISTOGRAM_BUCKET_COUNT];
+} az_http_histogram;
+
+/**
+ * @brief Metrics collected by the instrumentation policy for every attempt made to send an HTTP
+ * request.
+ *
+ * @details Initialize with #az_http_metrics_init() and read with #az_http_metrics_snapshot(), which
+ * can be called while requests are in flight.
+ */
+typedef struct
+{
+  /// Duration of each attempt, in milliseconds.
+  az_http_histogram attempt_duration_msec;
+
+  /// Size of each request (method, URL, headers and body), in bytes.
+  az_http_histogram request_size;
+
+  /// Size of each response (status line, headers and body), in bytes.
+  az_http_histogram response_size;
+
+  /// Number of attempts, including retries.
+  uint32_t attempt_count;
+
+  /// Number of attempts that were retries of a previous attempt.
+  uint32_t retry_count;
+
+  /// Number of attempts that failed without an HTTP response.
+  uint32_t failure_count;
+
+  /// Number of responses per status code class, from `1xx` (index 0) to `5xx` (index 4).
+  uint32_t status_code_class_count[5];
+} az_http_metrics;
+
+/**
+ * @brief Details of one attempt to send an HTTP request, reported by the instrumentation policy.
+ */
+typedef struct
+{
+  /// Result of the attempt.
+  az_result result;
+
+  /// Status code of the response, or #AZ_HTTP_STATUS_CODE_NONE if there was no response.
+  az_http_status_code status_code;
+
+  /// Attempt number, starting at `1`, or `0` if the pipeline has no retry policy.
+  int32_t attempt;
+
+  /// Duration of the attempt, in milliseconds.
+  int32_t duration_msec;
+
+  /// Size of the request (method, URL, headers and body), in bytes.
+  int32_t request_size;
+
+  /// Size of the response (status line, headers and body), in bytes.
+  int32_t response_size;
+} az_http_instrumentation_attempt;
+
+/**
+ * @brief Defines the signature of the callback invoked by the instrumentation policy after each
+ * attempt to send an HTTP request.
+ *
+ * @param[in] attempt The details of the attempt.
+ * @param[in] user_context The `callback_context` given in
+ * #az_http_policy_instrumentation_options.
+ */
+typedef void (*az_http_instrumentation_fn)(
+    az_http_instrumentation_attempt const* attempt,
+    void* user_context);
+
+/**
+ * @brief Options for the instrumentation policy.
+ *
+ * @details Given to the clients running an HTTP pipeline through their options, such as the
+ * `instrumentation_options` of #az_iot_adu_client_download_options. An attempt is timed with
+ * az_platform_clock_msec(), and is sent without being recorded when the clock fails.
+ */
+typedef struct
+{
+  /// __[nullable]__ Metrics to record each attempt into.
+  az_http_metrics* metrics;
+
+  /// __[nullable]__ Function invoked after each attempt.
+  az_http_instrumentation_fn callback;
+
+  /// __[nullable]__ Context passed to `callback`.
+  void* callback_context;
+} az_http_policy_instrumentation_options;
+
+/**
+ * @brief Initializes an #az_http_metrics instance with no recorded values.
+ *
+ * @param[out] out_metrics The pointer to the #az_http_metrics instance to initialize.
+ */
+void az_http_metrics_init(az_http_metrics* out_metrics);
+
+/**
+ * @brief Copies the values recorded in \p metrics.
+ *
+ * @details Each counter is read atomically on platforms with lock-free 32-bit atomics, so this can
+ * be called from a thread other than the ones sending requests. Counters are not read as a single
+ * transaction, so they may differ by the attempts that completed while the copy was made.
+ *
+ * @param[in] metrics The #az_http_metrics being recorded by the instrumentation policy.
+ * @param[out] out_snapshot The pointer to an #az_http_metrics instance to copy the values to.
+ */
+void az_http_metrics_snapshot(az_http_metrics const* metrics, az_http_metrics* out_snapshot);
+
+/**
+ * @brief Gets the value below or at which the given percentage of recorded values fall.
+ *
+ * @param[in] histogram The #az_http_histogram to read.
+ * @param[in] percentile The percentile, from `0` to `100` (for example, `99.9`).
+ *
+ * @return The upper bound of the bucket holding the requested percentile (capped at the largest
+ * recorded value), or `0` if no values were recorded.
+ */
+AZ_NODISCARD int32_t
+az_http_histogram_get_value_at_percentile(az_http_histogram const* histogram, double percentile);
+
 typedef enum
 {
   _az_HTTP_RESPONSE_KIND_STATUS_LINE = 0,
@@ -283,6 +430,44 @@ AZ_NODISCARD az_result az_http_response_get_next_header(
  */
 AZ_NODISCARD az_result az_http_response_get_body(az_http_response* ref_response, az_span* out_body);
 
+/**
+ * @brief The part of a resource carried by the body of an HTTP `206 Partial Content` response.
+ *
+ * @see https://www.rfc-editor.org/rfc/rfc7233#section-4.2
+ */
+typedef struct
+{
+  /// The offset, in bytes, of the first byte of the body within the resource.
+  int64_t first_byte;
+
+  /// The offset, in bytes, of the last byte of the body within the resource, inclusive.
+  int64_t last_byte;
+
+  /// The size, in bytes, of the whole resource, or -1 if the server does not know it.
+  int64_t complete_length;
+} az_http_response_content_range;
+
+/**
+ * @brief Returns the byte range carried by an HTTP response, from its `Content-Range` header.
+ *
+ * @details Invokes #az_http_response_get_status_line() and reads all the headers, so
+ * #az_http_response_get_body() can be called next.
+ *
+ * @param[in,out] ref_response A pointer to an #az_http_response instance.
+ * @param[out] out_content_range A pointer to an #az_http_response_content_range to receive the
+ * range.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The range of the response was returned.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The HTTP response has no `Content-Range` header.
+ * @retval #AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER The `Content-Range` header is not a valid byte
+ * range.
+ * @retval other The HTTP response was not parsed.
+ */
+AZ_NODISCARD az_result az_http_response_get_content_range(
+    az_http_response* ref_response,
+    az_http_response_content_range* out_content_range);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_HTTP_H
@@ -88,6 +88,7 @@ typedef struct
     int32_t headers_length;
     int32_t max_headers;
     int32_t retry_headers_start_byte_offset;
+    int32_t retry_attempt; // Set by the retry policy; 0 when there's no retry policy.
     az_span body;
   } _internal;
 } az_http_request;
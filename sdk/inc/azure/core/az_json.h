@@ -100,6 +100,11 @@ typedef struct
     /// optimization to avoid redundant checks. It is meaningless for any other token kind.
     bool string_has_escaped_chars;
 
+    /// A flag to indicate whether the JSON string was read from JSON text embedded within another
+    /// JSON string, in which case its escaped characters are escaped twice. It is meaningless for
+    /// any other token kind.
+    bool string_is_double_escaped;
+
     /// This is the first segment in the entire JSON payload, if it was non-contiguous. Otherwise,
     /// its set to #AZ_SPAN_EMPTY.
     az_span* pointer_to_first_buffer;
@@ -702,6 +707,14 @@ typedef struct
     /// A limited stack to track the depth and nested JSON objects or arrays read so far.
     _az_json_bit_stack bit_stack;
 
+    /// Flag which indicates that the JSON text is embedded, escaped, within a JSON string, rather
+    /// than being raw JSON.
+    bool is_escaped_json;
+
+    /// The offset within the last buffer segment where the JSON text ends, or -1 if the JSON text
+    /// ends with the last buffer segment.
+    int32_t end_buffer_offset;
+
     /// A copy of the options provided by the user.
     az_json_reader_options options;
   } _internal;
@@ -761,6 +774,63 @@ AZ_NODISCARD az_result az_json_reader_chunked_init(
     int32_t number_of_buffers,
     az_json_reader_options const* options);
 
+/**
+ * @brief Initializes an #az_json_reader to read the JSON text embedded, escaped, within the
+ * contents of a JSON string, without unescaping it into another buffer first.
+ *
+ * @param[out] out_json_reader A pointer to an #az_json_reader instance to initialize.
+ * @param[in] json_string An #az_span over the contents of the JSON string, without the surrounding
+ * quotes, such as the slice of an #az_json_token of kind #AZ_JSON_TOKEN_STRING.
+ * @param[in] options __[nullable]__ A reference to an #az_json_reader_options structure which
+ * defines custom behavior of the #az_json_reader. If `NULL` is passed, the reader will use the
+ * default options (i.e. #az_json_reader_options_default()).
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_reader is initialized successfully.
+ * @retval other Initialization failed.
+ *
+ * @remarks The JSON text is unescaped on the fly as it is read. For example, the JSON string
+ * `"{\"name\":\"value\"}"` is read as the JSON object `{"name":"value"}`. The slices of the
+ * tokens read point to the escaped JSON text. Use #az_json_token_is_text_equal() and
+ * #az_json_token_get_string() to get the unescaped value of string tokens.
+ *
+ * @remarks The provided json string must not be empty, as that is invalid JSON.
+ *
+ * @remarks An instance of #az_json_reader must not outlive the lifetime of the JSON payload within
+ * the \p json_string.
+ */
+AZ_NODISCARD az_result az_json_reader_init_escaped(
+    az_json_reader* out_json_reader,
+    az_span json_string,
+    az_json_reader_options const* options);
+
+/**
+ * @brief Initializes an #az_json_reader to read the JSON text embedded, escaped, within a JSON
+ * string token, even if the token straddles non-contiguous buffers.
+ *
+ * @param[out] out_json_reader A pointer to an #az_json_reader instance to initialize.
+ * @param[in] json_token A pointer to the #az_json_token of kind #AZ_JSON_TOKEN_STRING containing
+ * the JSON text to read.
+ * @param[in] options __[nullable]__ A reference to an #az_json_reader_options structure which
+ * defines custom behavior of the #az_json_reader. If `NULL` is passed, the reader will use the
+ * default options (i.e. #az_json_reader_options_default()).
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The #az_json_reader is initialized successfully.
+ * @retval other Initialization failed.
+ *
+ * @remarks See #az_json_reader_init_escaped() for how the JSON text is read.
+ *
+ * @remarks The \p json_token must not be empty, as that is invalid JSON.
+ *
+ * @remarks An instance of #az_json_reader must not outlive the lifetime of the JSON payload the
+ * \p json_token was read from.
+ */
+AZ_NODISCARD az_result az_json_reader_init_from_string_token(
+    az_json_reader* out_json_reader,
+    az_json_token const* json_token,
+    az_json_reader_options const* options);
+
 /**
  * @brief Reads the next token in the JSON text and updates the reader state.
  *
@@ -815,6 +885,235 @@ AZ_NODISCARD az_result az_json_reader_skip_children(az_json_reader* ref_json_rea
  */
 AZ_NODISCARD az_span az_json_string_unescape(az_span json_string, az_span destination);
 
+/************************************ JSON BINDING ******************/
+
+/**
+ * @brief Defines symbols for the C types of the struct members a JSON value can be bound to.
+ */
+typedef enum
+{
+  AZ_JSON_BINDING_STRING = 1, ///< An #az_span, set to the slice of a JSON string.
+  AZ_JSON_BINDING_BOOLEAN, ///< A `bool`, set from the JSON literal `true` or `false`.
+  AZ_JSON_BINDING_INT32, ///< An `int32_t`, set from a JSON number.
+  AZ_JSON_BINDING_UINT32, ///< A `uint32_t`, set from a JSON number.
+  AZ_JSON_BINDING_INT64, ///< An `int64_t`, set from a JSON number.
+  AZ_JSON_BINDING_UINT64, ///< A `uint64_t`, set from a JSON number.
+  AZ_JSON_BINDING_DOUBLE, ///< A `double`, set from a JSON number.
+  AZ_JSON_BINDING_OBJECT, ///< A struct, set from a JSON object by the binding of the field.
+  AZ_JSON_BINDING_JSON, ///< An #az_span, set to the JSON text of a JSON object or array.
+  AZ_JSON_BINDING_JSON_OBJECT, ///< An #az_span, set to the JSON text of a JSON object.
+} az_json_binding_type;
+
+typedef struct az_json_binding az_json_binding;
+
+/**
+ * @brief Binds a property of a JSON object to a member of a C struct.
+ */
+typedef struct
+{
+  /// The name of the property, without escapes. It is written as it is, without escaping, so it
+  /// must not contain quotes, backslashes or control characters.
+  az_span key;
+
+  /// The type of the member.
+  az_json_binding_type type;
+
+  /// The offset of the member within the struct, as given by `offsetof`.
+  size_t offset;
+
+  /// The binding of the struct of the member, for #AZ_JSON_BINDING_OBJECT.
+  az_json_binding const* binding;
+
+  /// The number of elements of the member, if it is an array bound to a JSON array, or 0 if the
+  /// member holds a single value.
+  int32_t array_capacity;
+
+  /// The offset within the struct of the `int32_t` member set to the number of elements of the
+  /// array, if \p array_capacity is not 0.
+  size_t array_count_offset;
+
+  /// The number of digits written after the decimal point, for #AZ_JSON_BINDING_DOUBLE. It must be
+  /// between 0 and 15 (inclusive).
+  int32_t fractional_digits;
+
+  /// The result of reading a value that is not of the type of the member, such as
+  /// #AZ_ERROR_ITEM_NOT_FOUND for a parser that reports a value of the wrong type as missing. If it
+  /// is not a failure, as when left zero, such a value fails with #AZ_ERROR_UNEXPECTED_CHAR.
+  az_result type_mismatch_result;
+
+  /// Whether the JSON literal `null` is a value of the wrong type, instead of being skipped.
+  bool rejects_null;
+} az_json_binding_field;
+
+/**
+ * @brief Binds the properties of a JSON object to the members of a C struct.
+ *
+ * @remarks A binding is usually a static constant, along with the array of its fields.
+ */
+struct az_json_binding
+{
+  /// The array of the properties bound to the struct.
+  az_json_binding_field const* fields;
+
+  /// The number of items in \p fields.
+  int32_t fields_length;
+
+  /// The size of the struct, as given by `sizeof`, to find the elements of an array of it.
+  size_t size;
+
+  /// Whether an error reading a property name, or the end of the object, ends the object as if it
+  /// was complete, keeping the properties read before. Errors within values still fail.
+  bool ends_at_invalid_property;
+};
+
+/**
+ * @brief Reads a JSON object into the members of a C struct, as described by a binding.
+ *
+ * @param[in,out] ref_json_reader A pointer to an #az_json_reader instance, on the token that begins
+ * the JSON object, or on the property name whose value it is.
+ * @param[in] binding The binding of the properties of the JSON object to the members of the struct.
+ * @param[in,out] ref_value A pointer to the struct to set the members of.
+ * @param[out] out_present __[nullable]__ A pointer to a bit mask, where bit `i` is set if the
+ * property of `binding->fields[i]` was read. Properties are recorded as they are read, so the bit
+ * mask also reflects the properties read before an error.
+ *
+ * @pre \p ref_json_reader must not be `NULL`.
+ * @pre \p binding must not be `NULL`.
+ * @pre \p ref_value must not be `NULL`.
+ * @pre `binding->fields_length` must be less than or equal to 32 if \p out_present is not `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The JSON object was read, and the reader is on the token that ends it.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR An invalid character is detected, a value is not of the kind
+ * of its field and the field has no `type_mismatch_result`, or a number does not fit in its
+ * member.
+ * @retval #AZ_ERROR_UNEXPECTED_END The end of the JSON document is reached.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE A JSON array has more elements than its member can hold.
+ * @retval #AZ_ERROR_NOT_SUPPORTED A string or the JSON text of an object straddles non-contiguous
+ * buffers.
+ *
+ * @remarks The object is read in a single pass. Properties without a field are skipped, and so are
+ * properties whose value is the JSON literal `null`, unless their field rejects it. The members of
+ * the fields of properties missing from the JSON object are left as they are, so they should be set
+ * to their default values beforehand.
+ *
+ * @remarks Property names are matched on their size first, then on their text. As properties are
+ * usually written in the order of the fields, the search for the field of a property starts after
+ * the field of the previous property, so that matching usually takes a single comparison.
+ *
+ * @remarks Spans point into the JSON text, with strings still escaped.
+ */
+AZ_NODISCARD az_result az_json_binding_read(
+    az_json_reader* ref_json_reader,
+    az_json_binding const* binding,
+    void* ref_value,
+    uint32_t* out_present);
+
+/**
+ * @brief Gets the exact size of the JSON text #az_json_binding_write() writes for a C struct.
+ *
+ * @param[in] binding The binding of the members of the struct to the properties of a JSON object.
+ * @param[in] value A pointer to the struct to write.
+ * @param[out] out_size The size of the JSON text, in bytes, not counting the comma that separates
+ * it from a previous value.
+ *
+ * @pre \p binding must not be `NULL`.
+ * @pre \p value must not be `NULL`.
+ * @pre \p out_size must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The size was computed.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR A member of type #AZ_JSON_BINDING_JSON is not valid JSON text,
+ * or one of type #AZ_JSON_BINDING_JSON_OBJECT is not the JSON text of an object.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The JSON text would be larger than `INT32_MAX` bytes.
+ *
+ * @remarks Use it to size a single buffer to write the JSON text into, instead of providing a
+ * buffer large enough for any value, or non-contiguous buffers to #az_json_writer_chunked_init().
+ */
+AZ_NODISCARD az_result az_json_binding_get_write_size(
+    az_json_binding const* binding,
+    void const* value,
+    int32_t* out_size);
+
+/**
+ * @brief Appends a C struct as a JSON object, as described by a binding.
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance containing the buffer to
+ * append the JSON object to.
+ * @param[in] binding The binding of the members of the struct to the properties of a JSON object.
+ * @param[in] value A pointer to the struct to write.
+ *
+ * @pre \p ref_json_writer must not be `NULL`.
+ * @pre \p binding must not be `NULL`.
+ * @pre \p value must not be `NULL`.
+ * @pre The writer must be in a state where a value can be appended.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The JSON object was appended.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR A member of type #AZ_JSON_BINDING_JSON is not valid JSON text,
+ * or one of type #AZ_JSON_BINDING_JSON_OBJECT is not the JSON text of an object.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The destination buffer is too small for the JSON object.
+ *
+ * @remarks The properties are written in the order of the fields, without whitespace. Fields of
+ * type #AZ_JSON_BINDING_STRING, #AZ_JSON_BINDING_JSON or #AZ_JSON_BINDING_JSON_OBJECT whose member
+ * is empty are not written.
+ * Arrays are written with the number of elements given by their count member.
+ *
+ * @remarks The size of the JSON object is computed first, so that it is written in a single
+ * contiguous slice of the destination, with keys copied as they are rather than escaped, and
+ * nothing written if it does not fit. A writer initialized with #az_json_writer_chunked_init()
+ * asks its allocator for a buffer large enough for the whole object.
+ */
+AZ_NODISCARD az_result az_json_binding_write(
+    az_json_writer* ref_json_writer,
+    az_json_binding const* binding,
+    void const* value);
+
+/************************************ JSON QUERY ******************/
+
+/**
+ * @brief Finds the values of several properties of a JSON document, given by their paths, in a
+ * single pass of a reader.
+ *
+ * @param[in,out] ref_json_reader A pointer to an #az_json_reader instance, on the token that begins
+ * the root JSON object, or before the first token of the JSON document.
+ * @param[in] paths The paths of the properties to find. A path is the names of the properties from
+ * the root object to the property, separated by dots, such as `desired.$version`.
+ * @param[in] paths_length The number of paths.
+ * @param[out] out_values An array of \p paths_length tokens, where element `i` is set to the value
+ * of the property of `paths[i]`, or has the kind #AZ_JSON_TOKEN_NONE if it is not found.
+ * @param[out] out_found __[nullable]__ A pointer to a bit mask, where bit `i` is set if the
+ * property of `paths[i]` is found.
+ *
+ * @pre \p ref_json_reader must not be `NULL`.
+ * @pre \p paths must not be `NULL`.
+ * @pre \p paths_length must be between 1 and 32 (inclusive).
+ * @pre \p out_values must not be `NULL`.
+ * @pre Each path must be made of non-empty property names.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The JSON document was searched, whether or not all the properties were found.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR An invalid character is detected, or the JSON document is not a
+ * JSON object.
+ * @retval #AZ_ERROR_UNEXPECTED_END The end of the JSON document is reached.
+ *
+ * @remarks Property names are compared with the text of each path, so a name that contains a dot
+ * cannot be part of a path, and the elements of arrays cannot be reached.
+ *
+ * @remarks Only the objects that lead to a property not found yet are read; the values of any other
+ * property are skipped. If a property appears more than once, its first value is kept. Reading
+ * stops as soon as all the properties are found, so the reader must not be used to read the rest
+ * of the JSON document.
+ *
+ * @remarks The value of a property that is a JSON object or array is the token that begins it.
+ */
+AZ_NODISCARD az_result az_json_query_read(
+    az_json_reader* ref_json_reader,
+    az_span const* paths,
+    int32_t paths_length,
+    az_json_token* out_values,
+    uint32_t* out_found);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_JSON_H
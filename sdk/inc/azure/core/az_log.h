@@ -122,6 +122,161 @@ AZ_INLINE void az_log_set_classification_filter_callback(
 }
 #endif // AZ_NO_LOGGING
 
+/**
+ * @brief Sets the classifications of the SDK log messages that should be reported, as an
+ * alternative to #az_log_set_classification_filter_callback().
+ *
+ * @details The classifications are stored as a bitmask, so checking whether a log message should
+ * be reported takes a single load and bit test instead of a call to an
+ * #az_log_classification_filter_fn. This replaces any filter callback set previously, and calling
+ * #az_log_set_classification_filter_callback() afterwards replaces this bitmask.
+ *
+ * @param[in] classifications __[nullable]__ The classifications to report. Only classifications
+ * defined by the SDK (such as #az_log_classification_core and #az_log_classification_iot values)
+ * can be set.
+ * @param[in] classifications_length The number of elements in \p classifications. If `0`, no log
+ * messages are reported.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_ARG One of \p classifications is not defined by the SDK. The classification
+ * filter is left unchanged.
+ */
+#ifndef AZ_NO_LOGGING
+AZ_NODISCARD az_result az_log_set_classifications(
+    az_log_classification const classifications[],
+    int32_t classifications_length);
+#else
+AZ_NODISCARD AZ_INLINE az_result az_log_set_classifications(
+    az_log_classification const classifications[],
+    int32_t classifications_length)
+{
+  (void)classifications;
+  (void)classifications_length;
+  return AZ_OK;
+}
+#endif // AZ_NO_LOGGING
+
+/**
+ * @brief A lock-free ring buffer that stores log records on the request path and formats them
+ * later.
+ *
+ * @details When a ring buffer is set with #az_log_set_ring_buffer(), the SDK no longer formats log
+ * messages and invokes the #az_log_message_fn synchronously. Instead, it copies the raw values of
+ * each message (for example, the URL and headers of an HTTP request) into the ring buffer as a
+ * compact binary record. Records are formatted into text and delivered when the application calls
+ * #az_log_ring_buffer_drain(), typically from a low priority thread or an idle loop.
+ *
+ * Any number of threads may write records concurrently, and one thread at a time may drain them.
+ * Records that do not fit in the buffer are dropped and counted.
+ */
+typedef struct
+{
+  struct
+  {
+    uint8_t* buffer;
+    uint32_t mask;
+    uint32_t reserve_position;
+    uint32_t read_position;
+    uint32_t dropped_count;
+  } _internal;
+} az_log_ring_buffer;
+
+/**
+ * @brief Defines the signature of the callback function that receives log records drained from an
+ * #az_log_ring_buffer.
+ *
+ * @param[in] classification The log message's #az_log_classification.
+ * @param[in] timestamp_msec The platform clock, in milliseconds, when the record was written.
+ * @param[in] message The formatted log message.
+ * @param[in] user_context The context passed to #az_log_ring_buffer_drain().
+ */
+typedef void (*az_log_record_fn)(
+    az_log_classification classification,
+    int64_t timestamp_msec,
+    az_span message,
+    void* user_context);
+
+#ifndef AZ_NO_LOGGING
+/**
+ * @brief Initializes an #az_log_ring_buffer over a caller-provided buffer.
+ *
+ * @param[out] out_ring_buffer The #az_log_ring_buffer to initialize.
+ * @param[in] buffer The memory used to store records. The ring buffer uses the largest power of two
+ * number of 8-byte aligned bytes that fits in \p buffer.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p buffer is smaller than 64 bytes.
+ */
+AZ_NODISCARD az_result
+az_log_ring_buffer_init(az_log_ring_buffer* out_ring_buffer, az_span buffer);
+
+/**
+ * @brief Sets the ring buffer that SDK log records are written to.
+ *
+ * @param[in] ring_buffer __[nullable]__ A pointer to an initialized #az_log_ring_buffer. If `NULL`,
+ * log messages are formatted and passed to the #az_log_message_fn as soon as they are produced.
+ */
+void az_log_set_ring_buffer(az_log_ring_buffer* ring_buffer);
+
+/**
+ * @brief Formats the records stored in \p ref_ring_buffer, in the order they were written.
+ *
+ * @param[in,out] ref_ring_buffer The #az_log_ring_buffer to drain.
+ * @param[in] max_records The maximum number of records to drain, or `-1` to drain all of them.
+ * @param[in] callback __[nullable]__ The function that receives each formatted record. If `NULL`,
+ * records are passed to the #az_log_message_fn set with #az_log_set_message_callback().
+ * @param[in] user_context __[nullable]__ A context passed to \p callback.
+ *
+ * @return The number of records drained.
+ */
+int32_t az_log_ring_buffer_drain(
+    az_log_ring_buffer* ref_ring_buffer,
+    int32_t max_records,
+    az_log_record_fn callback,
+    void* user_context);
+
+/**
+ * @brief Gets the number of records dropped because \p ring_buffer was full.
+ *
+ * @param[in] ring_buffer The #az_log_ring_buffer to query.
+ *
+ * @return The number of dropped records.
+ */
+AZ_NODISCARD uint32_t az_log_ring_buffer_get_dropped_count(az_log_ring_buffer const* ring_buffer);
+#else
+AZ_NODISCARD AZ_INLINE az_result
+az_log_ring_buffer_init(az_log_ring_buffer* out_ring_buffer, az_span buffer)
+{
+  (void)out_ring_buffer;
+  (void)buffer;
+  return AZ_OK;
+}
+
+AZ_INLINE void az_log_set_ring_buffer(az_log_ring_buffer* ring_buffer) { (void)ring_buffer; }
+
+AZ_INLINE int32_t az_log_ring_buffer_drain(
+    az_log_ring_buffer* ref_ring_buffer,
+    int32_t max_records,
+    az_log_record_fn callback,
+    void* user_context)
+{
+  (void)ref_ring_buffer;
+  (void)max_records;
+  (void)callback;
+  (void)user_context;
+  return 0;
+}
+
+AZ_NODISCARD AZ_INLINE uint32_t
+az_log_ring_buffer_get_dropped_count(az_log_ring_buffer const* ring_buffer)
+{
+  (void)ring_buffer;
+  return 0;
+}
+#endif // AZ_NO_LOGGING
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_LOG_H
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Defines the 32-bit atomic operations used by the SDK's lock-free structures.
+ *
+ * @details When the compiler reports that 32-bit atomics are always lock-free, these map to the
+ * GCC/Clang `__atomic` builtins. Otherwise (for example, on cores without atomic read-modify-write
+ * instructions, or on compilers without the builtins) they fall back to plain reads and writes, and
+ * the structures using them must only be accessed from one thread at a time.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_ATOMIC_INTERNAL_H
+#define _az_ATOMIC_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+
+#define _az_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define _az_ATOMIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define _az_ATOMIC_INCREMENT(ptr) ((void)__atomic_fetch_add((ptr), 1U, __ATOMIC_RELAXED))
+#define _az_ATOMIC_COMPARE_EXCHANGE(ptr, ref_expected, desired) \
+  __atomic_compare_exchange_n(                                 \
+      (ptr), (ref_expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+#else // !__GCC_ATOMIC_INT_LOCK_FREE
+
+#define _az_ATOMIC_LOAD(ptr) (*(ptr))
+#define _az_ATOMIC_STORE(ptr, value) ((void)(*(ptr) = (value)))
+#define _az_ATOMIC_INCREMENT(ptr) ((void)(++(*(ptr))))
+#define _az_ATOMIC_COMPARE_EXCHANGE(ptr, ref_expected, desired) \
+  ((*(ptr) == *(ref_expected)) ? ((*(ptr) = (desired)), true)    \
+                               : ((*(ref_expected) = *(ptr)), false))
+
+#endif // __GCC_ATOMIC_INT_LOCK_FREE
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_ATOMIC_INTERNAL_H
@@ -27,6 +27,10 @@ enum
 {
   /// The maximum number of HTTP pipeline policies allowed.
   _az_MAXIMUM_NUMBER_OF_POLICIES = 10,
+
+  /// The size of the buffer needed for the value of any `Range` header: `bytes=`, followed by two
+  /// 19-digit offsets separated by a dash.
+  _az_HTTP_RANGE_HEADER_VALUE_SIZE = 45,
 };
 
 /**
@@ -115,6 +119,7 @@ AZ_NODISCARD az_http_policy_retry_options _az_http_policy_retry_options_default(
 //    Retry
 //    Authentication
 //    Logging
+//    Instrumentation
 //    Buffer Response
 //    Distributed Tracing
 //    TransportPolicy
@@ -160,6 +165,12 @@ AZ_NODISCARD az_result az_http_pipeline_policy_logging(
     az_http_response* ref_response);
 #endif // AZ_NO_LOGGING
 
+AZ_NODISCARD az_result az_http_pipeline_policy_instrumentation(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
 AZ_NODISCARD az_result az_http_pipeline_policy_transport(
     _az_http_policy* ref_policies,
     void* ref_options,
@@ -261,6 +272,27 @@ AZ_NODISCARD az_result az_http_request_set_query_parameter(
 AZ_NODISCARD az_result
 az_http_request_append_header(az_http_request* ref_request, az_span name, az_span value);
 
+/**
+ * @brief Add a `Range` header for the request, asking for the bytes from \p first_byte to \p
+ * last_byte of the resource, inclusive.
+ *
+ * @param ref_request HTTP request builder to add the header to.
+ * @param value_buffer The #az_span to write the value of the header to. It must remain valid until
+ * the request is sent. #_az_HTTP_RANGE_HEADER_VALUE_SIZE bytes are enough for any range.
+ * @param first_byte The offset of the first byte to get.
+ * @param last_byte The offset of the last byte to get.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE There isn't enough space in the \p ref_request to add a
+ * header, or in \p value_buffer for its value.
+ */
+AZ_NODISCARD az_result az_http_request_append_range_header(
+    az_http_request* ref_request,
+    az_span value_buffer,
+    int64_t first_byte,
+    int64_t last_byte);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_HTTP_INTERNAL_H
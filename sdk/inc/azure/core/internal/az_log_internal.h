@@ -19,6 +19,7 @@
 #include <azure/core/az_span.h>
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <azure/core/_az_cfg_prefix.h>
 
@@ -27,6 +28,32 @@
 bool _az_log_should_write(az_log_classification classification);
 void _az_log_write(az_log_classification classification, az_span message);
 
+/**
+ * @brief A record reserved in an #az_log_ring_buffer. The writer fills `body`, then commits it.
+ */
+typedef struct
+{
+  az_span body;
+  uint32_t* state;
+  uint32_t committed_state;
+} _az_log_record;
+
+// Returns the ring buffer that messages of this classification are written to, or NULL if no ring
+// buffer is set or the classification filter rejects the message.
+AZ_NODISCARD az_log_ring_buffer* _az_log_get_ring_buffer(az_log_classification classification);
+
+// Reserves a record of body_size bytes, or returns false (and counts a drop) if it does not fit.
+// Binary records are formatted by _az_http_policy_logging_format_record when drained.
+AZ_NODISCARD bool _az_log_ring_buffer_reserve(
+    az_log_ring_buffer* ref_ring_buffer,
+    az_log_classification classification,
+    bool is_binary,
+    int32_t body_size,
+    _az_log_record* out_record);
+
+// Publishes a reserved record to the reader.
+void _az_log_ring_buffer_commit(_az_log_record const* record);
+
 #define _az_LOG_SHOULD_WRITE(classification) _az_log_should_write(classification)
 #define _az_LOG_WRITE(classification, message) _az_log_write(classification, message)
 
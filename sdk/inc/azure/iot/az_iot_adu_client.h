@@ -283,7 +283,8 @@ typedef struct
    * Description of the content of an update.
    * @note This will come as an escaped string. This is done to guarantee ordering
    * of JSON values so that we may verify a signature over the payload.
-   * The user must unescape it using an API such as az_json_string_unescape() before
+   * The user must either unescape it using an API such as az_json_string_unescape(), or read it
+   * in place with an #az_json_reader initialized by az_json_reader_init_escaped(), before
    * subsequently calling az_iot_adu_client_parse_update_manifest() with it.
    */
   az_span update_manifest;
@@ -440,6 +441,133 @@ typedef struct
   az_span create_date_time;
 } az_iot_adu_client_update_manifest;
 
+/**
+ * @brief Step in the instructions of an update manifest parsed by
+ *        az_iot_adu_client_parse_update_manifest_compact().
+ */
+typedef struct
+{
+  /**
+   * Name of the update agent handler type that is expected to handle the step.
+   */
+  az_span handler;
+  /**
+   * Files needed for this update step, as an array of file ids, placed in the arena passed to
+   * az_iot_adu_client_parse_update_manifest_compact().
+   */
+  az_span* files;
+  /**
+   * Number of items in \p files.
+   */
+  uint32_t files_count;
+  /**
+   * Additional user-defined properties for the update step handler.
+   */
+  az_iot_adu_client_update_manifest_instructions_step_handler_properties handler_properties;
+} az_iot_adu_client_compact_update_manifest_step;
+
+/**
+ * @brief Details of a file referenced in an update manifest parsed by
+ *        az_iot_adu_client_parse_update_manifest_compact().
+ */
+typedef struct
+{
+  /**
+   * Identity of a file, correlated with the same id in #az_iot_adu_client_file_url
+   * and #az_iot_adu_client_compact_update_manifest_step.files.
+   */
+  az_span id;
+  /**
+   * Name of the file.
+   */
+  az_span file_name;
+  /**
+   * Size of a file, in bytes.
+   */
+  int64_t size_in_bytes;
+  /**
+   * Hashes provided for a given file in the update request, placed in the arena passed to
+   * az_iot_adu_client_parse_update_manifest_compact().
+   */
+  az_iot_adu_client_update_manifest_file_hash* hashes;
+  /**
+   * Number of items in \p hashes.
+   */
+  uint32_t hashes_count;
+} az_iot_adu_client_compact_update_manifest_file;
+
+/**
+ * @brief Structure that holds the parsed contents of the update manifest sent by the ADU
+ *        service, with as many steps, files and hashes as the manifest has.
+ *
+ * @details The arrays are placed in the arena passed to
+ * az_iot_adu_client_parse_update_manifest_compact(), which must outlive this structure.
+ */
+typedef struct
+{
+  /**
+   * Version of the update manifest schema.
+   */
+  az_span manifest_version;
+  /**
+   * User-defined identity of the update manifest.
+   */
+  az_iot_adu_update_id update_id;
+  /**
+   * Steps of the instructions of the update manifest.
+   */
+  az_iot_adu_client_compact_update_manifest_step* steps;
+  /**
+   * Number of items in \p steps.
+   */
+  uint32_t steps_count;
+  /**
+   * The files referenced in the update manifest instructions.
+   */
+  az_iot_adu_client_compact_update_manifest_file* files;
+  /**
+   * Number of items in \p files.
+   */
+  uint32_t files_count;
+  /**
+   * The creation date and time.
+   */
+  az_span create_date_time;
+} az_iot_adu_client_compact_update_manifest;
+
+/**
+ * @brief Structure that holds the parsed contents of the ADU request sent by the ADU service, with
+ *        as many file urls as the request has.
+ *
+ * @details The file urls are placed in the arena passed to
+ * az_iot_adu_client_parse_service_properties_compact(), which must outlive this structure.
+ */
+typedef struct
+{
+  /**
+   * A set of values that indicate which deployment the agent is currently working on.
+   */
+  az_iot_adu_client_workflow workflow;
+  /**
+   * Description of the content of an update, escaped as in
+   * #az_iot_adu_client_update_request.update_manifest.
+   */
+  az_span update_manifest;
+  /**
+   * A JSON Web Signature (JWS) with JSON Web Keys used for source verification.
+   */
+  az_span update_manifest_signature;
+  /**
+   * The files associated with the deployment, correlated with the files of the update manifest
+   * by their IDs.
+   */
+  az_iot_adu_client_file_url* file_urls;
+  /**
+   * Number of items in \p file_urls.
+   */
+  uint32_t file_urls_count;
+} az_iot_adu_client_compact_update_request;
+
 /**
  * @brief User-defined options for the Azure IoT ADU client.
  *
@@ -464,6 +592,25 @@ typedef struct
   } _internal;
 } az_iot_adu_client;
 
+/**
+ * @brief An agent state payload with the parts that do not change from one report to the next
+ *        rendered once.
+ *
+ * @details The device properties, the compatibility property names and the installed update id
+ * are rendered into the buffer of the template by az_iot_adu_client_agent_state_template_init().
+ * az_iot_adu_client_agent_state_template_get_payload() then only writes the last install result,
+ * the agent state and the workflow of each report.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span buffer;
+    int32_t prefix_size;
+    int32_t suffix_size;
+  } _internal;
+} az_iot_adu_client_agent_state_template;
+
 /**
  * @brief Gets the default Azure IoT ADU Client options.
  * @details Call this to obtain an initialized #az_iot_adu_client_options structure that can be
@@ -542,6 +689,71 @@ AZ_NODISCARD az_result az_iot_adu_client_get_agent_state_payload(
     az_iot_adu_client_install_result* last_install_result,
     az_json_writer* ref_json_writer);
 
+/**
+ * @brief Renders the parts of the agent state payload that do not change from one report to the
+ *        next into a template.
+ *
+ * @param[in] client                The #az_iot_adu_client to use for this call.
+ * @param[in] device_properties     A pointer to a #az_iot_adu_client_device_properties
+ *                                  structure with all the details of the device,
+ *                                  as required by the ADU service.
+ * @param[in] buffer                The memory where to render the template and to write the
+ *                                  payloads of
+ *                                  az_iot_adu_client_agent_state_template_get_payload(). It must
+ *                                  outlive \p out_agent_state_template and must not be written
+ *                                  to by the application.
+ * @param[out] out_agent_state_template The #az_iot_adu_client_agent_state_template to initialize.
+ * @pre \p client must not be `NULL`.
+ * @pre \p device_properties must not be `NULL`.
+ * @pre \p buffer must be a valid span of size greater than 0.
+ * @pre \p out_agent_state_template must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The template was rendered.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p buffer is too small for the template.
+ * @remark The device properties must be rendered again, with a new template, when they change.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_agent_state_template_init(
+    az_iot_adu_client* client,
+    az_iot_adu_client_device_properties* device_properties,
+    az_span buffer,
+    az_iot_adu_client_agent_state_template* out_agent_state_template);
+
+/**
+ * @brief Generates the Azure Plug-and-Play (reported) properties payload with the state of the
+ *        ADU agent from a template.
+ *
+ * @details The payload is the same as the one az_iot_adu_client_get_agent_state_payload()
+ * generates with the device properties of the template, but only the last install result, the
+ * agent state and the workflow are written. The payload is written into the buffer of the
+ * template, replacing the previous payload.
+ *
+ * @param[in] agent_state_template  The #az_iot_adu_client_agent_state_template to use for this
+ *                                  call.
+ * @param[in] agent_state           An integer value indicating the current state of
+ *                                  the ADU agent. Use the values defined by the
+ *                                  #az_iot_adu_client_agent_state.
+ * @param[in] workflow              A pointer to a #az_iot_adu_client_workflow instance
+ *                                  indicating the current ADU workflow being processed,
+ *                                  if an ADU service workflow was received. Use NULL
+ *                                  if no device update is in progress.
+ * @param[in] last_install_result   A pointer to a #az_iot_adu_client_install_result
+ *                                  instance with the results of the current or past
+ *                                  device update workflow, if available. Use NULL
+ *                                  if no results are available.
+ * @param[out] out_payload          The property payload, in the buffer of the template.
+ * @pre \p agent_state_template must not be `NULL`.
+ * @pre \p out_payload must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The payload was generated.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer of the template is too small for the payload.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_agent_state_template_get_payload(
+    az_iot_adu_client_agent_state_template const* agent_state_template,
+    az_iot_adu_client_agent_state agent_state,
+    az_iot_adu_client_workflow* workflow,
+    az_iot_adu_client_install_result* last_install_result,
+    az_span* out_payload);
+
 /**
  * @brief Parses the json content from the ADU service writable properties into
  *        a pre-defined structure.
@@ -564,6 +776,38 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
     az_json_reader* ref_json_reader,
     az_iot_adu_client_update_request* update_request);
 
+/**
+ * @brief Parses the json content from the ADU service writable properties, placing the file urls
+ *        into a caller-provided arena.
+ *
+ * @details Unlike az_iot_adu_client_parse_service_properties(), the number of file urls is not
+ * limited at compile time. Strings are not copied: the #az_span fields point to the data read by
+ * \p ref_json_reader.
+ *
+ * @param[in] client              The #az_iot_adu_client to use for this call.
+ * @param[in] ref_json_reader     A #az_json_reader initialized with the ADU service writable
+ *                                properties json, set to the beginning of the json object that is
+ *                                the value of the ADU component.
+ * @param[in] arena               Memory where to place the file urls. It must outlive
+ *                                \p out_update_request.
+ * @param[out] out_update_request The structure where the parsed values of the request are stored.
+ * @param[out] out_arena_size     The number of bytes of \p arena used.
+ * @pre \p client must not be `NULL`.
+ * @pre \p ref_json_reader must not be `NULL`.
+ * @pre \p arena must be a valid span.
+ * @pre \p out_update_request must not be `NULL`.
+ * @pre \p out_arena_size must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The update request was parsed.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p arena is too small for the file urls.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties_compact(
+    az_iot_adu_client* client,
+    az_json_reader* ref_json_reader,
+    az_span arena,
+    az_iot_adu_client_compact_update_request* out_update_request,
+    int32_t* out_arena_size);
+
 /**
  * @brief    Generates the payload necessary to respond to the service
              after receiving incoming properties.
@@ -602,6 +846,39 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_update_manifest(
     az_json_reader* ref_json_reader,
     az_iot_adu_client_update_manifest* update_manifest);
 
+/**
+ * @brief Parses the json content from the ADU service update manifest, placing its steps, files
+ *        and hashes into a caller-provided arena.
+ *
+ * @details Unlike az_iot_adu_client_parse_update_manifest(), the number of steps, files per
+ * step, files and hashes per file is not limited at compile time: each array takes as much of
+ * \p arena as the manifest needs, and the manifest is still read in a single pass. As with
+ * az_iot_adu_client_parse_update_manifest(), strings are not copied: the #az_span fields point
+ * to the data read by \p ref_json_reader.
+ *
+ * @param[in] client              The #az_iot_adu_client to use for this call.
+ * @param[in] ref_json_reader     ADU update manifest, as initialized json reader.
+ * @param[in] arena               Memory where to place the arrays of the update manifest. It must
+ *                                outlive \p out_update_manifest.
+ * @param[out] out_update_manifest The structure where the parsed values of the manifest are
+ *                                stored.
+ * @param[out] out_arena_size     The number of bytes of \p arena used.
+ * @pre \p client must not be `NULL`.
+ * @pre \p ref_json_reader must not be `NULL`.
+ * @pre \p arena must be a valid span.
+ * @pre \p out_update_manifest must not be `NULL`.
+ * @pre \p out_arena_size must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The update manifest was parsed.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p arena is too small for the update manifest.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_parse_update_manifest_compact(
+    az_iot_adu_client* client,
+    az_json_reader* ref_json_reader,
+    az_span arena,
+    az_iot_adu_client_compact_update_manifest* out_update_manifest,
+    int32_t* out_arena_size);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_IOT_ADU_H
@@ -0,0 +1,445 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the ADU file download, which fetches the files of an update in chunks and
+ * verifies them against the update manifest as they arrive.
+ *
+ * @details The file is requested in fixed-size ranges, through an HTTP pipeline with a retry
+ * policy. Each chunk is added to a SHA-256 digest and handed to a sink, such as a flash writer,
+ * before the next one is requested, so the memory needed does not depend on the size of the file.
+ * Once the last chunk is received, the digest is compared with the `sha256` hash of the file in
+ * the update manifest.
+ *
+ * Large files can instead be downloaded with an #az_iot_adu_client_download_scheduler, which splits
+ * the file into ranges that can be fetched at the same time, in any order, and keeps track of the
+ * ranges received in a bitmap the application persists to resume the download after a restart.
+ * The ranges are written at their offset in the file, and the whole file is verified once they
+ * have all been received.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_ADU_CLIENT_DOWNLOAD_H
+#define _az_IOT_ADU_CLIENT_DOWNLOAD_H
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_adu_client.h>
+
+#include <azure/iot/internal/az_iot_adu_internal.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief Receives a chunk of a file being downloaded.
+ *
+ * @param[in] chunk The bytes of the chunk. They are overwritten by the next chunk, so they must be
+ * copied or written out before returning.
+ * @param[in] offset The offset, in bytes, of the chunk within the file.
+ * @param[in] user_context The `sink_context` passed to az_iot_adu_client_download_file().
+ * @return An #az_result value indicating the result of the operation. A failure stops the
+ * download and is returned by az_iot_adu_client_download_file().
+ */
+typedef AZ_NODISCARD az_result (
+    *az_iot_adu_client_download_sink)(az_span chunk, int64_t offset, void* user_context);
+
+/**
+ * @brief Reads back part of a file that was downloaded.
+ *
+ * @param[out] destination The #az_span to fill with the bytes of the file.
+ * @param[in] offset The offset, in bytes, of the first byte to read.
+ * @param[in] user_context The `source_context` passed to az_iot_adu_client_download_verify_file().
+ * @return An #az_result value indicating the result of the operation.
+ */
+typedef AZ_NODISCARD az_result (
+    *az_iot_adu_client_download_source)(az_span destination, int64_t offset, void* user_context);
+
+/**
+ * @brief Options for downloading the files of an update.
+ */
+typedef struct
+{
+  /// The size, in bytes, of the ranges az_iot_adu_client_download_file() requests the file in. The
+  /// response buffer must hold a chunk of this size along with the status line and headers of the
+  /// response.
+  int32_t chunk_size;
+
+  /// The retry policy applied to each range request.
+  az_http_policy_retry_options retry_options;
+
+  /// The metrics and callback each attempt to fetch a range is reported to. Nothing is recorded
+  /// when both are `NULL`, which is the default.
+  az_http_policy_instrumentation_options instrumentation_options;
+} az_iot_adu_client_download_options;
+
+/**
+ * @brief Gets the default #az_iot_adu_client_download_options.
+ *
+ * @details Chunks of 4 KiB, with the default retry policy of the SDK.
+ *
+ * @return An #az_iot_adu_client_download_options.
+ */
+AZ_NODISCARD az_iot_adu_client_download_options az_iot_adu_client_download_options_default(void);
+
+/**
+ * @brief Downloads a file of an update, and verifies its SHA-256 hash.
+ *
+ * @details The url of the file is found in the `file_urls` of \p update_request by the ID of \p
+ * file. The chunks reach the sink in order, and are not verified until the whole file has been
+ * received: the sink must not commit the file before this function returns #AZ_OK.
+ *
+ * @param[in] update_request The #az_iot_adu_client_update_request with the url of the file.
+ * @param[in] file The #az_iot_adu_client_update_manifest_file to download, from the update
+ * manifest.
+ * @param[in] context A pointer to an #az_context node, to cancel the download with.
+ * @param[in] url_buffer The #az_span to unescape the url of the file into.
+ * @param[in] response_buffer The #az_span each range response is received into.
+ * @param[in] sink The #az_iot_adu_client_download_sink the chunks are written through.
+ * @param[in] sink_context __[nullable]__ A context passed to \p sink.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_adu_client_download_options
+ * structure. If `NULL`, the default options are used.
+ * @pre \p update_request must not be `NULL`.
+ * @pre \p file must not be `NULL`, and its size must not be negative.
+ * @pre \p context must not be `NULL`.
+ * @pre \p url_buffer and \p response_buffer must be valid spans of size greater than 0.
+ * @pre \p sink must not be `NULL`.
+ * @pre The chunk size must be greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The file was downloaded, and its hash matches the update manifest.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The update request has no url for the file, or the update
+ * manifest has no `sha256` hash for it.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The `sha256` hash of the file is not a base64 encoded SHA-256
+ * digest.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p url_buffer is too small for the url, or \p response_buffer
+ * for a response.
+ * @retval #AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED The server answered a range request with an
+ * unexpected status code or number of bytes.
+ * @retval #AZ_ERROR_IOT_ADU_FILE_HASH_MISMATCH The SHA-256 hash of the downloaded file does not
+ * match the update manifest.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_file(
+    az_iot_adu_client_update_request const* update_request,
+    az_iot_adu_client_update_manifest_file const* file,
+    az_context* context,
+    az_span url_buffer,
+    az_span response_buffer,
+    az_iot_adu_client_download_sink sink,
+    void* sink_context,
+    az_iot_adu_client_download_options const* options);
+
+/**
+ * @brief Downloads a file of an update parsed in the compact model, and verifies its SHA-256 hash.
+ *
+ * @details Same as az_iot_adu_client_download_file(), for an update request parsed by
+ * az_iot_adu_client_parse_service_properties_compact() and a file of an update manifest parsed by
+ * az_iot_adu_client_parse_update_manifest_compact().
+ *
+ * @param[in] update_request The #az_iot_adu_client_compact_update_request with the url of the
+ * file.
+ * @param[in] file The #az_iot_adu_client_compact_update_manifest_file to download.
+ * @param[in] context A pointer to an #az_context node, to cancel the download with.
+ * @param[in] url_buffer The #az_span to unescape the url of the file into.
+ * @param[in] response_buffer The #az_span each range response is received into.
+ * @param[in] sink The #az_iot_adu_client_download_sink the chunks are written through.
+ * @param[in] sink_context __[nullable]__ A context passed to \p sink.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_adu_client_download_options
+ * structure. If `NULL`, the default options are used.
+ * @pre Same as az_iot_adu_client_download_file().
+ * @return An #az_result value indicating the result of the operation, as returned by
+ * az_iot_adu_client_download_file().
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_file_compact(
+    az_iot_adu_client_compact_update_request const* update_request,
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    az_context* context,
+    az_span url_buffer,
+    az_span response_buffer,
+    az_iot_adu_client_download_sink sink,
+    void* sink_context,
+    az_iot_adu_client_download_options const* options);
+
+/**
+ * @brief A range of a file to download.
+ */
+typedef struct
+{
+  /// The offset, in bytes, of the range within the file.
+  int64_t offset;
+
+  /// The size, in bytes, of the range.
+  int32_t size;
+
+  /// The index of the range within the file.
+  int32_t index;
+} az_iot_adu_client_download_range;
+
+/**
+ * @brief Splits a file into ranges and tracks which of them have been received.
+ *
+ * @details The scheduler does not synchronize access to itself: if ranges are fetched from several
+ * threads, calls to the scheduler must be serialized by the application.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span progress;
+    int64_t file_size;
+    int32_t range_size;
+    int32_t range_count;
+    int32_t received_count;
+    int32_t in_flight[_az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT];
+    int32_t in_flight_count;
+  } _internal;
+} az_iot_adu_client_download_scheduler;
+
+/**
+ * @brief Gets the size of the progress bitmap of a file.
+ *
+ * @param[in] file_size The size, in bytes, of the file.
+ * @param[in] range_size The size, in bytes, of the ranges the file is split into.
+ * @return The size, in bytes, of the progress bitmap: one bit per range.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_iot_adu_client_download_scheduler_get_progress_size(int64_t file_size, int32_t range_size)
+{
+  return (int32_t)(((file_size + range_size - 1) / range_size + 7) / 8);
+}
+
+/**
+ * @brief Initializes a scheduler for a file of an update.
+ *
+ * @param[out] out_scheduler The #az_iot_adu_client_download_scheduler to initialize.
+ * @param[in] file The #az_iot_adu_client_update_manifest_file to download.
+ * @param[in] range_size The size, in bytes, of the ranges to split the file into.
+ * @param[in] progress The #az_span of the progress bitmap, where a bit is set for each range
+ * received. The application persists it, along with the ID of the file, to resume the download.
+ * @param[in] resume `true` to resume the download recorded in \p progress, `false` to start over.
+ * @pre \p out_scheduler must not be `NULL`.
+ * @pre \p file must not be `NULL`, and its size must not be negative.
+ * @pre \p range_size must be greater than 0, and split the file into at most INT32_MAX ranges.
+ * @pre \p progress must be a valid span of at least the size returned by
+ * az_iot_adu_client_download_scheduler_get_progress_size().
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The scheduler was initialized successfully.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_init(
+    az_iot_adu_client_download_scheduler* out_scheduler,
+    az_iot_adu_client_update_manifest_file const* file,
+    int32_t range_size,
+    az_span progress,
+    bool resume);
+
+/**
+ * @brief Initializes a scheduler for a file of an update manifest parsed by
+ * az_iot_adu_client_parse_update_manifest_compact().
+ *
+ * @param[out] out_scheduler The #az_iot_adu_client_download_scheduler to initialize.
+ * @param[in] file The #az_iot_adu_client_compact_update_manifest_file to download.
+ * @param[in] range_size The size, in bytes, of the ranges to split the file into.
+ * @param[in] progress The #az_span of the progress bitmap, as in
+ * az_iot_adu_client_download_scheduler_init().
+ * @param[in] resume `true` to resume the download recorded in \p progress, `false` to start over.
+ * @pre Same as az_iot_adu_client_download_scheduler_init().
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The scheduler was initialized successfully.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_init_compact(
+    az_iot_adu_client_download_scheduler* out_scheduler,
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    int32_t range_size,
+    az_span progress,
+    bool resume);
+
+/**
+ * @brief Gets the next range to fetch, and marks it in flight.
+ *
+ * @param[in,out] ref_scheduler The #az_iot_adu_client_download_scheduler to use for this call.
+ * @param[out] out_range The #az_iot_adu_client_download_range to fetch.
+ * @pre \p ref_scheduler must not be `NULL`.
+ * @pre \p out_range must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK A range to fetch was returned.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND All the ranges not received yet are already in flight.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE #_az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT ranges are
+ * already in flight.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_next_range(
+    az_iot_adu_client_download_scheduler* ref_scheduler,
+    az_iot_adu_client_download_range* out_range);
+
+/**
+ * @brief Records that a range in flight was received.
+ *
+ * @details The bit of the range is set in the progress bitmap, which the application can then
+ * persist.
+ *
+ * @param[in,out] ref_scheduler The #az_iot_adu_client_download_scheduler to use for this call.
+ * @param[in] range The #az_iot_adu_client_download_range received.
+ * @pre \p ref_scheduler must not be `NULL`.
+ * @pre \p range must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The range was recorded.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The range is not in flight.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_complete_range(
+    az_iot_adu_client_download_scheduler* ref_scheduler,
+    az_iot_adu_client_download_range const* range);
+
+/**
+ * @brief Records that fetching a range in flight failed, so that it is returned again by
+ * az_iot_adu_client_download_scheduler_next_range().
+ *
+ * @param[in,out] ref_scheduler The #az_iot_adu_client_download_scheduler to use for this call.
+ * @param[in] range The #az_iot_adu_client_download_range that failed.
+ * @pre \p ref_scheduler must not be `NULL`.
+ * @pre \p range must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The range was released.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The range is not in flight.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_release_range(
+    az_iot_adu_client_download_scheduler* ref_scheduler,
+    az_iot_adu_client_download_range const* range);
+
+/**
+ * @brief Checks whether all the ranges of the file have been received.
+ *
+ * @param[in] scheduler The #az_iot_adu_client_download_scheduler to use for this call.
+ * @return `true` if the file has been received, `false` otherwise.
+ */
+AZ_NODISCARD AZ_INLINE bool az_iot_adu_client_download_scheduler_is_complete(
+    az_iot_adu_client_download_scheduler const* scheduler)
+{
+  return scheduler->_internal.received_count == scheduler->_internal.range_count;
+}
+
+/**
+ * @brief Gets the url of a file of an update.
+ *
+ * @param[in] update_request The #az_iot_adu_client_update_request with the url of the file.
+ * @param[in] file The #az_iot_adu_client_update_manifest_file to get the url of.
+ * @param[in] url_buffer The #az_span to unescape the url into.
+ * @param[out] out_url The url, a slice of \p url_buffer.
+ * @pre \p update_request must not be `NULL`.
+ * @pre \p file must not be `NULL`.
+ * @pre \p url_buffer must be a valid span of size greater than 0.
+ * @pre \p out_url must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The url was returned.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The update request has no url for the file.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p url_buffer is too small for the url.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_get_url(
+    az_iot_adu_client_update_request const* update_request,
+    az_iot_adu_client_update_manifest_file const* file,
+    az_span url_buffer,
+    az_span* out_url);
+
+/**
+ * @brief Gets the url of a file of an update parsed in the compact model.
+ *
+ * @param[in] update_request The #az_iot_adu_client_compact_update_request with the url of the
+ * file.
+ * @param[in] file The #az_iot_adu_client_compact_update_manifest_file to get the url of.
+ * @param[in] url_buffer The #az_span to unescape the url into.
+ * @param[out] out_url The url, a slice of \p url_buffer.
+ * @pre Same as az_iot_adu_client_download_get_url().
+ * @return An #az_result value indicating the result of the operation, as returned by
+ * az_iot_adu_client_download_get_url().
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_get_url_compact(
+    az_iot_adu_client_compact_update_request const* update_request,
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    az_span url_buffer,
+    az_span* out_url);
+
+/**
+ * @brief Fetches a range of a file, and writes it through a sink at its offset in the file.
+ *
+ * @details The server must answer with `206 Partial Content` and the requested range. Ranges can
+ * be fetched at the same time from several threads, each with its own \p response_buffer.
+ *
+ * @param[in] url The url of the file, from az_iot_adu_client_download_get_url().
+ * @param[in] range The #az_iot_adu_client_download_range to fetch.
+ * @param[in] context A pointer to an #az_context node, to cancel the request with.
+ * @param[in] response_buffer The #az_span the response is received into.
+ * @param[in] sink The #az_iot_adu_client_download_sink the range is written through.
+ * @param[in] sink_context __[nullable]__ A context passed to \p sink.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_adu_client_download_options
+ * structure, of which only the retry options are used. If `NULL`, the default options are used.
+ * @pre \p url must be a valid span of size greater than 0.
+ * @pre \p range must not be `NULL`.
+ * @pre \p context must not be `NULL`.
+ * @pre \p response_buffer must be a valid span of size greater than 0.
+ * @pre \p sink must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The range was received and written.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p response_buffer is too small for the response.
+ * @retval #AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED The server did not answer with the requested range.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_fetch_range(
+    az_span url,
+    az_iot_adu_client_download_range const* range,
+    az_context* context,
+    az_span response_buffer,
+    az_iot_adu_client_download_sink sink,
+    void* sink_context,
+    az_iot_adu_client_download_options const* options);
+
+/**
+ * @brief Verifies the SHA-256 hash of a file downloaded by ranges, by reading it back.
+ *
+ * @param[in] file The #az_iot_adu_client_update_manifest_file downloaded.
+ * @param[in] buffer The #az_span to read the file into, a part at a time.
+ * @param[in] source The #az_iot_adu_client_download_source the file is read through.
+ * @param[in] source_context __[nullable]__ A context passed to \p source.
+ * @pre \p file must not be `NULL`, and its size must not be negative.
+ * @pre \p buffer must be a valid span of size greater than 0.
+ * @pre \p source must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The hash of the file matches the update manifest.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The update manifest has no `sha256` hash for the file.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The `sha256` hash of the file is not a base64 encoded SHA-256
+ * digest.
+ * @retval #AZ_ERROR_IOT_ADU_FILE_HASH_MISMATCH The SHA-256 hash of the file does not match the
+ * update manifest.
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_verify_file(
+    az_iot_adu_client_update_manifest_file const* file,
+    az_span buffer,
+    az_iot_adu_client_download_source source,
+    void* source_context);
+
+/**
+ * @brief Verifies the SHA-256 hash of a file of an update manifest parsed by
+ * az_iot_adu_client_parse_update_manifest_compact(), by reading it back.
+ *
+ * @param[in] file The #az_iot_adu_client_compact_update_manifest_file downloaded.
+ * @param[in] buffer The #az_span to read the file into, a part at a time.
+ * @param[in] source The #az_iot_adu_client_download_source the file is read through.
+ * @param[in] source_context __[nullable]__ A context passed to \p source.
+ * @pre Same as az_iot_adu_client_download_verify_file().
+ * @return An #az_result value indicating the result of the operation, as returned by
+ * az_iot_adu_client_download_verify_file().
+ */
+AZ_NODISCARD az_result az_iot_adu_client_download_verify_file_compact(
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    az_span buffer,
+    az_iot_adu_client_download_source source,
+    void* source_context);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_ADU_CLIENT_DOWNLOAD_H
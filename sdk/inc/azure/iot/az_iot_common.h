@@ -36,6 +36,24 @@ enum az_result_iot
 
   /// While iterating, there are no more properties to return.
   AZ_ERROR_IOT_END_OF_PROPERTIES = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 2),
+
+  /// The MQTT packet is not complete yet; more bytes must be read from the network.
+  AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 3),
+
+  /// The MQTT packet does not follow the MQTT 3.1.1 specification.
+  AZ_ERROR_IOT_MQTT_MALFORMED_PACKET = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 4),
+
+  /// The twin patch does not follow the cached twin version; the full twin must be requested.
+  AZ_ERROR_IOT_TWIN_VERSION_GAP = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 5),
+
+  /// The server answered a download request with an unexpected status code or number of bytes.
+  AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 6),
+
+  /// The hash of a downloaded update file does not match the update manifest.
+  AZ_ERROR_IOT_ADU_FILE_HASH_MISMATCH = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 7),
+
+  /// The MQTT packet is larger than the decoder's buffer; its bytes are skipped.
+  AZ_ERROR_IOT_MQTT_PACKET_TOO_LARGE = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 8),
 };
 
 /**
@@ -290,6 +308,38 @@ AZ_NODISCARD int32_t az_iot_calculate_retry_delay(
     int32_t max_retry_delay_msec,
     int32_t random_jitter_msec);
 
+/**
+ * @brief The number of slots of a #_az_iot_timer_wheel.
+ */
+#define _az_IOT_TIMER_WHEEL_SIZE 64
+
+/**
+ * @brief The part of an entry scheduled on a #_az_iot_timer_wheel.
+ */
+typedef struct
+{
+  int64_t deadline_msec;
+  int32_t previous;
+  int32_t next;
+} _az_iot_timer_wheel_node;
+
+/**
+ * @brief A timer wheel over the entries of an array, shared by the request table and the
+ * provisioning batch.
+ */
+typedef struct
+{
+  struct
+  {
+    _az_iot_timer_wheel_node* first_node;
+    int32_t node_stride;
+    int32_t tick_msec;
+    int32_t count;
+    int64_t tick;
+    int32_t slots[_az_IOT_TIMER_WHEEL_SIZE];
+  } _internal;
+} _az_iot_timer_wheel;
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_IOT_CORE_H
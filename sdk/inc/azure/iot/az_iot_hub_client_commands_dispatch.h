@@ -0,0 +1,156 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the command dispatch table, which resolves received command requests to the
+ * command registered by the application.
+ *
+ * @details The application registers each (component, command) pair it implements once, in the
+ * order of its handlers. A received command request then resolves to the index of its command
+ * through a hash of the method name in the topic, instead of comparing the component and command
+ * names against every handler.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_H
+#define _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief A command registered in a dispatch table.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span component_name;
+    az_span command_name;
+    uint32_t hash;
+  } _internal;
+} az_iot_hub_client_commands_dispatch_entry;
+
+/**
+ * @brief A command dispatch table.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client_commands_dispatch_entry* entries;
+    int32_t entries_capacity;
+    int32_t entries_length;
+    int32_t* buckets;
+    uint32_t bucket_mask;
+  } _internal;
+} az_iot_hub_client_commands_dispatch;
+
+/**
+ * @brief Initializes a command dispatch table with no commands.
+ *
+ * @param[out] out_dispatch The #az_iot_hub_client_commands_dispatch to initialize.
+ * @param[in] entries The array holding the registered commands.
+ * @param[in] entries_capacity The number of elements in \p entries.
+ * @param[in] buckets The array holding the hash index over the commands.
+ * @param[in] buckets_length The number of elements in \p buckets. Must be a power of 2 greater than
+ * \p entries_capacity; twice \p entries_capacity keeps lookups short.
+ * @pre \p out_dispatch must not be `NULL`.
+ * @pre \p entries must not be `NULL`.
+ * @pre \p entries_capacity must be greater than 0.
+ * @pre \p buckets must not be `NULL`.
+ * @pre \p buckets_length must be a power of 2 greater than \p entries_capacity.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The dispatch table was initialized successfully.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_commands_dispatch_init(
+    az_iot_hub_client_commands_dispatch* out_dispatch,
+    az_iot_hub_client_commands_dispatch_entry entries[],
+    int32_t entries_capacity,
+    int32_t buckets[],
+    int32_t buckets_length);
+
+/**
+ * @brief Registers a command.
+ *
+ * @param[in,out] ref_dispatch The #az_iot_hub_client_commands_dispatch to use for this call.
+ * @param[in] component_name The name of the component implementing the command, or #AZ_SPAN_EMPTY
+ * for a command of the root interface. The span must stay valid while the table is used.
+ * @param[in] command_name The name of the command. The span must stay valid while the table is
+ * used.
+ * @param[out] out_command_index __[nullable]__ The index of the command, which is the number of
+ * commands registered before it.
+ * @pre \p ref_dispatch must not be `NULL`.
+ * @pre \p command_name must be a valid span of size greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The command was registered.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The dispatch table is full.
+ * @retval #AZ_ERROR_ARG The command is already registered for the component.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_commands_dispatch_add(
+    az_iot_hub_client_commands_dispatch* ref_dispatch,
+    az_span component_name,
+    az_span command_name,
+    int32_t* out_command_index);
+
+/**
+ * @brief Parses a received message's topic for command features, and resolves the request to a
+ * registered command.
+ *
+ * @details Once the command is handled, respond to it with
+ * az_iot_hub_client_commands_response_get_publish_topic() and the `request_id` of \p out_request.
+ * A request for a command which is not registered should be answered with
+ * #AZ_IOT_STATUS_NOT_FOUND.
+ *
+ * @param[in] dispatch The #az_iot_hub_client_commands_dispatch to use for this call.
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[in] received_topic An #az_span containing the received topic.
+ * @param[out] out_request If the message is a command request, this will contain the
+ * #az_iot_hub_client_command_request.
+ * @param[out] out_command_index The index of the command, as given by
+ * az_iot_hub_client_commands_dispatch_add().
+ * @pre \p dispatch must not be `NULL`.
+ * @pre \p client must not be `NULL`.
+ * @pre \p received_topic must be a valid span of size greater than 0.
+ * @pre \p out_request must not be `NULL`.
+ * @pre \p out_command_index must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The topic is a request for the command at \p out_command_index.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The topic is a request for a command which is not registered. \p
+ * out_request is populated.
+ * @retval #AZ_ERROR_IOT_TOPIC_NO_MATCH The topic is not a command request.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_commands_dispatch_parse_received_topic(
+    az_iot_hub_client_commands_dispatch const* dispatch,
+    az_iot_hub_client const* client,
+    az_span received_topic,
+    az_iot_hub_client_command_request* out_request,
+    int32_t* out_command_index);
+
+/**
+ * @brief Gets the number of registered commands.
+ *
+ * @param[in] dispatch The #az_iot_hub_client_commands_dispatch to use for this call.
+ * @return The number of registered commands.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_iot_hub_client_commands_dispatch_get_count(az_iot_hub_client_commands_dispatch const* dispatch)
+{
+  return dispatch->_internal.entries_length;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_H
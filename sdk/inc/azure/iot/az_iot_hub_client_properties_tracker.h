@@ -0,0 +1,160 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the reported properties tracker, which reports only the properties that
+ * changed since IoT Hub last acknowledged them.
+ *
+ * @details The application writes a snapshot of all its reported properties, with
+ * az_iot_hub_client_properties_writer_begin_component() and
+ * az_iot_hub_client_properties_writer_end_component() for the properties of components. The
+ * tracker keeps a copy of the snapshot last acknowledged by IoT Hub, and turns the snapshot into a
+ * patch with only the properties that are new, whose value changed, or that were removed.
+ *
+ * Only one patch is in flight at a time: snapshots taken while a patch waits for its response
+ * produce no patch, and their changes are coalesced into the next patch after the response.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_H
+#define _az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/az_iot_hub_client.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief The state kept by the tracker for a reported property.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span component_name;
+    az_span name;
+    az_span value;
+    uint32_t key_hash;
+    bool is_reported;
+  } _internal;
+} az_iot_hub_client_properties_tracker_entry;
+
+/**
+ * @brief A reported properties tracker.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client_properties_tracker_entry* entries;
+    int32_t entries_capacity;
+    int32_t entries_length;
+    int32_t next_entry;
+    az_span acknowledged_buffer;
+    az_span pending_buffer;
+    int32_t acknowledged_size;
+    int32_t pending_size;
+    bool is_patch_in_flight;
+  } _internal;
+} az_iot_hub_client_properties_tracker;
+
+/**
+ * @brief Initializes a reported properties tracker with no acknowledged properties.
+ *
+ * @param[out] out_tracker The #az_iot_hub_client_properties_tracker to initialize.
+ * @param[in] entries The array holding the state of the properties.
+ * @param[in] entries_capacity The number of elements in \p entries: the maximum number of
+ * properties, across all components, in a snapshot.
+ * @param[in] snapshot_buffer The buffer keeping copies of the acknowledged snapshot and of the
+ * snapshot of the patch in flight. It must be at least twice the size of the largest snapshot.
+ * @pre \p out_tracker must not be `NULL`.
+ * @pre \p entries must not be `NULL`.
+ * @pre \p entries_capacity must be greater than 0.
+ * @pre \p snapshot_buffer must be a valid span of size greater than or equal to 2.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The tracker was initialized successfully.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_tracker_init(
+    az_iot_hub_client_properties_tracker* out_tracker,
+    az_iot_hub_client_properties_tracker_entry entries[],
+    int32_t entries_capacity,
+    az_span snapshot_buffer);
+
+/**
+ * @brief Writes the reported properties patch for a snapshot of the reported properties.
+ *
+ * @details The patch holds the properties of the snapshot whose value is new or differs from the
+ * one last acknowledged, and is published with
+ * az_iot_hub_client_properties_get_reported_publish_topic(). Once the response to it is received,
+ * pass its status to az_iot_hub_client_properties_tracker_complete().
+ *
+ * Properties are identified by their component and property names, and values are compared by
+ * their JSON text, both as written in the snapshot. Acknowledged properties missing from the
+ * snapshot are reported as `null`, which removes them from the reported properties; components
+ * missing from the snapshot have each of their properties removed.
+ *
+ * @param[in,out] ref_tracker The #az_iot_hub_client_properties_tracker to use for this call.
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[in] snapshot A JSON object with all the reported properties of the device.
+ * @param[in] patch_buffer The buffer to write the patch to. It needs 64 bytes of slack for the JSON
+ * writer beyond the size of the patch.
+ * @param[out] out_patch The patch, or #AZ_SPAN_EMPTY if no property changed or a patch is in
+ * flight.
+ * @pre \p ref_tracker must not be `NULL`.
+ * @pre \p snapshot must be a valid span of size greater than 0.
+ * @pre \p patch_buffer must be a valid span of size greater than 0.
+ * @pre \p out_patch must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The patch was written, or there is nothing to report.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The snapshot has more properties than the tracker can hold,
+ * it is larger than half of the snapshot buffer, or the patch doesn't fit in \p patch_buffer. No
+ * patch is in flight.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_properties_tracker_get_patch(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_iot_hub_client const* client,
+    az_span snapshot,
+    az_span patch_buffer,
+    az_span* out_patch);
+
+/**
+ * @brief Completes the patch in flight with the status of its response.
+ *
+ * @details On success, the snapshot of the patch becomes the acknowledged one. Otherwise, its
+ * properties are reported again by the next patch.
+ *
+ * @param[in,out] ref_tracker The #az_iot_hub_client_properties_tracker to use for this call.
+ * @param[in] status The status of the response to the patch, or a failure status if the patch
+ * couldn't be published or timed out.
+ * @pre \p ref_tracker must not be `NULL`.
+ */
+void az_iot_hub_client_properties_tracker_complete(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_iot_status status);
+
+/**
+ * @brief Checks whether a patch is waiting for its response.
+ *
+ * @param[in] tracker The #az_iot_hub_client_properties_tracker to use for this call.
+ * @return `true` if a patch is in flight, `false` otherwise.
+ */
+AZ_NODISCARD AZ_INLINE bool az_iot_hub_client_properties_tracker_is_patch_in_flight(
+    az_iot_hub_client_properties_tracker const* tracker)
+{
+  return tracker->_internal.is_patch_in_flight;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_H
@@ -0,0 +1,217 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the telemetry batcher, which packs many small telemetry readings into a
+ * single message.
+ *
+ * @details IoT Hub meters and throttles telemetry per message. The batcher writes readings as the
+ * elements of one JSON array payload until the payload reaches a maximum size or the oldest reading
+ * has waited for the linger time, and publishes them with one set of message properties.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_HUB_CLIENT_TELEMETRY_BATCH_H
+#define _az_IOT_HUB_CLIENT_TELEMETRY_BATCH_H
+
+#include <azure/core/az_json.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/az_iot_hub_client.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief The default maximum size, in bytes, of a batch payload: the IoT Hub limit for
+ * device-to-cloud messages.
+ */
+#define AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_DEFAULT_MAX_PAYLOAD_SIZE (256 * 1024)
+
+/**
+ * @brief Options for the telemetry batcher.
+ */
+typedef struct
+{
+  /**
+   * The maximum size, in bytes, of the JSON array payload. The payload is also bounded by the size
+   * of the buffer given to az_iot_hub_client_telemetry_batch_init().
+   *
+   * @note The JSON writer needs 64 bytes of slack to append a reading, so the payload buffer should
+   * be 64 bytes larger than this size for batches to fill up to it.
+   */
+  int32_t max_payload_size;
+
+  /**
+   * The maximum time, in milliseconds, that the first reading of a batch waits before
+   * az_iot_hub_client_telemetry_batch_should_publish() reports the batch as ready.
+   */
+  int32_t linger_msec;
+} az_iot_hub_client_telemetry_batch_options;
+
+/**
+ * @brief A batch of telemetry readings.
+ */
+typedef struct
+{
+  struct
+  {
+    az_json_writer writer;
+    az_span properties_buffer;
+    az_iot_message_properties properties;
+    az_iot_hub_client_telemetry_batch_options options;
+    int64_t first_reading_msec;
+    int32_t count;
+  } _internal;
+} az_iot_hub_client_telemetry_batch;
+
+/**
+ * @brief Gets the default #az_iot_hub_client_telemetry_batch_options.
+ * @details Call this to obtain an initialized #az_iot_hub_client_telemetry_batch_options structure
+ * that can be afterwards modified and passed to az_iot_hub_client_telemetry_batch_init().
+ *
+ * @return #az_iot_hub_client_telemetry_batch_options.
+ */
+AZ_NODISCARD az_iot_hub_client_telemetry_batch_options
+az_iot_hub_client_telemetry_batch_options_default(void);
+
+/**
+ * @brief Initializes an empty telemetry batch.
+ *
+ * @param[out] out_batch The #az_iot_hub_client_telemetry_batch to initialize.
+ * @param[in] payload_buffer The buffer the JSON array payload is written to.
+ * @param[in] properties_buffer The buffer for the message properties of each batch. Can be
+ * #AZ_SPAN_EMPTY if batches are published without properties.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_hub_client_telemetry_batch_options
+ * structure. Can be `NULL` for default options.
+ * @pre \p out_batch must not be `NULL`.
+ * @pre \p payload_buffer must be a valid span of size greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The batch was initialized successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p payload_buffer is too small.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_init(
+    az_iot_hub_client_telemetry_batch* out_batch,
+    az_span payload_buffer,
+    az_span properties_buffer,
+    az_iot_hub_client_telemetry_batch_options const* options);
+
+/**
+ * @brief Gets the message properties of the current batch, to which the application can append
+ * properties with az_iot_message_properties_append().
+ *
+ * @param[in] ref_batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @return The properties of the current batch, or `NULL` if the batch was initialized without a
+ * properties buffer. The properties are cleared by az_iot_hub_client_telemetry_batch_reset().
+ */
+AZ_NODISCARD AZ_INLINE az_iot_message_properties*
+az_iot_hub_client_telemetry_batch_get_properties(az_iot_hub_client_telemetry_batch* ref_batch)
+{
+  return az_span_size(ref_batch->_internal.properties_buffer) > 0
+      ? &ref_batch->_internal.properties
+      : NULL;
+}
+
+/**
+ * @brief Appends a reading to the batch.
+ *
+ * @param[in,out] ref_batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @param[in] json_reading A single, possibly nested, valid JSON value, such as
+ * `{"temperature":21.5}`.
+ * @pre \p ref_batch must not be `NULL`.
+ * @pre \p json_reading must be a valid, non-empty #az_span.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The reading was appended.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The reading does not fit in the batch, which is left
+ * unchanged. Publish and reset the batch, then append the reading again. If the batch is empty,
+ * the reading is larger than the maximum payload size.
+ * @retval other \p json_reading is not valid JSON, and the batch is left unchanged.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_append(
+    az_iot_hub_client_telemetry_batch* ref_batch,
+    az_span json_reading);
+
+/**
+ * @brief Checks whether the batch should be published because its first reading has waited for
+ * the linger time.
+ *
+ * @param[in] batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @param[out] out_should_publish `true` if the batch is not empty and its linger time has elapsed.
+ * @pre \p batch must not be `NULL`.
+ * @pre \p out_should_publish must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The check was performed.
+ * @retval other The platform clock could not be read.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_should_publish(
+    az_iot_hub_client_telemetry_batch const* batch,
+    bool* out_should_publish);
+
+/**
+ * @brief Gets the MQTT topic and the JSON array payload to publish the batch with.
+ *
+ * @details The batch is not modified: more readings can still be appended, after which this
+ * function must be called again.
+ *
+ * @param[in] batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[out] mqtt_topic A buffer with sufficient capacity to hold the MQTT topic. If successful,
+ * contains a null-terminated string with the topic, including the batch's properties.
+ * @param[in] mqtt_topic_size The size, in bytes, of \p mqtt_topic.
+ * @param[out] out_mqtt_topic_length __[nullable]__ Contains the string length, in bytes, of \p
+ * mqtt_topic. Can be `NULL`.
+ * @param[out] out_payload The JSON array payload, which points into the batch's payload buffer.
+ * @pre \p batch must not be `NULL`.
+ * @pre \p client must not be `NULL`.
+ * @pre \p mqtt_topic must not be `NULL`.
+ * @pre \p mqtt_topic_size must be greater than 0.
+ * @pre \p out_payload must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The topic and payload were retrieved successfully.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The batch is empty.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p mqtt_topic is too small.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_get_publish_message(
+    az_iot_hub_client_telemetry_batch const* batch,
+    az_iot_hub_client const* client,
+    char* mqtt_topic,
+    size_t mqtt_topic_size,
+    size_t* out_mqtt_topic_length,
+    az_span* out_payload);
+
+/**
+ * @brief Empties the batch and clears its properties, once it was published.
+ *
+ * @param[in,out] ref_batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @pre \p ref_batch must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The batch was reset.
+ */
+AZ_NODISCARD az_result
+az_iot_hub_client_telemetry_batch_reset(az_iot_hub_client_telemetry_batch* ref_batch);
+
+/**
+ * @brief Gets the number of readings in the batch.
+ *
+ * @param[in] batch The #az_iot_hub_client_telemetry_batch to use for this call.
+ * @return The number of readings in the batch.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_iot_hub_client_telemetry_batch_get_count(az_iot_hub_client_telemetry_batch const* batch)
+{
+  return batch->_internal.count;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_HUB_CLIENT_TELEMETRY_BATCH_H
@@ -0,0 +1,245 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the store-and-forward queue for telemetry messages that could not be sent
+ * while the device was offline.
+ *
+ * @details The store keeps telemetry messages (the MQTT topic returned by
+ * az_iot_hub_client_telemetry_get_publish_topic() and the payload) in a caller-provided buffer,
+ * used as a ring. When the buffer is a memory-mapped file, the queued messages survive a restart
+ * or power loss: every record carries a CRC-32, and az_iot_hub_client_telemetry_store_init()
+ * recovers the records that were completely written, in order. When the buffer is full, the
+ * oldest messages are evicted to make room for new ones.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_HUB_CLIENT_TELEMETRY_STORE_H
+#define _az_IOT_HUB_CLIENT_TELEMETRY_STORE_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief The minimum size, in bytes, of the buffer given to
+ * az_iot_hub_client_telemetry_store_init().
+ */
+#define AZ_IOT_HUB_CLIENT_TELEMETRY_STORE_MIN_BUFFER_SIZE 128
+
+/**
+ * @brief Callback that makes the contents of the store's buffer durable, for example by calling
+ * `msync()` on a memory-mapped file.
+ *
+ * @param[in] context The `sync_context` from #az_iot_hub_client_telemetry_store_options.
+ *
+ * @return An #az_result value indicating the result of the operation. A failure is returned from
+ * the telemetry store function that requested the sync.
+ */
+typedef az_result (*az_iot_hub_client_telemetry_store_sync_fn)(void* context);
+
+/**
+ * @brief Options for the telemetry store.
+ */
+typedef struct
+{
+  /**
+   * Called to make the buffer durable. Can be `NULL` when the buffer is not persisted.
+   */
+  az_iot_hub_client_telemetry_store_sync_fn sync_callback;
+
+  /**
+   * Context passed to #sync_callback.
+   */
+  void* sync_context;
+
+  /**
+   * The number of appended messages after which the buffer is synced. Batching syncs trades
+   * durability of the most recent messages for append throughput. If 0, the buffer is only synced
+   * when az_iot_hub_client_telemetry_store_sync() is called, or when space freed by removing
+   * messages is about to be reused.
+   */
+  int32_t sync_interval;
+} az_iot_hub_client_telemetry_store_options;
+
+/**
+ * @brief A telemetry store.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span buffer;
+    az_iot_hub_client_telemetry_store_options options;
+    int32_t head;
+    int32_t tail;
+    int32_t wrap;
+    int32_t count;
+    int32_t unsynced_count;
+    uint32_t head_sequence;
+    uint32_t generation;
+    uint32_t evicted_count;
+    bool head_dirty;
+  } _internal;
+} az_iot_hub_client_telemetry_store;
+
+/**
+ * @brief A telemetry message read from the store.
+ *
+ * @details The spans point into the store's buffer, so that the message can be published without
+ * copying it. They remain valid until the message is removed or evicted.
+ */
+typedef struct
+{
+  /**
+   * The MQTT topic to publish the message to. The byte following the topic is a null terminator,
+   * so `(char const*)az_span_ptr(topic)` can be passed to MQTT clients that expect a C string.
+   */
+  az_span topic;
+
+  /**
+   * The message payload.
+   */
+  az_span payload;
+
+  /**
+   * The sequence number of the message, which increases by one for each appended message.
+   */
+  uint32_t sequence;
+} az_iot_hub_client_telemetry_store_message;
+
+/**
+ * @brief Gets the default #az_iot_hub_client_telemetry_store_options.
+ * @details Call this to obtain an initialized #az_iot_hub_client_telemetry_store_options structure
+ * that can be afterwards modified and passed to az_iot_hub_client_telemetry_store_init().
+ *
+ * @return #az_iot_hub_client_telemetry_store_options.
+ */
+AZ_NODISCARD az_iot_hub_client_telemetry_store_options
+az_iot_hub_client_telemetry_store_options_default(void);
+
+/**
+ * @brief Initializes a telemetry store, recovering the messages already in \p buffer.
+ *
+ * @details If \p buffer holds a store of the same size (for example, a memory-mapped file written
+ * by a previous run), the messages that were completely written are recovered; a message whose
+ * write was interrupted, and any message after it, are discarded. Otherwise, \p buffer is cleared
+ * and the store starts empty. To discard the previous contents of a store of the same size, zero
+ * the buffer before calling this function.
+ *
+ * @param[out] out_store The #az_iot_hub_client_telemetry_store to initialize.
+ * @param[in] buffer The buffer holding the store. It must stay valid, and must not be used by the
+ * application, while the store is in use.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_hub_client_telemetry_store_options
+ * structure. Can be `NULL` for default options.
+ * @pre \p out_store must not be `NULL`.
+ * @pre \p buffer must be a valid span.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The store was initialized successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p buffer is smaller than
+ * #AZ_IOT_HUB_CLIENT_TELEMETRY_STORE_MIN_BUFFER_SIZE.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_store_init(
+    az_iot_hub_client_telemetry_store* out_store,
+    az_span buffer,
+    az_iot_hub_client_telemetry_store_options const* options);
+
+/**
+ * @brief Appends a telemetry message to the store, evicting the oldest messages if there is not
+ * enough space.
+ *
+ * @param[in,out] ref_store The #az_iot_hub_client_telemetry_store to use for this call.
+ * @param[in] topic The MQTT topic returned by az_iot_hub_client_telemetry_get_publish_topic(),
+ * without the null terminator.
+ * @param[in] payload The message payload.
+ * @pre \p ref_store must not be `NULL`.
+ * @pre \p topic must be a valid, non-empty #az_span.
+ * @pre \p payload must be a valid #az_span.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The message was appended.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The message is larger than the store.
+ * @retval other The error returned by the sync callback.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_store_append(
+    az_iot_hub_client_telemetry_store* ref_store,
+    az_span topic,
+    az_span payload);
+
+/**
+ * @brief Reads the oldest message in the store without removing it.
+ *
+ * @param[in] store The #az_iot_hub_client_telemetry_store to use for this call.
+ * @param[out] out_message The oldest message.
+ * @pre \p store must not be `NULL`.
+ * @pre \p out_message must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK \p out_message contains the oldest message.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The store is empty.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_store_peek(
+    az_iot_hub_client_telemetry_store const* store,
+    az_iot_hub_client_telemetry_store_message* out_message);
+
+/**
+ * @brief Removes the oldest message from the store, typically once its publish was acknowledged.
+ *
+ * @param[in,out] ref_store The #az_iot_hub_client_telemetry_store to use for this call.
+ * @pre \p ref_store must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The oldest message was removed.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The store is empty.
+ */
+AZ_NODISCARD az_result
+az_iot_hub_client_telemetry_store_remove(az_iot_hub_client_telemetry_store* ref_store);
+
+/**
+ * @brief Makes the store's buffer durable by recording which messages were removed and calling
+ * the sync callback.
+ *
+ * @param[in,out] ref_store The #az_iot_hub_client_telemetry_store to use for this call.
+ * @pre \p ref_store must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The store was synced.
+ * @retval other The error returned by the sync callback.
+ */
+AZ_NODISCARD az_result
+az_iot_hub_client_telemetry_store_sync(az_iot_hub_client_telemetry_store* ref_store);
+
+/**
+ * @brief Gets the number of messages in the store.
+ *
+ * @param[in] store The #az_iot_hub_client_telemetry_store to use for this call.
+ * @return The number of messages in the store.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_iot_hub_client_telemetry_store_get_count(az_iot_hub_client_telemetry_store const* store)
+{
+  return store->_internal.count;
+}
+
+/**
+ * @brief Gets the number of messages evicted to make room for newer ones since the store was
+ * initialized.
+ *
+ * @param[in] store The #az_iot_hub_client_telemetry_store to use for this call.
+ * @return The number of evicted messages.
+ */
+AZ_NODISCARD AZ_INLINE uint32_t
+az_iot_hub_client_telemetry_store_get_evicted_count(az_iot_hub_client_telemetry_store const* store)
+{
+  return store->_internal.evicted_count;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_HUB_CLIENT_TELEMETRY_STORE_H
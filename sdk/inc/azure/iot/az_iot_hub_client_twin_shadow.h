@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the twin shadow, a local copy of the desired properties of a device twin.
+ *
+ * @details The shadow is seeded from the response to a twin document request, and each
+ * desired-properties patch received afterwards is applied to it as an RFC 7396 JSON merge patch.
+ * The `$version` of each patch is checked against the cached one, so the application only needs to
+ * request the full twin again when a patch was missed.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_HUB_CLIENT_TWIN_SHADOW_H
+#define _az_IOT_HUB_CLIENT_TWIN_SHADOW_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_common.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief The local copy of the desired properties of a device twin.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span buffer;
+    az_span document;
+    int32_t version;
+  } _internal;
+} az_iot_hub_client_twin_shadow;
+
+/**
+ * @brief Initializes a twin shadow with no document.
+ *
+ * @details The buffer is split in two halves: one holds the desired properties, and patches are
+ * merged into the other. Each half must fit the largest expected desired properties document, plus
+ * 64 bytes of slack for the JSON writer.
+ *
+ * @param[out] out_shadow The #az_iot_hub_client_twin_shadow to initialize.
+ * @param[in] buffer The buffer holding the desired properties.
+ * @pre \p out_shadow must not be `NULL`.
+ * @pre \p buffer must be a valid span of size greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The shadow was initialized successfully.
+ */
+AZ_NODISCARD az_result
+az_iot_hub_client_twin_shadow_init(az_iot_hub_client_twin_shadow* out_shadow, az_span buffer);
+
+/**
+ * @brief Replaces the shadow with the desired properties of a full twin document.
+ *
+ * @param[in,out] ref_shadow The #az_iot_hub_client_twin_shadow to use for this call.
+ * @param[in] twin_document The payload of a #AZ_IOT_HUB_CLIENT_TWIN_RESPONSE_TYPE_GET response.
+ * @pre \p ref_shadow must not be `NULL`.
+ * @pre \p twin_document must be a valid span of size greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The shadow holds the desired properties of \p twin_document.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The document has no desired properties or `$version`.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The desired properties don't fit in half of the buffer.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_twin_shadow_set_document(
+    az_iot_hub_client_twin_shadow* ref_shadow,
+    az_span twin_document);
+
+/**
+ * @brief Applies a desired-properties patch to the shadow.
+ *
+ * @details Members of the patch replace the members of the shadow with the same name, objects are
+ * merged recursively, and `null` members are removed, as specified by RFC 7396.
+ *
+ * A patch whose `$version` is not newer than the shadow's is a duplicate and is ignored. A patch
+ * that skips a version can't be applied: the application should request the full twin and pass it
+ * to az_iot_hub_client_twin_shadow_set_document().
+ *
+ * @note The cost of merging an object is the product of its number of members in the shadow and
+ * in the patch. Patches usually change a few members, which keeps this close to a single copy of
+ * the document.
+ *
+ * @param[in,out] ref_shadow The #az_iot_hub_client_twin_shadow to use for this call.
+ * @param[in] desired_patch The payload of a
+ * #AZ_IOT_HUB_CLIENT_TWIN_RESPONSE_TYPE_DESIRED_PROPERTIES message.
+ * @pre \p ref_shadow must not be `NULL`.
+ * @pre \p desired_patch must be a valid span of size greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The patch was applied, or ignored as a duplicate.
+ * @retval #AZ_ERROR_IOT_TWIN_VERSION_GAP The shadow has no document, or the patch is not the next
+ * version; the shadow is unchanged.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The patch has no `$version`.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The merged document doesn't fit in half of the buffer; the
+ * shadow is unchanged.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_twin_shadow_apply_patch(
+    az_iot_hub_client_twin_shadow* ref_shadow,
+    az_span desired_patch);
+
+/**
+ * @brief Gets the desired properties held by the shadow.
+ *
+ * @param[in] shadow The #az_iot_hub_client_twin_shadow to use for this call.
+ * @return The JSON object of the desired properties, including `$version`, or #AZ_SPAN_EMPTY if the
+ * shadow has no document. The span is valid until the shadow is next changed.
+ */
+AZ_NODISCARD AZ_INLINE az_span
+az_iot_hub_client_twin_shadow_get_document(az_iot_hub_client_twin_shadow const* shadow)
+{
+  return shadow->_internal.document;
+}
+
+/**
+ * @brief Gets the `$version` of the desired properties held by the shadow.
+ *
+ * @param[in] shadow The #az_iot_hub_client_twin_shadow to use for this call.
+ * @return The version, or -1 if the shadow has no document.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_iot_hub_client_twin_shadow_get_version(az_iot_hub_client_twin_shadow const* shadow)
+{
+  return shadow->_internal.version;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_HUB_CLIENT_TWIN_SHADOW_H
@@ -0,0 +1,291 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the IoT Hub gateway, which multiplexes many leaf devices over one MQTT
+ * connection.
+ *
+ * @details The gateway holds an #az_iot_hub_client for each leaf device in a caller-provided
+ * contiguous array, together with its SAS token expiration and its cached
+ * `devices/{device_id}/[modules/{module_id}/]` topic prefix, and an open-addressing hash index over
+ * the device and module IDs. Cloud-to-device messages and module inputs received on the shared
+ * connection carry that prefix, and are routed to their device with
+ * az_iot_hub_gateway_route_received_topic(), after which the device's client can be used with the
+ * regular hub client APIs to parse the topic.
+ *
+ * Twin, method and command topics begin with `$iothub/` and do not name the device, so they are not
+ * routed: the application must match their request IDs to the devices that sent the requests.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_HUB_GATEWAY_H
+#define _az_IOT_HUB_GATEWAY_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief The state kept by the gateway for a leaf device.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_hub_client client;
+    uint64_t sas_expiration_epoch_time;
+    void* user_context;
+    az_span topic_prefix;
+    uint32_t hash;
+    int32_t sas_expiration_heap_position;
+    int32_t sas_expiration_heap_entry;
+  } _internal;
+} az_iot_hub_gateway_device;
+
+/**
+ * @brief An IoT Hub gateway.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span iot_hub_hostname;
+    az_iot_hub_gateway_device* devices;
+    int32_t devices_capacity;
+    int32_t devices_length;
+    az_span topic_prefixes_buffer;
+    int32_t topic_prefix_slot_size;
+    int32_t* buckets;
+    uint32_t bucket_mask;
+  } _internal;
+} az_iot_hub_gateway;
+
+/**
+ * @brief Initializes an IoT Hub gateway with no devices.
+ *
+ * @param[out] out_gateway The #az_iot_hub_gateway to initialize.
+ * @param[in] iot_hub_hostname The IoT Hub hostname, shared by all devices.
+ * @param[in] devices The array holding the devices' state.
+ * @param[in] devices_capacity The number of elements in \p devices.
+ * @param[in] topic_prefixes_buffer The buffer holding the cached topic prefixes of the devices. It
+ * is split into \p devices_capacity slots of equal size, each of which must hold the
+ * `devices/{device_id}/modules/{module_id}/` prefix of a device.
+ * @param[in] buckets The array holding the hash index over the devices.
+ * @param[in] buckets_length The number of elements in \p buckets. Must be a power of 2 greater than
+ * \p devices_capacity; twice \p devices_capacity keeps lookups short.
+ * @pre \p out_gateway must not be `NULL`.
+ * @pre \p iot_hub_hostname must be a valid span of size greater than 0.
+ * @pre \p devices must not be `NULL`.
+ * @pre \p devices_capacity must be greater than 0.
+ * @pre \p topic_prefixes_buffer must be a valid span of size greater than or equal to
+ * \p devices_capacity.
+ * @pre \p buckets must not be `NULL`.
+ * @pre \p buckets_length must be a power of 2 greater than \p devices_capacity.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The gateway was initialized successfully.
+ */
+AZ_NODISCARD az_result az_iot_hub_gateway_init(
+    az_iot_hub_gateway* out_gateway,
+    az_span iot_hub_hostname,
+    az_iot_hub_gateway_device devices[],
+    int32_t devices_capacity,
+    az_span topic_prefixes_buffer,
+    int32_t buckets[],
+    int32_t buckets_length);
+
+/**
+ * @brief Adds a leaf device to the gateway.
+ *
+ * @param[in,out] ref_gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_id The device ID. The span must stay valid while the device is in the gateway.
+ * @param[in] options __[nullable]__ The #az_iot_hub_client_options of the device, including its
+ * module ID. Can be `NULL` for default options.
+ * @param[in] user_context __[nullable]__ An application context associated with the device.
+ * @param[out] out_device_index __[nullable]__ The index of the added device.
+ * @pre \p ref_gateway must not be `NULL`.
+ * @pre \p device_id must be a valid span of size greater than 0.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The device was added.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The gateway is full, or the topic prefix of the device does
+ * not fit in its slot of the topic prefixes buffer.
+ * @retval #AZ_ERROR_ARG A device with the same device and module IDs is already in the gateway.
+ */
+AZ_NODISCARD az_result az_iot_hub_gateway_add_device(
+    az_iot_hub_gateway* ref_gateway,
+    az_span device_id,
+    az_iot_hub_client_options const* options,
+    void* user_context,
+    int32_t* out_device_index);
+
+/**
+ * @brief Removes a leaf device from the gateway.
+ *
+ * @note To keep the devices contiguous, the last device is moved to \p device_index.
+ *
+ * @param[in,out] ref_gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_index The index of the device to remove.
+ * @pre \p ref_gateway must not be `NULL`.
+ * @pre \p device_index must be the index of a device in the gateway.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The device was removed.
+ */
+AZ_NODISCARD az_result
+az_iot_hub_gateway_remove_device(az_iot_hub_gateway* ref_gateway, int32_t device_index);
+
+/**
+ * @brief Finds a leaf device by its device and module IDs.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_id The device ID.
+ * @param[in] module_id The module ID, or #AZ_SPAN_EMPTY for a device without a module.
+ * @param[out] out_device_index The index of the device.
+ * @pre \p gateway must not be `NULL`.
+ * @pre \p out_device_index must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The device was found.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The device is not in the gateway.
+ */
+AZ_NODISCARD az_result az_iot_hub_gateway_find_device(
+    az_iot_hub_gateway const* gateway,
+    az_span device_id,
+    az_span module_id,
+    int32_t* out_device_index);
+
+/**
+ * @brief Finds the leaf device a received message is addressed to, from the
+ * `devices/{device_id}/` or `devices/{device_id}/modules/{module_id}/` prefix of its topic.
+ *
+ * @details Only cloud-to-device message and module input topics have this prefix. Twin, method and
+ * command topics begin with `$iothub/` instead, and return #AZ_ERROR_IOT_TOPIC_NO_MATCH.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] received_topic An #az_span containing the received topic.
+ * @param[out] out_device_index The index of the device.
+ * @pre \p gateway must not be `NULL`.
+ * @pre \p received_topic must be a valid span of size greater than 0.
+ * @pre \p out_device_index must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The topic is addressed to the device at \p out_device_index.
+ * @retval #AZ_ERROR_IOT_TOPIC_NO_MATCH The topic does not begin with the prefix of a device in the
+ * gateway.
+ */
+AZ_NODISCARD az_result az_iot_hub_gateway_route_received_topic(
+    az_iot_hub_gateway const* gateway,
+    az_span received_topic,
+    int32_t* out_device_index);
+
+/**
+ * @brief Finds the device whose SAS token expires first, so that it can be renewed.
+ *
+ * @note The devices are kept in a binary heap ordered by SAS token expiration, so this takes
+ * constant time, while setting an expiration, adding or removing a device takes O(log n). Of
+ * devices whose tokens expire at the same time, any may be returned.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @param[out] out_device_index The index of the device whose SAS token expires first.
+ * @pre \p gateway must not be `NULL`.
+ * @pre \p out_device_index must not be `NULL`.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The device was found.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The gateway has no devices.
+ */
+AZ_NODISCARD az_result az_iot_hub_gateway_get_next_sas_expiration(
+    az_iot_hub_gateway const* gateway,
+    int32_t* out_device_index);
+
+/**
+ * @brief Gets the number of devices in the gateway.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @return The number of devices.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_iot_hub_gateway_get_device_count(az_iot_hub_gateway const* gateway)
+{
+  return gateway->_internal.devices_length;
+}
+
+/**
+ * @brief Gets the hub client of a device, to use with the hub client APIs.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_index The index of the device.
+ * @return The #az_iot_hub_client of the device.
+ */
+AZ_NODISCARD AZ_INLINE az_iot_hub_client const*
+az_iot_hub_gateway_get_device_client(az_iot_hub_gateway const* gateway, int32_t device_index)
+{
+  return &gateway->_internal.devices[device_index]._internal.client;
+}
+
+/**
+ * @brief Gets the cached topic prefix of a device, `devices/{device_id}/` or
+ * `devices/{device_id}/modules/{module_id}/`, to build the topics it subscribes to.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_index The index of the device.
+ * @return An #az_span containing the topic prefix, valid until the device is removed or moved by
+ * the removal of another device.
+ */
+AZ_NODISCARD AZ_INLINE az_span
+az_iot_hub_gateway_get_device_topic_prefix(az_iot_hub_gateway const* gateway, int32_t device_index)
+{
+  return gateway->_internal.devices[device_index]._internal.topic_prefix;
+}
+
+/**
+ * @brief Gets the application context of a device.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_index The index of the device.
+ * @return The user context given to az_iot_hub_gateway_add_device().
+ */
+AZ_NODISCARD AZ_INLINE void*
+az_iot_hub_gateway_get_device_user_context(az_iot_hub_gateway const* gateway, int32_t device_index)
+{
+  return gateway->_internal.devices[device_index]._internal.user_context;
+}
+
+/**
+ * @brief Gets the expiration of a device's SAS token.
+ *
+ * @param[in] gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_index The index of the device.
+ * @return The expiration, in seconds since the Unix epoch, or 0 if it was never set.
+ */
+AZ_NODISCARD AZ_INLINE uint64_t az_iot_hub_gateway_get_device_sas_expiration(
+    az_iot_hub_gateway const* gateway,
+    int32_t device_index)
+{
+  return gateway->_internal.devices[device_index]._internal.sas_expiration_epoch_time;
+}
+
+/**
+ * @brief Sets the expiration of a device's SAS token, typically the `token_expiration_epoch_time`
+ * given to az_iot_hub_client_sas_get_signature().
+ *
+ * @param[in,out] ref_gateway The #az_iot_hub_gateway to use for this call.
+ * @param[in] device_index The index of the device.
+ * @param[in] token_expiration_epoch_time The expiration, in seconds since the Unix epoch.
+ * @pre \p ref_gateway must not be `NULL`.
+ * @pre \p device_index must be the index of a device in the gateway.
+ */
+void az_iot_hub_gateway_set_device_sas_expiration(
+    az_iot_hub_gateway* ref_gateway,
+    int32_t device_index,
+    uint64_t token_expiration_epoch_time);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_HUB_GATEWAY_H
@@ -0,0 +1,421 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file az_iot_provisioning_client_batch.h
+ *
+ * @brief Definition of the provisioning batch, which drives the registration of many devices.
+ *
+ * @details A single #az_iot_provisioning_client registers one device, and the application polls
+ * the status of its register operation itself. The provisioning batch keeps a compact table of
+ * pending registrations, tells the application which register or query-status request to publish
+ * next, and schedules each query-status request after the `retry-after` of the previous response.
+ * Several requests can be in flight at once. Device keys can be derived from the key of a group
+ * enrollment, so that only the group key needs to be known to onboard a whole batch of devices.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_PROVISIONING_CLIENT_BATCH_H
+#define _az_IOT_PROVISIONING_CLIENT_BATCH_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/az_iot_provisioning_client.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief The maximum size, in bytes, of the operation ID of a registration.
+ */
+#define AZ_IOT_PROVISIONING_CLIENT_BATCH_OPERATION_ID_MAX_SIZE 64
+
+/**
+ * @brief The size, in bytes, of a buffer large enough for a base64 encoded device key.
+ */
+#define AZ_IOT_PROVISIONING_CLIENT_BATCH_DEVICE_KEY_BUFFER_SIZE 44
+
+/**
+ * @brief The status of a registration of an #az_iot_provisioning_client_batch.
+ */
+typedef enum
+{
+  /// The entry holds no registration.
+  AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_UNUSED = 0,
+
+  /// The registration waits for its next request to be due.
+  AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_PENDING = 1,
+
+  /// The registration waits for the response to its last request.
+  AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_IN_FLIGHT = 2,
+
+  /// The device was assigned to an IoT Hub.
+  AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_ASSIGNED = 3,
+
+  /// The registration failed, or the enrollment is disabled.
+  AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_FAILED = 4,
+} az_iot_provisioning_client_batch_status;
+
+/**
+ * @brief The kind of request to publish for a registration.
+ */
+typedef enum
+{
+  /// A register request, published to the topic of
+  /// #az_iot_provisioning_client_register_get_publish_topic() with the payload of
+  /// #az_iot_provisioning_client_register_get_request_payload().
+  AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_REGISTER = 0,
+
+  /// A query-status request, published to the topic of
+  /// #az_iot_provisioning_client_query_status_get_publish_topic() with an empty payload.
+  AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_QUERY_STATUS = 1,
+} az_iot_provisioning_client_batch_request;
+
+/**
+ * @brief A registration of an #az_iot_provisioning_client_batch, provided by the application.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span registration_id;
+    void* user_context;
+    _az_iot_timer_wheel_node timer;
+    az_iot_provisioning_client_batch_status status;
+    int32_t operation_id_length;
+    uint8_t operation_id[AZ_IOT_PROVISIONING_CLIENT_BATCH_OPERATION_ID_MAX_SIZE];
+  } _internal;
+} az_iot_provisioning_client_batch_registration;
+
+/**
+ * @brief Options for an #az_iot_provisioning_client_batch.
+ */
+typedef struct
+{
+  /**
+   * The options of the #az_iot_provisioning_client of each registration.
+   */
+  az_iot_provisioning_client_options client_options;
+
+  /**
+   * The maximum number of requests in flight at once.
+   */
+  int32_t max_in_flight;
+
+  /**
+   * How long to wait for the response to a request, in milliseconds, before publishing it again.
+   */
+  int32_t response_timeout_msec;
+
+  /**
+   * How long to wait before the next request, in seconds, when a response has no `retry-after`.
+   */
+  uint32_t default_retry_after_seconds;
+
+  /**
+   * The resolution, in milliseconds, of the timer wheel. Requests are due up to this long after
+   * their time.
+   */
+  int32_t tick_msec;
+} az_iot_provisioning_client_batch_options;
+
+/**
+ * @brief Drives the registration of many devices with the Device Provisioning Service.
+ *
+ * @details Every registration that is neither complete nor unused is linked into the slot of the
+ * timer wheel of the tick its next request is due in: right away for a new registration, after
+ * the `retry-after` of the last response for a registration waiting to query its status, and after
+ * the response timeout for a request in flight. Only the slots of the ticks elapsed since the last
+ * call are visited to find the requests due. Time is measured with #az_platform_clock_msec().
+ */
+typedef struct
+{
+  struct
+  {
+    az_span global_device_endpoint;
+    az_span id_scope;
+    az_iot_provisioning_client_batch_registration* registrations;
+    int32_t registrations_length;
+    int32_t in_flight_count;
+    _az_iot_timer_wheel wheel;
+    az_iot_provisioning_client_batch_options options;
+  } _internal;
+} az_iot_provisioning_client_batch;
+
+/**
+ * @brief Gets the default #az_iot_provisioning_client_batch_options.
+ *
+ * @details Up to 64 requests are in flight at once, responses are awaited for 30 seconds, a
+ * response without `retry-after` delays the next request by 3 seconds, and the timer wheel ticks
+ * every second.
+ *
+ * @return An #az_iot_provisioning_client_batch_options.
+ */
+AZ_NODISCARD az_iot_provisioning_client_batch_options
+az_iot_provisioning_client_batch_options_default(void);
+
+/**
+ * @brief Initializes an #az_iot_provisioning_client_batch.
+ *
+ * @param[out] out_batch The #az_iot_provisioning_client_batch to initialize.
+ * @param[in] global_device_hostname The device provisioning services global host name.
+ * @param[in] id_scope The ID Scope.
+ * @param[in] registrations The registrations used by the batch. They must stay valid while the
+ * batch is used.
+ * @param[in] registrations_length The number of elements in \p registrations.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_provisioning_client_batch_options
+ * structure. If `NULL`, the default options are used.
+ * @pre \p out_batch must not be `NULL`.
+ * @pre \p global_device_hostname must be a valid span of size greater than 0.
+ * @pre \p id_scope must be a valid span of size greater than 0.
+ * @pre \p registrations must not be `NULL`.
+ * @pre \p registrations_length must be greater than 0.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_init(
+    az_iot_provisioning_client_batch* out_batch,
+    az_span global_device_hostname,
+    az_span id_scope,
+    az_iot_provisioning_client_batch_registration registrations[],
+    int32_t registrations_length,
+    az_iot_provisioning_client_batch_options const* options);
+
+/**
+ * @brief Adds a device to register. Its register request is due right away.
+ *
+ * @param[in,out] ref_batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[in] registration_id The registration ID of the device. It must stay valid while the
+ * registration is in the batch.
+ * @param[in] user_context __[nullable]__ A context for the application, such as its MQTT
+ * connection for the device.
+ * @param[out] out_index The index of the registration in the batch.
+ * @pre \p ref_batch must not be `NULL`.
+ * @pre \p registration_id must be a valid span of size greater than 0.
+ * @pre \p out_index must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE Every registration is in use.
+ * @retval Other Failure reading the platform clock.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_add(
+    az_iot_provisioning_client_batch* ref_batch,
+    az_span registration_id,
+    void* user_context,
+    int32_t* out_index);
+
+/**
+ * @brief Removes a registration from the batch, to reuse its entry.
+ *
+ * @param[in,out] ref_batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[in] index The index of the registration.
+ * @pre \p ref_batch must not be `NULL`.
+ * @pre \p index must be the index of a registration in use.
+ */
+void az_iot_provisioning_client_batch_remove(
+    az_iot_provisioning_client_batch* ref_batch,
+    int32_t index);
+
+/**
+ * @brief Gets the #az_iot_provisioning_client of a registration, to get its MQTT client ID, user
+ * name and register request payload.
+ *
+ * @param[in] batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[in] index The index of the registration.
+ * @param[out] out_client The #az_iot_provisioning_client of the registration.
+ * @pre \p batch must not be `NULL`.
+ * @pre \p index must be the index of a registration in use.
+ * @pre \p out_client must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_get_client(
+    az_iot_provisioning_client_batch const* batch,
+    int32_t index,
+    az_iot_provisioning_client* out_client);
+
+/**
+ * @brief Gets the next request to publish.
+ *
+ * @details The request is considered in flight until its response is given to
+ * #az_iot_provisioning_client_batch_handle_response(). If the response doesn't arrive within the
+ * response timeout, the request is due again. Call this function repeatedly to publish every
+ * request due, without waiting for the responses.
+ *
+ * @param[in,out] ref_batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[out] out_index The index of the registration to publish a request for.
+ * @param[out] out_request The kind of request to publish.
+ * @param[out] mqtt_topic A buffer with sufficient capacity to hold the MQTT topic. If successful,
+ * contains a null-terminated string with the topic to publish the request to.
+ * @param[in] mqtt_topic_size The size, in bytes of \p mqtt_topic.
+ * @param[out] out_mqtt_topic_length __[nullable]__ Contains the string length, in bytes, of \p
+ * mqtt_topic. Can be `NULL`.
+ * @pre \p ref_batch must not be `NULL`.
+ * @pre \p out_index must not be `NULL`.
+ * @pre \p out_request must not be `NULL`.
+ * @pre \p mqtt_topic must not be `NULL`.
+ * @pre \p mqtt_topic_size must be greater than 0.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK A request is due.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No request is due.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The maximum number of requests is in flight, or \p mqtt_topic
+ * is too small.
+ * @retval Other Failure reading the platform clock.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_get_next_request(
+    az_iot_provisioning_client_batch* ref_batch,
+    int32_t* out_index,
+    az_iot_provisioning_client_batch_request* out_request,
+    char* mqtt_topic,
+    size_t mqtt_topic_size,
+    size_t* out_mqtt_topic_length);
+
+/**
+ * @brief Updates a registration with the response to its request.
+ *
+ * @details A response with a final operation status completes the registration. A throttled or
+ * server error response makes the request due again after its `retry-after`. Otherwise, the
+ * operation ID is kept and a query-status request is due after the `retry-after`.
+ *
+ * @param[in,out] ref_batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[in] index The index of the registration the response was received for.
+ * @param[in] response The response, parsed with
+ * #az_iot_provisioning_client_parse_received_topic_and_payload().
+ * @pre \p ref_batch must not be `NULL`.
+ * @pre \p index must be the index of a registration in use.
+ * @pre \p response must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The registration is already complete.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The operation ID is longer than
+ * #AZ_IOT_PROVISIONING_CLIENT_BATCH_OPERATION_ID_MAX_SIZE.
+ * @retval Other Failure reading the platform clock.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_handle_response(
+    az_iot_provisioning_client_batch* ref_batch,
+    int32_t index,
+    az_iot_provisioning_client_register_response const* response);
+
+/**
+ * @brief Derives the key of a device from the key of its group enrollment.
+ *
+ * @details The device key is the base64 encoded HMAC-SHA256 of the registration ID, keyed with the
+ * base64 decoded group key.
+ *
+ * @param[in] group_key The base64 encoded symmetric key of the group enrollment.
+ * @param[in] registration_id The registration ID of the device.
+ * @param[in] device_key_buffer The buffer to write the device key to, of at least
+ * #AZ_IOT_PROVISIONING_CLIENT_BATCH_DEVICE_KEY_BUFFER_SIZE bytes.
+ * @param[out] out_device_key The base64 encoded device key.
+ * @pre \p group_key must be a valid span of size greater than 0.
+ * @pre \p registration_id must be a valid span of size greater than 0.
+ * @pre \p out_device_key must not be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p device_key_buffer is too small, or \p group_key is longer
+ * than 64 bytes once decoded.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR \p group_key is not valid base64.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_derive_device_key(
+    az_span group_key,
+    az_span registration_id,
+    az_span device_key_buffer,
+    az_span* out_device_key);
+
+/**
+ * @brief Gets the MQTT password of a registration, signed with a key derived from the key of its
+ * group enrollment.
+ *
+ * @param[in] batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[in] index The index of the registration.
+ * @param[in] group_key The base64 encoded symmetric key of the group enrollment.
+ * @param[in] token_expiration_epoch_time The time, in seconds, from 1/1/1970.
+ * @param[out] mqtt_password A buffer with sufficient capacity to hold the MQTT password. If
+ * successful, contains a null-terminated string with the password that needs to be passed to the
+ * MQTT client.
+ * @param[in] mqtt_password_size The size, in bytes of \p mqtt_password.
+ * @param[out] out_mqtt_password_length __[nullable]__ Contains the string length, in bytes, of \p
+ * mqtt_password. Can be `NULL`.
+ * @pre \p batch must not be `NULL`.
+ * @pre \p index must be the index of a registration in use.
+ * @pre \p group_key must be a valid span of size greater than 0.
+ * @pre \p token_expiration_epoch_time must be greater than 0.
+ * @pre \p mqtt_password must not be `NULL`.
+ * @pre \p mqtt_password_size must be greater than 0.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p mqtt_password is too small, or \p group_key is longer than
+ * 64 bytes once decoded.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR \p group_key is not valid base64.
+ */
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_sas_get_password(
+    az_iot_provisioning_client_batch const* batch,
+    int32_t index,
+    az_span group_key,
+    uint64_t token_expiration_epoch_time,
+    char* mqtt_password,
+    size_t mqtt_password_size,
+    size_t* out_mqtt_password_length);
+
+/**
+ * @brief Gets the status of a registration.
+ *
+ * @param[in] batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[in] index The index of the registration.
+ *
+ * @return The #az_iot_provisioning_client_batch_status of the registration.
+ */
+AZ_NODISCARD AZ_INLINE az_iot_provisioning_client_batch_status
+az_iot_provisioning_client_batch_get_status(
+    az_iot_provisioning_client_batch const* batch,
+    int32_t index)
+{
+  return batch->_internal.registrations[index]._internal.status;
+}
+
+/**
+ * @brief Gets the context given to #az_iot_provisioning_client_batch_add() for a registration.
+ *
+ * @param[in] batch The #az_iot_provisioning_client_batch to use for this call.
+ * @param[in] index The index of the registration.
+ *
+ * @return The context of the registration.
+ */
+AZ_NODISCARD AZ_INLINE void* az_iot_provisioning_client_batch_get_user_context(
+    az_iot_provisioning_client_batch const* batch,
+    int32_t index)
+{
+  return batch->_internal.registrations[index]._internal.user_context;
+}
+
+/**
+ * @brief Gets the number of registrations not complete yet.
+ *
+ * @param[in] batch The #az_iot_provisioning_client_batch to use for this call.
+ *
+ * @return The number of pending or in flight registrations.
+ */
+AZ_NODISCARD AZ_INLINE int32_t
+az_iot_provisioning_client_batch_get_pending_count(az_iot_provisioning_client_batch const* batch)
+{
+  return batch->_internal.wheel._internal.count;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_PROVISIONING_CLIENT_BATCH_H
@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the request table, which correlates IoT Hub responses with their requests.
+ *
+ * @details Twin, properties and method requests carry a request ID (`$rid`) chosen by the
+ * application, which IoT Hub echoes in the response topic. The request table generates request IDs,
+ * resolves the request ID of a response to the context of its request in constant time, and expires
+ * requests whose response didn't arrive in time.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_REQUEST_TABLE_H
+#define _az_IOT_REQUEST_TABLE_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_common.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief The size, in bytes, of a buffer large enough for any request ID.
+ */
+#define AZ_IOT_REQUEST_TABLE_REQUEST_ID_BUFFER_SIZE 10
+
+/**
+ * @brief An entry of an #az_iot_request_table, provided by the application.
+ */
+typedef struct
+{
+  struct
+  {
+    void* user_context;
+    _az_iot_timer_wheel_node timer;
+    uint32_t request_id;
+  } _internal;
+} az_iot_request_table_entry;
+
+/**
+ * @brief Options for an #az_iot_request_table.
+ */
+typedef struct
+{
+  /**
+   * The resolution, in milliseconds, of the timer wheel. Requests expire up to this long after
+   * their timeout.
+   */
+  int32_t tick_msec;
+} az_iot_request_table_options;
+
+/**
+ * @brief Tracks requests awaiting a response.
+ *
+ * @details Request IDs are assigned so that each one maps directly to an entry. Timeouts are kept
+ * in a timer wheel: each request is linked into the slot of the tick its deadline falls in, and
+ * only the slots of the ticks elapsed since the last check are visited to find expired requests.
+ * Time is measured with #az_platform_clock_msec().
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_request_table_entry* entries;
+    int32_t entries_length;
+    uint32_t next_request_id;
+    _az_iot_timer_wheel wheel;
+    az_iot_request_table_options options;
+  } _internal;
+} az_iot_request_table;
+
+/**
+ * @brief Gets the default #az_iot_request_table_options.
+ *
+ * @details The timer wheel ticks every second.
+ *
+ * @return An #az_iot_request_table_options.
+ */
+AZ_NODISCARD az_iot_request_table_options az_iot_request_table_options_default(void);
+
+/**
+ * @brief Initializes an #az_iot_request_table.
+ *
+ * @param[out] out_table The #az_iot_request_table to initialize.
+ * @param[in] entries The entries used by the table. They must stay valid while the table is used.
+ * @param[in] entries_length The number of elements in \p entries.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_request_table_options structure. If
+ * `NULL`, the default options are used.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_iot_request_table_init(
+    az_iot_request_table* out_table,
+    az_iot_request_table_entry entries[],
+    int32_t entries_length,
+    az_iot_request_table_options const* options);
+
+/**
+ * @brief Adds a request about to be sent, and generates its request ID.
+ *
+ * @details Request IDs are increasing decimal numbers, skipping those whose entry is still in use.
+ *
+ * @param[in,out] ref_table The #az_iot_request_table to use for this call.
+ * @param[in] user_context __[nullable]__ A context returned when the response is received or the
+ * request expires.
+ * @param[in] timeout_msec How long to wait for the response, in milliseconds.
+ * @param[in] request_id_buffer The buffer to write the request ID to, of at least
+ * #AZ_IOT_REQUEST_TABLE_REQUEST_ID_BUFFER_SIZE bytes.
+ * @param[out] out_request_id The request ID, to send the request with.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE Every entry is in use.
+ * @retval Other Failure reading the platform clock.
+ */
+AZ_NODISCARD az_result az_iot_request_table_add(
+    az_iot_request_table* ref_table,
+    void* user_context,
+    int32_t timeout_msec,
+    az_span request_id_buffer,
+    az_span* out_request_id);
+
+/**
+ * @brief Removes the request a response is for.
+ *
+ * @param[in,out] ref_table The #az_iot_request_table to use for this call.
+ * @param[in] request_id The request ID of the response, such as the `request_id` parsed from a twin
+ * response topic.
+ * @param[out] out_user_context __[nullable]__ If not `NULL`, receives the context given to
+ * #az_iot_request_table_add().
+ * @pre \p request_id must be a valid span of size greater than 0.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No request is pending with \p request_id, for example because it
+ * expired.
+ */
+AZ_NODISCARD az_result az_iot_request_table_remove(
+    az_iot_request_table* ref_table,
+    az_span request_id,
+    void** out_user_context);
+
+/**
+ * @brief Removes a request whose response didn't arrive before its timeout.
+ *
+ * @details Call this function repeatedly until it returns #AZ_ERROR_ITEM_NOT_FOUND.
+ *
+ * @param[in,out] ref_table The #az_iot_request_table to use for this call.
+ * @param[out] out_user_context __[nullable]__ If not `NULL`, receives the context given to
+ * #az_iot_request_table_add().
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK A request expired.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No request is past its timeout.
+ * @retval Other Failure reading the platform clock.
+ */
+AZ_NODISCARD az_result
+az_iot_request_table_get_expired(az_iot_request_table* ref_table, void** out_user_context);
+
+/**
+ * @brief Gets the number of requests awaiting a response.
+ *
+ * @param[in] table The #az_iot_request_table to use for this call.
+ *
+ * @return The number of pending requests.
+ */
+AZ_NODISCARD AZ_INLINE int32_t az_iot_request_table_get_count(az_iot_request_table const* table)
+{
+  return table->_internal.wheel._internal.count;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_REQUEST_TABLE_H
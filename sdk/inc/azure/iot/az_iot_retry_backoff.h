@@ -0,0 +1,148 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Definition of the retry backoff controller, which spreads the reconnection attempts of a
+ * fleet of devices over time.
+ *
+ * @details Unlike az_iot_calculate_retry_delay(), the controller keeps the state of the retries of
+ * an operation, such as connecting to IoT Hub or registering with the Device Provisioning Service,
+ * and draws its own jitter from a pseudo-random generator seeded per device. Devices disconnected
+ * at the same time, for example by a service failover, then retry at different times instead of
+ * in lockstep.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_RETRY_BACKOFF_H
+#define _az_IOT_RETRY_BACKOFF_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief How the delay between retries grows.
+ */
+typedef enum
+{
+  /// Each delay is random between the minimum delay and three times the previous delay. This
+  /// spreads retries the most while still growing the delays.
+  AZ_IOT_RETRY_BACKOFF_DECORRELATED_JITTER = 0,
+
+  /// Each delay is random between 0 and the exponential delay of the attempt.
+  AZ_IOT_RETRY_BACKOFF_FULL_JITTER = 1,
+
+  /// Each delay is the minimum delay doubled for every attempt, without jitter.
+  AZ_IOT_RETRY_BACKOFF_EXPONENTIAL = 2,
+} az_iot_retry_backoff_strategy;
+
+/**
+ * @brief Options for an #az_iot_retry_backoff.
+ */
+typedef struct
+{
+  /// How the delay between retries grows.
+  az_iot_retry_backoff_strategy strategy;
+
+  /// The delay, in milliseconds, of the first retry, and the minimum delay of the decorrelated
+  /// jitter strategy.
+  int32_t min_retry_delay_msec;
+
+  /// The maximum delay, in milliseconds, between retries.
+  int32_t max_retry_delay_msec;
+} az_iot_retry_backoff_options;
+
+/**
+ * @brief The retry backoff controller of an operation.
+ */
+typedef struct
+{
+  struct
+  {
+    az_iot_retry_backoff_options options;
+    uint32_t random_state;
+    int32_t previous_delay_msec;
+    int16_t attempt;
+  } _internal;
+} az_iot_retry_backoff;
+
+/**
+ * @brief Gets the default #az_iot_retry_backoff_options.
+ *
+ * @details Decorrelated jitter, starting at 1 second and capped at 100 seconds.
+ *
+ * @return An #az_iot_retry_backoff_options.
+ */
+AZ_NODISCARD az_iot_retry_backoff_options az_iot_retry_backoff_options_default(void);
+
+/**
+ * @brief Initializes a retry backoff controller with no failed attempts.
+ *
+ * @param[out] out_backoff The #az_iot_retry_backoff to initialize.
+ * @param[in] seed A value that differs between devices, such as the device ID or the registration
+ * ID, to seed the pseudo-random generator of the jitter with.
+ * @param[in] options __[nullable]__ A reference to an #az_iot_retry_backoff_options structure. If
+ * `NULL`, the default options are used.
+ * @pre \p out_backoff must not be `NULL`.
+ * @pre \p seed must be a valid span of size greater than 0.
+ * @pre The minimum retry delay must be greater than 0, and not greater than the maximum retry
+ * delay.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The controller was initialized successfully.
+ */
+AZ_NODISCARD az_result az_iot_retry_backoff_init(
+    az_iot_retry_backoff* out_backoff,
+    az_span seed,
+    az_iot_retry_backoff_options const* options);
+
+/**
+ * @brief Records a failed attempt, and gets the delay before retrying.
+ *
+ * @param[in,out] ref_backoff The #az_iot_retry_backoff to use for this call.
+ * @param[in] operation_msec The time it took, in milliseconds, to perform the operation that
+ * failed. It is deducted from the delay.
+ * @param[in] retry_after_seconds The delay requested by the service, such as the
+ * `retry_after_seconds` of an #az_iot_provisioning_client_register_response, or 0 if none. The
+ * returned delay is never shorter than it.
+ * @pre \p ref_backoff must not be `NULL`.
+ * @pre \p operation_msec must be between 0 and INT32_MAX - 1.
+ * @return The delay, in milliseconds, before retrying.
+ */
+AZ_NODISCARD int32_t az_iot_retry_backoff_get_delay(
+    az_iot_retry_backoff* ref_backoff,
+    int32_t operation_msec,
+    uint32_t retry_after_seconds);
+
+/**
+ * @brief Resets the controller after the operation succeeded, so that the next failure starts
+ * again from the minimum delay.
+ *
+ * @param[in,out] ref_backoff The #az_iot_retry_backoff to use for this call.
+ * @pre \p ref_backoff must not be `NULL`.
+ */
+void az_iot_retry_backoff_reset(az_iot_retry_backoff* ref_backoff);
+
+/**
+ * @brief Gets the number of failed attempts since the controller was initialized or reset.
+ *
+ * @param[in] backoff The #az_iot_retry_backoff to use for this call.
+ * @return The number of failed attempts.
+ */
+AZ_NODISCARD AZ_INLINE int16_t az_iot_retry_backoff_get_attempt(az_iot_retry_backoff const* backoff)
+{
+  return backoff->_internal.attempt;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_RETRY_BACKOFF_H
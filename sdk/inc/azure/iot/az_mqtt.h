@@ -0,0 +1,496 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file az_mqtt.h
+ *
+ * @brief Allocation-free MQTT 3.1.1 packet encoder and decoder.
+ *
+ * @details The IoT clients produce the topics, client IDs and user names used to talk to Azure IoT
+ * services, and leave the MQTT framing to an MQTT library. This codec lets an application frame the
+ * packets itself over any byte stream (for example, a TLS socket), encoding packets into and
+ * decoding packets out of caller-provided buffers. It covers the packets a device needs: CONNECT,
+ * PUBLISH, PUBACK, SUBSCRIBE, PINGREQ and DISCONNECT are encoded; CONNACK, PUBLISH, PUBACK, SUBACK
+ * and PINGRESP are decoded.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_MQTT_H
+#define _az_MQTT_H
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_common.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief MQTT control packet types.
+ */
+typedef enum
+{
+  AZ_MQTT_PACKET_TYPE_CONNECT = 1, ///< Client request to connect to the server.
+  AZ_MQTT_PACKET_TYPE_CONNACK = 2, ///< Connect acknowledgment.
+  AZ_MQTT_PACKET_TYPE_PUBLISH = 3, ///< Publish message.
+  AZ_MQTT_PACKET_TYPE_PUBACK = 4, ///< Publish acknowledgment.
+  AZ_MQTT_PACKET_TYPE_PUBREC = 5, ///< Publish received (QoS 2, part 1).
+  AZ_MQTT_PACKET_TYPE_PUBREL = 6, ///< Publish release (QoS 2, part 2).
+  AZ_MQTT_PACKET_TYPE_PUBCOMP = 7, ///< Publish complete (QoS 2, part 3).
+  AZ_MQTT_PACKET_TYPE_SUBSCRIBE = 8, ///< Client subscribe request.
+  AZ_MQTT_PACKET_TYPE_SUBACK = 9, ///< Subscribe acknowledgment.
+  AZ_MQTT_PACKET_TYPE_UNSUBSCRIBE = 10, ///< Client unsubscribe request.
+  AZ_MQTT_PACKET_TYPE_UNSUBACK = 11, ///< Unsubscribe acknowledgment.
+  AZ_MQTT_PACKET_TYPE_PINGREQ = 12, ///< Ping request.
+  AZ_MQTT_PACKET_TYPE_PINGRESP = 13, ///< Ping response.
+  AZ_MQTT_PACKET_TYPE_DISCONNECT = 14, ///< Client is disconnecting.
+} az_mqtt_packet_type;
+
+/**
+ * @brief MQTT quality of service levels.
+ */
+typedef enum
+{
+  AZ_MQTT_QOS_AT_MOST_ONCE = 0, ///< QoS 0.
+  AZ_MQTT_QOS_AT_LEAST_ONCE = 1, ///< QoS 1.
+  AZ_MQTT_QOS_EXACTLY_ONCE = 2, ///< QoS 2 (not supported by Azure IoT services).
+} az_mqtt_qos;
+
+enum
+{
+  /// The largest remaining length an MQTT packet can declare.
+  AZ_MQTT_MAX_REMAINING_LENGTH = 268435455,
+
+  /// Return code in a SUBACK packet for a subscription the server rejected.
+  AZ_MQTT_SUBACK_FAILURE = 0x80,
+};
+
+/**
+ * @brief The content of an MQTT CONNECT packet.
+ */
+typedef struct
+{
+  /**
+   * The client identifier, such as the one returned by #az_iot_hub_client_get_client_id().
+   */
+  az_span client_id;
+
+  /**
+   * __[nullable]__ The user name, such as the one returned by #az_iot_hub_client_get_user_name().
+   * Not sent if empty.
+   */
+  az_span user_name;
+
+  /**
+   * __[nullable]__ The password, such as a SAS token. Not sent if empty. Requires `user_name`.
+   */
+  az_span password;
+
+  /**
+   * The keep alive interval, in seconds.
+   */
+  uint16_t keep_alive_seconds;
+
+  /**
+   * Whether the server should discard any previous session state.
+   */
+  bool clean_session;
+} az_mqtt_connect;
+
+/**
+ * @brief The content of an MQTT PUBLISH packet.
+ */
+typedef struct
+{
+  az_span topic; ///< The topic name.
+  az_span payload; ///< The application message.
+  az_mqtt_qos qos; ///< The quality of service level.
+  uint16_t packet_id; ///< The packet identifier (only present when `qos` is not QoS 0).
+  bool retain; ///< Whether the server should retain the message.
+  bool duplicate; ///< Whether this is a redelivery of an earlier attempt to send the packet.
+} az_mqtt_publish;
+
+/**
+ * @brief A topic filter of an MQTT SUBSCRIBE packet.
+ */
+typedef struct
+{
+  az_span topic_filter; ///< The topic filter, such as #AZ_IOT_HUB_CLIENT_C2D_SUBSCRIBE_TOPIC.
+  az_mqtt_qos qos; ///< The maximum quality of service level requested.
+} az_mqtt_subscription;
+
+/**
+ * @brief The content of an MQTT CONNACK packet.
+ */
+typedef struct
+{
+  bool session_present; ///< Whether the server resumed a previous session.
+  uint8_t return_code; ///< `0` if the connection was accepted, or the reason it was refused.
+} az_mqtt_connack;
+
+/**
+ * @brief The content of an MQTT SUBACK packet.
+ */
+typedef struct
+{
+  uint16_t packet_id; ///< The packet identifier of the SUBSCRIBE packet acknowledged.
+
+  /**
+   * One byte per topic filter of the SUBSCRIBE packet: the QoS level granted, or
+   * #AZ_MQTT_SUBACK_FAILURE.
+   */
+  az_span return_codes;
+} az_mqtt_suback;
+
+/**
+ * @brief A packet decoded by #az_mqtt_decoder_decode().
+ *
+ * @details Only the member matching `type` is set. Packets of other types are reported with their
+ * `type` only.
+ */
+typedef struct
+{
+  az_mqtt_packet_type type; ///< The packet type.
+  az_mqtt_connack connack; ///< Set for #AZ_MQTT_PACKET_TYPE_CONNACK.
+  az_mqtt_publish publish; ///< Set for #AZ_MQTT_PACKET_TYPE_PUBLISH.
+  uint16_t packet_id; ///< Set for #AZ_MQTT_PACKET_TYPE_PUBACK.
+  az_mqtt_suback suback; ///< Set for #AZ_MQTT_PACKET_TYPE_SUBACK.
+} az_mqtt_packet;
+
+/**
+ * @brief Decodes MQTT packets from a byte stream that may be read in arbitrary chunks.
+ */
+typedef struct
+{
+  struct
+  {
+    az_span buffer;
+    int32_t buffered;
+    int32_t packet_size;
+    int32_t skip_size;
+  } _internal;
+} az_mqtt_decoder;
+
+/**
+ * @brief Encodes an MQTT CONNECT packet.
+ *
+ * @param[out] destination The buffer the packet is written to.
+ * @param[in] connect The content of the packet.
+ * @param[out] out_written The number of bytes written to \p destination.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small, or the packet would be longer
+ * than an MQTT packet may be.
+ */
+AZ_NODISCARD az_result
+az_mqtt_encode_connect(az_span destination, az_mqtt_connect const* connect, int32_t* out_written);
+
+/**
+ * @brief Encodes an MQTT PUBLISH packet.
+ *
+ * @param[out] destination The buffer the packet is written to.
+ * @param[in] publish The content of the packet.
+ * @param[out] out_written The number of bytes written to \p destination.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small, or the packet would be longer
+ * than an MQTT packet may be.
+ */
+AZ_NODISCARD az_result
+az_mqtt_encode_publish(az_span destination, az_mqtt_publish const* publish, int32_t* out_written);
+
+/**
+ * @brief Encodes everything in an MQTT PUBLISH packet except its payload.
+ *
+ * @details The packet is complete once the `payload` of \p publish is sent right after the bytes
+ * written to \p destination, so large payloads can be sent from where they are without being
+ * copied.
+ *
+ * @param[out] destination The buffer the packet header is written to.
+ * @param[in] publish The content of the packet.
+ * @param[out] out_written The number of bytes written to \p destination.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small, or the packet would be longer
+ * than an MQTT packet may be.
+ */
+AZ_NODISCARD az_result az_mqtt_encode_publish_header(
+    az_span destination,
+    az_mqtt_publish const* publish,
+    int32_t* out_written);
+
+/**
+ * @brief Encodes an MQTT PUBACK packet.
+ *
+ * @param[out] destination The buffer the packet is written to.
+ * @param[in] packet_id The packet identifier of the PUBLISH packet being acknowledged.
+ * @param[out] out_written The number of bytes written to \p destination.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small.
+ */
+AZ_NODISCARD az_result
+az_mqtt_encode_puback(az_span destination, uint16_t packet_id, int32_t* out_written);
+
+/**
+ * @brief Encodes an MQTT SUBSCRIBE packet.
+ *
+ * @param[out] destination The buffer the packet is written to.
+ * @param[in] packet_id The packet identifier, which must not be `0`.
+ * @param[in] subscriptions The topic filters to subscribe to.
+ * @param[in] subscriptions_length The number of elements in \p subscriptions, at least `1`.
+ * @param[out] out_written The number of bytes written to \p destination.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small, or the packet would be longer
+ * than an MQTT packet may be.
+ */
+AZ_NODISCARD az_result az_mqtt_encode_subscribe(
+    az_span destination,
+    uint16_t packet_id,
+    az_mqtt_subscription const subscriptions[],
+    int32_t subscriptions_length,
+    int32_t* out_written);
+
+/**
+ * @brief Encodes an MQTT PINGREQ packet.
+ *
+ * @param[out] destination The buffer the packet is written to.
+ * @param[out] out_written The number of bytes written to \p destination.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small.
+ */
+AZ_NODISCARD az_result az_mqtt_encode_pingreq(az_span destination, int32_t* out_written);
+
+/**
+ * @brief Encodes an MQTT DISCONNECT packet.
+ *
+ * @param[out] destination The buffer the packet is written to.
+ * @param[out] out_written The number of bytes written to \p destination.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p destination is too small.
+ */
+AZ_NODISCARD az_result az_mqtt_encode_disconnect(az_span destination, int32_t* out_written);
+
+/**
+ * @brief Initializes an #az_mqtt_decoder.
+ *
+ * @param[out] out_decoder The #az_mqtt_decoder to initialize.
+ * @param[in] buffer The buffer used to reassemble packets split across several reads. It must be
+ * as large as the largest packet the application expects to receive.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_mqtt_decoder_init(az_mqtt_decoder* out_decoder, az_span buffer);
+
+/**
+ * @brief Decodes the next MQTT packet from bytes read from the network.
+ *
+ * @details Call this function with the bytes read from the network, then again with the bytes
+ * that were not consumed, until it returns #AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET, after which more
+ * bytes must be read. When \p data holds a whole packet, it is decoded in place and the spans in
+ * \p out_packet point into \p data. Otherwise, the bytes are accumulated in the decoder's buffer
+ * and the spans point into that buffer. Either way, they are only valid until the next call.
+ *
+ * @param[in,out] ref_decoder The #az_mqtt_decoder.
+ * @param[in] data The bytes read from the network.
+ * @param[out] out_consumed The number of bytes of \p data that were consumed.
+ * @param[out] out_packet The decoded packet.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK A packet was decoded into \p out_packet.
+ * @retval #AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET All of \p data was consumed without completing a
+ * packet.
+ * @retval #AZ_ERROR_IOT_MQTT_MALFORMED_PACKET The packet is not valid: a reserved packet type, a
+ * remaining length longer than 4 bytes, a PUBACK or SUBACK with packet identifier `0`, or invalid
+ * flags or content. The connection should be closed.
+ * @retval #AZ_ERROR_IOT_MQTT_PACKET_TOO_LARGE The packet is larger than the decoder's buffer. Only
+ * the `type` of \p out_packet is set. The bytes of the packet are skipped by the next calls, after
+ * which decoding goes on with the following packet. A skipped PUBLISH is not acknowledged, so the
+ * connection should be closed unless the application can do without it.
+ */
+AZ_NODISCARD az_result az_mqtt_decoder_decode(
+    az_mqtt_decoder* ref_decoder,
+    az_span data,
+    int32_t* out_consumed,
+    az_mqtt_packet* out_packet);
+
+/**
+ * @brief An entry of an #az_mqtt_inflight table, provided by the application.
+ */
+typedef struct
+{
+  struct
+  {
+    void* user_context;
+    int64_t deadline_msec;
+    int32_t heap_position;
+    int32_t heap_entry;
+    uint16_t packet_id;
+  } _internal;
+} az_mqtt_inflight_entry;
+
+/**
+ * @brief Options for an #az_mqtt_inflight table.
+ */
+typedef struct
+{
+  /**
+   * The maximum number of QoS 1 publishes awaiting a PUBACK at once, or `0` to allow as many as the
+   * table has entries.
+   */
+  int32_t max_in_flight;
+
+  /**
+   * How long to wait for a PUBACK, in milliseconds, before a publish should be sent again.
+   */
+  int32_t retransmit_timeout_msec;
+} az_mqtt_inflight_options;
+
+/**
+ * @brief Tracks QoS 1 publishes awaiting a PUBACK and when each should be sent again.
+ *
+ * @details The table assigns packet identifiers so that each one maps directly to an entry, which
+ * makes adding and acknowledging a publish constant time. Retransmission deadlines are kept in a
+ * min-heap over the same entries and are measured with #az_platform_clock_msec().
+ */
+typedef struct
+{
+  struct
+  {
+    az_mqtt_inflight_entry* entries;
+    int32_t entries_length;
+    int32_t count;
+    uint16_t next_packet_id;
+    az_mqtt_inflight_options options;
+  } _internal;
+} az_mqtt_inflight;
+
+/**
+ * @brief Gets the default #az_mqtt_inflight_options.
+ *
+ * @details The number of publishes in flight is only limited by the number of entries, and a
+ * publish is sent again after 20 seconds without a PUBACK.
+ *
+ * @return An #az_mqtt_inflight_options.
+ */
+AZ_NODISCARD az_mqtt_inflight_options az_mqtt_inflight_options_default(void);
+
+/**
+ * @brief Initializes an #az_mqtt_inflight table.
+ *
+ * @param[out] out_inflight The #az_mqtt_inflight to initialize.
+ * @param[in] entries The entries used by the table. They must stay valid while the table is used.
+ * @param[in] entries_length The number of elements in \p entries, between `1` and `65535`.
+ * @param[in] options __[nullable]__ A reference to an #az_mqtt_inflight_options structure. If
+ * `NULL`, the default options are used.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_mqtt_inflight_init(
+    az_mqtt_inflight* out_inflight,
+    az_mqtt_inflight_entry entries[],
+    int32_t entries_length,
+    az_mqtt_inflight_options const* options);
+
+/**
+ * @brief Adds a QoS 1 publish about to be sent, and assigns its packet identifier.
+ *
+ * @param[in,out] ref_inflight The #az_mqtt_inflight table.
+ * @param[in] user_context __[nullable]__ A context returned when the publish is acknowledged or
+ * must be sent again, such as a pointer to the message.
+ * @param[out] out_packet_id The packet identifier to send the publish with.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The maximum number of publishes are already in flight.
+ * @retval Other Failure reading the platform clock.
+ */
+AZ_NODISCARD az_result
+az_mqtt_inflight_add(az_mqtt_inflight* ref_inflight, void* user_context, uint16_t* out_packet_id);
+
+/**
+ * @brief Removes the publish acknowledged by a PUBACK.
+ *
+ * @param[in,out] ref_inflight The #az_mqtt_inflight table.
+ * @param[in] packet_id The packet identifier of the PUBACK.
+ * @param[out] out_user_context __[nullable]__ If not `NULL`, receives the context given to
+ * #az_mqtt_inflight_add().
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No publish is in flight with \p packet_id.
+ */
+AZ_NODISCARD az_result az_mqtt_inflight_ack(
+    az_mqtt_inflight* ref_inflight,
+    uint16_t packet_id,
+    void** out_user_context);
+
+/**
+ * @brief Gets the publish whose PUBACK has been awaited the longest, if it is past its deadline.
+ *
+ * @details The publish stays in flight and its deadline is pushed back by the retransmit timeout,
+ * so the application should send it again, with the same packet identifier and its `duplicate`
+ * flag set. Call this function repeatedly until it returns #AZ_ERROR_ITEM_NOT_FOUND.
+ *
+ * @param[in,out] ref_inflight The #az_mqtt_inflight table.
+ * @param[out] out_packet_id The packet identifier of the publish.
+ * @param[out] out_user_context __[nullable]__ If not `NULL`, receives the context given to
+ * #az_mqtt_inflight_add().
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK A publish must be sent again.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No publish is past its deadline.
+ * @retval Other Failure reading the platform clock.
+ */
+AZ_NODISCARD az_result az_mqtt_inflight_get_expired(
+    az_mqtt_inflight* ref_inflight,
+    uint16_t* out_packet_id,
+    void** out_user_context);
+
+/**
+ * @brief Gets the soonest retransmit deadline, for example to bound how long to wait for network
+ * data.
+ *
+ * @param[in] inflight The #az_mqtt_inflight table.
+ * @param[out] out_deadline_msec The deadline, in the time base of #az_platform_clock_msec().
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND No publish is in flight.
+ */
+AZ_NODISCARD az_result
+az_mqtt_inflight_get_next_deadline(az_mqtt_inflight const* inflight, int64_t* out_deadline_msec);
+
+/**
+ * @brief Gets the number of publishes in flight.
+ *
+ * @param[in] inflight The #az_mqtt_inflight table.
+ *
+ * @return The number of publishes awaiting a PUBACK.
+ */
+AZ_NODISCARD AZ_INLINE int32_t az_mqtt_inflight_get_count(az_mqtt_inflight const* inflight)
+{
+  return inflight->_internal.count;
+}
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_MQTT_H
@@ -37,3 +37,8 @@
 #ifndef _az_IOT_ADU_CLIENT_MAX_DEVICE_CUSTOM_PROPERTIES
 #define _az_IOT_ADU_CLIENT_MAX_DEVICE_CUSTOM_PROPERTIES (5)
 #endif // _az_IOT_ADU_CLIENT_MAX_DEVICE_CUSTOM_PROPERTIES
+
+// Maximum Number of Ranges of a File Downloaded at the Same Time
+#ifndef _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT
+#define _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT (4)
+#endif // _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT
@@ -15,10 +15,13 @@
 #ifndef _az_IOT_CORE_INTERNAL_H
 #define _az_IOT_CORE_INTERNAL_H
 
+#include <azure/core/az_json.h>
 #include <azure/core/az_result.h>
 #include <azure/core/az_span.h>
+#include <azure/iot/az_iot_common.h>
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <azure/core/_az_cfg_prefix.h>
@@ -54,6 +57,123 @@ AZ_NODISCARD int32_t _az_iot_u64toa_size(uint64_t number);
 AZ_NODISCARD az_result
 _az_span_copy_url_encode(az_span destination, az_span source, az_span* out_remainder);
 
+/**
+ * @brief The initial value of a 32-bit FNV-1a hash.
+ */
+#define _az_IOT_FNV1A_OFFSET_BASIS 2166136261U
+
+/**
+ * @brief Continues a 32-bit FNV-1a hash over the bytes of a span.
+ *
+ * @param[in] hash The hash of the preceding bytes, or #_az_IOT_FNV1A_OFFSET_BASIS to start a new
+ * hash.
+ * @param[in] span The bytes to hash.
+ * @return The hash of the preceding bytes followed by the bytes of \p span.
+ */
+AZ_NODISCARD AZ_INLINE uint32_t _az_iot_fnv1a(uint32_t hash, az_span span)
+{
+  uint8_t const* const ptr = az_span_ptr(span);
+  int32_t const size = az_span_size(span);
+  for (int32_t i = 0; i < size; i++)
+  {
+    hash = (hash ^ ptr[i]) * 16777619U;
+  }
+  return hash;
+}
+
+/**
+ * @brief Moves a JSON reader from the first token of a value to its last token, and gets the JSON
+ * text of the value.
+ *
+ * @param[in,out] ref_json_reader A reader over a single contiguous buffer, at the first token of a
+ * value.
+ * @param[out] out_json_text The JSON text of the value, including the quotes of a string.
+ * @return An `az_result` value.
+ */
+AZ_NODISCARD az_result
+_az_iot_json_reader_get_value_text(az_json_reader* ref_json_reader, az_span* out_json_text);
+
+/**
+ * @brief Gets the unescaped text of a JSON property name.
+ *
+ * @param[in] name_token A property name token read from a single contiguous buffer.
+ * @param[in] name_buffer The buffer to unescape the name into. It is only used if the name has
+ * escape sequences.
+ * @param[in] name_buffer_size The size of \p name_buffer.
+ * @param[out] out_name The unescaped text of the name.
+ * @return An `az_result` value.
+ */
+AZ_NODISCARD az_result _az_iot_json_token_get_property_name(
+    az_json_token const* name_token,
+    char* name_buffer,
+    int32_t name_buffer_size,
+    az_span* out_name);
+
+enum
+{
+  /// The index of no entry of a #_az_iot_timer_wheel.
+  _az_IOT_TIMER_WHEEL_NO_ENTRY = -1,
+};
+
+/**
+ * @brief Decides whether an expired entry of a #_az_iot_timer_wheel is returned by
+ * #_az_iot_timer_wheel_find_expired().
+ */
+typedef bool (*_az_iot_timer_wheel_filter_fn)(int32_t index, void* user_context);
+
+/**
+ * @brief Initializes a #_az_iot_timer_wheel with no entries scheduled.
+ *
+ * @param[out] out_wheel The #_az_iot_timer_wheel to initialize.
+ * @param[in] first_node The node of the first entry of the array.
+ * @param[in] node_stride The size, in bytes, of an entry of the array.
+ * @param[in] tick_msec The resolution, in milliseconds, of the wheel.
+ */
+void _az_iot_timer_wheel_init(
+    _az_iot_timer_wheel* out_wheel,
+    _az_iot_timer_wheel_node* first_node,
+    int32_t node_stride,
+    int32_t tick_msec);
+
+/**
+ * @brief Schedules the entry at \p index, which must not be scheduled, at \p deadline_msec.
+ */
+void _az_iot_timer_wheel_link(_az_iot_timer_wheel* ref_wheel, int32_t index, int64_t deadline_msec);
+
+/**
+ * @brief Unschedules the entry at \p index, which must be scheduled.
+ */
+void _az_iot_timer_wheel_unlink(_az_iot_timer_wheel* ref_wheel, int32_t index);
+
+/**
+ * @brief Finds a scheduled entry whose deadline is at or before \p now_msec.
+ *
+ * @details Only the slots of the ticks elapsed since the last call are visited. The wheel only
+ * moves past the slots without expired entries, so that an expired entry rejected by \p filter is
+ * found again by later calls.
+ *
+ * @param[in,out] ref_wheel The #_az_iot_timer_wheel to use for this call.
+ * @param[in] now_msec The current time, in milliseconds.
+ * @param[in] filter __[nullable]__ Decides which expired entries are returned. If `NULL`, any is.
+ * @param[in] filter_context The context passed to \p filter.
+ * @return The index of the entry, which stays scheduled, or #_az_IOT_TIMER_WHEEL_NO_ENTRY.
+ */
+AZ_NODISCARD int32_t _az_iot_timer_wheel_find_expired(
+    _az_iot_timer_wheel* ref_wheel,
+    int64_t now_msec,
+    _az_iot_timer_wheel_filter_fn filter,
+    void* filter_context);
+
+/**
+ * @brief Gets the node of the entry at \p index.
+ */
+AZ_NODISCARD AZ_INLINE _az_iot_timer_wheel_node*
+_az_iot_timer_wheel_get_node(_az_iot_timer_wheel const* wheel, int32_t index)
+{
+  return (_az_iot_timer_wheel_node*)(void*)((uint8_t*)wheel->_internal.first_node
+                                            + (size_t)index * (size_t)wheel->_internal.node_stride);
+}
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_IOT_CORE_INTERNAL_H
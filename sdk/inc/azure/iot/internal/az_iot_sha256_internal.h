@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file az_iot_sha256_internal.h
+ *
+ * @brief Incremental SHA-256 (FIPS 180-4), used to verify downloaded update files, and HMAC-SHA256
+ * (RFC 2104), used to derive device keys.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_IOT_SHA256_INTERNAL_H
+#define _az_IOT_SHA256_INTERNAL_H
+
+#include <azure/core/az_span.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+enum
+{
+  /// The size, in bytes, of a SHA-256 digest.
+  _az_IOT_SHA256_DIGEST_SIZE = 32,
+
+  /// The size, in bytes, of the blocks SHA-256 processes.
+  _az_IOT_SHA256_BLOCK_SIZE = 64,
+};
+
+/**
+ * @brief The state of a SHA-256 digest being computed.
+ */
+typedef struct
+{
+  uint32_t state[8];
+  uint64_t length;
+  uint8_t block[_az_IOT_SHA256_BLOCK_SIZE];
+  int32_t block_length;
+} _az_iot_sha256;
+
+/**
+ * @brief Starts computing a SHA-256 digest.
+ *
+ * @param[out] out_sha256 The #_az_iot_sha256 to initialize.
+ */
+void _az_iot_sha256_init(_az_iot_sha256* out_sha256);
+
+/**
+ * @brief Adds data to the SHA-256 digest being computed.
+ *
+ * @param[in,out] ref_sha256 The #_az_iot_sha256 to use for this call.
+ * @param[in] data The data to add. It can be of any size.
+ */
+void _az_iot_sha256_update(_az_iot_sha256* ref_sha256, az_span data);
+
+/**
+ * @brief Finishes computing the SHA-256 digest.
+ *
+ * @param[in,out] ref_sha256 The #_az_iot_sha256 to use for this call. It must be initialized again
+ * before being reused.
+ * @param[out] out_digest The #az_span to write the digest to. It must be at least
+ * #_az_IOT_SHA256_DIGEST_SIZE bytes.
+ */
+void _az_iot_sha256_final(_az_iot_sha256* ref_sha256, az_span out_digest);
+
+/**
+ * @brief Computes the HMAC-SHA256 of data.
+ *
+ * @param[in] key The key. Keys longer than #_az_IOT_SHA256_BLOCK_SIZE bytes are hashed first.
+ * @param[in] data The data to authenticate.
+ * @param[out] out_digest The #az_span to write the HMAC to. It must be at least
+ * #_az_IOT_SHA256_DIGEST_SIZE bytes.
+ */
+void _az_iot_hmac_sha256(az_span key, az_span data, az_span out_digest);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_IOT_SHA256_INTERNAL_H
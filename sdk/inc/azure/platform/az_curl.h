@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Optional configuration for the libcurl HTTP transport adapter (`az_curl`).
+ *
+ * @details By default, every call to #az_http_client_send_request() creates a new libcurl easy
+ * handle, so DNS results, TLS sessions and connections are not reused across requests. An
+ * application that sends many requests can call #az_http_client_curl_init() once at startup to
+ * share those caches between requests and to negotiate HTTP/2.
+ *
+ * @note This header is only meaningful when the application links against `az_curl`.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_CURL_H
+#define _az_CURL_H
+
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_result.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief Connection and TLS timing of a single request sent by the curl transport adapter.
+ *
+ * @details Every value is the time, in microseconds, elapsed from the start of the request until
+ * the given phase completed. A phase that did not take place (for example, TLS handshake on a
+ * reused connection) reports the same value as the phase before it.
+ */
+typedef struct
+{
+  int64_t name_lookup_usec; ///< Name resolution completed.
+  int64_t connect_usec; ///< TCP connection to the remote host completed.
+  int64_t app_connect_usec; ///< TLS handshake completed (`0` for plain HTTP).
+  int64_t first_byte_usec; ///< First byte of the response was received.
+  int64_t total_usec; ///< The whole request completed.
+  int32_t new_connections; ///< Number of new connections opened (`0` when one was reused).
+  int32_t http_version; ///< Negotiated HTTP version (`10`, `11`, `20`) or `0` if unknown.
+} az_http_client_curl_timing;
+
+/**
+ * @brief Callback invoked by the curl transport adapter after each request completes.
+ *
+ * @param[in] request The request that was sent.
+ * @param[in] result The result of sending \p request.
+ * @param[in] timing The connection and TLS timing of \p request.
+ * @param[in] user_context The `timing_context` given in #az_http_client_curl_options.
+ */
+typedef void (*az_http_client_curl_timing_fn)(
+    az_http_request const* request,
+    az_result result,
+    az_http_client_curl_timing const* timing,
+    void* user_context);
+
+/**
+ * @brief Callback used to lock or unlock the shared DNS cache and TLS sessions when requests are
+ * sent concurrently from several threads.
+ *
+ * @param[in] user_context The `lock_context` given in #az_http_client_curl_options.
+ */
+typedef void (*az_http_client_curl_lock_fn)(void* user_context);
+
+/**
+ * @brief Options for the curl transport adapter.
+ */
+typedef struct
+{
+  /**
+   * Share resolved host names between requests.
+   */
+  bool share_dns_cache;
+
+  /**
+   * Share TLS session IDs between requests, so reconnecting to a host resumes the previous TLS
+   * session instead of performing a full handshake.
+   */
+  bool share_ssl_sessions;
+
+  /**
+   * Share the connection cache between requests, so a request to a host reuses an idle connection
+   * opened by a previous request. libcurl does not support sharing connections between threads,
+   * even with lock callbacks, so this must only be set when #az_http_client_send_request() is
+   * called from a single thread, and cannot be combined with `lock`.
+   */
+  bool share_connections;
+
+  /**
+   * Negotiate HTTP/2 over TLS (falling back to HTTP/1.1) and wait for an existing connection to be
+   * available for multiplexing rather than opening a new one.
+   */
+  bool enable_http2;
+
+  /**
+   * __[nullable]__ Function that locks the shared DNS cache and TLS sessions. Must be set along
+   * with `unlock`, and `share_connections` must be `false`, if #az_http_client_send_request() is
+   * called concurrently from several threads.
+   */
+  az_http_client_curl_lock_fn lock;
+
+  /**
+   * __[nullable]__ Function that unlocks the shared caches.
+   */
+  az_http_client_curl_lock_fn unlock;
+
+  /**
+   * __[nullable]__ Context passed to `lock` and `unlock`.
+   */
+  void* lock_context;
+
+  /**
+   * __[nullable]__ Function invoked with the connection and TLS timing of each request.
+   */
+  az_http_client_curl_timing_fn timing_callback;
+
+  /**
+   * __[nullable]__ Context passed to `timing_callback`.
+   */
+  void* timing_context;
+} az_http_client_curl_options;
+
+/**
+ * @brief Gets the default curl transport adapter options.
+ *
+ * @details DNS, TLS session and connection sharing as well as HTTP/2 are enabled. No lock and no
+ * timing callbacks are set, so these options are for an application that sends requests from a
+ * single thread. To send requests from several threads, set `lock` and `unlock`, and set
+ * `share_connections` to `false`.
+ *
+ * @return An #az_http_client_curl_options.
+ */
+AZ_NODISCARD az_http_client_curl_options az_http_client_curl_options_default(void);
+
+/**
+ * @brief Configures the curl transport adapter used by #az_http_client_send_request().
+ *
+ * @details Must be called before any request is sent and must not be called concurrently with
+ * #az_http_client_send_request().
+ *
+ * @param[in] options __[nullable]__ A reference to an #az_http_client_curl_options structure. If
+ * `NULL`, the default options are used.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_ARG `share_connections` is set along with `lock`: the connection cache cannot
+ * be shared between threads.
+ * @retval #AZ_ERROR_NOT_SUPPORTED The libcurl version in use does not support one of the requested
+ * features.
+ * @retval #AZ_ERROR_HTTP_ADAPTER libcurl failed to create the shared caches.
+ */
+AZ_NODISCARD az_result az_http_client_curl_init(az_http_client_curl_options const* options);
+
+/**
+ * @brief Releases the shared caches created by #az_http_client_curl_init() and restores the
+ * default behavior of creating independent connections for each request.
+ *
+ * @details Must not be called concurrently with #az_http_client_send_request().
+ */
+void az_http_client_curl_deinit(void);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_CURL_H
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include <azure/core/az_context.h>
+#include <azure/core/internal/az_atomic_internal.h>
 #include <azure/core/internal/az_precondition_internal.h>
 
 #include <stddef.h>
@@ -12,15 +13,34 @@
 // never expires. Call az_context_cancel passing a pointer to this node to cancel the entire
 // application (which cancels all the child nodes).
 az_context az_context_application = {
-  ._internal
-  = { .parent = NULL, .expiration = _az_CONTEXT_MAX_EXPIRATION, .key = NULL, .value = NULL }
+  ._internal = {
+    .parent = NULL,
+    .expiration = _az_CONTEXT_MAX_EXPIRATION,
+    .key = NULL,
+    .value = NULL,
+    .min_expiration = _az_CONTEXT_MAX_EXPIRATION,
+    .cancel_epoch = 0,
+    .value_parent = NULL,
+  }
 };
 
+// Incremented by every call to az_context_cancel(). Expirations only change when a node is
+// canceled, so while this counter has not moved since a node was created, the soonest expiration
+// of its chain that the node cached at creation is still exact. The counter starts at 1 (and skips
+// 0 when it wraps) so that a cancel_epoch of 0 always means "nothing cached".
+static uint32_t _az_context_cancel_epoch = 1;
+
 // Returns the soonest expiration time of this az_context node or any of its parent nodes.
 AZ_NODISCARD int64_t az_context_get_expiration(az_context const* context)
 {
   _az_PRECONDITION_NOT_NULL(context);
 
+  if (context->_internal.cancel_epoch != 0
+      && context->_internal.cancel_epoch == _az_ATOMIC_LOAD(&_az_context_cancel_epoch))
+  {
+    return context->_internal.min_expiration;
+  }
+
   int64_t expiration = _az_CONTEXT_MAX_EXPIRATION;
   for (; context != NULL; context = context->_internal.parent)
   {
@@ -42,25 +62,69 @@ az_context_get_value(az_context const* context, void const* key, void const** ou
   _az_PRECONDITION_NOT_NULL(out_value);
   _az_PRECONDITION_NOT_NULL(key);
 
-  for (; context != NULL; context = context->_internal.parent)
+  while (context != NULL)
   {
     if (context->_internal.key == key)
     {
       *out_value = context->_internal.value;
       return AZ_OK;
     }
+
+    // Nodes created by az_context_create_with_*() link to their nearest parent with a key.
+    context = context->_internal.cancel_epoch != 0 ? context->_internal.value_parent
+                                                   : context->_internal.parent;
   }
   *out_value = NULL;
   return AZ_ERROR_ITEM_NOT_FOUND;
 }
 
+static az_context _az_context_create(
+    az_context const* parent,
+    int64_t expiration,
+    void const* key,
+    void const* value)
+{
+  // Read the counter before the parent's expirations, so that a concurrent cancel either shows up
+  // in the cached value or invalidates it.
+  uint32_t const cancel_epoch = _az_ATOMIC_LOAD(&_az_context_cancel_epoch);
+  int64_t const parent_expiration = az_context_get_expiration(parent);
+
+  az_context const* value_parent = parent;
+  if (parent->_internal.key == NULL)
+  {
+    if (parent->_internal.cancel_epoch != 0)
+    {
+      value_parent = parent->_internal.value_parent;
+    }
+    else
+    {
+      while (value_parent != NULL && value_parent->_internal.key == NULL)
+      {
+        value_parent = value_parent->_internal.parent;
+      }
+    }
+  }
+
+  return (az_context){
+    ._internal = {
+      .parent = parent,
+      .expiration = expiration,
+      .key = key,
+      .value = value,
+      .min_expiration = expiration < parent_expiration ? expiration : parent_expiration,
+      .cancel_epoch = cancel_epoch,
+      .value_parent = value_parent,
+    },
+  };
+}
+
 AZ_NODISCARD az_context
 az_context_create_with_expiration(az_context const* parent, int64_t expiration)
 {
   _az_PRECONDITION_NOT_NULL(parent);
   _az_PRECONDITION(expiration >= 0);
 
-  return (az_context){ ._internal = { .parent = parent, .expiration = expiration } };
+  return _az_context_create(parent, expiration, NULL, NULL);
 }
 
 AZ_NODISCARD az_context
@@ -69,10 +133,7 @@ az_context_create_with_value(az_context const* parent, void const* key, void con
   _az_PRECONDITION_NOT_NULL(parent);
   _az_PRECONDITION_NOT_NULL(key);
 
-  return (az_context){
-    ._internal
-    = { .parent = parent, .expiration = _az_CONTEXT_MAX_EXPIRATION, .key = key, .value = value }
-  };
+  return _az_context_create(parent, _az_CONTEXT_MAX_EXPIRATION, key, value);
 }
 
 void az_context_cancel(az_context* ref_context)
@@ -80,6 +141,13 @@ void az_context_cancel(az_context* ref_context)
   _az_PRECONDITION_NOT_NULL(ref_context);
 
   ref_context->_internal.expiration = 0; // The beginning of time
+
+  // Invalidate the expirations cached by every node, since they may descend from this one.
+  uint32_t epoch = _az_ATOMIC_LOAD(&_az_context_cancel_epoch);
+  while (!_az_ATOMIC_COMPARE_EXCHANGE(
+      &_az_context_cancel_epoch, &epoch, epoch == UINT32_MAX ? 1U : epoch + 1U))
+  {
+  }
 }
 
 AZ_NODISCARD bool az_context_has_expired(az_context const* context, int64_t current_time)
@@ -0,0 +1,259 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_http_private.h"
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/internal/az_atomic_internal.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+// Counters are updated with the lock-free atomics from az_atomic_internal.h, so several threads
+// can share one az_http_metrics instance where those are available.
+
+AZ_INLINE int32_t _az_http_histogram_get_highest_bit(uint32_t value)
+{
+  int32_t bit = -1;
+  while (value != 0)
+  {
+    value >>= 1U;
+    bit++;
+  }
+  return bit;
+}
+
+AZ_INLINE int32_t _az_http_histogram_get_bucket_index(int32_t value)
+{
+  if (value < _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT)
+  {
+    return value < 0 ? 0 : value;
+  }
+
+  int32_t const shift
+      = _az_http_histogram_get_highest_bit((uint32_t)value) - _az_HTTP_HISTOGRAM_SUB_BUCKET_BITS;
+
+  // Values in [2^(shift + BITS), 2^(shift + BITS + 1)) land in sub-bucket (value >> shift) - COUNT
+  // of magnitude (shift + 1).
+  return ((shift + 1) * _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT)
+      + ((int32_t)((uint32_t)value >> (uint32_t)shift) - _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT);
+}
+
+// Returns the largest value that maps to the bucket at index.
+AZ_INLINE int32_t _az_http_histogram_get_bucket_upper_bound(int32_t index)
+{
+  if (index < _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT)
+  {
+    return index;
+  }
+
+  int32_t const shift = (index / _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT) - 1;
+  int64_t const lower_bound = (int64_t)((index % _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT)
+                                        + _az_HTTP_HISTOGRAM_SUB_BUCKET_COUNT)
+      << shift;
+  int64_t const upper_bound = lower_bound + ((int64_t)1 << shift) - 1;
+
+  return upper_bound > INT32_MAX ? INT32_MAX : (int32_t)upper_bound;
+}
+
+static void _az_http_histogram_record(az_http_histogram* ref_histogram, int32_t value)
+{
+  if (value < 0)
+  {
+    value = 0;
+  }
+
+  _az_ATOMIC_INCREMENT(&ref_histogram->buckets[_az_http_histogram_get_bucket_index(value)]);
+  _az_ATOMIC_INCREMENT(&ref_histogram->count);
+
+  int32_t max = _az_ATOMIC_LOAD(&ref_histogram->max);
+  while (value > max && !_az_ATOMIC_COMPARE_EXCHANGE(&ref_histogram->max, &max, value))
+  {
+  }
+}
+
+static void _az_http_histogram_snapshot(
+    az_http_histogram const* histogram,
+    az_http_histogram* out_snapshot)
+{
+  out_snapshot->count = _az_ATOMIC_LOAD(&histogram->count);
+  out_snapshot->max = _az_ATOMIC_LOAD(&histogram->max);
+  for (int32_t i = 0; i < AZ_HTTP_HISTOGRAM_BUCKET_COUNT; i++)
+  {
+    out_snapshot->buckets[i] = _az_ATOMIC_LOAD(&histogram->buckets[i]);
+  }
+}
+
+void az_http_metrics_init(az_http_metrics* out_metrics)
+{
+  _az_PRECONDITION_NOT_NULL(out_metrics);
+
+  *out_metrics = (az_http_metrics){ 0 };
+}
+
+void az_http_metrics_snapshot(az_http_metrics const* metrics, az_http_metrics* out_snapshot)
+{
+  _az_PRECONDITION_NOT_NULL(metrics);
+  _az_PRECONDITION_NOT_NULL(out_snapshot);
+
+  _az_http_histogram_snapshot(
+      &metrics->attempt_duration_msec, &out_snapshot->attempt_duration_msec);
+  _az_http_histogram_snapshot(&metrics->request_size, &out_snapshot->request_size);
+  _az_http_histogram_snapshot(&metrics->response_size, &out_snapshot->response_size);
+
+  out_snapshot->attempt_count = _az_ATOMIC_LOAD(&metrics->attempt_count);
+  out_snapshot->retry_count = _az_ATOMIC_LOAD(&metrics->retry_count);
+  out_snapshot->failure_count = _az_ATOMIC_LOAD(&metrics->failure_count);
+  for (size_t i = 0; i < _az_COUNTOF(metrics->status_code_class_count); i++)
+  {
+    out_snapshot->status_code_class_count[i]
+        = _az_ATOMIC_LOAD(&metrics->status_code_class_count[i]);
+  }
+}
+
+AZ_NODISCARD int32_t
+az_http_histogram_get_value_at_percentile(az_http_histogram const* histogram, double percentile)
+{
+  _az_PRECONDITION_NOT_NULL(histogram);
+  _az_PRECONDITION(percentile >= 0 && percentile <= 100);
+
+  if (histogram->count == 0)
+  {
+    return 0;
+  }
+
+  // Number of values that must be at or below the returned value (at least 1).
+  uint64_t target = (uint64_t)((percentile * histogram->count) / 100.0 + 0.5);
+  if (target == 0)
+  {
+    target = 1;
+  }
+
+  uint64_t seen = 0;
+  for (int32_t i = 0; i < AZ_HTTP_HISTOGRAM_BUCKET_COUNT; i++)
+  {
+    seen += histogram->buckets[i];
+    if (seen >= target)
+    {
+      int32_t const upper_bound = _az_http_histogram_get_bucket_upper_bound(i);
+      return upper_bound < histogram->max ? upper_bound : histogram->max;
+    }
+  }
+
+  return histogram->max;
+}
+
+static int32_t _az_http_policy_instrumentation_get_request_size(az_http_request const* request)
+{
+  int32_t size = az_span_size(request->_internal.method) + request->_internal.url_length
+      + az_span_size(request->_internal.body);
+
+  for (int32_t i = 0; i < request->_internal.headers_length; i++)
+  {
+    _az_http_request_header const* const header
+        = &((_az_http_request_header const*)az_span_ptr(request->_internal.headers))[i];
+    size += az_span_size(header->name) + az_span_size(header->value);
+  }
+
+  return size;
+}
+
+static void _az_http_policy_instrumentation_record(
+    az_http_metrics* ref_metrics,
+    az_http_instrumentation_attempt const* attempt)
+{
+  _az_ATOMIC_INCREMENT(&ref_metrics->attempt_count);
+
+  if (attempt->attempt > 1)
+  {
+    _az_ATOMIC_INCREMENT(&ref_metrics->retry_count);
+  }
+
+  if (attempt->status_code == AZ_HTTP_STATUS_CODE_NONE)
+  {
+    _az_ATOMIC_INCREMENT(&ref_metrics->failure_count);
+  }
+  else
+  {
+    int32_t const status_class = ((int32_t)attempt->status_code / 100) - 1;
+    if (status_class >= 0
+        && status_class < (int32_t)_az_COUNTOF(ref_metrics->status_code_class_count))
+    {
+      _az_ATOMIC_INCREMENT(&ref_metrics->status_code_class_count[status_class]);
+    }
+  }
+
+  _az_http_histogram_record(&ref_metrics->attempt_duration_msec, attempt->duration_msec);
+  _az_http_histogram_record(&ref_metrics->request_size, attempt->request_size);
+  _az_http_histogram_record(&ref_metrics->response_size, attempt->response_size);
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_instrumentation(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  _az_PRECONDITION_NOT_NULL(ref_options);
+
+  az_http_policy_instrumentation_options const* const options
+      = (az_http_policy_instrumentation_options const*)ref_options;
+
+  if (options->metrics == NULL && options->callback == NULL)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  // Without a clock, the attempt is sent without being recorded, so that the result of the request
+  // is never replaced by the error of the clock.
+  int64_t start = 0;
+  if (az_result_failed(az_platform_clock_msec(&start)))
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  az_result const result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+
+  int64_t end = 0;
+  if (az_result_failed(az_platform_clock_msec(&end)))
+  {
+    return result;
+  }
+
+  int64_t const duration_msec = end - start;
+
+  az_http_instrumentation_attempt attempt = {
+    .result = result,
+    .status_code = AZ_HTTP_STATUS_CODE_NONE,
+    .attempt = ref_request->_internal.retry_attempt,
+    .duration_msec = duration_msec > INT32_MAX ? INT32_MAX : (int32_t)duration_msec,
+    .request_size = _az_http_policy_instrumentation_get_request_size(ref_request),
+    .response_size = 0,
+  };
+
+  if (az_result_succeeded(result))
+  {
+    // Parse the status line on a copy so that the caller reads the response from the beginning.
+    az_http_response response_copy = *ref_response;
+    attempt.status_code = az_http_response_get_status_code(&response_copy);
+    attempt.response_size = ref_response->_internal.written;
+  }
+
+  if (options->metrics != NULL)
+  {
+    _az_http_policy_instrumentation_record(options->metrics, &attempt);
+  }
+
+  if (options->callback != NULL)
+  {
+    options->callback(&attempt, options->callback_context);
+  }
+
+  return result;
+}
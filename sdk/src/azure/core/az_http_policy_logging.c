@@ -207,8 +207,194 @@ static az_result _az_http_policy_logging_append_http_response_msg(
   return AZ_OK;
 }
 
+#ifndef AZ_NO_LOGGING
+
+// When a ring buffer is set, the request and response are copied into a binary record instead of
+// being formatted: a _az_http_policy_logging_record, followed by the request headers (whose spans
+// point into the record), followed by the method, URL, header names and values and, for
+// responses, the status line and headers as received. Header values are trimmed to
+// _az_LOG_LENGTHY_VALUE_MAX_LENGTH the same way formatting trims them, and the authorization
+// value is never copied, so formatting the record later produces the same message.
+typedef struct
+{
+  int64_t duration_msec;
+  int32_t headers_length; // -1 when the request is NULL.
+  int32_t method_length;
+  int32_t url_length;
+  int32_t response_length; // 0 when there is no response.
+} _az_http_policy_logging_record;
+
+static az_span const _az_http_policy_logging_auth_header_name
+    = AZ_SPAN_LITERAL_FROM_STR("authorization");
+
+AZ_INLINE int32_t _az_http_policy_logging_get_logged_value_size(az_span name, az_span value)
+{
+  if (az_span_is_content_equal(name, _az_http_policy_logging_auth_header_name))
+  {
+    return 0;
+  }
+
+  return az_span_size(value) < _az_LOG_LENGTHY_VALUE_MAX_LENGTH ? az_span_size(value)
+                                                                : _az_LOG_LENGTHY_VALUE_MAX_LENGTH;
+}
+
+static az_span _az_http_policy_logging_get_response_head(az_http_response const* response)
+{
+  if (response == NULL)
+  {
+    return AZ_SPAN_EMPTY;
+  }
+
+  az_span head = response->_internal.http_response;
+  int32_t const headers_end = az_span_find(head, AZ_SPAN_FROM_STR("\r\n\r\n"));
+  if (headers_end >= 0)
+  {
+    head = az_span_slice(head, 0, headers_end + 4);
+  }
+
+  // A response head larger than this could not be formatted into a log message anyway.
+  return az_span_size(head) > AZ_LOG_MESSAGE_BUFFER_SIZE
+      ? az_span_slice(head, 0, AZ_LOG_MESSAGE_BUFFER_SIZE)
+      : head;
+}
+
+static void _az_http_policy_logging_write_record(
+    az_log_ring_buffer* ref_ring_buffer,
+    az_log_classification classification,
+    az_http_request const* request,
+    az_http_response const* response,
+    int64_t duration_msec)
+{
+  az_span const head = _az_http_policy_logging_get_response_head(response);
+
+  _az_http_policy_logging_record record_info = {
+    .duration_msec = duration_msec,
+    .headers_length = request == NULL ? -1 : request->_internal.headers_length,
+    .method_length = request == NULL ? 0 : az_span_size(request->_internal.method),
+    .url_length = request == NULL ? 0 : request->_internal.url_length,
+    .response_length = az_span_size(head),
+  };
+
+  int32_t const headers_count = record_info.headers_length < 0 ? 0 : record_info.headers_length;
+  int32_t body_size = (int32_t)sizeof(record_info)
+      + (headers_count * (int32_t)sizeof(_az_http_request_header)) + record_info.method_length
+      + record_info.url_length + record_info.response_length;
+
+  for (int32_t i = 0; i < headers_count; i++)
+  {
+    _az_http_request_header const* const header
+        = &((_az_http_request_header const*)az_span_ptr(request->_internal.headers))[i];
+    body_size += az_span_size(header->name)
+        + _az_http_policy_logging_get_logged_value_size(header->name, header->value);
+  }
+
+  _az_log_record record = { 0 };
+  if (!_az_log_ring_buffer_reserve(ref_ring_buffer, classification, true, body_size, &record))
+  {
+    return;
+  }
+
+  uint8_t* const body = az_span_ptr(record.body);
+  *(_az_http_policy_logging_record*)(void*)body = record_info;
+
+  _az_http_request_header* const headers
+      = (_az_http_request_header*)(void*)(body + sizeof(record_info));
+  az_span remainder = az_span_slice_to_end(
+      record.body,
+      (int32_t)sizeof(record_info) + (headers_count * (int32_t)sizeof(_az_http_request_header)));
+
+  if (request != NULL)
+  {
+    remainder = az_span_copy(remainder, request->_internal.method);
+    remainder = az_span_copy(
+        remainder, az_span_slice(request->_internal.url, 0, request->_internal.url_length));
+  }
+
+  for (int32_t i = 0; i < headers_count; i++)
+  {
+    _az_http_request_header const* const header
+        = &((_az_http_request_header const*)az_span_ptr(request->_internal.headers))[i];
+
+    int32_t const name_size = az_span_size(header->name);
+    int32_t const value_size
+        = _az_http_policy_logging_get_logged_value_size(header->name, header->value);
+
+    headers[i].name = az_span_slice(remainder, 0, name_size);
+    remainder = az_span_copy(remainder, header->name);
+
+    headers[i].value = az_span_slice(remainder, 0, value_size);
+    if (value_size > 0)
+    {
+      remainder = _az_http_policy_logging_copy_lengthy_value(remainder, header->value);
+    }
+  }
+
+  az_span_copy(remainder, head);
+
+  _az_log_ring_buffer_commit(&record);
+}
+
+az_result _az_http_policy_logging_format_record(
+    az_log_classification classification,
+    az_span record,
+    az_span* ref_log_msg)
+{
+  _az_http_policy_logging_record const* const record_info
+      = (_az_http_policy_logging_record const*)(void*)az_span_ptr(record);
+
+  int32_t const headers_count
+      = record_info->headers_length < 0 ? 0 : record_info->headers_length;
+  az_span const headers = az_span_slice(
+      record,
+      (int32_t)sizeof(*record_info),
+      (int32_t)sizeof(*record_info) + (headers_count * (int32_t)sizeof(_az_http_request_header)));
+  az_span remainder = az_span_slice_to_end(
+      record, (int32_t)sizeof(*record_info) + az_span_size(headers));
+
+  az_http_request request = { 0 };
+  request._internal.method = az_span_slice(remainder, 0, record_info->method_length);
+  remainder = az_span_slice_to_end(remainder, record_info->method_length);
+  request._internal.url = az_span_slice(remainder, 0, record_info->url_length);
+  request._internal.url_length = record_info->url_length;
+  request._internal.headers = headers;
+  request._internal.headers_length = headers_count;
+
+  az_http_request const* const request_ptr = record_info->headers_length < 0 ? NULL : &request;
+
+  if (classification != AZ_LOG_HTTP_RESPONSE)
+  {
+    return _az_http_policy_logging_append_http_request_msg(request_ptr, ref_log_msg);
+  }
+
+  az_span const head = az_span_slice(
+      record, az_span_size(record) - record_info->response_length, az_span_size(record));
+
+  az_http_response response = { 0 };
+  if (az_span_size(head) > 0)
+  {
+    _az_RETURN_IF_FAILED(az_http_response_init(&response, head));
+  }
+
+  return _az_http_policy_logging_append_http_response_msg(
+      az_span_size(head) > 0 ? &response : NULL,
+      record_info->duration_msec,
+      request_ptr,
+      ref_log_msg);
+}
+
+#endif // AZ_NO_LOGGING
+
 void _az_http_policy_logging_log_http_request(az_http_request const* request)
 {
+#ifndef AZ_NO_LOGGING
+  az_log_ring_buffer* const ring_buffer = _az_log_get_ring_buffer(AZ_LOG_HTTP_REQUEST);
+  if (ring_buffer != NULL)
+  {
+    _az_http_policy_logging_write_record(ring_buffer, AZ_LOG_HTTP_REQUEST, request, NULL, 0);
+    return;
+  }
+#endif // AZ_NO_LOGGING
+
   uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
   az_span log_msg = AZ_SPAN_FROM_BUFFER(log_msg_buf);
 
@@ -222,6 +408,16 @@ void _az_http_policy_logging_log_http_response(
     int64_t duration_msec,
     az_http_request const* request)
 {
+#ifndef AZ_NO_LOGGING
+  az_log_ring_buffer* const ring_buffer = _az_log_get_ring_buffer(AZ_LOG_HTTP_RESPONSE);
+  if (ring_buffer != NULL)
+  {
+    _az_http_policy_logging_write_record(
+        ring_buffer, AZ_LOG_HTTP_RESPONSE, request, response, duration_msec);
+    return;
+  }
+#endif // AZ_NO_LOGGING
+
   uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
   az_span log_msg = AZ_SPAN_FROM_BUFFER(log_msg_buf);
 
@@ -17,6 +17,8 @@
 
 #include <azure/core/az_http.h>
 #include <azure/core/az_http_transport.h>
+#include <azure/core/az_log.h>
+#include <azure/core/az_span.h>
 
 #include <stdint.h>
 
@@ -29,6 +31,14 @@ void _az_http_policy_logging_log_http_response(
     int64_t duration_msec,
     az_http_request const* request);
 
+#ifndef AZ_NO_LOGGING
+// Formats a binary record written to an az_log_ring_buffer by one of the functions above.
+az_result _az_http_policy_logging_format_record(
+    az_log_classification classification,
+    az_span record,
+    az_span* ref_log_msg);
+#endif // AZ_NO_LOGGING
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_HTTP_POLICY_LOGGING_PRIVATE_H
@@ -175,6 +175,7 @@ AZ_NODISCARD az_result az_http_pipeline_policy_retry(
     _az_RETURN_IF_FAILED(
         az_http_response_init(ref_response, ref_response->_internal.http_response));
     _az_RETURN_IF_FAILED(_az_http_request_remove_retry_headers(ref_request));
+    ref_request->_internal.retry_attempt = attempt;
 
     result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
 
@@ -61,6 +61,7 @@ AZ_NODISCARD az_result az_http_request_init(
                                .max_headers = az_span_size(headers_buffer)
                                    / (int32_t)sizeof(_az_http_request_header),
                                .retry_headers_start_byte_offset = 0,
+                               .retry_attempt = 0,
                                .body = body,
                            } };
 
@@ -152,6 +153,31 @@ az_http_request_append_header(az_http_request* ref_request, az_span name, az_spa
   return AZ_OK;
 }
 
+AZ_NODISCARD az_result az_http_request_append_range_header(
+    az_http_request* ref_request,
+    az_span value_buffer,
+    int64_t first_byte,
+    int64_t last_byte)
+{
+  _az_PRECONDITION_NOT_NULL(ref_request);
+  _az_PRECONDITION_VALID_SPAN(value_buffer, 0, false);
+  _az_PRECONDITION(first_byte >= 0);
+  _az_PRECONDITION(first_byte <= last_byte);
+
+  az_span const unit = AZ_SPAN_FROM_STR("bytes=");
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(value_buffer, az_span_size(unit) + 1);
+  az_span remainder = az_span_copy(value_buffer, unit);
+  _az_RETURN_IF_FAILED(az_span_i64toa(remainder, first_byte, &remainder));
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remainder, 1);
+  remainder = az_span_copy_u8(remainder, '-');
+  _az_RETURN_IF_FAILED(az_span_i64toa(remainder, last_byte, &remainder));
+
+  return az_http_request_append_header(
+      ref_request,
+      AZ_SPAN_FROM_STR("Range"),
+      az_span_slice(value_buffer, 0, az_span_size(value_buffer) - az_span_size(remainder)));
+}
+
 AZ_NODISCARD az_result az_http_request_get_header(
     az_http_request const* request,
     int32_t index,
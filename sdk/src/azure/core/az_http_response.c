@@ -61,6 +61,8 @@ _az_get_http_status_line(az_span* ref_span, az_http_response_status_line* out_st
 
   // HTTP-version = HTTP-name "/" DIGIT "." DIGIT
   // https://tools.ietf.org/html/rfc7230#section-2.6
+  // HTTP/2 and HTTP/3 have no status line on the wire, and libcurl reports theirs as "HTTP/2" and
+  // "HTTP/3", without a minor version, which is then 0.
   az_span const start = AZ_SPAN_FROM_STR("HTTP/");
   az_span const dot = AZ_SPAN_FROM_STR(".");
   az_span const space = AZ_SPAN_FROM_STR(" ");
@@ -68,8 +70,16 @@ _az_get_http_status_line(az_span* ref_span, az_http_response_status_line* out_st
   // parse and move reader if success
   _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, start));
   _az_RETURN_IF_FAILED(_az_get_digit(ref_span, &out_status_line->major_version));
-  _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, dot));
-  _az_RETURN_IF_FAILED(_az_get_digit(ref_span, &out_status_line->minor_version));
+  if (out_status_line->major_version >= 2 && az_span_size(*ref_span) > 0
+      && az_span_ptr(*ref_span)[0] == ' ')
+  {
+    out_status_line->minor_version = 0;
+  }
+  else
+  {
+    _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, dot));
+    _az_RETURN_IF_FAILED(_az_get_digit(ref_span, &out_status_line->minor_version));
+  }
 
   // SP = " "
   _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, space));
@@ -329,6 +339,81 @@ AZ_NODISCARD az_result az_http_response_get_body(az_http_response* ref_response,
   return AZ_OK;
 }
 
+// Parses a `Content-Range` header value, such as `bytes 0-1023/10000` or `bytes 0-1023/*`.
+static AZ_NODISCARD az_result _az_http_response_parse_content_range(
+    az_span value,
+    az_http_response_content_range* out_content_range)
+{
+  az_span const unit = AZ_SPAN_FROM_STR("bytes ");
+  int32_t const dash = az_span_find(value, AZ_SPAN_FROM_STR("-"));
+  int32_t const slash = az_span_find(value, AZ_SPAN_FROM_STR("/"));
+  if (az_span_size(value) <= az_span_size(unit)
+      || !az_span_is_content_equal_ignoring_case(az_span_slice(value, 0, az_span_size(unit)), unit)
+      || dash <= az_span_size(unit) || slash <= dash + 1 || slash + 1 >= az_span_size(value))
+  {
+    return AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER;
+  }
+
+  az_http_response_content_range range = { 0 };
+  az_span const complete_length = az_span_slice_to_end(value, slash + 1);
+  if (az_result_failed(
+          az_span_atoi64(az_span_slice(value, az_span_size(unit), dash), &range.first_byte))
+      || az_result_failed(az_span_atoi64(az_span_slice(value, dash + 1, slash), &range.last_byte)))
+  {
+    return AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER;
+  }
+
+  if (az_span_is_content_equal(complete_length, AZ_SPAN_FROM_STR("*")))
+  {
+    range.complete_length = -1;
+  }
+  else if (
+      az_result_failed(az_span_atoi64(complete_length, &range.complete_length))
+      || range.last_byte >= range.complete_length)
+  {
+    return AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER;
+  }
+
+  if (range.first_byte < 0 || range.last_byte < range.first_byte)
+  {
+    return AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER;
+  }
+
+  *out_content_range = range;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_http_response_get_content_range(
+    az_http_response* ref_response,
+    az_http_response_content_range* out_content_range)
+{
+  _az_PRECONDITION_NOT_NULL(ref_response);
+  _az_PRECONDITION_NOT_NULL(out_content_range);
+
+  az_http_response_status_line status_line = { 0 };
+  _az_RETURN_IF_FAILED(az_http_response_get_status_line(ref_response, &status_line));
+
+  az_result result = AZ_ERROR_ITEM_NOT_FOUND;
+  while (true)
+  {
+    az_span name = AZ_SPAN_EMPTY;
+    az_span value = AZ_SPAN_EMPTY;
+    az_result const header_result = az_http_response_get_next_header(ref_response, &name, &value);
+    if (header_result == AZ_ERROR_HTTP_END_OF_HEADERS)
+    {
+      break;
+    }
+    _az_RETURN_IF_FAILED(header_result);
+
+    if (az_span_is_content_equal_ignoring_case(name, AZ_SPAN_FROM_STR("Content-Range")))
+    {
+      result = _az_http_response_parse_content_range(value, out_content_range);
+    }
+  }
+
+  return result;
+}
+
 void _az_http_response_reset(az_http_response* ref_response)
 {
   // never fails, discard the result
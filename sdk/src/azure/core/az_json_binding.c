@@ -0,0 +1,637 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_json_private.h"
+#include "az_span_private.h"
+#include <azure/core/az_precondition.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  // The number of bits of the bit mask of the properties read.
+  _az_JSON_BINDING_MAX_PRESENT_FIELDS = 32,
+};
+
+AZ_NODISCARD static az_result _az_json_binding_read_object(
+    az_json_reader* ref_json_reader,
+    az_json_binding const* binding,
+    uint8_t* ref_value,
+    uint32_t* out_present);
+
+// Returns the index of the field of a property name, or -1 if it has none.
+static int32_t _az_json_binding_find_field(
+    az_json_token const* property_name,
+    az_json_binding const* binding,
+    int32_t first_field)
+{
+  az_json_binding_field const* const fields = binding->fields;
+  int32_t const fields_length = binding->fields_length;
+
+  // The slice of a name with escaped characters differs from its text, and a name split across
+  // buffers has no contiguous slice, so such a name is compared with the text of every field.
+  if (property_name->_internal.string_has_escaped_chars || property_name->_internal.is_multisegment)
+  {
+    for (int32_t i = 0; i < fields_length; i++)
+    {
+      if (az_json_token_is_text_equal(property_name, fields[i].key))
+      {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // The size of the key of each field is known up front, so only the fields with a key of the
+  // same size are compared.
+  int32_t const size = az_span_size(property_name->slice);
+  int32_t i = first_field;
+  for (int32_t n = 0; n < fields_length; n++, i++)
+  {
+    if (i == fields_length)
+    {
+      i = 0;
+    }
+
+    if (az_span_size(fields[i].key) == size
+        && az_span_is_content_equal(property_name->slice, fields[i].key))
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+AZ_NODISCARD static size_t _az_json_binding_get_element_size(az_json_binding_field const* field)
+{
+  switch (field->type)
+  {
+    case AZ_JSON_BINDING_BOOLEAN:
+      return sizeof(bool);
+    case AZ_JSON_BINDING_INT32:
+      return sizeof(int32_t);
+    case AZ_JSON_BINDING_UINT32:
+      return sizeof(uint32_t);
+    case AZ_JSON_BINDING_INT64:
+      return sizeof(int64_t);
+    case AZ_JSON_BINDING_UINT64:
+      return sizeof(uint64_t);
+    case AZ_JSON_BINDING_DOUBLE:
+      return sizeof(double);
+    case AZ_JSON_BINDING_OBJECT:
+      return field->binding->size;
+    case AZ_JSON_BINDING_STRING:
+    case AZ_JSON_BINDING_JSON:
+    case AZ_JSON_BINDING_JSON_OBJECT:
+    default:
+      return sizeof(az_span);
+  }
+}
+
+// Returns the result of reading a value that is not of the type of the member of a field.
+AZ_NODISCARD AZ_INLINE az_result _az_json_binding_type_mismatch(az_json_binding_field const* field)
+{
+  return az_result_failed(field->type_mismatch_result) ? field->type_mismatch_result
+                                                       : AZ_ERROR_UNEXPECTED_CHAR;
+}
+
+// Reads the JSON text of an object or array, with the reader on the token that begins it.
+AZ_NODISCARD static az_result
+_az_json_binding_read_json(az_json_reader* ref_json_reader, az_span* out_value)
+{
+  uint8_t* const begin = az_span_ptr(ref_json_reader->token.slice);
+  int32_t const buffer_index = ref_json_reader->_internal.buffer_index;
+
+  _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+
+  if (ref_json_reader->_internal.buffer_index != buffer_index)
+  {
+    return AZ_ERROR_NOT_SUPPORTED;
+  }
+
+  uint8_t* const end = az_span_ptr(ref_json_reader->token.slice) + 1;
+  *out_value = az_span_create(begin, (int32_t)(end - begin));
+
+  return AZ_OK;
+}
+
+// Reads a single value into a member, with the reader on the value.
+AZ_NODISCARD static az_result _az_json_binding_read_value(
+    az_json_reader* ref_json_reader,
+    az_json_binding_field const* field,
+    uint8_t* ref_member)
+{
+  az_json_token const* const token = &ref_json_reader->token;
+
+  // A null value leaves the member as it is, unless the field rejects it.
+  if (token->kind == AZ_JSON_TOKEN_NULL)
+  {
+    return field->rejects_null ? _az_json_binding_type_mismatch(field) : AZ_OK;
+  }
+
+  switch (field->type)
+  {
+    case AZ_JSON_BINDING_STRING:
+      if (token->kind != AZ_JSON_TOKEN_STRING)
+      {
+        return _az_json_binding_type_mismatch(field);
+      }
+      if (token->_internal.is_multisegment)
+      {
+        return AZ_ERROR_NOT_SUPPORTED;
+      }
+      *(az_span*)ref_member = token->slice;
+      return AZ_OK;
+    case AZ_JSON_BINDING_BOOLEAN:
+      if (token->kind != AZ_JSON_TOKEN_TRUE && token->kind != AZ_JSON_TOKEN_FALSE)
+      {
+        return _az_json_binding_type_mismatch(field);
+      }
+      *(bool*)ref_member = token->kind == AZ_JSON_TOKEN_TRUE;
+      return AZ_OK;
+    case AZ_JSON_BINDING_OBJECT:
+      if (token->kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+      {
+        return _az_json_binding_type_mismatch(field);
+      }
+      return _az_json_binding_read_object(ref_json_reader, field->binding, ref_member, NULL);
+    case AZ_JSON_BINDING_JSON:
+    case AZ_JSON_BINDING_JSON_OBJECT:
+      if (token->kind != AZ_JSON_TOKEN_BEGIN_OBJECT
+          && (field->type == AZ_JSON_BINDING_JSON_OBJECT
+              || token->kind != AZ_JSON_TOKEN_BEGIN_ARRAY))
+      {
+        return _az_json_binding_type_mismatch(field);
+      }
+      return _az_json_binding_read_json(ref_json_reader, (az_span*)ref_member);
+    default:
+      break;
+  }
+
+  if (token->kind != AZ_JSON_TOKEN_NUMBER)
+  {
+    return _az_json_binding_type_mismatch(field);
+  }
+
+  switch (field->type)
+  {
+    case AZ_JSON_BINDING_INT32:
+      return az_json_token_get_int32(token, (int32_t*)ref_member);
+    case AZ_JSON_BINDING_UINT32:
+      return az_json_token_get_uint32(token, (uint32_t*)ref_member);
+    case AZ_JSON_BINDING_INT64:
+      return az_json_token_get_int64(token, (int64_t*)ref_member);
+    case AZ_JSON_BINDING_UINT64:
+      return az_json_token_get_uint64(token, (uint64_t*)ref_member);
+    case AZ_JSON_BINDING_DOUBLE:
+      return az_json_token_get_double(token, (double*)ref_member);
+    default:
+      return AZ_ERROR_ARG;
+  }
+}
+
+// Reads the elements of a JSON array into an array member, with the reader on the array.
+AZ_NODISCARD static az_result _az_json_binding_read_array(
+    az_json_reader* ref_json_reader,
+    az_json_binding_field const* field,
+    uint8_t* ref_value)
+{
+  if (ref_json_reader->token.kind == AZ_JSON_TOKEN_NULL)
+  {
+    return field->rejects_null ? _az_json_binding_type_mismatch(field) : AZ_OK;
+  }
+
+  if (ref_json_reader->token.kind != AZ_JSON_TOKEN_BEGIN_ARRAY)
+  {
+    return _az_json_binding_type_mismatch(field);
+  }
+
+  size_t const element_size = _az_json_binding_get_element_size(field);
+  int32_t* const count = (int32_t*)(ref_value + field->array_count_offset);
+  *count = 0;
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_ARRAY)
+  {
+    if (*count == field->array_capacity)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+
+    _az_RETURN_IF_FAILED(_az_json_binding_read_value(
+        ref_json_reader, field, ref_value + field->offset + (size_t)*count * element_size));
+    (*count)++;
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  return AZ_OK;
+}
+
+// Moves the reader to the next property name, or to the end of the object. An error there ends the
+// object for a binding that ends at an invalid property.
+AZ_NODISCARD static az_result _az_json_binding_next_property(
+    az_json_reader* ref_json_reader,
+    az_json_binding const* binding,
+    bool* out_is_end)
+{
+  az_result const result = az_json_reader_next_token(ref_json_reader);
+  if (az_result_failed(result))
+  {
+    *out_is_end = true;
+    return binding->ends_at_invalid_property ? AZ_OK : result;
+  }
+
+  *out_is_end = ref_json_reader->token.kind == AZ_JSON_TOKEN_END_OBJECT;
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result _az_json_binding_read_object(
+    az_json_reader* ref_json_reader,
+    az_json_binding const* binding,
+    uint8_t* ref_value,
+    uint32_t* out_present)
+{
+  if (ref_json_reader->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  // Properties are usually written in the order of the fields, so the search for the field of a
+  // property starts after the field of the previous one.
+  int32_t next_field = 0;
+
+  bool is_end = false;
+  _az_RETURN_IF_FAILED(_az_json_binding_next_property(ref_json_reader, binding, &is_end));
+  while (!is_end)
+  {
+    int32_t const index
+        = _az_json_binding_find_field(&ref_json_reader->token, binding, next_field);
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+    if (index < 0)
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+    }
+    else
+    {
+      az_json_binding_field const* const field = &binding->fields[index];
+      bool const is_null = ref_json_reader->token.kind == AZ_JSON_TOKEN_NULL;
+
+      if (field->array_capacity > 0)
+      {
+        _az_RETURN_IF_FAILED(_az_json_binding_read_array(ref_json_reader, field, ref_value));
+      }
+      else
+      {
+        _az_RETURN_IF_FAILED(
+            _az_json_binding_read_value(ref_json_reader, field, ref_value + field->offset));
+      }
+
+      if (out_present != NULL && !is_null)
+      {
+        *out_present |= 1U << (uint32_t)index;
+      }
+
+      next_field = index + 1;
+    }
+
+    _az_RETURN_IF_FAILED(_az_json_binding_next_property(ref_json_reader, binding, &is_end));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_binding_read(
+    az_json_reader* ref_json_reader,
+    az_json_binding const* binding,
+    void* ref_value,
+    uint32_t* out_present)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION_NOT_NULL(binding);
+  _az_PRECONDITION_NOT_NULL(ref_value);
+  _az_PRECONDITION(
+      out_present == NULL || binding->fields_length <= _az_JSON_BINDING_MAX_PRESENT_FIELDS);
+
+  if (out_present != NULL)
+  {
+    *out_present = 0;
+  }
+
+  if (ref_json_reader->token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  return _az_json_binding_read_object(ref_json_reader, binding, (uint8_t*)ref_value, out_present);
+}
+
+// Writes a number member, and returns the remainder of the destination.
+AZ_NODISCARD static az_result _az_json_binding_write_number(
+    az_span destination,
+    az_json_binding_field const* field,
+    uint8_t const* member,
+    az_span* out_remainder)
+{
+  switch (field->type)
+  {
+    case AZ_JSON_BINDING_INT32:
+      return az_span_i32toa(destination, *(int32_t const*)member, out_remainder);
+    case AZ_JSON_BINDING_UINT32:
+      return az_span_u32toa(destination, *(uint32_t const*)member, out_remainder);
+    case AZ_JSON_BINDING_INT64:
+      return az_span_i64toa(destination, *(int64_t const*)member, out_remainder);
+    case AZ_JSON_BINDING_UINT64:
+      return az_span_u64toa(destination, *(uint64_t const*)member, out_remainder);
+    case AZ_JSON_BINDING_DOUBLE:
+      // Non-finite numbers are not supported because they lead to invalid JSON.
+      _az_PRECONDITION(_az_isfinite(*(double const*)member));
+      _az_PRECONDITION_RANGE(0, field->fractional_digits, _az_MAX_SUPPORTED_FRACTIONAL_DIGITS);
+      return az_span_dtoa(
+          destination, *(double const*)member, field->fractional_digits, out_remainder);
+    default:
+      return AZ_ERROR_ARG;
+  }
+}
+
+// Adds a size to a running total, failing rather than overflowing int32_t.
+AZ_NODISCARD static az_result _az_json_binding_add_size(int32_t* ref_total, int32_t size)
+{
+  if (*ref_total > INT32_MAX - size)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  *ref_total += size;
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result _az_json_binding_get_object_write_size(
+    az_json_binding const* binding,
+    uint8_t const* value,
+    int32_t* out_size);
+
+// Gets the size of the JSON text of a single member.
+AZ_NODISCARD static az_result _az_json_binding_get_value_write_size(
+    az_json_binding_field const* field,
+    uint8_t const* member,
+    int32_t* out_size)
+{
+  switch (field->type)
+  {
+    case AZ_JSON_BINDING_STRING:
+    {
+      az_span const value = *(az_span const*)member;
+      if (az_span_size(value) > _az_MAX_UNESCAPED_STRING_SIZE)
+      {
+        return AZ_ERROR_NOT_ENOUGH_SPACE;
+      }
+
+      int32_t index_of_first_escaped_char = -1;
+      *out_size = 2 + _az_json_writer_escaped_length(value, &index_of_first_escaped_char, false);
+      return AZ_OK;
+    }
+    case AZ_JSON_BINDING_BOOLEAN:
+      *out_size = *(bool const*)member ? (int32_t)sizeof("true") - 1
+                                       : (int32_t)sizeof("false") - 1;
+      return AZ_OK;
+    case AZ_JSON_BINDING_OBJECT:
+      return _az_json_binding_get_object_write_size(field->binding, member, out_size);
+    case AZ_JSON_BINDING_JSON:
+    case AZ_JSON_BINDING_JSON_OBJECT:
+    {
+      // The JSON text of a member is copied as it is, so it must be a single, complete value.
+      az_json_token_kind first_token_kind = AZ_JSON_TOKEN_NONE;
+      az_json_token_kind last_token_kind = AZ_JSON_TOKEN_NONE;
+      _az_RETURN_IF_FAILED(
+          _az_validate_json(*(az_span const*)member, &first_token_kind, &last_token_kind));
+      if (field->type == AZ_JSON_BINDING_JSON_OBJECT
+          && first_token_kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+      {
+        return AZ_ERROR_UNEXPECTED_CHAR;
+      }
+      *out_size = az_span_size(*(az_span const*)member);
+      return AZ_OK;
+    }
+    default:
+    {
+      // Numbers are written into a scratch buffer, so that their size is the one of the text
+      // written later on, whatever the formatting.
+      uint8_t scratch_buffer[_az_MAX_SIZE_FOR_WRITING_DOUBLE];
+      az_span const scratch = AZ_SPAN_FROM_BUFFER(scratch_buffer);
+      az_span remainder = AZ_SPAN_EMPTY;
+      _az_RETURN_IF_FAILED(_az_json_binding_write_number(scratch, field, member, &remainder));
+      *out_size = _az_span_diff(remainder, scratch);
+      return AZ_OK;
+    }
+  }
+}
+
+// Returns whether a field is written, which is not the case of an empty string or JSON text.
+AZ_NODISCARD static bool _az_json_binding_is_written(
+    az_json_binding_field const* field,
+    uint8_t const* value)
+{
+  return field->array_capacity > 0
+      || (field->type != AZ_JSON_BINDING_STRING && field->type != AZ_JSON_BINDING_JSON
+          && field->type != AZ_JSON_BINDING_JSON_OBJECT)
+      || az_span_size(*(az_span const*)(value + field->offset)) > 0;
+}
+
+// Gets the size of the JSON text of the elements of an array member, between brackets.
+AZ_NODISCARD static az_result _az_json_binding_get_array_write_size(
+    az_json_binding_field const* field,
+    uint8_t const* value,
+    int32_t* out_size)
+{
+  size_t const element_size = _az_json_binding_get_element_size(field);
+  int32_t const count = *(int32_t const*)(value + field->array_count_offset);
+  _az_PRECONDITION_RANGE(0, count, field->array_capacity);
+
+  int32_t size = 2; // For the brackets.
+  for (int32_t i = 0; i < count; i++)
+  {
+    int32_t element_write_size = 0;
+    _az_RETURN_IF_FAILED(_az_json_binding_get_value_write_size(
+        field, value + field->offset + (size_t)i * element_size, &element_write_size));
+    _az_RETURN_IF_FAILED(_az_json_binding_add_size(&size, i > 0 ? 1 : 0));
+    _az_RETURN_IF_FAILED(_az_json_binding_add_size(&size, element_write_size));
+  }
+
+  *out_size = size;
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result _az_json_binding_get_object_write_size(
+    az_json_binding const* binding,
+    uint8_t const* value,
+    int32_t* out_size)
+{
+  int32_t size = 2; // For the braces.
+  bool need_comma = false;
+
+  for (int32_t i = 0; i < binding->fields_length; i++)
+  {
+    az_json_binding_field const* const field = &binding->fields[i];
+    if (!_az_json_binding_is_written(field, value))
+    {
+      continue;
+    }
+
+    int32_t value_write_size = 0;
+    if (field->array_capacity > 0)
+    {
+      _az_RETURN_IF_FAILED(_az_json_binding_get_array_write_size(field, value, &value_write_size));
+    }
+    else
+    {
+      _az_RETURN_IF_FAILED(
+          _az_json_binding_get_value_write_size(field, value + field->offset, &value_write_size));
+    }
+
+    // The key is written between quotes and followed by a colon.
+    _az_RETURN_IF_FAILED(_az_json_binding_add_size(&size, need_comma ? 4 : 3));
+    _az_RETURN_IF_FAILED(_az_json_binding_add_size(&size, az_span_size(field->key)));
+    _az_RETURN_IF_FAILED(_az_json_binding_add_size(&size, value_write_size));
+    need_comma = true;
+  }
+
+  *out_size = size;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_binding_get_write_size(
+    az_json_binding const* binding,
+    void const* value,
+    int32_t* out_size)
+{
+  _az_PRECONDITION_NOT_NULL(binding);
+  _az_PRECONDITION_NOT_NULL(value);
+  _az_PRECONDITION_NOT_NULL(out_size);
+
+  return _az_json_binding_get_object_write_size(binding, (uint8_t const*)value, out_size);
+}
+
+static az_span _az_json_binding_write_object(
+    az_span destination,
+    az_json_binding const* binding,
+    uint8_t const* value);
+
+// Writes a single member into a destination its size was computed for, and returns the remainder.
+static az_span _az_json_binding_write_value(
+    az_span destination,
+    az_json_binding_field const* field,
+    uint8_t const* member)
+{
+  switch (field->type)
+  {
+    case AZ_JSON_BINDING_STRING:
+    {
+      az_span const value = *(az_span const*)member;
+      destination = az_span_copy_u8(destination, '"');
+      if (az_span_size(value) > 0)
+      {
+        destination = _az_json_writer_escape_and_copy(destination, value);
+      }
+      return az_span_copy_u8(destination, '"');
+    }
+    case AZ_JSON_BINDING_BOOLEAN:
+      return az_span_copy(
+          destination,
+          *(bool const*)member ? AZ_SPAN_FROM_STR("true") : AZ_SPAN_FROM_STR("false"));
+    case AZ_JSON_BINDING_OBJECT:
+      return _az_json_binding_write_object(destination, field->binding, member);
+    case AZ_JSON_BINDING_JSON:
+    case AZ_JSON_BINDING_JSON_OBJECT:
+      return az_span_copy(destination, *(az_span const*)member);
+    default:
+    {
+      // The size pass already wrote this number, so this cannot fail.
+      az_span remainder = destination;
+      az_result const result
+          = _az_json_binding_write_number(destination, field, member, &remainder);
+      _az_PRECONDITION(az_result_succeeded(result));
+      (void)result;
+      return remainder;
+    }
+  }
+}
+
+static az_span _az_json_binding_write_object(
+    az_span destination,
+    az_json_binding const* binding,
+    uint8_t const* value)
+{
+  destination = az_span_copy_u8(destination, '{');
+
+  bool need_comma = false;
+  for (int32_t i = 0; i < binding->fields_length; i++)
+  {
+    az_json_binding_field const* const field = &binding->fields[i];
+    if (!_az_json_binding_is_written(field, value))
+    {
+      continue;
+    }
+
+    if (need_comma)
+    {
+      destination = az_span_copy_u8(destination, ',');
+    }
+    need_comma = true;
+
+    destination = az_span_copy_u8(destination, '"');
+    destination = az_span_copy(destination, field->key);
+    destination = az_span_copy(destination, AZ_SPAN_FROM_STR("\":"));
+
+    if (field->array_capacity > 0)
+    {
+      size_t const element_size = _az_json_binding_get_element_size(field);
+      int32_t const count = *(int32_t const*)(value + field->array_count_offset);
+
+      destination = az_span_copy_u8(destination, '[');
+      for (int32_t j = 0; j < count; j++)
+      {
+        if (j > 0)
+        {
+          destination = az_span_copy_u8(destination, ',');
+        }
+        destination = _az_json_binding_write_value(
+            destination, field, value + field->offset + (size_t)j * element_size);
+      }
+      destination = az_span_copy_u8(destination, ']');
+    }
+    else
+    {
+      destination = _az_json_binding_write_value(destination, field, value + field->offset);
+    }
+  }
+
+  return az_span_copy_u8(destination, '}');
+}
+
+AZ_NODISCARD az_result az_json_binding_write(
+    az_json_writer* ref_json_writer,
+    az_json_binding const* binding,
+    void const* value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_NOT_NULL(binding);
+  _az_PRECONDITION_NOT_NULL(value);
+
+  int32_t size = 0;
+  _az_RETURN_IF_FAILED(
+      _az_json_binding_get_object_write_size(binding, (uint8_t const*)value, &size));
+
+  az_span destination = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_json_writer_append_value_of_size(
+      ref_json_writer, size, AZ_JSON_TOKEN_END_OBJECT, &destination));
+
+  _az_json_binding_write_object(destination, binding, (uint8_t const*)value);
+
+  return AZ_OK;
+}
@@ -138,6 +138,35 @@ AZ_NODISCARD AZ_INLINE bool _az_is_valid_escaped_character(uint8_t byte)
   }
 }
 
+// Returns the length of the JSON string within the az_span after it has been escaped.
+// The out parameter contains the index where the first character to escape is found.
+// If no chars need to be escaped then return the size of value with the out parameter set to -1.
+// If break_on_first_escaped is set to true, then it returns as soon as the first character to
+// escape is found.
+int32_t _az_json_writer_escaped_length(
+    az_span value,
+    int32_t* out_index_of_first_escaped_char,
+    bool break_on_first_escaped);
+
+// Copies the source into the destination, escaping the characters that need to be, and returns
+// the remainder of the destination.
+AZ_NODISCARD az_span _az_json_writer_escape_and_copy(az_span destination, az_span source);
+
+// Checks that the JSON text is a single, complete JSON value, and returns the kinds of its first
+// and last tokens.
+AZ_NODISCARD az_result _az_validate_json(
+    az_span json_text,
+    az_json_token_kind* first_token_kind,
+    az_json_token_kind* last_token_kind);
+
+// Appends a value whose JSON text has the given size, and returns the span of that size, in the
+// destination of the writer, for the caller to write the text into.
+AZ_NODISCARD az_result _az_json_writer_append_value_of_size(
+    az_json_writer* ref_json_writer,
+    int32_t size,
+    az_json_token_kind kind,
+    az_span* out_value);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_SPAN_PRIVATE_H
@@ -0,0 +1,180 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_json_private.h"
+#include <azure/core/az_precondition.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  // The number of bits of the bit mask of the paths found.
+  _az_JSON_QUERY_MAX_PATHS = 32,
+};
+
+// Returns the property name of a path at a depth, where the root object is at depth 0, and whether
+// it is the last one of the path.
+static az_span _az_json_query_get_segment(az_span path, int32_t depth, bool* out_is_last)
+{
+  uint8_t const* const path_ptr = az_span_ptr(path);
+  int32_t const path_size = az_span_size(path);
+
+  int32_t begin = 0;
+  for (int32_t i = 0; i < path_size && depth > 0; i++)
+  {
+    if (path_ptr[i] == '.')
+    {
+      begin = i + 1;
+      depth--;
+    }
+  }
+
+  int32_t end = begin;
+  while (end < path_size && path_ptr[end] != '.')
+  {
+    end++;
+  }
+
+  *out_is_last = end == path_size;
+
+  az_span const segment = az_span_slice(path, begin, end);
+  _az_PRECONDITION(az_span_size(segment) > 0);
+  return segment;
+}
+
+// Returns the bit mask of all the paths.
+AZ_NODISCARD static uint32_t _az_json_query_get_all_paths(int32_t paths_length)
+{
+  return paths_length == _az_JSON_QUERY_MAX_PATHS ? UINT32_MAX
+                                                  : (1U << (uint32_t)paths_length) - 1U;
+}
+
+// Reads an object, with the reader on the token that begins it, and the paths that lead to its
+// properties in a bit mask.
+AZ_NODISCARD static az_result _az_json_query_read_object(
+    az_json_reader* ref_json_reader,
+    az_span const* paths,
+    int32_t paths_length,
+    int32_t depth,
+    uint32_t live_paths,
+    az_json_token* out_values,
+    uint32_t* ref_found)
+{
+  uint32_t const all_paths = _az_json_query_get_all_paths(paths_length);
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    // The paths found elsewhere since this object began are no longer searched for.
+    live_paths &= ~*ref_found;
+
+    uint32_t ending_paths = 0;
+    uint32_t continuing_paths = 0;
+    for (int32_t i = 0; i < paths_length; i++)
+    {
+      uint32_t const path_bit = 1U << (uint32_t)i;
+      if ((live_paths & path_bit) == 0)
+      {
+        continue;
+      }
+
+      bool is_last = false;
+      az_span const segment = _az_json_query_get_segment(paths[i], depth, &is_last);
+      if (az_json_token_is_text_equal(&ref_json_reader->token, segment))
+      {
+        if (is_last)
+        {
+          ending_paths |= path_bit;
+        }
+        else
+        {
+          continuing_paths |= path_bit;
+        }
+      }
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+    for (int32_t i = 0; i < paths_length && ending_paths != 0; i++)
+    {
+      if ((ending_paths & (1U << (uint32_t)i)) != 0)
+      {
+        out_values[i] = ref_json_reader->token;
+      }
+    }
+    *ref_found |= ending_paths;
+
+    if (continuing_paths != 0 && ref_json_reader->token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT)
+    {
+      _az_RETURN_IF_FAILED(_az_json_query_read_object(
+          ref_json_reader,
+          paths,
+          paths_length,
+          depth + 1,
+          continuing_paths,
+          out_values,
+          ref_found));
+    }
+    else
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+    }
+
+    if (*ref_found == all_paths)
+    {
+      return AZ_OK;
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_query_read(
+    az_json_reader* ref_json_reader,
+    az_span const* paths,
+    int32_t paths_length,
+    az_json_token* out_values,
+    uint32_t* out_found)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION_NOT_NULL(paths);
+  _az_PRECONDITION_RANGE(1, paths_length, _az_JSON_QUERY_MAX_PATHS);
+  _az_PRECONDITION_NOT_NULL(out_values);
+
+  for (int32_t i = 0; i < paths_length; i++)
+  {
+    out_values[i] = (az_json_token){ 0 };
+  }
+
+  uint32_t found = 0;
+  if (out_found != NULL)
+  {
+    *out_found = 0;
+  }
+
+  if (ref_json_reader->token.kind == AZ_JSON_TOKEN_NONE)
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  if (ref_json_reader->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  uint32_t const all_paths = _az_json_query_get_all_paths(paths_length);
+
+  az_result const result = _az_json_query_read_object(
+      ref_json_reader, paths, paths_length, 0, all_paths, out_values, &found);
+
+  // The paths found before an error are recorded as well.
+  if (out_found != NULL)
+  {
+    *out_found = found;
+  }
+
+  return result;
+}
@@ -26,6 +26,7 @@ AZ_NODISCARD az_result az_json_reader_init(
       ._internal = {
         .is_multisegment = false,
         .string_has_escaped_chars = false,
+        .string_is_double_escaped = false,
         .pointer_to_first_buffer = &AZ_SPAN_EMPTY,
         .start_buffer_index = -1,
         .start_buffer_offset = -1,
@@ -43,6 +44,8 @@ AZ_NODISCARD az_result az_json_reader_init(
       .total_bytes_consumed = 0,
       .is_complex_json = false,
       .bit_stack = { 0 },
+      .is_escaped_json = false,
+      .end_buffer_offset = -1,
       .options = options == NULL ? az_json_reader_options_default() : *options,
     },
   };
@@ -67,6 +70,7 @@ AZ_NODISCARD az_result az_json_reader_chunked_init(
       ._internal = {
         .is_multisegment = false,
         .string_has_escaped_chars = false,
+        .string_is_double_escaped = false,
         .pointer_to_first_buffer = json_buffers,
         .start_buffer_index = -1,
         .start_buffer_offset = -1,
@@ -84,12 +88,59 @@ AZ_NODISCARD az_result az_json_reader_chunked_init(
       .total_bytes_consumed = 0,
       .is_complex_json = false,
       .bit_stack = { 0 },
+      .is_escaped_json = false,
+      .end_buffer_offset = -1,
       .options = options == NULL ? az_json_reader_options_default() : *options,
     },
   };
   return AZ_OK;
 }
 
+AZ_NODISCARD az_result az_json_reader_init_escaped(
+    az_json_reader* out_json_reader,
+    az_span json_string,
+    az_json_reader_options const* options)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_init(out_json_reader, json_string, options));
+
+  out_json_reader->_internal.is_escaped_json = true;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_reader_init_from_string_token(
+    az_json_reader* out_json_reader,
+    az_json_token const* json_token,
+    az_json_reader_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(json_token);
+  _az_PRECONDITION(json_token->kind == AZ_JSON_TOKEN_STRING);
+
+  // Contiguous token
+  if (!json_token->_internal.is_multisegment)
+  {
+    return az_json_reader_init_escaped(out_json_reader, json_token->slice, options);
+  }
+
+  // Token straddles more than one segment, so read the segments it spans, starting and ending where
+  // the token does.
+  int32_t const end_index = json_token->_internal.end_buffer_index;
+  int32_t const end_offset = json_token->_internal.end_buffer_offset;
+
+  _az_RETURN_IF_FAILED(az_json_reader_chunked_init(
+      out_json_reader,
+      json_token->_internal.pointer_to_first_buffer,
+      end_offset == 0 ? end_index : end_index + 1,
+      options));
+
+  out_json_reader->_internal.is_escaped_json = true;
+  out_json_reader->_internal.end_buffer_offset = end_offset == 0 ? -1 : end_offset;
+  out_json_reader->_internal.buffer_index = json_token->_internal.start_buffer_index;
+  out_json_reader->_internal.json_buffer
+      = json_token->_internal.pointer_to_first_buffer[json_token->_internal.start_buffer_index];
+  out_json_reader->_internal.bytes_consumed = json_token->_internal.start_buffer_offset;
+  return AZ_OK;
+}
+
 AZ_NODISCARD static az_span _get_remaining_json(az_json_reader* json_reader)
 {
   _az_PRECONDITION_NOT_NULL(json_reader);
@@ -160,6 +211,14 @@ AZ_NODISCARD static az_result _az_json_reader_get_next_buffer(
   ref_json_reader->_internal.json_buffer
       = ref_json_reader->_internal.json_buffers[ref_json_reader->_internal.buffer_index];
 
+  // The JSON text embedded within a string token can end before the last buffer segment does.
+  if (ref_json_reader->_internal.buffer_index == ref_json_reader->_internal.number_of_buffers - 1
+      && ref_json_reader->_internal.end_buffer_offset != -1)
+  {
+    ref_json_reader->_internal.json_buffer = az_span_slice(
+        ref_json_reader->_internal.json_buffer, 0, ref_json_reader->_internal.end_buffer_offset);
+  }
+
   ref_json_reader->_internal.bytes_consumed = 0;
 
   az_span place_holder = _get_remaining_json(ref_json_reader);
@@ -174,6 +233,43 @@ AZ_NODISCARD static az_result _az_json_reader_get_next_buffer(
   return AZ_OK;
 }
 
+// In escaped JSON mode, returns the byte following the backslash at the start of the remaining
+// JSON text, which may be at the start of the next buffer segment, or 0 if there isn't any.
+AZ_NODISCARD static uint8_t
+_az_json_reader_peek_escaped_byte(az_json_reader const* json_reader, az_span json)
+{
+  if (az_span_size(json) >= 2)
+  {
+    return az_span_ptr(json)[1];
+  }
+
+  int32_t const next_index = json_reader->_internal.buffer_index + 1;
+  if (next_index < json_reader->_internal.number_of_buffers
+      && az_span_size(json_reader->_internal.json_buffers[next_index]) >= 1)
+  {
+    return az_span_ptr(json_reader->_internal.json_buffers[next_index])[0];
+  }
+
+  return 0;
+}
+
+// Moves past a two byte escape sequence, which may be split across buffer segments.
+AZ_NODISCARD static az_result _az_json_reader_skip_escape_sequence(az_json_reader* ref_json_reader)
+{
+  az_span remaining = _get_remaining_json(ref_json_reader);
+  ref_json_reader->_internal.total_bytes_consumed += 2;
+
+  if (az_span_size(remaining) >= 2)
+  {
+    ref_json_reader->_internal.bytes_consumed += 2;
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_FAILED(_az_json_reader_get_next_buffer(ref_json_reader, &remaining, true));
+  ref_json_reader->_internal.bytes_consumed = 1;
+  return AZ_OK;
+}
+
 AZ_NODISCARD static az_span _az_json_reader_skip_whitespace(az_json_reader* ref_json_reader)
 {
   az_span json;
@@ -189,8 +285,23 @@ AZ_NODISCARD static az_span _az_json_reader_skip_whitespace(az_json_reader* ref_
     ref_json_reader->_internal.bytes_consumed += consumed;
     ref_json_reader->_internal.total_bytes_consumed += consumed;
 
-    if (az_span_size(json) >= 1
-        || az_result_failed(_az_json_reader_get_next_buffer(ref_json_reader, &remaining, true)))
+    if (az_span_size(json) >= 1)
+    {
+      // In escaped JSON mode, the newlines and tabs between tokens are escaped.
+      if (!ref_json_reader->_internal.is_escaped_json || az_span_ptr(json)[0] != '\\')
+      {
+        break;
+      }
+
+      uint8_t const escaped_byte = _az_json_reader_peek_escaped_byte(ref_json_reader, json);
+      if ((escaped_byte != 'n' && escaped_byte != 'r' && escaped_byte != 't')
+          || az_result_failed(_az_json_reader_skip_escape_sequence(ref_json_reader)))
+      {
+        break;
+      }
+      remaining = _get_remaining_json(ref_json_reader);
+    }
+    else if (az_result_failed(_az_json_reader_get_next_buffer(ref_json_reader, &remaining, true)))
     {
       break;
     }
@@ -199,6 +310,25 @@ AZ_NODISCARD static az_span _az_json_reader_skip_whitespace(az_json_reader* ref_
   return json;
 }
 
+// In escaped JSON mode, strings start with an escaped quote, and no other escape sequence can start
+// a token. Replaces the backslash starting such a string with the quote.
+AZ_NODISCARD static az_result _az_json_reader_unescape_first_byte(
+    az_json_reader const* json_reader,
+    az_span json,
+    uint8_t* ref_first_byte)
+{
+  if (json_reader->_internal.is_escaped_json && *ref_first_byte == '\\')
+  {
+    if (_az_json_reader_peek_escaped_byte(json_reader, json) != '"')
+    {
+      return AZ_ERROR_UNEXPECTED_CHAR;
+    }
+    *ref_first_byte = '"';
+  }
+
+  return AZ_OK;
+}
+
 AZ_NODISCARD static az_result _az_json_reader_process_container_end(
     az_json_reader* ref_json_reader,
     az_json_token_kind token_kind)
@@ -237,8 +367,193 @@ AZ_NODISCARD static az_result _az_json_reader_process_container_start(
   return AZ_OK;
 }
 
+// Moves to the next byte of the string being processed, continuing into the next buffer segment if
+// needed.
+AZ_NODISCARD static az_result _az_json_reader_next_string_byte(
+    az_json_reader* ref_json_reader,
+    az_span* ref_token,
+    int32_t* ref_current_index,
+    int32_t* ref_string_length,
+    uint8_t* out_byte)
+{
+  (*ref_current_index)++;
+  (*ref_string_length)++;
+
+  if (*ref_current_index >= az_span_size(*ref_token))
+  {
+    _az_RETURN_IF_FAILED(_az_json_reader_get_next_buffer(ref_json_reader, ref_token, false));
+    *ref_current_index = 0;
+  }
+
+  *out_byte = az_span_ptr(*ref_token)[*ref_current_index];
+  return AZ_OK;
+}
+
+// Moves past the 4 hex digits following an escaped 'u', and gets the code point they encode.
+AZ_NODISCARD static az_result _az_json_reader_next_string_code_point(
+    az_json_reader* ref_json_reader,
+    az_span* ref_token,
+    int32_t* ref_current_index,
+    int32_t* ref_string_length,
+    uint32_t* out_code_point)
+{
+  uint32_t code_point = 0;
+  for (int32_t i = 0; i < 4; i++)
+  {
+    uint8_t next_byte = 0;
+    _az_RETURN_IF_FAILED(_az_json_reader_next_string_byte(
+        ref_json_reader, ref_token, ref_current_index, ref_string_length, &next_byte));
+
+    if (!isxdigit(next_byte))
+    {
+      return AZ_ERROR_UNEXPECTED_CHAR;
+    }
+
+    code_point = (code_point << 4U)
+        | (uint32_t)(isdigit(next_byte) ? next_byte - '0' : tolower(next_byte) - 'a' + 10);
+  }
+
+  *out_code_point = code_point;
+  return AZ_OK;
+}
+
+// In escaped JSON mode, strings are delimited by escaped quotes, and the escape sequences within
+// them are escaped once more. For example, the string "a\"b" is embedded as \"a\\\"b\". The token
+// slice is the escaped text between the delimiters.
+AZ_NODISCARD static az_result _az_json_reader_process_escaped_string(
+    az_json_reader* ref_json_reader)
+{
+  // Move past the first '\"' escape sequence
+  _az_RETURN_IF_FAILED(_az_json_reader_skip_escape_sequence(ref_json_reader));
+
+  az_span token = _get_remaining_json(ref_json_reader);
+
+  if (az_span_size(token) < 1)
+  {
+    _az_RETURN_IF_FAILED(_az_json_reader_get_next_buffer(ref_json_reader, &token, false));
+  }
+
+  int32_t current_index = 0;
+  int32_t string_length = 0;
+  uint8_t next_byte = az_span_ptr(token)[0];
+
+  // Where the last backslash was found. The string ends there if it starts the closing '\"', which
+  // may be split across buffer segments.
+  az_span end_token = AZ_SPAN_EMPTY;
+  int32_t end_index = 0;
+  int32_t end_buffer_index = 0;
+  int32_t end_buffer_offset = 0;
+  int32_t end_string_length = 0;
+
+  // Clear the state of any previous string token.
+  ref_json_reader->token._internal.string_has_escaped_chars = false;
+  ref_json_reader->token._internal.string_is_double_escaped = true;
+
+  while (true)
+  {
+    if (next_byte == '\\')
+    {
+      end_token = token;
+      end_index = current_index;
+      end_buffer_index = ref_json_reader->_internal.buffer_index;
+      end_buffer_offset
+          = _az_span_diff(token, ref_json_reader->_internal.json_buffer) + current_index;
+      end_string_length = string_length;
+
+      _az_RETURN_IF_FAILED(_az_json_reader_next_string_byte(
+          ref_json_reader, &token, &current_index, &string_length, &next_byte));
+
+      if (next_byte == '"')
+      {
+        break;
+      }
+
+      ref_json_reader->token._internal.string_has_escaped_chars = true;
+      uint32_t code_point = 0;
+
+      if (next_byte == '\\')
+      {
+        // An escape sequence of the string, whose escaped character may itself be escaped.
+        _az_RETURN_IF_FAILED(_az_json_reader_next_string_byte(
+            ref_json_reader, &token, &current_index, &string_length, &next_byte));
+
+        if (next_byte == '\\')
+        {
+          _az_RETURN_IF_FAILED(_az_json_reader_next_string_byte(
+              ref_json_reader, &token, &current_index, &string_length, &next_byte));
+
+          if (next_byte != '"' && next_byte != '\\' && next_byte != '/')
+          {
+            return AZ_ERROR_UNEXPECTED_CHAR;
+          }
+        }
+        else if (next_byte == 'u')
+        {
+          _az_RETURN_IF_FAILED(_az_json_reader_next_string_code_point(
+              ref_json_reader, &token, &current_index, &string_length, &code_point));
+        }
+        else if (next_byte == '"' || !_az_is_valid_escaped_character(next_byte))
+        {
+          return AZ_ERROR_UNEXPECTED_CHAR;
+        }
+      }
+      else if (next_byte == 'u')
+      {
+        // A character of the string that is only escaped in the embedding string. It must not be a
+        // quote, a backslash, or a control character, which the string itself must escape.
+        _az_RETURN_IF_FAILED(_az_json_reader_next_string_code_point(
+            ref_json_reader, &token, &current_index, &string_length, &code_point));
+
+        if (code_point < _az_ASCII_SPACE_CHARACTER || code_point == '"' || code_point == '\\')
+        {
+          return AZ_ERROR_UNEXPECTED_CHAR;
+        }
+      }
+      else if (next_byte != '/')
+      {
+        // Any other escaped character is a control character, which the string itself must escape.
+        return AZ_ERROR_UNEXPECTED_CHAR;
+      }
+    }
+    else if (next_byte < _az_ASCII_SPACE_CHARACTER || next_byte == '"')
+    {
+      // Control characters and quotes are invalid within the embedding JSON string.
+      return AZ_ERROR_UNEXPECTED_CHAR;
+    }
+
+    _az_RETURN_IF_FAILED(_az_json_reader_next_string_byte(
+        ref_json_reader, &token, &current_index, &string_length, &next_byte));
+  }
+
+  _az_json_reader_update_state(
+      ref_json_reader,
+      AZ_JSON_TOKEN_STRING,
+      az_span_slice(end_token, 0, end_index),
+      current_index,
+      end_string_length);
+
+  // The string ends before the closing '\"', even if the '"' is in the next buffer segment.
+  int32_t const start_buffer_index = ref_json_reader->token._internal.start_buffer_index;
+  ref_json_reader->token._internal.end_buffer_index = end_buffer_index;
+  ref_json_reader->token._internal.end_buffer_offset = end_buffer_offset;
+  ref_json_reader->token._internal.is_multisegment
+      = start_buffer_index != -1 && start_buffer_index < end_buffer_index;
+
+  // Add 1 to number of bytes consumed to account for the last '"' character, and 2 to the total to
+  // account for the last '\"' escape sequence.
+  ref_json_reader->_internal.bytes_consumed++;
+  ref_json_reader->_internal.total_bytes_consumed += 2;
+
+  return AZ_OK;
+}
+
 AZ_NODISCARD static az_result _az_json_reader_process_string(az_json_reader* ref_json_reader)
 {
+  if (ref_json_reader->_internal.is_escaped_json)
+  {
+    return _az_json_reader_process_escaped_string(ref_json_reader);
+  }
+
   // Move past the first '"' character
   ref_json_reader->_internal.bytes_consumed++;
 
@@ -386,7 +701,17 @@ AZ_NODISCARD static az_result _az_json_reader_process_property_name(az_json_read
 // Whitespace characters, comma, or a container end character indicate the end of a JSON number.
 static const az_span json_delimiters = AZ_SPAN_LITERAL_FROM_STR(",}] \n\r\t");
 
+// In escaped JSON mode, a backslash starting an escaped whitespace character also indicates the end
+// of a JSON number.
+static const az_span escaped_json_delimiters = AZ_SPAN_LITERAL_FROM_STR(",}] \n\r\t\\");
+
+AZ_NODISCARD static az_span _az_json_reader_get_delimiters(az_json_reader const* json_reader)
+{
+  return json_reader->_internal.is_escaped_json ? escaped_json_delimiters : json_delimiters;
+}
+
 AZ_NODISCARD static bool _az_finished_consuming_json_number(
+    az_span delimiters,
     uint8_t next_byte,
     az_span expected_next_bytes,
     az_result* out_result)
@@ -394,7 +719,7 @@ AZ_NODISCARD static bool _az_finished_consuming_json_number(
   az_span next_byte_span = az_span_create(&next_byte, 1);
 
   // Checking if we are done processing a JSON number
-  int32_t index = az_span_find(json_delimiters, next_byte_span);
+  int32_t index = az_span_find(delimiters, next_byte_span);
   if (index != -1)
   {
     *out_result = AZ_OK;
@@ -537,7 +862,11 @@ AZ_NODISCARD static az_result _az_json_reader_process_number(az_json_reader* ref
 
     next_byte = az_span_ptr(token)[current_consumed];
     az_result result = AZ_OK;
-    if (_az_finished_consuming_json_number(next_byte, AZ_SPAN_FROM_STR(".eE"), &result))
+    if (_az_finished_consuming_json_number(
+            _az_json_reader_get_delimiters(ref_json_reader),
+            next_byte,
+            AZ_SPAN_FROM_STR(".eE"),
+            &result))
     {
       if (az_result_succeeded(result))
       {
@@ -576,7 +905,11 @@ AZ_NODISCARD static az_result _az_json_reader_process_number(az_json_reader* ref
 
     next_byte = az_span_ptr(token)[current_consumed];
     az_result result = AZ_OK;
-    if (_az_finished_consuming_json_number(next_byte, AZ_SPAN_FROM_STR(".eE"), &result))
+    if (_az_finished_consuming_json_number(
+            _az_json_reader_get_delimiters(ref_json_reader),
+            next_byte,
+            AZ_SPAN_FROM_STR(".eE"),
+            &result))
     {
       if (az_result_succeeded(result))
       {
@@ -621,7 +954,11 @@ AZ_NODISCARD static az_result _az_json_reader_process_number(az_json_reader* ref
 
     next_byte = az_span_ptr(token)[current_consumed];
     az_result result = AZ_OK;
-    if (_az_finished_consuming_json_number(next_byte, AZ_SPAN_FROM_STR("eE"), &result))
+    if (_az_finished_consuming_json_number(
+            _az_json_reader_get_delimiters(ref_json_reader),
+            next_byte,
+            AZ_SPAN_FROM_STR("eE"),
+            &result))
     {
       if (az_result_succeeded(result))
       {
@@ -680,7 +1017,8 @@ AZ_NODISCARD static az_result _az_json_reader_process_number(az_json_reader* ref
 
   // Checking if we are done processing a JSON number
   next_byte = az_span_ptr(token)[current_consumed];
-  int32_t index = az_span_find(json_delimiters, az_span_create(&next_byte, 1));
+  int32_t index = az_span_find(
+      _az_json_reader_get_delimiters(ref_json_reader), az_span_create(&next_byte, 1));
   if (index == -1)
   {
     return AZ_ERROR_UNEXPECTED_CHAR;
@@ -843,6 +1181,7 @@ AZ_NODISCARD static az_result _az_json_reader_process_next_byte(
     }
 
     next_byte = az_span_ptr(json)[0];
+    _az_RETURN_IF_FAILED(_az_json_reader_unescape_first_byte(ref_json_reader, json, &next_byte));
 
     if (within_object)
     {
@@ -896,7 +1235,8 @@ AZ_NODISCARD az_result az_json_reader_next_token(az_json_reader* ref_json_reader
   ref_json_reader->token._internal.end_buffer_index = -1;
   ref_json_reader->token._internal.end_buffer_offset = -1;
 
-  uint8_t const first_byte = az_span_ptr(json)[0];
+  uint8_t first_byte = az_span_ptr(json)[0];
+  _az_RETURN_IF_FAILED(_az_json_reader_unescape_first_byte(ref_json_reader, json, &first_byte));
 
   switch (ref_json_reader->token.kind)
   {
@@ -8,6 +8,9 @@
 #include "az_json_private.h"
 
 #include "az_span_private.h"
+
+#include <ctype.h>
+
 #include <azure/core/_az_cfg.h>
 
 static az_span _az_json_token_copy_into_span_helper(
@@ -83,6 +86,154 @@ AZ_NODISCARD static uint8_t _az_json_unescape_single_byte(uint8_t ch)
   }
 }
 
+// Reads a string token read in escaped JSON mode one unescaped byte at a time, undoing both levels
+// of escaping, across the buffer segments it straddles.
+typedef struct
+{
+  az_json_token const* token;
+  az_span remaining;
+  int32_t buffer_index;
+} _az_json_double_escaped_string;
+
+static _az_json_double_escaped_string
+_az_json_double_escaped_string_create(az_json_token const* json_token)
+{
+  _az_json_double_escaped_string string = {
+    .token = json_token,
+    .remaining = json_token->slice,
+    .buffer_index = json_token->_internal.start_buffer_index,
+  };
+
+  if (json_token->_internal.is_multisegment)
+  {
+    string.remaining = az_span_slice_to_end(
+        json_token->_internal.pointer_to_first_buffer[string.buffer_index],
+        json_token->_internal.start_buffer_offset);
+  }
+
+  return string;
+}
+
+static bool _az_json_double_escaped_string_next_raw(
+    _az_json_double_escaped_string* ref_string,
+    uint8_t* out_byte)
+{
+  az_json_token const* const token = ref_string->token;
+  while (az_span_size(ref_string->remaining) < 1)
+  {
+    if (!token->_internal.is_multisegment
+        || ref_string->buffer_index >= token->_internal.end_buffer_index)
+    {
+      return false;
+    }
+
+    ref_string->buffer_index++;
+    ref_string->remaining = token->_internal.pointer_to_first_buffer[ref_string->buffer_index];
+    if (ref_string->buffer_index == token->_internal.end_buffer_index)
+    {
+      ref_string->remaining
+          = az_span_slice(ref_string->remaining, 0, token->_internal.end_buffer_offset);
+    }
+  }
+
+  *out_byte = az_span_ptr(ref_string->remaining)[0];
+  ref_string->remaining = az_span_slice_to_end(ref_string->remaining, 1);
+  return true;
+}
+
+// Undoes the escaping of the embedding JSON string only.
+AZ_NODISCARD static az_result _az_json_double_escaped_string_next_escaped(
+    _az_json_double_escaped_string* ref_string,
+    uint8_t* out_byte,
+    bool* out_done)
+{
+  uint8_t token_byte = 0;
+  *out_done = !_az_json_double_escaped_string_next_raw(ref_string, &token_byte);
+  if (*out_done || token_byte != '\\')
+  {
+    *out_byte = token_byte;
+    return AZ_OK;
+  }
+
+  // The reader has already validated the escape sequences.
+  (void)_az_json_double_escaped_string_next_raw(ref_string, &token_byte);
+  if (token_byte != 'u')
+  {
+    *out_byte = _az_json_unescape_single_byte(token_byte);
+    return AZ_OK;
+  }
+
+  uint32_t code_point = 0;
+  for (int32_t i = 0; i < 4; i++)
+  {
+    (void)_az_json_double_escaped_string_next_raw(ref_string, &token_byte);
+    code_point = (code_point << 4U)
+        | (uint32_t)(isdigit(token_byte) ? token_byte - '0' : tolower(token_byte) - 'a' + 10);
+  }
+
+  // TODO: Characters escaped in the form of \uXXXX where XXXX is the UTF-16 code point, is
+  // not currently supported beyond ASCII.
+  if (code_point > 0x7F)
+  {
+    return AZ_ERROR_NOT_IMPLEMENTED;
+  }
+
+  *out_byte = (uint8_t)code_point;
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result _az_json_double_escaped_string_next(
+    _az_json_double_escaped_string* ref_string,
+    uint8_t* out_byte,
+    bool* out_done)
+{
+  uint8_t token_byte = 0;
+  _az_RETURN_IF_FAILED(
+      _az_json_double_escaped_string_next_escaped(ref_string, &token_byte, out_done));
+  if (*out_done || token_byte != '\\')
+  {
+    *out_byte = token_byte;
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_FAILED(
+      _az_json_double_escaped_string_next_escaped(ref_string, &token_byte, out_done));
+
+  // TODO: Characters escaped in the form of \uXXXX where XXXX is the UTF-16 code point, is
+  // not currently supported.
+  if (token_byte == 'u')
+  {
+    return AZ_ERROR_NOT_IMPLEMENTED;
+  }
+
+  *out_byte = _az_json_unescape_single_byte(token_byte);
+  return AZ_OK;
+}
+
+AZ_NODISCARD static bool _az_json_token_is_double_escaped_text_equal(
+    az_json_token const* json_token,
+    az_span expected_text)
+{
+  _az_json_double_escaped_string string = _az_json_double_escaped_string_create(json_token);
+  uint8_t token_byte = 0;
+  bool done = false;
+
+  int32_t const expected_size = az_span_size(expected_text);
+  uint8_t const* const expected_ptr = az_span_ptr(expected_text);
+  for (int32_t i = 0; i < expected_size; i++)
+  {
+    if (az_result_failed(_az_json_double_escaped_string_next(&string, &token_byte, &done)) || done
+        || token_byte != expected_ptr[i])
+    {
+      return false;
+    }
+  }
+
+  // Only return true if the size of the unescaped token matches the expected size exactly.
+  return az_result_succeeded(_az_json_double_escaped_string_next(&string, &token_byte, &done))
+      && done;
+}
+
 AZ_NODISCARD static bool _az_json_token_is_text_equal_helper(
     az_span token_slice,
     az_span* expected_text,
@@ -201,6 +352,12 @@ AZ_NODISCARD bool az_json_token_is_text_equal(
   int32_t token_size = json_token->size;
   int32_t expected_size = az_span_size(expected_text);
 
+  if (json_token->_internal.string_is_double_escaped)
+  {
+    return token_size >= expected_size
+        && _az_json_token_is_double_escaped_text_equal(json_token, expected_text);
+  }
+
   // No need to try to unescape the token slice, since the lengths won't match anyway.
   // Unescaping always shrinks the string, at most by a factor of 6.
   if (token_size < expected_size
@@ -438,9 +595,29 @@ AZ_NODISCARD az_result az_json_token_get_string(
   int32_t dest_idx = 0;
   bool next_char_escaped = false;
 
-  // Contiguous token
-  if (!json_token->_internal.is_multisegment)
+  // Token read from JSON text embedded within another JSON string
+  if (json_token->_internal.string_is_double_escaped)
+  {
+    _az_json_double_escaped_string string = _az_json_double_escaped_string_create(json_token);
+    uint8_t token_byte = 0;
+    bool done = false;
+    while (true)
+    {
+      _az_RETURN_IF_FAILED(_az_json_double_escaped_string_next(&string, &token_byte, &done));
+      if (done)
+      {
+        break;
+      }
+      if (dest_idx >= destination_max_size)
+      {
+        return AZ_ERROR_NOT_ENOUGH_SPACE;
+      }
+      destination[dest_idx++] = (char)token_byte;
+    }
+  }
+  else if (!json_token->_internal.is_multisegment)
   {
+    // Contiguous token
     _az_RETURN_IF_FAILED(_az_json_token_get_string_helper(
         token_slice, destination, destination_max_size, &dest_idx, &next_char_escaped));
   }
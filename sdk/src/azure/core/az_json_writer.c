@@ -205,12 +205,7 @@ static AZ_NODISCARD bool _az_is_appending_container_end_valid(
 }
 #endif // AZ_NO_PRECONDITION_CHECKING
 
-// Returns the length of the JSON string within the az_span after it has been escaped.
-// The out parameter contains the index where the first character to escape is found.
-// If no chars need to be escaped then return the size of value with the out parameter set to -1.
-// If break_on_first_escaped is set to true, then it returns as soon as the first character to
-// escape is found.
-static int32_t _az_json_writer_escaped_length(
+int32_t _az_json_writer_escaped_length(
     az_span value,
     int32_t* out_index_of_first_escaped_char,
     bool break_on_first_escaped)
@@ -366,7 +361,7 @@ static int32_t _az_json_writer_escape_next_byte_and_copy(
   return written;
 }
 
-static AZ_NODISCARD az_span _az_json_writer_escape_and_copy(az_span destination, az_span source)
+AZ_NODISCARD az_span _az_json_writer_escape_and_copy(az_span destination, az_span source)
 {
   _az_PRECONDITION_VALID_SPAN(source, 1, false);
 
@@ -729,20 +724,20 @@ az_json_writer_append_property_name(az_json_writer* ref_json_writer, az_span nam
   return az_json_writer_append_property_name_chunked(ref_json_writer, name);
 }
 
-static AZ_NODISCARD az_result _az_validate_json(
+AZ_NODISCARD az_result _az_validate_json(
     az_span json_text,
     az_json_token_kind* first_token_kind,
     az_json_token_kind* last_token_kind)
 {
   _az_PRECONDITION_NOT_NULL(first_token_kind);
-  // Checked for consistency and maintainability alongside first_token_kind. The only caller
-  // (az_json_writer_append_json_text) always passes a valid pointer.
+  // Checked for consistency and maintainability alongside first_token_kind. The callers always
+  // pass a valid pointer.
   _az_PRECONDITION_NOT_NULL(last_token_kind);
 
   // json_text is intentionally not precondition-validated here: az_json_reader_init below
-  // performs the appropriate validation, and the only caller (az_json_writer_append_json_text)
-  // already enforces _az_PRECONDITION_VALID_SPAN on it. Duplicating that validation would be
-  // unnecessary. See https://github.com/Azure/azure-sdk-for-c/issues/2239.
+  // performs the appropriate validation, and az_json_writer_append_json_text already enforces
+  // _az_PRECONDITION_VALID_SPAN on it. Duplicating that validation would be unnecessary. See
+  // https://github.com/Azure/azure-sdk-for-c/issues/2239.
   az_json_reader reader = { 0 };
   _az_RETURN_IF_FAILED(az_json_reader_init(&reader, json_text, NULL));
 
@@ -948,6 +943,41 @@ AZ_NODISCARD az_result az_json_writer_append_double(
   return _az_update_json_writer_state(ref_json_writer, written, written, true, AZ_JSON_TOKEN_NUMBER);
 }
 
+AZ_NODISCARD az_result _az_json_writer_append_value_of_size(
+    az_json_writer* ref_json_writer,
+    int32_t size,
+    az_json_token_kind kind,
+    az_span* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION(size > 0);
+  _az_PRECONDITION_NOT_NULL(out_value);
+  _az_PRECONDITION(_az_is_appending_value_valid(ref_json_writer));
+
+  int32_t required_size = size;
+
+  if (ref_json_writer->_internal.need_comma)
+  {
+    if (required_size == INT32_MAX)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+    required_size++; // For the leading comma separator.
+  }
+
+  az_span remaining_json = _get_remaining_span(ref_json_writer, required_size);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining_json, required_size);
+
+  if (ref_json_writer->_internal.need_comma)
+  {
+    remaining_json = az_span_copy_u8(remaining_json, ',');
+  }
+
+  *out_value = az_span_slice(remaining_json, 0, size);
+
+  return _az_update_json_writer_state(ref_json_writer, required_size, required_size, true, kind);
+}
+
 static AZ_NODISCARD az_result _az_json_writer_append_container_start(
     az_json_writer* ref_json_writer,
     uint8_t byte,
@@ -1,14 +1,18 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // SPDX-License-Identifier: MIT
 
+#include "az_http_policy_logging_private.h"
 #include "az_span_private.h"
 #include <azure/core/az_config.h>
 #include <azure/core/az_http.h>
 #include <azure/core/az_http_transport.h>
 #include <azure/core/az_log.h>
+#include <azure/core/az_platform.h>
 #include <azure/core/az_span.h>
+#include <azure/core/internal/az_atomic_internal.h>
 #include <azure/core/internal/az_http_internal.h>
 #include <azure/core/internal/az_log_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
 
 #include <stddef.h>
 
@@ -20,11 +24,59 @@
 // it falsely thinks are stale reads.
 static az_log_message_fn volatile _az_log_message_callback = NULL;
 static az_log_classification_filter_fn volatile _az_message_filter_callback = NULL;
+static az_log_ring_buffer* volatile _az_log_ring_buffer = NULL;
+
+// Classifications defined by the SDK use facilities 1 to 7 and codes 1 to 4, so each one maps to a
+// bit of a 28-bit mask.
+enum
+{
+  _az_LOG_CLASSIFICATION_MAX_FACILITY = 7,
+  _az_LOG_CLASSIFICATION_MAX_CODE = 4,
+};
+
+// The filter state combines everything _az_log_should_write() depends on into one word that is
+// republished whenever a setter is called, so that the check is a single load:
+//   - 0 when there is nowhere to log to, so nothing is logged.
+//   - _az_LOG_FILTER_STATE_CALLBACK when the filter callback (or the absence of one) decides.
+//   - Otherwise, the mask of the classifications set with az_log_set_classifications().
+#define _az_LOG_FILTER_STATE_CALLBACK 0x80000000U
+
+static uint32_t _az_log_filter_state = 0;
+static uint32_t _az_log_classifications_mask = 0;
+static bool volatile _az_log_use_classifications_mask = false;
+
+AZ_INLINE int32_t _az_log_classification_get_bit(az_log_classification classification)
+{
+  uint32_t const facility = (uint32_t)classification >> 16U;
+  uint32_t const code = (uint32_t)classification & 0xFFFFU;
+
+  if (facility == 0 || facility > _az_LOG_CLASSIFICATION_MAX_FACILITY || code == 0
+      || code > _az_LOG_CLASSIFICATION_MAX_CODE)
+  {
+    return -1;
+  }
+
+  return (int32_t)(((facility - 1U) * _az_LOG_CLASSIFICATION_MAX_CODE) + (code - 1U));
+}
+
+static void _az_log_publish_filter_state(void)
+{
+  uint32_t state = 0;
+
+  if (_az_log_message_callback != NULL || _az_log_ring_buffer != NULL)
+  {
+    state = _az_log_use_classifications_mask ? _az_log_classifications_mask
+                                             : _az_LOG_FILTER_STATE_CALLBACK;
+  }
+
+  _az_ATOMIC_STORE(&_az_log_filter_state, state);
+}
 
 void az_log_set_message_callback(az_log_message_fn log_message_callback)
 {
   // We assume assignments are atomic for the supported platforms and compilers.
   _az_log_message_callback = log_message_callback;
+  _az_log_publish_filter_state();
 }
 
 void az_log_set_classification_filter_callback(
@@ -32,34 +84,82 @@ void az_log_set_classification_filter_callback(
 {
   // We assume assignments are atomic for the supported platforms and compilers.
   _az_message_filter_callback = message_filter_callback;
+  _az_log_use_classifications_mask = false;
+  _az_log_publish_filter_state();
 }
 
-AZ_INLINE az_log_message_fn _az_log_get_message_callback(az_log_classification classification)
+AZ_NODISCARD az_result az_log_set_classifications(
+    az_log_classification const classifications[],
+    int32_t classifications_length)
+{
+  _az_PRECONDITION(classifications_length == 0 || classifications != NULL);
+  _az_PRECONDITION(classifications_length >= 0);
+
+  uint32_t mask = 0;
+  for (int32_t i = 0; i < classifications_length; i++)
+  {
+    int32_t const bit = _az_log_classification_get_bit(classifications[i]);
+    if (bit < 0)
+    {
+      return AZ_ERROR_ARG;
+    }
+
+    mask |= 1U << (uint32_t)bit;
+  }
+
+  _az_log_classifications_mask = mask;
+  _az_log_use_classifications_mask = true;
+  _az_message_filter_callback = NULL;
+  _az_log_publish_filter_state();
+
+  return AZ_OK;
+}
+
+void az_log_set_ring_buffer(az_log_ring_buffer* ring_buffer)
+{
+  // We assume assignments are atomic for the supported platforms and compilers.
+  _az_log_ring_buffer = ring_buffer;
+  _az_log_publish_filter_state();
+}
+
+// This function returns whether or not the passed-in message should be logged.
+bool _az_log_should_write(az_log_classification classification)
 {
   _az_PRECONDITION(classification > 0);
 
-  // Copy the volatile fields to local variables so that they don't change within this function.
-  az_log_message_fn const message_callback = _az_log_message_callback;
-  az_log_classification_filter_fn const message_filter_callback = _az_message_filter_callback;
+  uint32_t const state = _az_ATOMIC_LOAD(&_az_log_filter_state);
 
-  // If the user hasn't registered a message_filter_callback, then we log everything, as long as a
-  // message_callback method was provided.
-  // Otherwise, we log only what that filter allows.
-  if (message_callback != NULL
-      && (message_filter_callback == NULL || message_filter_callback(classification)))
+  if ((state & _az_LOG_FILTER_STATE_CALLBACK) != 0)
   {
-    return message_callback;
+    // Copy the volatile field to a local variable so that it doesn't change within this function.
+    // If the user hasn't registered a message_filter_callback, then we log everything.
+    // Otherwise, we log only what that filter allows.
+    az_log_classification_filter_fn const message_filter_callback = _az_message_filter_callback;
+    return message_filter_callback == NULL || message_filter_callback(classification);
   }
 
+  int32_t const bit = _az_log_classification_get_bit(classification);
+  return bit >= 0 && ((state >> (uint32_t)bit) & 1U) != 0;
+}
+
+AZ_INLINE az_log_message_fn _az_log_get_message_callback(az_log_classification classification)
+{
+  // Copy the volatile field to a local variable so that it doesn't change within this function.
+  az_log_message_fn const message_callback = _az_log_message_callback;
+
   // This message's classification is either not allowed by the filter, or there is no callback
   // function registered to receive the message. In both cases, we should not log it.
-  return NULL;
+  return message_callback != NULL && _az_log_should_write(classification) ? message_callback
+                                                                           : NULL;
 }
 
-// This function returns whether or not the passed-in message should be logged.
-bool _az_log_should_write(az_log_classification classification)
+AZ_NODISCARD az_log_ring_buffer* _az_log_get_ring_buffer(az_log_classification classification)
 {
-  return _az_log_get_message_callback(classification) != NULL;
+  az_log_ring_buffer* const ring_buffer = _az_log_ring_buffer;
+
+  // Records are stored whether or not a message callback is set yet, since they are only delivered
+  // when the ring buffer is drained.
+  return ring_buffer != NULL && _az_log_should_write(classification) ? ring_buffer : NULL;
 }
 
 // This function attempts to log the passed-in message.
@@ -67,6 +167,21 @@ void _az_log_write(az_log_classification classification, az_span message)
 {
   _az_PRECONDITION_VALID_SPAN(message, 0, true);
 
+  if (_az_log_ring_buffer != NULL)
+  {
+    az_log_ring_buffer* const ring_buffer = _az_log_get_ring_buffer(classification);
+    _az_log_record record = { 0 };
+    if (ring_buffer != NULL
+        && _az_log_ring_buffer_reserve(
+            ring_buffer, classification, false, az_span_size(message), &record))
+    {
+      az_span_copy(record.body, message);
+      _az_log_ring_buffer_commit(&record);
+    }
+
+    return;
+  }
+
   az_log_message_fn const message_callback = _az_log_get_message_callback(classification);
 
   if (message_callback != NULL)
@@ -75,4 +190,237 @@ void _az_log_write(az_log_classification classification, az_span message)
   }
 }
 
+// Each record starts with this header, 8-byte aligned, and is followed by its body. The state word
+// holds the record size (header included, rounded up to 8 bytes), its kind, and the committed flag
+// that the writer sets last, so the reader never observes a partially written record.
+typedef struct
+{
+  uint32_t state;
+  int32_t classification;
+  int64_t timestamp_msec;
+  int32_t body_size;
+  int32_t _reserved;
+} _az_log_record_header;
+
+enum
+{
+  _az_LOG_RECORD_ALIGNMENT = 8,
+  _az_LOG_RING_BUFFER_MIN_SIZE = 64,
+  _az_LOG_RING_BUFFER_MAX_SIZE = 0x08000000,
+};
+
+#define _az_LOG_RECORD_SIZE_MASK 0x0FFFFFFFU
+#define _az_LOG_RECORD_KIND_SHIFT 28U
+#define _az_LOG_RECORD_KIND_MASK 0x3U
+#define _az_LOG_RECORD_COMMITTED 0x80000000U
+
+enum
+{
+  _az_LOG_RECORD_KIND_TEXT = 0,
+  _az_LOG_RECORD_KIND_BINARY = 1,
+  _az_LOG_RECORD_KIND_PADDING = 2,
+};
+
+AZ_INLINE _az_log_record_header* _az_log_ring_buffer_get_header(
+    az_log_ring_buffer const* ring_buffer,
+    uint32_t position)
+{
+  return (_az_log_record_header*)(void*)(ring_buffer->_internal.buffer
+                                         + (position & ring_buffer->_internal.mask));
+}
+
+AZ_NODISCARD az_result
+az_log_ring_buffer_init(az_log_ring_buffer* out_ring_buffer, az_span buffer)
+{
+  _az_PRECONDITION_NOT_NULL(out_ring_buffer);
+  _az_PRECONDITION_VALID_SPAN(buffer, 0, false);
+
+  uint8_t* const ptr = az_span_ptr(buffer);
+  int32_t const alignment_offset = (int32_t)((_az_LOG_RECORD_ALIGNMENT
+                                              - ((uintptr_t)ptr % _az_LOG_RECORD_ALIGNMENT))
+                                             % _az_LOG_RECORD_ALIGNMENT);
+  int32_t const usable_size = az_span_size(buffer) - alignment_offset;
+
+  if (usable_size < _az_LOG_RING_BUFFER_MIN_SIZE)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  // Positions wrap with a mask, so the capacity is the largest power of two that fits.
+  uint32_t capacity = _az_LOG_RING_BUFFER_MIN_SIZE;
+  while (capacity < _az_LOG_RING_BUFFER_MAX_SIZE && capacity * 2U <= (uint32_t)usable_size)
+  {
+    capacity *= 2U;
+  }
+
+  *out_ring_buffer = (az_log_ring_buffer){
+    ._internal = {
+      .buffer = ptr + alignment_offset,
+      .mask = capacity - 1U,
+      .reserve_position = 0,
+      .read_position = 0,
+      .dropped_count = 0,
+    },
+  };
+
+  // The reader relies on the state word of a record that has not been committed being 0.
+  az_span_fill(az_span_slice(buffer, alignment_offset, alignment_offset + (int32_t)capacity), 0);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD bool _az_log_ring_buffer_reserve(
+    az_log_ring_buffer* ref_ring_buffer,
+    az_log_classification classification,
+    bool is_binary,
+    int32_t body_size,
+    _az_log_record* out_record)
+{
+  _az_PRECONDITION_NOT_NULL(ref_ring_buffer);
+  _az_PRECONDITION(body_size >= 0);
+  _az_PRECONDITION_NOT_NULL(out_record);
+
+  uint32_t const capacity = ref_ring_buffer->_internal.mask + 1U;
+  uint32_t const size = ((uint32_t)sizeof(_az_log_record_header) + (uint32_t)body_size
+                         + (_az_LOG_RECORD_ALIGNMENT - 1U))
+      & ~(uint32_t)(_az_LOG_RECORD_ALIGNMENT - 1U);
+
+  if ((uint32_t)body_size > capacity || size > capacity)
+  {
+    _az_ATOMIC_INCREMENT(&ref_ring_buffer->_internal.dropped_count);
+    return false;
+  }
+
+  // Writers claim space by advancing reserve_position, so concurrent writers never overlap. A
+  // record never wraps around the end of the buffer: the space before the end is claimed as
+  // padding instead, and the record starts at the beginning of the buffer.
+  uint32_t position = _az_ATOMIC_LOAD(&ref_ring_buffer->_internal.reserve_position);
+  uint32_t padding = 0;
+  do
+  {
+    uint32_t const space_to_end = capacity - (position & ref_ring_buffer->_internal.mask);
+    padding = size <= space_to_end ? 0 : space_to_end;
+
+    uint32_t const used = position - _az_ATOMIC_LOAD(&ref_ring_buffer->_internal.read_position);
+    if (used + padding + size > capacity)
+    {
+      _az_ATOMIC_INCREMENT(&ref_ring_buffer->_internal.dropped_count);
+      return false;
+    }
+  } while (!_az_ATOMIC_COMPARE_EXCHANGE(
+      &ref_ring_buffer->_internal.reserve_position, &position, position + padding + size));
+
+  if (padding > 0)
+  {
+    _az_log_record_header* const padding_header
+        = _az_log_ring_buffer_get_header(ref_ring_buffer, position);
+    _az_ATOMIC_STORE(
+        &padding_header->state,
+        padding | ((uint32_t)_az_LOG_RECORD_KIND_PADDING << _az_LOG_RECORD_KIND_SHIFT)
+            | _az_LOG_RECORD_COMMITTED);
+    position += padding;
+  }
+
+  _az_log_record_header* const header = _az_log_ring_buffer_get_header(ref_ring_buffer, position);
+  header->classification = (int32_t)classification;
+  header->body_size = body_size;
+  if (az_result_failed(az_platform_clock_msec(&header->timestamp_msec)))
+  {
+    header->timestamp_msec = 0;
+  }
+
+  *out_record = (_az_log_record){
+    .body = az_span_create((uint8_t*)(header + 1), body_size),
+    .state = &header->state,
+    .committed_state = size
+        | ((uint32_t)(is_binary ? _az_LOG_RECORD_KIND_BINARY : _az_LOG_RECORD_KIND_TEXT)
+           << _az_LOG_RECORD_KIND_SHIFT)
+        | _az_LOG_RECORD_COMMITTED,
+  };
+
+  return true;
+}
+
+void _az_log_ring_buffer_commit(_az_log_record const* record)
+{
+  _az_PRECONDITION_NOT_NULL(record);
+
+  _az_ATOMIC_STORE(record->state, record->committed_state);
+}
+
+int32_t az_log_ring_buffer_drain(
+    az_log_ring_buffer* ref_ring_buffer,
+    int32_t max_records,
+    az_log_record_fn callback,
+    void* user_context)
+{
+  _az_PRECONDITION_NOT_NULL(ref_ring_buffer);
+
+  int32_t drained = 0;
+  uint32_t position = ref_ring_buffer->_internal.read_position;
+  uint32_t const reserve_position = _az_ATOMIC_LOAD(&ref_ring_buffer->_internal.reserve_position);
+
+  while (position != reserve_position && (max_records < 0 || drained < max_records))
+  {
+    _az_log_record_header* const header = _az_log_ring_buffer_get_header(ref_ring_buffer, position);
+    uint32_t const state = _az_ATOMIC_LOAD(&header->state);
+
+    // Records are drained in order, so stop at the first one that is still being written.
+    if ((state & _az_LOG_RECORD_COMMITTED) == 0)
+    {
+      break;
+    }
+
+    uint32_t const size = state & _az_LOG_RECORD_SIZE_MASK;
+    uint32_t const kind = (state >> _az_LOG_RECORD_KIND_SHIFT) & _az_LOG_RECORD_KIND_MASK;
+
+    if (kind != _az_LOG_RECORD_KIND_PADDING)
+    {
+      az_log_classification const classification = (az_log_classification)header->classification;
+      az_span const body = az_span_create((uint8_t*)(header + 1), header->body_size);
+
+      uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
+      az_span log_msg = body;
+      if (kind == _az_LOG_RECORD_KIND_BINARY)
+      {
+        log_msg = AZ_SPAN_FROM_BUFFER(log_msg_buf);
+        (void)_az_http_policy_logging_format_record(classification, body, &log_msg);
+      }
+
+      if (callback != NULL)
+      {
+        callback(classification, header->timestamp_msec, log_msg, user_context);
+      }
+      else
+      {
+        az_log_message_fn const message_callback = _az_log_message_callback;
+        if (message_callback != NULL)
+        {
+          message_callback(classification, log_msg);
+        }
+      }
+
+      drained++;
+    }
+
+    // Zero the whole record, not only its state word: a later record may start anywhere inside
+    // this one, and the reader must not mistake leftover bytes for a committed state.
+    // Padding records may be smaller than a header.
+    az_span_fill(az_span_create((uint8_t*)header, (int32_t)size), 0);
+    _az_ATOMIC_STORE(&header->state, 0U);
+
+    position += size;
+    _az_ATOMIC_STORE(&ref_ring_buffer->_internal.read_position, position);
+  }
+
+  return drained;
+}
+
+AZ_NODISCARD uint32_t az_log_ring_buffer_get_dropped_count(az_log_ring_buffer const* ring_buffer)
+{
+  _az_PRECONDITION_NOT_NULL(ring_buffer);
+
+  return _az_ATOMIC_LOAD(&ring_buffer->_internal.dropped_count);
+}
+
 #endif // AZ_NO_LOGGING
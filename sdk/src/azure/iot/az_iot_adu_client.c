@@ -148,24 +148,109 @@ static az_result _generate_step_id(az_span buffer, uint32_t step_index, az_span*
   return AZ_OK;
 }
 
-AZ_NODISCARD az_result az_iot_adu_client_get_agent_state_payload(
+// Writes the object of the last install result, the value of the lastInstallResult property.
+AZ_NODISCARD static az_result _az_iot_adu_client_write_install_result(
+    az_json_writer* ref_json_writer,
+    az_iot_adu_client_install_result* last_install_result)
+{
+  uint8_t step_id_scratch_buffer[7];
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+      ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_CODE)));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_int32(ref_json_writer, last_install_result->result_code));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+      ref_json_writer,
+      AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_EXTENDED_RESULT_CODE)));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_int32(ref_json_writer, last_install_result->extended_result_code));
+
+  if (!az_span_is_content_equal(last_install_result->result_details, AZ_SPAN_EMPTY))
+  {
+    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_DETAILS)));
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_string(ref_json_writer, last_install_result->result_details));
+  }
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+      ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_STEP_RESULTS)));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  for (int32_t i = 0; i < last_install_result->step_results_count; i++)
+  {
+    az_span step_id = AZ_SPAN_FROM_BUFFER(step_id_scratch_buffer);
+    _az_RETURN_IF_FAILED(_generate_step_id(step_id, (uint32_t)i, &step_id));
+
+    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, step_id));
+    _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_CODE)));
+    _az_RETURN_IF_FAILED(az_json_writer_append_int32(
+        ref_json_writer, last_install_result->step_results[i].result_code));
+
+    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+        ref_json_writer,
+        AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_EXTENDED_RESULT_CODE)));
+    _az_RETURN_IF_FAILED(az_json_writer_append_int32(
+        ref_json_writer, last_install_result->step_results[i].extended_result_code));
+
+    if (!az_span_is_content_equal(
+            last_install_result->step_results[i].result_details, AZ_SPAN_EMPTY))
+    {
+      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+          ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_DETAILS)));
+      _az_RETURN_IF_FAILED(az_json_writer_append_string(
+          ref_json_writer, last_install_result->step_results[i].result_details));
+    }
+
+    _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+  }
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+
+  return AZ_OK;
+}
+
+// Writes the object of the workflow, the value of the workflow property.
+AZ_NODISCARD static az_result _az_iot_adu_client_write_workflow(
+    az_json_writer* ref_json_writer,
+    az_iot_adu_client_workflow* workflow)
+{
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+      ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_ACTION)));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, (int32_t)workflow->action));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+      ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_ID)));
+  _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, workflow->id));
+
+  /* Append retry timestamp in workflow if existed.  */
+  if (!az_span_is_content_equal(workflow->retry_timestamp, AZ_SPAN_EMPTY))
+  {
+    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RETRY_TIMESTAMP)));
+    _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, workflow->retry_timestamp));
+  }
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+
+  return AZ_OK;
+}
+
+// Writes the start of the agent state payload, up to the compatibility property names, which do
+// not change from one report to the next.
+AZ_NODISCARD static az_result _az_iot_adu_client_write_agent_state_prefix(
     az_iot_adu_client* client,
     az_iot_adu_client_device_properties* device_properties,
-    az_iot_adu_client_agent_state agent_state,
-    az_iot_adu_client_workflow* workflow,
-    az_iot_adu_client_install_result* last_install_result,
     az_json_writer* ref_json_writer)
 {
-  _az_PRECONDITION_NOT_NULL(client);
-  _az_PRECONDITION_NOT_NULL(device_properties);
-  _az_PRECONDITION_VALID_SPAN(device_properties->manufacturer, 1, false);
-  _az_PRECONDITION_VALID_SPAN(device_properties->model, 1, false);
-  _az_PRECONDITION_VALID_SPAN(device_properties->update_id, 1, false);
-  _az_PRECONDITION_VALID_SPAN(device_properties->adu_version, 1, false);
-  _az_PRECONDITION_NOT_NULL(ref_json_writer);
-
-  uint8_t step_id_scratch_buffer[7];
-
   /* Update reported property */
   _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
 
@@ -233,130 +318,315 @@ AZ_NODISCARD az_result az_iot_adu_client_get_agent_state_payload(
   _az_RETURN_IF_FAILED(az_json_writer_append_string(
       ref_json_writer, client->_internal.options.device_compatibility_properties));
 
+  return AZ_OK;
+}
+
+// Writes the end of the agent state payload, from the installed update id.
+AZ_NODISCARD static az_result _az_iot_adu_client_write_agent_state_suffix(
+    az_iot_adu_client_device_properties* device_properties,
+    az_json_writer* ref_json_writer)
+{
+  /* Fill installed update id. */
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+      ref_json_writer,
+      AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_INSTALLED_UPDATE_ID)));
+  _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, device_properties->update_id));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+
+  _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_end_component(NULL, ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_get_agent_state_payload(
+    az_iot_adu_client* client,
+    az_iot_adu_client_device_properties* device_properties,
+    az_iot_adu_client_agent_state agent_state,
+    az_iot_adu_client_workflow* workflow,
+    az_iot_adu_client_install_result* last_install_result,
+    az_json_writer* ref_json_writer)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(device_properties);
+  _az_PRECONDITION_VALID_SPAN(device_properties->manufacturer, 1, false);
+  _az_PRECONDITION_VALID_SPAN(device_properties->model, 1, false);
+  _az_PRECONDITION_VALID_SPAN(device_properties->update_id, 1, false);
+  _az_PRECONDITION_VALID_SPAN(device_properties->adu_version, 1, false);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+
+  _az_RETURN_IF_FAILED(
+      _az_iot_adu_client_write_agent_state_prefix(client, device_properties, ref_json_writer));
+
   /* Add last installed update information */
   if (last_install_result != NULL)
   {
     _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
         ref_json_writer,
         AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_LAST_INSTALL_RESULT)));
-    _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
-
-    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_CODE)));
     _az_RETURN_IF_FAILED(
-        az_json_writer_append_int32(ref_json_writer, last_install_result->result_code));
+        _az_iot_adu_client_write_install_result(ref_json_writer, last_install_result));
+  }
+
+  /* Fill the agent state.   */
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
+      ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_STATE)));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, (int32_t)agent_state));
 
+  /* Fill the workflow.  */
+  if (workflow != NULL && (az_span_ptr(workflow->id) != NULL && az_span_size(workflow->id) > 0))
+  {
     _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-        ref_json_writer,
-        AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_EXTENDED_RESULT_CODE)));
-    _az_RETURN_IF_FAILED(
-        az_json_writer_append_int32(ref_json_writer, last_install_result->extended_result_code));
+        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_WORKFLOW)));
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_write_workflow(ref_json_writer, workflow));
+  }
 
-    if (!az_span_is_content_equal(last_install_result->result_details, AZ_SPAN_EMPTY))
-    {
-      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-          ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_DETAILS)));
-      _az_RETURN_IF_FAILED(
-          az_json_writer_append_string(ref_json_writer, last_install_result->result_details));
-    }
+  return _az_iot_adu_client_write_agent_state_suffix(device_properties, ref_json_writer);
+}
 
-    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_STEP_RESULTS)));
-    _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+AZ_NODISCARD az_result az_iot_adu_client_agent_state_template_init(
+    az_iot_adu_client* client,
+    az_iot_adu_client_device_properties* device_properties,
+    az_span buffer,
+    az_iot_adu_client_agent_state_template* out_agent_state_template)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(device_properties);
+  _az_PRECONDITION_VALID_SPAN(device_properties->manufacturer, 1, false);
+  _az_PRECONDITION_VALID_SPAN(device_properties->model, 1, false);
+  _az_PRECONDITION_VALID_SPAN(device_properties->update_id, 1, false);
+  _az_PRECONDITION_VALID_SPAN(device_properties->adu_version, 1, false);
+  _az_PRECONDITION_VALID_SPAN(buffer, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_agent_state_template);
 
-    for (int32_t i = 0; i < last_install_result->step_results_count; i++)
-    {
-      az_span step_id = AZ_SPAN_FROM_BUFFER(step_id_scratch_buffer);
-      _az_RETURN_IF_FAILED(_generate_step_id(step_id, (uint32_t)i, &step_id));
+  // Render the prefix in place and the suffix right after it, with the same writer calls as
+  // az_iot_adu_client_get_agent_state_payload(), so the payloads are the same.
+  az_json_writer jw;
+  _az_RETURN_IF_FAILED(az_json_writer_init(&jw, buffer, NULL));
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_write_agent_state_prefix(client, device_properties, &jw));
+  int32_t const prefix_size = az_span_size(az_json_writer_get_bytes_used_in_destination(&jw));
 
-      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, step_id));
-      _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_write_agent_state_suffix(device_properties, &jw));
+  int32_t const suffix_size
+      = az_span_size(az_json_writer_get_bytes_used_in_destination(&jw)) - prefix_size;
 
-      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-          ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_CODE)));
-      _az_RETURN_IF_FAILED(az_json_writer_append_int32(
-          ref_json_writer, last_install_result->step_results[i].result_code));
+  // Payloads must fit in the buffer along with the suffix kept at its end.
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(buffer, prefix_size + suffix_size + suffix_size);
 
-      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-          ref_json_writer,
-          AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_EXTENDED_RESULT_CODE)));
-      _az_RETURN_IF_FAILED(az_json_writer_append_int32(
-          ref_json_writer, last_install_result->step_results[i].extended_result_code));
+  // The suffix is kept at the end of the buffer, and copied after the state of each report.
+  az_span const suffix = az_span_slice(buffer, prefix_size, prefix_size + suffix_size);
+  az_span_copy(az_span_slice_to_end(buffer, az_span_size(buffer) - suffix_size), suffix);
 
-      if (!az_span_is_content_equal(
-              last_install_result->step_results[i].result_details, AZ_SPAN_EMPTY))
-      {
-        _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-            ref_json_writer,
-            AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RESULT_DETAILS)));
-        _az_RETURN_IF_FAILED(az_json_writer_append_string(
-            ref_json_writer, last_install_result->step_results[i].result_details));
-      }
+  out_agent_state_template->_internal.buffer = buffer;
+  out_agent_state_template->_internal.prefix_size = prefix_size;
+  out_agent_state_template->_internal.suffix_size = suffix_size;
 
-      _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
-    }
+  return AZ_OK;
+}
 
-    _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
-    _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+AZ_NODISCARD az_result az_iot_adu_client_agent_state_template_get_payload(
+    az_iot_adu_client_agent_state_template const* agent_state_template,
+    az_iot_adu_client_agent_state agent_state,
+    az_iot_adu_client_workflow* workflow,
+    az_iot_adu_client_install_result* last_install_result,
+    az_span* out_payload)
+{
+  _az_PRECONDITION_NOT_NULL(agent_state_template);
+  _az_PRECONDITION_NOT_NULL(out_payload);
+
+  az_span const buffer = agent_state_template->_internal.buffer;
+  int32_t const prefix_size = agent_state_template->_internal.prefix_size;
+  int32_t const suffix_size = agent_state_template->_internal.suffix_size;
+
+  // The reports are written after the prefix, and must leave room for a copy of the suffix
+  // without overwriting it.
+  az_span remainder
+      = az_span_slice(buffer, prefix_size, az_span_size(buffer) - suffix_size - suffix_size);
+  az_json_writer jw;
+
+  if (last_install_result != NULL)
+  {
+    az_span const name = AZ_SPAN_FROM_STR(
+        ",\"" AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_LAST_INSTALL_RESULT "\":");
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remainder, az_span_size(name));
+    remainder = az_span_copy(remainder, name);
+
+    _az_RETURN_IF_FAILED(az_json_writer_init(&jw, remainder, NULL));
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_write_install_result(&jw, last_install_result));
+    az_span const written = az_json_writer_get_bytes_used_in_destination(&jw);
+    remainder = az_span_slice_to_end(remainder, az_span_size(written));
   }
 
-  /* Fill the agent state.   */
-  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-      ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_STATE)));
-  _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, (int32_t)agent_state));
+  az_span const state_name
+      = AZ_SPAN_FROM_STR(",\"" AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_STATE "\":");
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remainder, az_span_size(state_name));
+  remainder = az_span_copy(remainder, state_name);
+  _az_RETURN_IF_FAILED(az_span_i32toa(remainder, (int32_t)agent_state, &remainder));
 
-  /* Fill the workflow.  */
   if (workflow != NULL && (az_span_ptr(workflow->id) != NULL && az_span_size(workflow->id) > 0))
   {
-    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_WORKFLOW)));
-    _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+    az_span const name
+        = AZ_SPAN_FROM_STR(",\"" AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_WORKFLOW "\":");
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remainder, az_span_size(name));
+    remainder = az_span_copy(remainder, name);
+
+    _az_RETURN_IF_FAILED(az_json_writer_init(&jw, remainder, NULL));
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_write_workflow(&jw, workflow));
+    az_span const written = az_json_writer_get_bytes_used_in_destination(&jw);
+    remainder = az_span_slice_to_end(remainder, az_span_size(written));
+  }
 
-    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_ACTION)));
-    _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, (int32_t)workflow->action));
+  int32_t const payload_size = (int32_t)(az_span_ptr(remainder) - az_span_ptr(buffer));
+  az_span_copy(
+      az_span_slice_to_end(buffer, payload_size),
+      az_span_slice_to_end(buffer, az_span_size(buffer) - suffix_size));
 
-    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-        ref_json_writer, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_ID)));
-    _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, workflow->id));
+  *out_payload = az_span_slice(buffer, 0, payload_size + suffix_size);
 
-    /* Append retry timestamp in workflow if existed.  */
-    if (!az_span_is_content_equal(workflow->retry_timestamp, AZ_SPAN_EMPTY))
-    {
-      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-          ref_json_writer,
-          AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RETRY_TIMESTAMP)));
-      _az_RETURN_IF_FAILED(
-          az_json_writer_append_string(ref_json_writer, workflow->retry_timestamp));
-    }
-    _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
-  }
+  return AZ_OK;
+}
 
-  /* Fill installed update id. */
-  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(
-      ref_json_writer,
-      AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_INSTALLED_UPDATE_ID)));
-  _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, device_properties->update_id));
+/*
+ * The compact update manifest places its parents (steps and files) from the start of the arena
+ * and their children (the file ids of a step and the hashes of a file) from the end. Since the
+ * children of a parent are read before the next parent, every array stays contiguous although
+ * the manifest is read in a single pass. The compact update request only places its file urls,
+ * from the start of the arena.
+ */
+typedef struct
+{
+  uint8_t* start;
+  uint8_t* front;
+  uint8_t* back;
+  uint8_t* end;
+} _az_iot_adu_client_arena;
 
-  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+enum
+{
+  // Enough for the alignment of the pointers, int64_t and #az_span in the compact structures.
+  _az_IOT_ADU_CLIENT_ARENA_ALIGNMENT = 8,
+};
 
-  _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_end_component(NULL, ref_json_writer));
-  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+static void _az_iot_adu_client_arena_align_front(_az_iot_adu_client_arena* ref_arena)
+{
+  size_t const available = (size_t)(ref_arena->back - ref_arena->front);
+  size_t const misalignment
+      = (size_t)((uintptr_t)ref_arena->front % _az_IOT_ADU_CLIENT_ARENA_ALIGNMENT);
+  size_t const padding
+      = misalignment == 0 ? 0 : _az_IOT_ADU_CLIENT_ARENA_ALIGNMENT - misalignment;
+  ref_arena->front += padding < available ? padding : available;
+}
+
+static void _az_iot_adu_client_arena_align_back(_az_iot_adu_client_arena* ref_arena)
+{
+  size_t const available = (size_t)(ref_arena->back - ref_arena->front);
+  size_t const misalignment
+      = (size_t)((uintptr_t)ref_arena->back % _az_IOT_ADU_CLIENT_ARENA_ALIGNMENT);
+  ref_arena->back -= misalignment < available ? misalignment : available;
+}
+
+AZ_NODISCARD static az_result _az_iot_adu_client_arena_push_front(
+    _az_iot_adu_client_arena* ref_arena,
+    size_t size,
+    void** out_memory)
+{
+  if (size > (size_t)(ref_arena->back - ref_arena->front))
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
 
+  *out_memory = ref_arena->front;
+  ref_arena->front += size;
   return AZ_OK;
 }
 
-AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
-    az_iot_adu_client* client,
+AZ_NODISCARD static az_result _az_iot_adu_client_arena_push_back(
+    _az_iot_adu_client_arena* ref_arena,
+    size_t size,
+    void** out_memory)
+{
+  if (size > (size_t)(ref_arena->back - ref_arena->front))
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  ref_arena->back -= size;
+  *out_memory = ref_arena->back;
+  return AZ_OK;
+}
+
+// Parses the file urls, with the reader on the property name. They are placed from the start of the
+// arena, or in the array of *ref_file_urls, of _az_IOT_ADU_CLIENT_MAX_TOTAL_FILE_COUNT items, if
+// there is no arena.
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_file_urls(
     az_json_reader* ref_json_reader,
-    az_iot_adu_client_update_request* update_request)
+    _az_iot_adu_client_arena* ref_arena,
+    az_iot_adu_client_file_url** ref_file_urls,
+    uint32_t* file_urls_count)
 {
-  _az_PRECONDITION_NOT_NULL(client);
-  _az_PRECONDITION_NOT_NULL(ref_json_reader);
-  _az_PRECONDITION_NOT_NULL(update_request);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  if (ref_json_reader->token.kind == AZ_JSON_TOKEN_NULL)
+  {
+    return AZ_OK;
+  }
 
-  (void)client;
+  RETURN_IF_JSON_TOKEN_NOT_TYPE(ref_json_reader, AZ_JSON_TOKEN_BEGIN_OBJECT);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  if (ref_arena != NULL)
+  {
+    _az_iot_adu_client_arena_align_front(ref_arena);
+    *ref_file_urls = (az_iot_adu_client_file_url*)(void*)ref_arena->front;
+  }
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE(ref_json_reader, AZ_JSON_TOKEN_PROPERTY_NAME);
+
+    // If object isn't ended and we have reached max files allowed, next would overflow.
+    if (ref_arena == NULL && *file_urls_count == _az_IOT_ADU_CLIENT_MAX_TOTAL_FILE_COUNT)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+
+    az_span const id = ref_json_reader->token.slice;
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    if (ref_json_reader->token.kind != AZ_JSON_TOKEN_NULL)
+    {
+      if (ref_arena != NULL)
+      {
+        // The file urls are contiguous, since nothing else is placed in the arena meanwhile.
+        void* memory = NULL;
+        _az_RETURN_IF_FAILED(_az_iot_adu_client_arena_push_front(
+            ref_arena, sizeof(az_iot_adu_client_file_url), &memory));
+      }
+
+      (*ref_file_urls)[*file_urls_count] = (az_iot_adu_client_file_url){
+        .id = id,
+        .url = ref_json_reader->token.slice,
+      };
+      (*file_urls_count)++;
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  return AZ_OK;
+}
 
+// Parses the ADU service writable properties, with the file urls placed as in
+// _az_iot_adu_client_parse_file_urls().
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_service_properties(
+    az_json_reader* ref_json_reader,
+    _az_iot_adu_client_arena* ref_arena,
+    az_iot_adu_client_workflow* workflow,
+    az_span* update_manifest,
+    az_span* update_manifest_signature,
+    az_iot_adu_client_file_url** ref_file_urls,
+    uint32_t* file_urls_count)
+{
   RETURN_IF_JSON_TOKEN_NOT_TYPE(ref_json_reader, AZ_JSON_TOKEN_PROPERTY_NAME);
   RETURN_IF_JSON_TOKEN_NOT_TEXT(ref_json_reader, AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_SERVICE);
 
@@ -364,12 +634,12 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
   RETURN_IF_JSON_TOKEN_NOT_TYPE(ref_json_reader, AZ_JSON_TOKEN_BEGIN_OBJECT);
   _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
 
-  update_request->workflow.action = 0;
-  update_request->workflow.id = AZ_SPAN_EMPTY;
-  update_request->workflow.retry_timestamp = AZ_SPAN_EMPTY;
-  update_request->update_manifest = AZ_SPAN_EMPTY;
-  update_request->update_manifest_signature = AZ_SPAN_EMPTY;
-  update_request->file_urls_count = 0;
+  workflow->action = 0;
+  workflow->id = AZ_SPAN_EMPTY;
+  workflow->retry_timestamp = AZ_SPAN_EMPTY;
+  *update_manifest = AZ_SPAN_EMPTY;
+  *update_manifest_signature = AZ_SPAN_EMPTY;
+  *file_urls_count = 0;
 
   while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
   {
@@ -393,7 +663,7 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
         {
           _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
           _az_RETURN_IF_FAILED(az_json_token_get_int32(
-              &ref_json_reader->token, (int32_t*)&update_request->workflow.action));
+              &ref_json_reader->token, (int32_t*)&workflow->action));
         }
         else if (az_json_token_is_text_equal(
                      &ref_json_reader->token,
@@ -401,14 +671,14 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
         {
           _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
 
-          update_request->workflow.id = ref_json_reader->token.slice;
+          workflow->id = ref_json_reader->token.slice;
         }
         else if (az_json_token_is_text_equal(
                      &ref_json_reader->token,
                      AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RETRY_TIMESTAMP)))
         {
           _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-          update_request->workflow.retry_timestamp = ref_json_reader->token.slice;
+          workflow->retry_timestamp = ref_json_reader->token.slice;
         }
         else
         {
@@ -430,7 +700,7 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
 
       if (ref_json_reader->token.kind != AZ_JSON_TOKEN_NULL)
       {
-        update_request->update_manifest = ref_json_reader->token.slice;
+        *update_manifest = ref_json_reader->token.slice;
       }
     }
     else if (az_json_token_is_text_equal(
@@ -441,49 +711,80 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
 
       if (ref_json_reader->token.kind != AZ_JSON_TOKEN_NULL)
       {
-        update_request->update_manifest_signature = ref_json_reader->token.slice;
+        *update_manifest_signature = ref_json_reader->token.slice;
       }
     }
     else if (az_json_token_is_text_equal(
                  &ref_json_reader->token,
                  AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_FILEURLS)))
     {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-      if (ref_json_reader->token.kind != AZ_JSON_TOKEN_NULL)
-      {
-        RETURN_IF_JSON_TOKEN_NOT_TYPE(ref_json_reader, AZ_JSON_TOKEN_BEGIN_OBJECT);
-        _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      _az_RETURN_IF_FAILED(_az_iot_adu_client_parse_file_urls(
+          ref_json_reader, ref_arena, ref_file_urls, file_urls_count));
+    }
 
-        while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
-        {
-          RETURN_IF_JSON_TOKEN_NOT_TYPE(ref_json_reader, AZ_JSON_TOKEN_PROPERTY_NAME);
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
 
-          // If object isn't ended and we have reached max files allowed, next would overflow.
-          if (update_request->file_urls_count == _az_IOT_ADU_CLIENT_MAX_TOTAL_FILE_COUNT)
-          {
-            return AZ_ERROR_NOT_ENOUGH_SPACE;
-          }
+  return AZ_OK;
+}
 
-          update_request->file_urls[update_request->file_urls_count].id
-              = ref_json_reader->token.slice;
+AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties(
+    az_iot_adu_client* client,
+    az_json_reader* ref_json_reader,
+    az_iot_adu_client_update_request* update_request)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION_NOT_NULL(update_request);
 
-          _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-          if (ref_json_reader->token.kind != AZ_JSON_TOKEN_NULL)
-          {
-            update_request->file_urls[update_request->file_urls_count].url
-                = ref_json_reader->token.slice;
+  (void)client;
 
-            update_request->file_urls_count++;
-          }
+  az_iot_adu_client_file_url* file_urls = update_request->file_urls;
+  return _az_iot_adu_client_parse_service_properties(
+      ref_json_reader,
+      NULL,
+      &update_request->workflow,
+      &update_request->update_manifest,
+      &update_request->update_manifest_signature,
+      &file_urls,
+      &update_request->file_urls_count);
+}
 
-          _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-        }
-      }
-    }
+AZ_NODISCARD az_result az_iot_adu_client_parse_service_properties_compact(
+    az_iot_adu_client* client,
+    az_json_reader* ref_json_reader,
+    az_span arena,
+    az_iot_adu_client_compact_update_request* out_update_request,
+    int32_t* out_arena_size)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION_VALID_SPAN(arena, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_update_request);
+  _az_PRECONDITION_NOT_NULL(out_arena_size);
 
-    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-  }
+  (void)client;
 
+  _az_iot_adu_client_arena request_arena = {
+    .start = az_span_ptr(arena),
+    .front = az_span_ptr(arena),
+    .back = az_span_ptr(arena) + az_span_size(arena),
+    .end = az_span_ptr(arena) + az_span_size(arena),
+  };
+
+  out_update_request->file_urls = NULL;
+  *out_arena_size = 0;
+
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_parse_service_properties(
+      ref_json_reader,
+      &request_arena,
+      &out_update_request->workflow,
+      &out_update_request->update_manifest,
+      &out_update_request->update_manifest_signature,
+      &out_update_request->file_urls,
+      &out_update_request->file_urls_count));
+
+  *out_arena_size = (int32_t)(request_arena.front - request_arena.start);
   return AZ_OK;
 }
 
@@ -515,10 +816,96 @@ AZ_NODISCARD az_result az_iot_adu_client_get_service_properties_response(
   _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
   _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
 
-  _az_RETURN_IF_FAILED(
-      az_iot_hub_client_properties_writer_end_response_status(NULL, ref_json_writer));
-  _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_end_component(NULL, ref_json_writer));
-  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(
+      az_iot_hub_client_properties_writer_end_response_status(NULL, ref_json_writer));
+  _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_end_component(NULL, ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+
+  return AZ_OK;
+}
+
+// Parses the update id object, with the reader on its property name.
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_update_id(
+    az_json_reader* ref_json_reader,
+    az_iot_adu_update_id* update_id)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+    if (az_json_token_is_text_equal(
+            &ref_json_reader->token,
+            AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_PROVIDER)))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+      update_id->provider = ref_json_reader->token.slice;
+    }
+    else if (az_json_token_is_text_equal(
+                 &ref_json_reader->token,
+                 AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_NAME)))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+      update_id->name = ref_json_reader->token.slice;
+    }
+    else if (az_json_token_is_text_equal(
+                 &ref_json_reader->token,
+                 AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_VERSION)))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+      update_id->version = ref_json_reader->token.slice;
+    }
+    else
+    {
+      _az_LOG_WRITE(
+          AZ_LOG_IOT_ADU, AZ_SPAN_FROM_STR("Unexpected property found in ADU update id object:"));
+      _az_LOG_WRITE(AZ_LOG_IOT_ADU, ref_json_reader->token.slice);
+      return AZ_ERROR_JSON_INVALID_STATE;
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  return AZ_OK;
+}
+
+// Parses the handler properties object of a step, with the reader on its property name.
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_handler_properties(
+    az_json_reader* ref_json_reader,
+    az_iot_adu_client_update_manifest_instructions_step_handler_properties* handler_properties)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+    if (az_json_token_is_text_equal(
+            &ref_json_reader->token,
+            AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_INSTALLED_CRITERIA)))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+      handler_properties->installed_criteria = ref_json_reader->token.slice;
+    }
+    else
+    {
+      // Skip unknown handlerProperties members so future manifest
+      // versions remain parseable (forward compatibility).
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
 
   return AZ_OK;
 }
@@ -642,35 +1029,9 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_update_manifest(
                          AZ_SPAN_FROM_STR(
                              AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_HANDLER_PROPERTIES)))
             {
-              _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-              RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
-              _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-
-              while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
-              {
-                RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
-
-                if (az_json_token_is_text_equal(
-                        &ref_json_reader->token,
-                        AZ_SPAN_FROM_STR(
-                            AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_INSTALLED_CRITERIA)))
-                {
-                  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-                  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
-                  update_manifest->instructions.steps[step_index]
-                      .handler_properties.installed_criteria
-                      = ref_json_reader->token.slice;
-                }
-                else
-                {
-                  // Skip unknown handlerProperties members so future manifest
-                  // versions remain parseable (forward compatibility).
-                  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-                  _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
-                }
-
-                _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-              }
+              _az_RETURN_IF_FAILED(_az_iot_adu_client_parse_handler_properties(
+                  ref_json_reader,
+                  &update_manifest->instructions.steps[step_index].handler_properties));
             }
             else
             {
@@ -703,49 +1064,8 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_update_manifest(
                  &ref_json_reader->token,
                  AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_UPDATE_ID)))
     {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-
-      while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
-      {
-        RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
-
-        if (az_json_token_is_text_equal(
-                &ref_json_reader->token,
-                AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_PROVIDER)))
-        {
-          _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-          RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
-          update_manifest->update_id.provider = ref_json_reader->token.slice;
-        }
-        else if (az_json_token_is_text_equal(
-                     &ref_json_reader->token,
-                     AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_NAME)))
-        {
-          _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-          RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
-          update_manifest->update_id.name = ref_json_reader->token.slice;
-        }
-        else if (az_json_token_is_text_equal(
-                     &ref_json_reader->token,
-                     AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_VERSION)))
-        {
-          _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-          RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
-          update_manifest->update_id.version = ref_json_reader->token.slice;
-        }
-        else
-        {
-          _az_LOG_WRITE(
-              AZ_LOG_IOT_ADU,
-              AZ_SPAN_FROM_STR("Unexpected property found in ADU update id object:"));
-          _az_LOG_WRITE(AZ_LOG_IOT_ADU, ref_json_reader->token.slice);
-          return AZ_ERROR_JSON_INVALID_STATE;
-        }
-
-        _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
-      }
+      _az_RETURN_IF_FAILED(
+          _az_iot_adu_client_parse_update_id(ref_json_reader, &update_manifest->update_id));
     }
     else if (az_json_token_is_text_equal(
                  &ref_json_reader->token,
@@ -899,3 +1219,373 @@ AZ_NODISCARD az_result az_iot_adu_client_parse_update_manifest(
 
   return AZ_OK;
 }
+
+// Parses the file ids of a step into the end of the arena, with the reader on the property name.
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_compact_step_files(
+    az_json_reader* ref_json_reader,
+    _az_iot_adu_client_arena* ref_arena,
+    az_iot_adu_client_compact_update_manifest_step* step)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_ARRAY);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  _az_iot_adu_client_arena_align_back(ref_arena);
+  uint32_t files_count = 0;
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_ARRAY)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+
+    void* memory = NULL;
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_arena_push_back(ref_arena, sizeof(az_span), &memory));
+    *(az_span*)memory = ref_json_reader->token.slice;
+    files_count++;
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  // The file ids were placed from the end of the arena, so they are in reverse order.
+  step->files = (az_span*)(void*)ref_arena->back;
+  step->files_count = files_count;
+
+  for (uint32_t i = 0; i < files_count / 2; i++)
+  {
+    az_span const file = step->files[i];
+    step->files[i] = step->files[files_count - 1 - i];
+    step->files[files_count - 1 - i] = file;
+  }
+
+  return AZ_OK;
+}
+
+// Parses the instructions steps into the start of the arena, with the reader on the property name.
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_compact_instructions(
+    az_json_reader* ref_json_reader,
+    _az_iot_adu_client_arena* ref_arena,
+    az_iot_adu_client_compact_update_manifest* ref_update_manifest)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+  if (!az_json_token_is_text_equal(
+          &ref_json_reader->token, AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_STEPS)))
+  {
+    _az_LOG_WRITE(
+        AZ_LOG_IOT_ADU, AZ_SPAN_FROM_STR("Unexpected property found in ADU manifest steps:"));
+    _az_LOG_WRITE(AZ_LOG_IOT_ADU, ref_json_reader->token.slice);
+    return AZ_ERROR_JSON_INVALID_STATE;
+  }
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_ARRAY);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  _az_iot_adu_client_arena_align_front(ref_arena);
+  ref_update_manifest->steps
+      = (az_iot_adu_client_compact_update_manifest_step*)(void*)ref_arena->front;
+  ref_update_manifest->steps_count = 0;
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_ARRAY)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+    void* memory = NULL;
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_arena_push_front(
+        ref_arena, sizeof(az_iot_adu_client_compact_update_manifest_step), &memory));
+    az_iot_adu_client_compact_update_manifest_step* step
+        = (az_iot_adu_client_compact_update_manifest_step*)memory;
+    *step = (az_iot_adu_client_compact_update_manifest_step){
+      .handler = AZ_SPAN_EMPTY,
+      .files = NULL,
+      .files_count = 0,
+      .handler_properties = { .installed_criteria = AZ_SPAN_EMPTY },
+    };
+
+    while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+    {
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+      if (az_json_token_is_text_equal(
+              &ref_json_reader->token,
+              AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_HANDLER)))
+      {
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+        RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+        step->handler = ref_json_reader->token.slice;
+      }
+      else if (az_json_token_is_text_equal(
+                   &ref_json_reader->token,
+                   AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_FILES)))
+      {
+        _az_RETURN_IF_FAILED(
+            _az_iot_adu_client_parse_compact_step_files(ref_json_reader, ref_arena, step));
+      }
+      else if (az_json_token_is_text_equal(
+                   &ref_json_reader->token,
+                   AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_HANDLER_PROPERTIES)))
+      {
+        _az_RETURN_IF_FAILED(_az_iot_adu_client_parse_handler_properties(
+            ref_json_reader, &step->handler_properties));
+      }
+      else
+      {
+        // Skip unknown step members so future manifest versions remain
+        // parseable (forward compatibility).
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+        _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+      }
+
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    }
+
+    ref_update_manifest->steps_count++;
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_END_OBJECT);
+
+  return AZ_OK;
+}
+
+// Parses the hashes of a file into the end of the arena, with the reader on the property name.
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_compact_file_hashes(
+    az_json_reader* ref_json_reader,
+    _az_iot_adu_client_arena* ref_arena,
+    az_iot_adu_client_compact_update_manifest_file* file)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  _az_iot_adu_client_arena_align_back(ref_arena);
+  uint32_t hashes_count = 0;
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+    void* memory = NULL;
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_arena_push_back(
+        ref_arena, sizeof(az_iot_adu_client_update_manifest_file_hash), &memory));
+    az_iot_adu_client_update_manifest_file_hash* hash
+        = (az_iot_adu_client_update_manifest_file_hash*)memory;
+
+    hash->hash_type = ref_json_reader->token.slice;
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+    hash->hash_value = ref_json_reader->token.slice;
+    hashes_count++;
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  // The hashes were placed from the end of the arena, so they are in reverse order.
+  file->hashes = (az_iot_adu_client_update_manifest_file_hash*)(void*)ref_arena->back;
+  file->hashes_count = hashes_count;
+
+  for (uint32_t i = 0; i < hashes_count / 2; i++)
+  {
+    az_iot_adu_client_update_manifest_file_hash const hash = file->hashes[i];
+    file->hashes[i] = file->hashes[hashes_count - 1 - i];
+    file->hashes[hashes_count - 1 - i] = hash;
+  }
+
+  return AZ_OK;
+}
+
+// Parses the files into the start of the arena, with the reader on the property name.
+AZ_NODISCARD static az_result _az_iot_adu_client_parse_compact_files(
+    az_json_reader* ref_json_reader,
+    _az_iot_adu_client_arena* ref_arena,
+    az_iot_adu_client_compact_update_manifest* ref_update_manifest)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  _az_iot_adu_client_arena_align_front(ref_arena);
+  ref_update_manifest->files
+      = (az_iot_adu_client_compact_update_manifest_file*)(void*)ref_arena->front;
+  ref_update_manifest->files_count = 0;
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+    void* memory = NULL;
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_arena_push_front(
+        ref_arena, sizeof(az_iot_adu_client_compact_update_manifest_file), &memory));
+    az_iot_adu_client_compact_update_manifest_file* file
+        = (az_iot_adu_client_compact_update_manifest_file*)memory;
+    *file = (az_iot_adu_client_compact_update_manifest_file){
+      .id = ref_json_reader->token.slice,
+      .file_name = AZ_SPAN_EMPTY,
+      .size_in_bytes = 0,
+      .hashes = NULL,
+      .hashes_count = 0,
+    };
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+    while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+    {
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+      if (az_json_token_is_text_equal(
+              &ref_json_reader->token,
+              AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_FILE_NAME)))
+      {
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+        RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+        file->file_name = ref_json_reader->token.slice;
+      }
+      else if (az_json_token_is_text_equal(
+                   &ref_json_reader->token,
+                   AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_SIZE_IN_BYTES)))
+      {
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+        RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_NUMBER);
+        _az_RETURN_IF_FAILED(
+            az_json_token_get_int64(&ref_json_reader->token, &file->size_in_bytes));
+      }
+      else if (az_json_token_is_text_equal(
+                   &ref_json_reader->token,
+                   AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_HASHES)))
+      {
+        _az_RETURN_IF_FAILED(
+            _az_iot_adu_client_parse_compact_file_hashes(ref_json_reader, ref_arena, file));
+      }
+      // Delta updates are not supported, as in az_iot_adu_client_parse_update_manifest().
+      else if (
+          az_json_token_is_text_equal(
+              &ref_json_reader->token,
+              AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_RELATED_FILES))
+          || az_json_token_is_text_equal(
+              &ref_json_reader->token,
+              AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_DOWNLOAD_HANDLER)))
+      {
+        _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+      }
+      else if (az_json_token_is_text_equal(
+                   &ref_json_reader->token,
+                   AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_MIME_TYPE)))
+      {
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      }
+      else
+      {
+        return AZ_ERROR_JSON_INVALID_STATE;
+      }
+
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    }
+
+    ref_update_manifest->files_count++;
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_parse_update_manifest_compact(
+    az_iot_adu_client* client,
+    az_json_reader* ref_json_reader,
+    az_span arena,
+    az_iot_adu_client_compact_update_manifest* out_update_manifest,
+    int32_t* out_arena_size)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION_VALID_SPAN(arena, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_update_manifest);
+  _az_PRECONDITION_NOT_NULL(out_arena_size);
+
+  (void)client;
+
+  _az_iot_adu_client_arena manifest_arena = {
+    .start = az_span_ptr(arena),
+    .front = az_span_ptr(arena),
+    .back = az_span_ptr(arena) + az_span_size(arena),
+    .end = az_span_ptr(arena) + az_span_size(arena),
+  };
+
+  *out_update_manifest = (az_iot_adu_client_compact_update_manifest){
+    .manifest_version = AZ_SPAN_EMPTY,
+    .update_id = { .provider = AZ_SPAN_EMPTY, .name = AZ_SPAN_EMPTY, .version = AZ_SPAN_EMPTY },
+    .steps = NULL,
+    .steps_count = 0,
+    .files = NULL,
+    .files_count = 0,
+    .create_date_time = AZ_SPAN_EMPTY,
+  };
+  *out_arena_size = 0;
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_BEGIN_OBJECT);
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+
+  while (ref_json_reader->token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  {
+    RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_PROPERTY_NAME);
+
+    if (az_json_token_is_text_equal(
+            &ref_json_reader->token,
+            AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_MANIFEST_VERSION)))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+      out_update_manifest->manifest_version = ref_json_reader->token.slice;
+    }
+    else if (az_json_token_is_text_equal(
+                 &ref_json_reader->token,
+                 AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_INSTRUCTIONS)))
+    {
+      _az_RETURN_IF_FAILED(_az_iot_adu_client_parse_compact_instructions(
+          ref_json_reader, &manifest_arena, out_update_manifest));
+    }
+    else if (az_json_token_is_text_equal(
+                 &ref_json_reader->token,
+                 AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_UPDATE_ID)))
+    {
+      _az_RETURN_IF_FAILED(
+          _az_iot_adu_client_parse_update_id(ref_json_reader, &out_update_manifest->update_id));
+    }
+    else if (az_json_token_is_text_equal(
+                 &ref_json_reader->token,
+                 AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_FILES)))
+    {
+      _az_RETURN_IF_FAILED(_az_iot_adu_client_parse_compact_files(
+          ref_json_reader, &manifest_arena, out_update_manifest));
+    }
+    else if (az_json_token_is_text_equal(
+                 &ref_json_reader->token,
+                 AZ_SPAN_FROM_STR(AZ_IOT_ADU_CLIENT_AGENT_PROPERTY_NAME_CREATED_DATE_TIME)))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      RETURN_IF_JSON_TOKEN_NOT_TYPE((ref_json_reader), AZ_JSON_TOKEN_STRING);
+      out_update_manifest->create_date_time = ref_json_reader->token.slice;
+    }
+    else
+    {
+      // The compatibility properties are not intended to be consumed by the ADU agent either.
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  }
+
+  *out_arena_size = (int32_t)((manifest_arena.front - manifest_arena.start)
+                              + (manifest_arena.end - manifest_arena.back));
+
+  return AZ_OK;
+}
@@ -0,0 +1,693 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_base64.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_json.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_adu_client_download.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/internal/az_iot_sha256_internal.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  _az_IOT_ADU_CLIENT_DOWNLOAD_DEFAULT_CHUNK_SIZE = 4096,
+
+  // The base64 encoded size of a SHA-256 digest, padding included.
+  _az_IOT_ADU_CLIENT_DOWNLOAD_SHA256_BASE64_SIZE = 44,
+};
+
+static const az_span sha256_hash_type = AZ_SPAN_LITERAL_FROM_STR("sha256");
+static const az_span content_length_header_name = AZ_SPAN_LITERAL_FROM_STR("Content-Length");
+
+AZ_NODISCARD az_iot_adu_client_download_options az_iot_adu_client_download_options_default(void)
+{
+  return (az_iot_adu_client_download_options){
+    .chunk_size = _az_IOT_ADU_CLIENT_DOWNLOAD_DEFAULT_CHUNK_SIZE,
+    .retry_options = _az_http_policy_retry_options_default(),
+  };
+}
+
+// The fields a download needs of a file of either #az_iot_adu_client_update_manifest or
+// #az_iot_adu_client_compact_update_manifest, along with the file urls of its update request.
+typedef struct
+{
+  az_span id;
+  int64_t size_in_bytes;
+  az_iot_adu_client_update_manifest_file_hash const* hashes;
+  uint32_t hashes_count;
+  az_iot_adu_client_file_url const* file_urls;
+  uint32_t file_urls_count;
+} _az_iot_adu_client_download_file_info;
+
+static _az_iot_adu_client_download_file_info _az_iot_adu_client_download_get_file(
+    az_iot_adu_client_update_request const* update_request,
+    az_iot_adu_client_update_manifest_file const* file)
+{
+  return (_az_iot_adu_client_download_file_info){
+    .id = file->id,
+    .size_in_bytes = file->size_in_bytes,
+    .hashes = file->hashes,
+    .hashes_count = file->hashes_count,
+    .file_urls = update_request == NULL ? NULL : update_request->file_urls,
+    .file_urls_count = update_request == NULL ? 0 : update_request->file_urls_count,
+  };
+}
+
+static _az_iot_adu_client_download_file_info _az_iot_adu_client_download_get_compact_file(
+    az_iot_adu_client_compact_update_request const* update_request,
+    az_iot_adu_client_compact_update_manifest_file const* file)
+{
+  return (_az_iot_adu_client_download_file_info){
+    .id = file->id,
+    .size_in_bytes = file->size_in_bytes,
+    .hashes = file->hashes,
+    .hashes_count = file->hashes_count,
+    .file_urls = update_request == NULL ? NULL : update_request->file_urls,
+    .file_urls_count = update_request == NULL ? 0 : update_request->file_urls_count,
+  };
+}
+
+static az_span
+_az_iot_adu_client_download_find_url(_az_iot_adu_client_download_file_info const* file)
+{
+  for (uint32_t i = 0; i < file->file_urls_count; i++)
+  {
+    if (az_span_is_content_equal(file->file_urls[i].id, file->id))
+    {
+      return file->file_urls[i].url;
+    }
+  }
+
+  return AZ_SPAN_EMPTY;
+}
+
+AZ_NODISCARD static az_result _az_iot_adu_client_download_get_expected_digest(
+    _az_iot_adu_client_download_file_info const* file,
+    az_span out_digest)
+{
+  for (uint32_t i = 0; i < file->hashes_count; i++)
+  {
+    if (!az_span_is_content_equal(file->hashes[i].hash_type, sha256_hash_type))
+    {
+      continue;
+    }
+
+    az_span const hash_value = file->hashes[i].hash_value;
+    if (az_span_size(hash_value) != _az_IOT_ADU_CLIENT_DOWNLOAD_SHA256_BASE64_SIZE)
+    {
+      return AZ_ERROR_UNEXPECTED_CHAR;
+    }
+
+    int32_t written = 0;
+    _az_RETURN_IF_FAILED(az_base64_decode(out_digest, hash_value, &written));
+    return written == _az_IOT_SHA256_DIGEST_SIZE ? AZ_OK : AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
+
+AZ_NODISCARD static az_result _az_iot_adu_client_download_check_digest(
+    _az_iot_sha256* ref_sha256,
+    az_span expected_digest)
+{
+  uint8_t digest[_az_IOT_SHA256_DIGEST_SIZE];
+  _az_iot_sha256_final(ref_sha256, AZ_SPAN_FROM_BUFFER(digest));
+
+  return az_span_is_content_equal(AZ_SPAN_FROM_BUFFER(digest), expected_digest)
+      ? AZ_OK
+      : AZ_ERROR_IOT_ADU_FILE_HASH_MISMATCH;
+}
+
+// Gets the Content-Length of a response whose status line has been read.
+AZ_NODISCARD static az_result _az_iot_adu_client_download_get_content_length(
+    az_http_response* ref_response,
+    int64_t* out_content_length)
+{
+  *out_content_length = -1;
+  while (true)
+  {
+    az_span name;
+    az_span value;
+    az_result const result = az_http_response_get_next_header(ref_response, &name, &value);
+    if (result == AZ_ERROR_HTTP_END_OF_HEADERS)
+    {
+      return AZ_OK;
+    }
+    _az_RETURN_IF_FAILED(result);
+
+    if (az_span_is_content_equal_ignoring_case(name, content_length_header_name))
+    {
+      _az_RETURN_IF_FAILED(az_span_atoi64(value, out_content_length));
+    }
+  }
+}
+
+// Requests size bytes of a file at offset, and gets them from the body of the response. The body
+// returned by az_http_response_get_body() runs to the end of the response buffer, so its size is
+// taken from the bytes the transport wrote, and checked against the Content-Length when there is
+// one.
+AZ_NODISCARD static az_result _az_iot_adu_client_download_fetch(
+    az_span url,
+    az_context* context,
+    az_iot_adu_client_download_options const* options,
+    az_span response_buffer,
+    int64_t offset,
+    int32_t size,
+    bool is_whole_file,
+    az_span* out_chunk)
+{
+  az_http_policy_retry_options pipeline_retry_options = options->retry_options;
+  az_http_policy_instrumentation_options pipeline_instrumentation_options
+      = options->instrumentation_options;
+  _az_http_pipeline pipeline = {
+    ._internal = {
+      .policies = {
+        {
+          ._internal = {
+            .process = az_http_pipeline_policy_retry,
+            .options = &pipeline_retry_options,
+          },
+        },
+        {
+          ._internal = {
+            .process = az_http_pipeline_policy_instrumentation,
+            .options = &pipeline_instrumentation_options,
+          },
+        },
+        {
+          ._internal = {
+            .process = az_http_pipeline_policy_transport,
+            .options = NULL,
+          },
+        },
+      },
+    },
+  };
+
+  uint8_t range_buffer[_az_HTTP_RANGE_HEADER_VALUE_SIZE];
+  uint8_t headers_buffer[sizeof(_az_http_request_header)];
+  az_http_request request;
+  _az_RETURN_IF_FAILED(az_http_request_init(
+      &request,
+      context,
+      az_http_method_get(),
+      url,
+      az_span_size(url),
+      AZ_SPAN_FROM_BUFFER(headers_buffer),
+      AZ_SPAN_EMPTY));
+  _az_RETURN_IF_FAILED(az_http_request_append_range_header(
+      &request, AZ_SPAN_FROM_BUFFER(range_buffer), offset, offset + size - 1));
+
+  az_http_response response;
+  _az_RETURN_IF_FAILED(az_http_response_init(&response, response_buffer));
+  _az_RETURN_IF_FAILED(az_http_pipeline_process(&pipeline, &request, &response));
+
+  az_http_response_status_line status_line;
+  _az_RETURN_IF_FAILED(az_http_response_get_status_line(&response, &status_line));
+  if (status_line.status_code == AZ_HTTP_STATUS_CODE_PARTIAL_CONTENT)
+  {
+    az_http_response_content_range content_range;
+    az_result const result = az_http_response_get_content_range(&response, &content_range);
+    if (result == AZ_ERROR_ITEM_NOT_FOUND || result == AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER)
+    {
+      return AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED;
+    }
+    _az_RETURN_IF_FAILED(result);
+
+    if (content_range.first_byte != offset || content_range.last_byte != offset + size - 1)
+    {
+      return AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED;
+    }
+  }
+  else if (status_line.status_code != AZ_HTTP_STATUS_CODE_OK || !is_whole_file)
+  {
+    // A server ignoring the range answers with the whole file, which is only fine if the whole
+    // file was requested.
+    return AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED;
+  }
+
+  // Reading the status line again rewinds the headers read for the Content-Range.
+  _az_RETURN_IF_FAILED(az_http_response_get_status_line(&response, &status_line));
+  int64_t content_length;
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_download_get_content_length(&response, &content_length));
+  if (content_length != -1 && content_length != size)
+  {
+    return AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED;
+  }
+
+  az_span body;
+  _az_RETURN_IF_FAILED(az_http_response_get_body(&response, &body));
+  int32_t const body_offset
+      = (int32_t)(az_span_ptr(body) - az_span_ptr(response._internal.http_response));
+  if (response._internal.written - body_offset != size)
+  {
+    return AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED;
+  }
+
+  *out_chunk = az_span_slice(body, 0, size);
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result _az_iot_adu_client_download_get_url(
+    _az_iot_adu_client_download_file_info const* file,
+    az_span url_buffer,
+    az_span* out_url)
+{
+  az_span const escaped_url = _az_iot_adu_client_download_find_url(file);
+  if (az_span_size(escaped_url) == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  // The urls of the update request are JSON strings, in which '/' may be escaped.
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(url_buffer, az_span_size(escaped_url));
+  *out_url = az_json_string_unescape(escaped_url, url_buffer);
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result _az_iot_adu_client_download_file(
+    _az_iot_adu_client_download_file_info const* file,
+    az_context* context,
+    az_span url_buffer,
+    az_span response_buffer,
+    az_iot_adu_client_download_sink sink,
+    void* sink_context,
+    az_iot_adu_client_download_options const* options)
+{
+  _az_PRECONDITION(file->size_in_bytes >= 0);
+  _az_PRECONDITION_NOT_NULL(context);
+  _az_PRECONDITION_VALID_SPAN(url_buffer, 1, false);
+  _az_PRECONDITION_VALID_SPAN(response_buffer, 1, false);
+  _az_PRECONDITION_NOT_NULL(sink);
+
+  az_iot_adu_client_download_options const download_options
+      = options == NULL ? az_iot_adu_client_download_options_default() : *options;
+  _az_PRECONDITION(download_options.chunk_size > 0);
+
+  az_span url;
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_download_get_url(file, url_buffer, &url));
+
+  uint8_t expected_digest[_az_IOT_SHA256_DIGEST_SIZE + 1];
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_download_get_expected_digest(
+      file, AZ_SPAN_FROM_BUFFER(expected_digest)));
+
+  _az_iot_sha256 sha256;
+  _az_iot_sha256_init(&sha256);
+
+  int64_t offset = 0;
+  while (offset < file->size_in_bytes)
+  {
+    int64_t const remaining = file->size_in_bytes - offset;
+    int32_t const chunk_size = remaining < download_options.chunk_size
+        ? (int32_t)remaining
+        : download_options.chunk_size;
+
+    az_span chunk;
+    _az_RETURN_IF_FAILED(_az_iot_adu_client_download_fetch(
+        url,
+        context,
+        &download_options,
+        response_buffer,
+        offset,
+        chunk_size,
+        offset == 0 && chunk_size == file->size_in_bytes,
+        &chunk));
+
+    _az_iot_sha256_update(&sha256, chunk);
+    _az_RETURN_IF_FAILED(sink(chunk, offset, sink_context));
+    offset += chunk_size;
+  }
+
+  return _az_iot_adu_client_download_check_digest(
+      &sha256, az_span_create(expected_digest, _az_IOT_SHA256_DIGEST_SIZE));
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_get_url(
+    az_iot_adu_client_update_request const* update_request,
+    az_iot_adu_client_update_manifest_file const* file,
+    az_span url_buffer,
+    az_span* out_url)
+{
+  _az_PRECONDITION_NOT_NULL(update_request);
+  _az_PRECONDITION_NOT_NULL(file);
+  _az_PRECONDITION_VALID_SPAN(url_buffer, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_url);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_file(update_request, file);
+  return _az_iot_adu_client_download_get_url(&download_file, url_buffer, out_url);
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_get_url_compact(
+    az_iot_adu_client_compact_update_request const* update_request,
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    az_span url_buffer,
+    az_span* out_url)
+{
+  _az_PRECONDITION_NOT_NULL(update_request);
+  _az_PRECONDITION_NOT_NULL(file);
+  _az_PRECONDITION_VALID_SPAN(url_buffer, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_url);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_compact_file(update_request, file);
+  return _az_iot_adu_client_download_get_url(&download_file, url_buffer, out_url);
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_file(
+    az_iot_adu_client_update_request const* update_request,
+    az_iot_adu_client_update_manifest_file const* file,
+    az_context* context,
+    az_span url_buffer,
+    az_span response_buffer,
+    az_iot_adu_client_download_sink sink,
+    void* sink_context,
+    az_iot_adu_client_download_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(update_request);
+  _az_PRECONDITION_NOT_NULL(file);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_file(update_request, file);
+  return _az_iot_adu_client_download_file(
+      &download_file, context, url_buffer, response_buffer, sink, sink_context, options);
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_file_compact(
+    az_iot_adu_client_compact_update_request const* update_request,
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    az_context* context,
+    az_span url_buffer,
+    az_span response_buffer,
+    az_iot_adu_client_download_sink sink,
+    void* sink_context,
+    az_iot_adu_client_download_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(update_request);
+  _az_PRECONDITION_NOT_NULL(file);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_compact_file(update_request, file);
+  return _az_iot_adu_client_download_file(
+      &download_file, context, url_buffer, response_buffer, sink, sink_context, options);
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_fetch_range(
+    az_span url,
+    az_iot_adu_client_download_range const* range,
+    az_context* context,
+    az_span response_buffer,
+    az_iot_adu_client_download_sink sink,
+    void* sink_context,
+    az_iot_adu_client_download_options const* options)
+{
+  _az_PRECONDITION_VALID_SPAN(url, 1, false);
+  _az_PRECONDITION_NOT_NULL(range);
+  _az_PRECONDITION_NOT_NULL(context);
+  _az_PRECONDITION_VALID_SPAN(response_buffer, 1, false);
+  _az_PRECONDITION_NOT_NULL(sink);
+
+  az_iot_adu_client_download_options const download_options
+      = options == NULL ? az_iot_adu_client_download_options_default() : *options;
+
+  az_span chunk;
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_download_fetch(
+      url,
+      context,
+      &download_options,
+      response_buffer,
+      range->offset,
+      range->size,
+      false,
+      &chunk));
+
+  return sink(chunk, range->offset, sink_context);
+}
+
+AZ_NODISCARD static az_result _az_iot_adu_client_download_verify_file(
+    _az_iot_adu_client_download_file_info const* file,
+    az_span buffer,
+    az_iot_adu_client_download_source source,
+    void* source_context)
+{
+  _az_PRECONDITION(file->size_in_bytes >= 0);
+  _az_PRECONDITION_VALID_SPAN(buffer, 1, false);
+  _az_PRECONDITION_NOT_NULL(source);
+
+  uint8_t expected_digest[_az_IOT_SHA256_DIGEST_SIZE + 1];
+  _az_RETURN_IF_FAILED(_az_iot_adu_client_download_get_expected_digest(
+      file, AZ_SPAN_FROM_BUFFER(expected_digest)));
+
+  _az_iot_sha256 sha256;
+  _az_iot_sha256_init(&sha256);
+
+  for (int64_t offset = 0; offset < file->size_in_bytes;)
+  {
+    int64_t const remaining = file->size_in_bytes - offset;
+    az_span const part = remaining < az_span_size(buffer)
+        ? az_span_slice(buffer, 0, (int32_t)remaining)
+        : buffer;
+
+    _az_RETURN_IF_FAILED(source(part, offset, source_context));
+    _az_iot_sha256_update(&sha256, part);
+    offset += az_span_size(part);
+  }
+
+  return _az_iot_adu_client_download_check_digest(
+      &sha256, az_span_create(expected_digest, _az_IOT_SHA256_DIGEST_SIZE));
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_verify_file(
+    az_iot_adu_client_update_manifest_file const* file,
+    az_span buffer,
+    az_iot_adu_client_download_source source,
+    void* source_context)
+{
+  _az_PRECONDITION_NOT_NULL(file);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_file(NULL, file);
+  return _az_iot_adu_client_download_verify_file(&download_file, buffer, source, source_context);
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_verify_file_compact(
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    az_span buffer,
+    az_iot_adu_client_download_source source,
+    void* source_context)
+{
+  _az_PRECONDITION_NOT_NULL(file);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_compact_file(NULL, file);
+  return _az_iot_adu_client_download_verify_file(&download_file, buffer, source, source_context);
+}
+
+// The progress bitmap has one bit per range, the lowest bit of the first byte for the first range.
+
+AZ_INLINE bool _az_iot_adu_client_download_scheduler_is_received(
+    az_iot_adu_client_download_scheduler const* scheduler,
+    int32_t index)
+{
+  return (az_span_ptr(scheduler->_internal.progress)[index / 8] & (1U << (index % 8))) != 0;
+}
+
+static int32_t _az_iot_adu_client_download_scheduler_find_in_flight(
+    az_iot_adu_client_download_scheduler const* scheduler,
+    int32_t index)
+{
+  for (int32_t i = 0; i < scheduler->_internal.in_flight_count; i++)
+  {
+    if (scheduler->_internal.in_flight[i] == index)
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// Removes a range from the ranges in flight, returning AZ_ERROR_ITEM_NOT_FOUND if it isn't there.
+AZ_NODISCARD static az_result _az_iot_adu_client_download_scheduler_remove_in_flight(
+    az_iot_adu_client_download_scheduler* ref_scheduler,
+    int32_t index)
+{
+  int32_t const position
+      = _az_iot_adu_client_download_scheduler_find_in_flight(ref_scheduler, index);
+  if (position < 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  ref_scheduler->_internal.in_flight_count--;
+  ref_scheduler->_internal.in_flight[position]
+      = ref_scheduler->_internal.in_flight[ref_scheduler->_internal.in_flight_count];
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result _az_iot_adu_client_download_scheduler_init(
+    az_iot_adu_client_download_scheduler* out_scheduler,
+    _az_iot_adu_client_download_file_info const* file,
+    int32_t range_size,
+    az_span progress,
+    bool resume)
+{
+  _az_PRECONDITION_NOT_NULL(out_scheduler);
+  _az_PRECONDITION(file->size_in_bytes >= 0);
+  _az_PRECONDITION(range_size > 0);
+  _az_PRECONDITION((file->size_in_bytes + range_size - 1) / range_size <= INT32_MAX);
+  _az_PRECONDITION_VALID_SPAN(
+      progress,
+      az_iot_adu_client_download_scheduler_get_progress_size(file->size_in_bytes, range_size),
+      false);
+
+  int32_t const range_count = (int32_t)((file->size_in_bytes + range_size - 1) / range_size);
+  int32_t const progress_size
+      = az_iot_adu_client_download_scheduler_get_progress_size(file->size_in_bytes, range_size);
+
+  *out_scheduler = (az_iot_adu_client_download_scheduler){
+    ._internal = {
+      .progress = az_span_slice(progress, 0, progress_size),
+      .file_size = file->size_in_bytes,
+      .range_size = range_size,
+      .range_count = range_count,
+      .received_count = 0,
+      .in_flight_count = 0,
+    },
+  };
+
+  if (!resume)
+  {
+    az_span_fill(out_scheduler->_internal.progress, 0);
+    return AZ_OK;
+  }
+
+  // Bits past the last range are ignored, then cleared.
+  uint8_t* progress_ptr = az_span_ptr(out_scheduler->_internal.progress);
+  if (range_count % 8 != 0)
+  {
+    progress_ptr[progress_size - 1] &= (uint8_t)((1U << (range_count % 8)) - 1U);
+  }
+
+  for (int32_t i = 0; i < progress_size; i++)
+  {
+    for (uint8_t bits = progress_ptr[i]; bits != 0; bits &= (uint8_t)(bits - 1))
+    {
+      out_scheduler->_internal.received_count++;
+    }
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_init(
+    az_iot_adu_client_download_scheduler* out_scheduler,
+    az_iot_adu_client_update_manifest_file const* file,
+    int32_t range_size,
+    az_span progress,
+    bool resume)
+{
+  _az_PRECONDITION_NOT_NULL(file);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_file(NULL, file);
+  return _az_iot_adu_client_download_scheduler_init(
+      out_scheduler, &download_file, range_size, progress, resume);
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_init_compact(
+    az_iot_adu_client_download_scheduler* out_scheduler,
+    az_iot_adu_client_compact_update_manifest_file const* file,
+    int32_t range_size,
+    az_span progress,
+    bool resume)
+{
+  _az_PRECONDITION_NOT_NULL(file);
+
+  _az_iot_adu_client_download_file_info const download_file
+      = _az_iot_adu_client_download_get_compact_file(NULL, file);
+  return _az_iot_adu_client_download_scheduler_init(
+      out_scheduler, &download_file, range_size, progress, resume);
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_next_range(
+    az_iot_adu_client_download_scheduler* ref_scheduler,
+    az_iot_adu_client_download_range* out_range)
+{
+  _az_PRECONDITION_NOT_NULL(ref_scheduler);
+  _az_PRECONDITION_NOT_NULL(out_range);
+
+  if (ref_scheduler->_internal.in_flight_count == _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  uint8_t const* progress_ptr = az_span_ptr(ref_scheduler->_internal.progress);
+  for (int32_t index = 0; index < ref_scheduler->_internal.range_count; index++)
+  {
+    // Skip the ranges received, eight at a time.
+    if (index % 8 == 0 && progress_ptr[index / 8] == 0xFF)
+    {
+      index += 7;
+      continue;
+    }
+
+    if (_az_iot_adu_client_download_scheduler_is_received(ref_scheduler, index)
+        || _az_iot_adu_client_download_scheduler_find_in_flight(ref_scheduler, index) >= 0)
+    {
+      continue;
+    }
+
+    int64_t const offset = (int64_t)index * ref_scheduler->_internal.range_size;
+    int64_t const remaining = ref_scheduler->_internal.file_size - offset;
+    *out_range = (az_iot_adu_client_download_range){
+      .offset = offset,
+      .size = remaining < ref_scheduler->_internal.range_size
+          ? (int32_t)remaining
+          : ref_scheduler->_internal.range_size,
+      .index = index,
+    };
+
+    ref_scheduler->_internal.in_flight[ref_scheduler->_internal.in_flight_count++] = index;
+    return AZ_OK;
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_complete_range(
+    az_iot_adu_client_download_scheduler* ref_scheduler,
+    az_iot_adu_client_download_range const* range)
+{
+  _az_PRECONDITION_NOT_NULL(ref_scheduler);
+  _az_PRECONDITION_NOT_NULL(range);
+
+  _az_RETURN_IF_FAILED(
+      _az_iot_adu_client_download_scheduler_remove_in_flight(ref_scheduler, range->index));
+
+  az_span_ptr(ref_scheduler->_internal.progress)[range->index / 8]
+      |= (uint8_t)(1U << (range->index % 8));
+  ref_scheduler->_internal.received_count++;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_adu_client_download_scheduler_release_range(
+    az_iot_adu_client_download_scheduler* ref_scheduler,
+    az_iot_adu_client_download_range const* range)
+{
+  _az_PRECONDITION_NOT_NULL(ref_scheduler);
+  _az_PRECONDITION_NOT_NULL(range);
+
+  return _az_iot_adu_client_download_scheduler_remove_in_flight(ref_scheduler, range->index);
+}
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 
+#include <azure/core/az_json.h>
 #include <azure/core/az_result.h>
 #include <azure/core/az_span.h>
 #include <azure/core/internal/az_precondition_internal.h>
@@ -217,3 +218,48 @@ _az_span_copy_url_encode(az_span destination, az_span source, az_span* out_remai
   *out_remainder = az_span_slice(destination, length, az_span_size(destination));
   return AZ_OK;
 }
+
+AZ_NODISCARD az_result
+_az_iot_json_reader_get_value_text(az_json_reader* ref_json_reader, az_span* out_json_text)
+{
+  uint8_t* start = az_span_ptr(ref_json_reader->token.slice);
+  int32_t size = az_span_size(ref_json_reader->token.slice);
+
+  switch (ref_json_reader->token.kind)
+  {
+    case AZ_JSON_TOKEN_STRING:
+      // The token excludes the quotes.
+      start--;
+      size += 2;
+      break;
+    case AZ_JSON_TOKEN_BEGIN_OBJECT:
+    case AZ_JSON_TOKEN_BEGIN_ARRAY:
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+      size = (int32_t)(az_span_ptr(ref_json_reader->token.slice) - start) + 1;
+      break;
+    default:
+      break;
+  }
+
+  *out_json_text = az_span_create(start, size);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result _az_iot_json_token_get_property_name(
+    az_json_token const* name_token,
+    char* name_buffer,
+    int32_t name_buffer_size,
+    az_span* out_name)
+{
+  if (!name_token->_internal.string_has_escaped_chars)
+  {
+    *out_name = name_token->slice;
+    return AZ_OK;
+  }
+
+  int32_t name_length = 0;
+  _az_RETURN_IF_FAILED(
+      az_json_token_get_string(name_token, name_buffer, name_buffer_size, &name_length));
+  *out_name = az_span_create((uint8_t*)name_buffer, name_length);
+  return AZ_OK;
+}
@@ -0,0 +1,225 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_hub_client_commands_dispatch.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+static const az_span commands_dispatch_separator = AZ_SPAN_LITERAL_FROM_STR("*");
+
+enum
+{
+  _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_EMPTY_BUCKET = -1,
+};
+
+// Commands are keyed by the method name IoT Hub sends for them: `{component}*{command}`, or the
+// command name alone for the root interface. The buckets form an open-addressing table with linear
+// probing over the hash of that name, so a received method name is hashed once and compared
+// against the commands sharing its hash only. Commands are never removed.
+
+AZ_INLINE uint32_t
+_az_iot_hub_client_commands_dispatch_hash(az_span component_name, az_span command_name)
+{
+  uint32_t hash = _az_IOT_FNV1A_OFFSET_BASIS;
+  if (az_span_size(component_name) > 0)
+  {
+    hash = _az_iot_fnv1a(_az_iot_fnv1a(hash, component_name), commands_dispatch_separator);
+  }
+  return _az_iot_fnv1a(hash, command_name);
+}
+
+AZ_INLINE bool _az_iot_hub_client_commands_dispatch_entry_matches(
+    az_iot_hub_client_commands_dispatch_entry const* entry,
+    uint32_t hash,
+    az_span method_name)
+{
+  if (entry->_internal.hash != hash)
+  {
+    return false;
+  }
+
+  int32_t const component_size = az_span_size(entry->_internal.component_name);
+  if (component_size == 0)
+  {
+    return az_span_is_content_equal(entry->_internal.command_name, method_name);
+  }
+
+  return az_span_size(method_name)
+      == component_size + 1 + az_span_size(entry->_internal.command_name)
+      && az_span_ptr(method_name)[component_size] == '*'
+      && az_span_is_content_equal(
+             az_span_slice(method_name, 0, component_size), entry->_internal.component_name)
+      && az_span_is_content_equal(
+             az_span_slice_to_end(method_name, component_size + 1),
+             entry->_internal.command_name);
+}
+
+// Returns the bucket holding the command, or the empty bucket that ends its probe sequence.
+static uint32_t _az_iot_hub_client_commands_dispatch_find_bucket(
+    az_iot_hub_client_commands_dispatch const* dispatch,
+    uint32_t hash,
+    az_span method_name)
+{
+  uint32_t const mask = dispatch->_internal.bucket_mask;
+  uint32_t bucket = hash & mask;
+
+  while (true)
+  {
+    int32_t const entry_index = dispatch->_internal.buckets[bucket];
+    if (entry_index == _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_EMPTY_BUCKET
+        || _az_iot_hub_client_commands_dispatch_entry_matches(
+            &dispatch->_internal.entries[entry_index], hash, method_name))
+    {
+      return bucket;
+    }
+    bucket = (bucket + 1U) & mask;
+  }
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_commands_dispatch_init(
+    az_iot_hub_client_commands_dispatch* out_dispatch,
+    az_iot_hub_client_commands_dispatch_entry entries[],
+    int32_t entries_capacity,
+    int32_t buckets[],
+    int32_t buckets_length)
+{
+  _az_PRECONDITION_NOT_NULL(out_dispatch);
+  _az_PRECONDITION_NOT_NULL(entries);
+  _az_PRECONDITION(entries_capacity > 0);
+  _az_PRECONDITION_NOT_NULL(buckets);
+  _az_PRECONDITION(buckets_length > entries_capacity);
+  _az_PRECONDITION((buckets_length & (buckets_length - 1)) == 0);
+
+  *out_dispatch = (az_iot_hub_client_commands_dispatch){
+    ._internal = {
+      .entries = entries,
+      .entries_capacity = entries_capacity,
+      .entries_length = 0,
+      .buckets = buckets,
+      .bucket_mask = (uint32_t)buckets_length - 1U,
+    },
+  };
+
+  for (int32_t i = 0; i < buckets_length; i++)
+  {
+    buckets[i] = _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_EMPTY_BUCKET;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_commands_dispatch_add(
+    az_iot_hub_client_commands_dispatch* ref_dispatch,
+    az_span component_name,
+    az_span command_name,
+    int32_t* out_command_index)
+{
+  _az_PRECONDITION_NOT_NULL(ref_dispatch);
+  _az_PRECONDITION_VALID_SPAN(command_name, 1, false);
+
+  if (ref_dispatch->_internal.entries_length == ref_dispatch->_internal.entries_capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  int32_t const entry_index = ref_dispatch->_internal.entries_length;
+  az_iot_hub_client_commands_dispatch_entry* const entry
+      = &ref_dispatch->_internal.entries[entry_index];
+  entry->_internal.component_name = component_name;
+  entry->_internal.command_name = command_name;
+  entry->_internal.hash = _az_iot_hub_client_commands_dispatch_hash(component_name, command_name);
+
+  // Look the new command up by its entry, as its method name isn't stored contiguously.
+  uint32_t const mask = ref_dispatch->_internal.bucket_mask;
+  uint32_t bucket = entry->_internal.hash & mask;
+  while (ref_dispatch->_internal.buckets[bucket]
+         != _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_EMPTY_BUCKET)
+  {
+    az_iot_hub_client_commands_dispatch_entry const* const other
+        = &ref_dispatch->_internal.entries[ref_dispatch->_internal.buckets[bucket]];
+    if (other->_internal.hash == entry->_internal.hash
+        && az_span_is_content_equal(other->_internal.component_name, component_name)
+        && az_span_is_content_equal(other->_internal.command_name, command_name))
+    {
+      return AZ_ERROR_ARG;
+    }
+    bucket = (bucket + 1U) & mask;
+  }
+
+  ref_dispatch->_internal.buckets[bucket] = entry_index;
+  ref_dispatch->_internal.entries_length++;
+
+  if (out_command_index != NULL)
+  {
+    *out_command_index = entry_index;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_commands_dispatch_parse_received_topic(
+    az_iot_hub_client_commands_dispatch const* dispatch,
+    az_iot_hub_client const* client,
+    az_span received_topic,
+    az_iot_hub_client_command_request* out_request,
+    int32_t* out_command_index)
+{
+  _az_PRECONDITION_NOT_NULL(dispatch);
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(received_topic, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_request);
+  _az_PRECONDITION_NOT_NULL(out_command_index);
+
+  az_iot_hub_client_method_request method_request;
+  _az_RETURN_IF_FAILED(
+      az_iot_hub_client_methods_parse_received_topic(client, received_topic, &method_request));
+
+  out_request->request_id = method_request.request_id;
+
+  uint32_t const bucket = _az_iot_hub_client_commands_dispatch_find_bucket(
+      dispatch,
+      _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, method_request.name),
+      method_request.name);
+  int32_t const entry_index = dispatch->_internal.buckets[bucket];
+
+  if (entry_index != _az_IOT_HUB_CLIENT_COMMANDS_DISPATCH_EMPTY_BUCKET)
+  {
+    // The registered names split the method name without searching for the separator.
+    az_iot_hub_client_commands_dispatch_entry const* const entry
+        = &dispatch->_internal.entries[entry_index];
+    int32_t const component_size = az_span_size(entry->_internal.component_name);
+    if (component_size > 0)
+    {
+      out_request->component_name = az_span_slice(method_request.name, 0, component_size);
+      out_request->command_name = az_span_slice_to_end(method_request.name, component_size + 1);
+    }
+    else
+    {
+      out_request->component_name = AZ_SPAN_EMPTY;
+      out_request->command_name = method_request.name;
+    }
+    *out_command_index = entry_index;
+    return AZ_OK;
+  }
+
+  int32_t const separator_index = az_span_find(method_request.name, commands_dispatch_separator);
+  if (separator_index > 0)
+  {
+    out_request->component_name = az_span_slice(method_request.name, 0, separator_index);
+    out_request->command_name = az_span_slice_to_end(method_request.name, separator_index + 1);
+  }
+  else
+  {
+    out_request->component_name = AZ_SPAN_EMPTY;
+    out_request->command_name = method_request.name;
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
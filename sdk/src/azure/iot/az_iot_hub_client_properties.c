@@ -9,6 +9,8 @@
 static const az_span iot_hub_properties_reported = AZ_SPAN_LITERAL_FROM_STR("reported");
 static const az_span iot_hub_properties_desired = AZ_SPAN_LITERAL_FROM_STR("desired");
 static const az_span iot_hub_properties_desired_version = AZ_SPAN_LITERAL_FROM_STR("$version");
+static const az_span iot_hub_properties_desired_version_path
+    = AZ_SPAN_LITERAL_FROM_STR("desired.$version");
 static const az_span properties_response_value_name = AZ_SPAN_LITERAL_FROM_STR("value");
 static const az_span properties_ack_code_name = AZ_SPAN_LITERAL_FROM_STR("ac");
 static const az_span properties_ack_version_name = AZ_SPAN_LITERAL_FROM_STR("av");
@@ -207,23 +209,22 @@ AZ_NODISCARD az_result az_iot_hub_client_properties_get_properties_version(
 
   _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
 
-  if (ref_json_reader->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
-  {
-    return AZ_ERROR_UNEXPECTED_CHAR;
-  }
+  // The version of a full twin is within its desired properties, which are the root of a patch.
+  az_span const version_path
+      = (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE)
+      ? iot_hub_properties_desired_version_path
+      : iot_hub_properties_desired_version;
 
-  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+  az_json_token version;
+  uint32_t found = 0;
+  _az_RETURN_IF_FAILED(az_json_query_read(ref_json_reader, &version_path, 1, &version, &found));
 
-  if (message_type == AZ_IOT_HUB_CLIENT_PROPERTIES_MESSAGE_TYPE_GET_RESPONSE)
+  if (found == 0)
   {
-    _az_RETURN_IF_FAILED(json_child_token_move(ref_json_reader, iot_hub_properties_desired));
-    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_json_reader));
+    return AZ_ERROR_ITEM_NOT_FOUND;
   }
 
-  _az_RETURN_IF_FAILED(json_child_token_move(ref_json_reader, iot_hub_properties_desired_version));
-  _az_RETURN_IF_FAILED(az_json_token_get_int32(&ref_json_reader->token, out_version));
-
-  return AZ_OK;
+  return az_json_token_get_int32(&version, out_version);
 }
 
 // process_first_move_if_needed performs initial setup when beginning to parse
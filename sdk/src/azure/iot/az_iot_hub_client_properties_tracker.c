@@ -0,0 +1,488 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_json.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_hub_client_properties.h>
+#include <azure/iot/az_iot_hub_client_properties_tracker.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+static const az_span tracker_component_label_name = AZ_SPAN_LITERAL_FROM_STR("__t");
+static const az_span tracker_component_label_value = AZ_SPAN_LITERAL_FROM_STR("c");
+static const az_span tracker_key_separator = AZ_SPAN_LITERAL_FROM_STR("/");
+
+enum
+{
+  // Property names with escape sequences are unescaped into a buffer of this size.
+  _az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_NAME_BUFFER_SIZE = 128,
+};
+
+// Hashes the key of a property, where root properties have an empty component name. The hash only
+// narrows the search: entries are matched on the names themselves.
+static uint32_t _az_properties_tracker_hash_key(az_span component_name, az_span name)
+{
+  uint32_t const component_hash = _az_iot_fnv1a(
+      _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, component_name), tracker_key_separator);
+  return _az_iot_fnv1a(component_hash, name);
+}
+
+// Finds the entry of a property of the acknowledged snapshot, or returns NULL for a new property.
+static az_iot_hub_client_properties_tracker_entry* _az_properties_tracker_find_entry(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_span component_name,
+    az_span name)
+{
+  az_iot_hub_client_properties_tracker_entry* const entries = ref_tracker->_internal.entries;
+  int32_t const length = ref_tracker->_internal.entries_length;
+  uint32_t const key_hash = _az_properties_tracker_hash_key(component_name, name);
+
+  // Snapshots list the properties in the same order every time, so the entry following the last
+  // one found is tried first.
+  int32_t index = ref_tracker->_internal.next_entry;
+  for (int32_t i = 0; i < length; i++)
+  {
+    if (index >= length)
+    {
+      index = 0;
+    }
+
+    az_iot_hub_client_properties_tracker_entry* const entry = &entries[index];
+    if (entry->_internal.key_hash == key_hash
+        && az_span_is_content_equal(entry->_internal.name, name)
+        && az_span_is_content_equal(entry->_internal.component_name, component_name))
+    {
+      ref_tracker->_internal.next_entry = index + 1;
+      return entry;
+    }
+
+    index++;
+  }
+
+  return NULL;
+}
+
+// Checks whether an object holds the properties of a component, given a reader at its beginning.
+// The component label is written first by az_iot_hub_client_properties_writer_begin_component().
+static AZ_NODISCARD bool _az_properties_tracker_is_component(az_json_reader const* object_reader)
+{
+  az_json_reader reader = *object_reader;
+
+  return az_result_succeeded(az_json_reader_next_token(&reader))
+      && reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME
+      && az_json_token_is_text_equal(&reader.token, tracker_component_label_name)
+      && az_result_succeeded(az_json_reader_next_token(&reader))
+      && reader.token.kind == AZ_JSON_TOKEN_STRING
+      && az_json_token_is_text_equal(&reader.token, tracker_component_label_value);
+}
+
+// Moves the reader to the last token of a property value, and gets the value if it differs from the
+// acknowledged one.
+static AZ_NODISCARD az_result _az_properties_tracker_get_changed_value(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_span component_name,
+    az_span name,
+    az_json_reader* ref_reader,
+    az_span* out_value)
+{
+  az_span value = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_iot_json_reader_get_value_text(ref_reader, &value));
+
+  az_iot_hub_client_properties_tracker_entry* const entry
+      = _az_properties_tracker_find_entry(ref_tracker, component_name, name);
+  if (entry != NULL)
+  {
+    entry->_internal.is_reported = true;
+    if (az_span_is_content_equal(entry->_internal.value, value))
+    {
+      *out_value = AZ_SPAN_EMPTY;
+      return AZ_OK;
+    }
+  }
+
+  *out_value = value;
+  return AZ_OK;
+}
+
+// Gets the unescaped text of a property name kept by an entry.
+static AZ_NODISCARD az_result
+_az_properties_tracker_unescape_name(az_span name, az_span name_buffer, az_span* out_name)
+{
+  if (az_span_find(name, AZ_SPAN_FROM_STR("\\")) == -1)
+  {
+    *out_name = name;
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(name_buffer, az_span_size(name));
+  *out_name = az_json_string_unescape(name, name_buffer);
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_properties_tracker_append_property(
+    az_json_writer* ref_writer,
+    az_json_token const* name_token,
+    az_span value)
+{
+  char name_buffer[_az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_NAME_BUFFER_SIZE];
+  az_span name = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_iot_json_token_get_property_name(
+      name_token, name_buffer, _az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_NAME_BUFFER_SIZE, &name));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, name));
+  return az_json_writer_append_json_text(ref_writer, value);
+}
+
+// Writes null for the acknowledged properties of a component that are missing from the snapshot, so
+// that IoT Hub removes them. The component is begun unless something was already written for it.
+// Root properties have an empty component name.
+static AZ_NODISCARD az_result _az_properties_tracker_append_removed_properties(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_iot_hub_client const* client,
+    az_span component_name,
+    az_json_writer* ref_writer,
+    bool* ref_is_written)
+{
+  uint8_t name_buffer[_az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_NAME_BUFFER_SIZE];
+  az_span name = AZ_SPAN_EMPTY;
+
+  for (int32_t i = 0; i < ref_tracker->_internal.entries_length; i++)
+  {
+    az_iot_hub_client_properties_tracker_entry* const entry = &ref_tracker->_internal.entries[i];
+    if (entry->_internal.is_reported
+        || !az_span_is_content_equal(entry->_internal.component_name, component_name))
+    {
+      continue;
+    }
+
+    if (az_span_size(component_name) > 0 && !*ref_is_written)
+    {
+      _az_RETURN_IF_FAILED(_az_properties_tracker_unescape_name(
+          component_name, AZ_SPAN_FROM_BUFFER(name_buffer), &name));
+      _az_RETURN_IF_FAILED(
+          az_iot_hub_client_properties_writer_begin_component(client, ref_writer, name));
+    }
+
+    _az_RETURN_IF_FAILED(_az_properties_tracker_unescape_name(
+        entry->_internal.name, AZ_SPAN_FROM_BUFFER(name_buffer), &name));
+    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, name));
+    _az_RETURN_IF_FAILED(az_json_writer_append_null(ref_writer));
+    entry->_internal.is_reported = true;
+    *ref_is_written = true;
+  }
+
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_properties_tracker_write_patch(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_iot_hub_client const* client,
+    az_span snapshot,
+    az_json_writer* ref_writer,
+    bool* out_has_changes)
+{
+  char component_name_buffer[_az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_NAME_BUFFER_SIZE];
+  az_span component_name = AZ_SPAN_EMPTY;
+  az_span value = AZ_SPAN_EMPTY;
+  int32_t properties_length = 0;
+
+  *out_has_changes = false;
+
+  for (int32_t i = 0; i < ref_tracker->_internal.entries_length; i++)
+  {
+    ref_tracker->_internal.entries[i]._internal.is_reported = false;
+  }
+
+  az_json_reader reader;
+  _az_RETURN_IF_FAILED(az_json_reader_init(&reader, snapshot, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  if (reader.token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_writer));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+  while (reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    az_json_token const name_token = reader.token;
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+    if (reader.token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT
+        && _az_properties_tracker_is_component(&reader))
+    {
+      // The component is only written to the patch once one of its properties changed.
+      bool is_component_written = false;
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+      while (reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+      {
+        az_json_token const property_name_token = reader.token;
+        bool const is_label
+            = az_json_token_is_text_equal(&property_name_token, tracker_component_label_name);
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+        if (!is_label)
+        {
+          if (++properties_length > ref_tracker->_internal.entries_capacity)
+          {
+            return AZ_ERROR_NOT_ENOUGH_SPACE;
+          }
+          _az_RETURN_IF_FAILED(_az_properties_tracker_get_changed_value(
+              ref_tracker, name_token.slice, property_name_token.slice, &reader, &value));
+          if (az_span_size(value) > 0)
+          {
+            if (!is_component_written)
+            {
+              _az_RETURN_IF_FAILED(_az_iot_json_token_get_property_name(
+                  &name_token,
+                  component_name_buffer,
+                  _az_IOT_HUB_CLIENT_PROPERTIES_TRACKER_NAME_BUFFER_SIZE,
+                  &component_name));
+              _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_begin_component(
+                  client, ref_writer, component_name));
+              is_component_written = true;
+            }
+            _az_RETURN_IF_FAILED(
+                _az_properties_tracker_append_property(ref_writer, &property_name_token, value));
+          }
+        }
+
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+      }
+
+      _az_RETURN_IF_FAILED(_az_properties_tracker_append_removed_properties(
+          ref_tracker, client, name_token.slice, ref_writer, &is_component_written));
+
+      if (is_component_written)
+      {
+        _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_end_component(client, ref_writer));
+        *out_has_changes = true;
+      }
+    }
+    else
+    {
+      if (++properties_length > ref_tracker->_internal.entries_capacity)
+      {
+        return AZ_ERROR_NOT_ENOUGH_SPACE;
+      }
+      _az_RETURN_IF_FAILED(_az_properties_tracker_get_changed_value(
+          ref_tracker, AZ_SPAN_EMPTY, name_token.slice, &reader, &value));
+      if (az_span_size(value) > 0)
+      {
+        _az_RETURN_IF_FAILED(
+            _az_properties_tracker_append_property(ref_writer, &name_token, value));
+        *out_has_changes = true;
+      }
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  }
+
+  // The root properties missing from the snapshot, then the components missing from it.
+  _az_RETURN_IF_FAILED(_az_properties_tracker_append_removed_properties(
+      ref_tracker, client, AZ_SPAN_EMPTY, ref_writer, out_has_changes));
+
+  for (int32_t i = 0; i < ref_tracker->_internal.entries_length; i++)
+  {
+    az_iot_hub_client_properties_tracker_entry const* const entry
+        = &ref_tracker->_internal.entries[i];
+    if (!entry->_internal.is_reported)
+    {
+      bool is_component_written = false;
+      _az_RETURN_IF_FAILED(_az_properties_tracker_append_removed_properties(
+          ref_tracker, client, entry->_internal.component_name, ref_writer, &is_component_written));
+      _az_RETURN_IF_FAILED(az_iot_hub_client_properties_writer_end_component(client, ref_writer));
+      *out_has_changes = true;
+    }
+  }
+
+  return az_json_writer_append_end_object(ref_writer);
+}
+
+// Adds the entry of a property of the acknowledged snapshot, given a reader at its value.
+static AZ_NODISCARD az_result _az_properties_tracker_add_entry(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_span component_name,
+    az_span name,
+    az_json_reader* ref_reader)
+{
+  int32_t const length = ref_tracker->_internal.entries_length;
+  if (length == ref_tracker->_internal.entries_capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_span value = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_iot_json_reader_get_value_text(ref_reader, &value));
+
+  ref_tracker->_internal.entries[length] = (az_iot_hub_client_properties_tracker_entry){
+    ._internal = {
+      .component_name = component_name,
+      .name = name,
+      .value = value,
+      .key_hash = _az_properties_tracker_hash_key(component_name, name),
+      .is_reported = false,
+    },
+  };
+  ref_tracker->_internal.entries_length++;
+  return AZ_OK;
+}
+
+// Indexes the properties of the acknowledged snapshot. The snapshot was read without error by
+// _az_properties_tracker_write_patch(), so this doesn't fail.
+static AZ_NODISCARD az_result
+_az_properties_tracker_load_entries(az_iot_hub_client_properties_tracker* ref_tracker)
+{
+  ref_tracker->_internal.entries_length = 0;
+  ref_tracker->_internal.next_entry = 0;
+
+  az_json_reader reader;
+  _az_RETURN_IF_FAILED(az_json_reader_init(
+      &reader,
+      az_span_slice(
+          ref_tracker->_internal.acknowledged_buffer, 0, ref_tracker->_internal.acknowledged_size),
+      NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+  while (reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    az_span const name = reader.token.slice;
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+    if (reader.token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT
+        && _az_properties_tracker_is_component(&reader))
+    {
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+      while (reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+      {
+        az_json_token const property_name_token = reader.token;
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+        if (!az_json_token_is_text_equal(&property_name_token, tracker_component_label_name))
+        {
+          _az_RETURN_IF_FAILED(_az_properties_tracker_add_entry(
+              ref_tracker, name, property_name_token.slice, &reader));
+        }
+
+        _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+      }
+    }
+    else
+    {
+      _az_RETURN_IF_FAILED(
+          _az_properties_tracker_add_entry(ref_tracker, AZ_SPAN_EMPTY, name, &reader));
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_tracker_init(
+    az_iot_hub_client_properties_tracker* out_tracker,
+    az_iot_hub_client_properties_tracker_entry entries[],
+    int32_t entries_capacity,
+    az_span snapshot_buffer)
+{
+  _az_PRECONDITION_NOT_NULL(out_tracker);
+  _az_PRECONDITION_NOT_NULL(entries);
+  _az_PRECONDITION(entries_capacity > 0);
+  _az_PRECONDITION_VALID_SPAN(snapshot_buffer, 2, false);
+
+  // One half keeps the acknowledged snapshot, the other one the snapshot of the patch in flight.
+  int32_t const half_size = az_span_size(snapshot_buffer) / 2;
+
+  *out_tracker = (az_iot_hub_client_properties_tracker){
+    ._internal = {
+      .entries = entries,
+      .entries_capacity = entries_capacity,
+      .entries_length = 0,
+      .next_entry = 0,
+      .acknowledged_buffer = az_span_slice(snapshot_buffer, 0, half_size),
+      .pending_buffer = az_span_slice(snapshot_buffer, half_size, 2 * half_size),
+      .acknowledged_size = 0,
+      .pending_size = 0,
+      .is_patch_in_flight = false,
+    },
+  };
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_properties_tracker_get_patch(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_iot_hub_client const* client,
+    az_span snapshot,
+    az_span patch_buffer,
+    az_span* out_patch)
+{
+  _az_PRECONDITION_NOT_NULL(ref_tracker);
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(snapshot, 1, false);
+  _az_PRECONDITION_VALID_SPAN(patch_buffer, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_patch);
+
+  *out_patch = AZ_SPAN_EMPTY;
+
+  if (ref_tracker->_internal.is_patch_in_flight)
+  {
+    // The changes are coalesced into the patch following the response.
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(ref_tracker->_internal.pending_buffer, az_span_size(snapshot));
+
+  az_json_writer writer;
+  _az_RETURN_IF_FAILED(az_json_writer_init(&writer, patch_buffer, NULL));
+
+  bool has_changes = false;
+  _az_RETURN_IF_FAILED(
+      _az_properties_tracker_write_patch(ref_tracker, client, snapshot, &writer, &has_changes));
+
+  if (has_changes)
+  {
+    // The snapshot becomes the acknowledged one once IoT Hub accepts the patch.
+    az_span_copy(ref_tracker->_internal.pending_buffer, snapshot);
+    ref_tracker->_internal.pending_size = az_span_size(snapshot);
+    ref_tracker->_internal.is_patch_in_flight = true;
+    *out_patch = az_json_writer_get_bytes_used_in_destination(&writer);
+  }
+
+  return AZ_OK;
+}
+
+void az_iot_hub_client_properties_tracker_complete(
+    az_iot_hub_client_properties_tracker* ref_tracker,
+    az_iot_status status)
+{
+  _az_PRECONDITION_NOT_NULL(ref_tracker);
+
+  if (ref_tracker->_internal.is_patch_in_flight && az_iot_status_succeeded(status))
+  {
+    az_span const acknowledged_buffer = ref_tracker->_internal.pending_buffer;
+    ref_tracker->_internal.pending_buffer = ref_tracker->_internal.acknowledged_buffer;
+    ref_tracker->_internal.acknowledged_buffer = acknowledged_buffer;
+    ref_tracker->_internal.acknowledged_size = ref_tracker->_internal.pending_size;
+
+    if (az_result_failed(_az_properties_tracker_load_entries(ref_tracker)))
+    {
+      // Not reached: everything is reported again rather than keeping entries of a partial index.
+      ref_tracker->_internal.acknowledged_size = 0;
+      ref_tracker->_internal.entries_length = 0;
+    }
+  }
+
+  // On failure, the acknowledged snapshot is unchanged and the patch is written again.
+  ref_tracker->_internal.is_patch_in_flight = false;
+}
@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_json.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_hub_client_telemetry_batch.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  _az_IOT_HUB_CLIENT_TELEMETRY_BATCH_DEFAULT_LINGER_MSEC = 1000,
+};
+
+AZ_NODISCARD az_iot_hub_client_telemetry_batch_options
+az_iot_hub_client_telemetry_batch_options_default(void)
+{
+  return (az_iot_hub_client_telemetry_batch_options){
+    .max_payload_size = AZ_IOT_HUB_CLIENT_TELEMETRY_BATCH_DEFAULT_MAX_PAYLOAD_SIZE,
+    .linger_msec = _az_IOT_HUB_CLIENT_TELEMETRY_BATCH_DEFAULT_LINGER_MSEC,
+  };
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_init(
+    az_iot_hub_client_telemetry_batch* out_batch,
+    az_span payload_buffer,
+    az_span properties_buffer,
+    az_iot_hub_client_telemetry_batch_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_batch);
+  _az_PRECONDITION_VALID_SPAN(payload_buffer, 1, false);
+  _az_PRECONDITION_VALID_SPAN(properties_buffer, 0, true);
+
+  *out_batch = (az_iot_hub_client_telemetry_batch){
+    ._internal = {
+      .properties_buffer = properties_buffer,
+      .options = options == NULL ? az_iot_hub_client_telemetry_batch_options_default() : *options,
+      .first_reading_msec = 0,
+      .count = 0,
+    },
+  };
+
+  _az_PRECONDITION(out_batch->_internal.options.max_payload_size > 0);
+  _az_PRECONDITION(out_batch->_internal.options.linger_msec >= 0);
+
+  // The payload can't be larger than the buffer it is written to.
+  if (out_batch->_internal.options.max_payload_size > az_span_size(payload_buffer))
+  {
+    out_batch->_internal.options.max_payload_size = az_span_size(payload_buffer);
+  }
+
+  _az_RETURN_IF_FAILED(az_json_writer_init(&out_batch->_internal.writer, payload_buffer, NULL));
+
+  return az_iot_hub_client_telemetry_batch_reset(out_batch);
+}
+
+AZ_NODISCARD az_result
+az_iot_hub_client_telemetry_batch_reset(az_iot_hub_client_telemetry_batch* ref_batch)
+{
+  _az_PRECONDITION_NOT_NULL(ref_batch);
+
+  if (az_span_size(ref_batch->_internal.properties_buffer) > 0)
+  {
+    _az_RETURN_IF_FAILED(az_iot_message_properties_init(
+        &ref_batch->_internal.properties, ref_batch->_internal.properties_buffer, 0));
+  }
+
+  az_span const payload_buffer = ref_batch->_internal.writer._internal.destination_buffer;
+  _az_RETURN_IF_FAILED(az_json_writer_init(&ref_batch->_internal.writer, payload_buffer, NULL));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(&ref_batch->_internal.writer));
+
+  ref_batch->_internal.count = 0;
+  ref_batch->_internal.first_reading_msec = 0;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_append(
+    az_iot_hub_client_telemetry_batch* ref_batch,
+    az_span json_reading)
+{
+  _az_PRECONDITION_NOT_NULL(ref_batch);
+  _az_PRECONDITION_VALID_SPAN(json_reading, 1, false);
+
+  int64_t now = ref_batch->_internal.first_reading_msec;
+  if (ref_batch->_internal.count == 0)
+  {
+    _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+  }
+
+  // Write the reading into a copy of the writer, so that the batch is unchanged if the reading is
+  // invalid or doesn't fit.
+  az_json_writer writer = ref_batch->_internal.writer;
+  _az_RETURN_IF_FAILED(az_json_writer_append_json_text(&writer, json_reading));
+
+  // Leave room for the closing bracket.
+  if (az_span_size(az_json_writer_get_bytes_used_in_destination(&writer))
+      >= ref_batch->_internal.options.max_payload_size)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  ref_batch->_internal.writer = writer;
+  ref_batch->_internal.first_reading_msec = now;
+  ref_batch->_internal.count++;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_should_publish(
+    az_iot_hub_client_telemetry_batch const* batch,
+    bool* out_should_publish)
+{
+  _az_PRECONDITION_NOT_NULL(batch);
+  _az_PRECONDITION_NOT_NULL(out_should_publish);
+
+  *out_should_publish = false;
+
+  if (batch->_internal.count == 0)
+  {
+    return AZ_OK;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  *out_should_publish
+      = now - batch->_internal.first_reading_msec >= batch->_internal.options.linger_msec;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_batch_get_publish_message(
+    az_iot_hub_client_telemetry_batch const* batch,
+    az_iot_hub_client const* client,
+    char* mqtt_topic,
+    size_t mqtt_topic_size,
+    size_t* out_mqtt_topic_length,
+    az_span* out_payload)
+{
+  _az_PRECONDITION_NOT_NULL(batch);
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_NOT_NULL(mqtt_topic);
+  _az_PRECONDITION(mqtt_topic_size > 0);
+  _az_PRECONDITION_NOT_NULL(out_payload);
+
+  if (batch->_internal.count == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  _az_RETURN_IF_FAILED(az_iot_hub_client_telemetry_get_publish_topic(
+      client,
+      az_span_size(batch->_internal.properties_buffer) > 0 ? &batch->_internal.properties : NULL,
+      mqtt_topic,
+      mqtt_topic_size,
+      out_mqtt_topic_length));
+
+  // Close the array in a copy of the writer, so that readings can still be appended after it.
+  az_json_writer writer = batch->_internal.writer;
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_array(&writer));
+
+  *out_payload = az_json_writer_get_bytes_used_in_destination(&writer);
+
+  return AZ_OK;
+}
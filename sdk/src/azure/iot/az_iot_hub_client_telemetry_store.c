@@ -0,0 +1,536 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_hub_client_telemetry_store.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <azure/core/_az_cfg.h>
+
+// Layout of the buffer:
+//
+//   [header slot 0][header slot 1][record][record]...[wrap marker]  ...free...  [record]...
+//
+// The header slots record where the oldest message is. They are written alternately, so that a
+// torn header write leaves the other slot intact, and the slot with the higher generation wins.
+// Each record is followed by the next one, with consecutive sequence numbers; a record that does
+// not fit before the end of the buffer starts over at the beginning of the ring, after a wrap
+// marker when there is room for one. Recovery walks the records from the head until one is
+// missing, torn, or stale.
+//
+// Since recovery starts from the durable head, space freed by removing or evicting messages is
+// only reused once the header that no longer references it has been synced.
+
+enum
+{
+  _az_TELEMETRY_STORE_HEADER_MAGIC = 0x41545348, // "HSTA"
+  _az_TELEMETRY_STORE_RECORD_MAGIC = 0x41545352, // "RSTA"
+  _az_TELEMETRY_STORE_WRAP_MAGIC = 0x41545357, // "WSTA"
+  _az_TELEMETRY_STORE_RECORD_ALIGNMENT = 4,
+  _az_TELEMETRY_STORE_DEFAULT_SYNC_INTERVAL = 16,
+};
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t generation;
+  uint32_t head;
+  uint32_t head_sequence;
+  uint32_t buffer_size;
+  uint32_t crc;
+} _az_telemetry_store_header;
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t sequence;
+  uint32_t topic_size; // Includes the null terminator.
+  uint32_t payload_size;
+  uint32_t crc;
+} _az_telemetry_store_record_header;
+
+#define _az_TELEMETRY_STORE_RING_START ((int32_t)(2 * sizeof(_az_telemetry_store_header)))
+#define _az_TELEMETRY_STORE_RECORD_HEADER_SIZE ((int32_t)sizeof(_az_telemetry_store_record_header))
+
+// CRC-32 (IEEE 802.3), computed a nibble at a time to keep the table small.
+static uint32_t _az_telemetry_store_crc32(uint32_t crc, uint8_t const* data, int32_t size)
+{
+  static uint32_t const table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+    0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+  };
+
+  crc = ~crc;
+  for (int32_t i = 0; i < size; i++)
+  {
+    crc = (crc >> 4U) ^ table[(crc ^ data[i]) & 0x0FU];
+    crc = (crc >> 4U) ^ table[(crc ^ ((uint32_t)data[i] >> 4U)) & 0x0FU];
+  }
+  return ~crc;
+}
+
+AZ_INLINE uint8_t*
+_az_telemetry_store_at(az_iot_hub_client_telemetry_store const* store, int32_t offset)
+{
+  return az_span_ptr(store->_internal.buffer) + offset;
+}
+
+AZ_INLINE int32_t _az_telemetry_store_get_record_size(uint32_t topic_size, uint32_t payload_size)
+{
+  int64_t const size = (int64_t)_az_TELEMETRY_STORE_RECORD_HEADER_SIZE + topic_size + payload_size;
+  int64_t const aligned = (size + _az_TELEMETRY_STORE_RECORD_ALIGNMENT - 1)
+      & ~(int64_t)(_az_TELEMETRY_STORE_RECORD_ALIGNMENT - 1);
+  return aligned > INT32_MAX ? INT32_MAX : (int32_t)aligned;
+}
+
+static uint32_t _az_telemetry_store_get_header_crc(_az_telemetry_store_header const* header)
+{
+  return _az_telemetry_store_crc32(
+      0, (uint8_t const*)header, (int32_t)offsetof(_az_telemetry_store_header, crc));
+}
+
+// The record CRC covers the sequence, the sizes and the data, so stale records from a previous
+// pass over the ring, and records whose data was only partially written, are rejected.
+static uint32_t _az_telemetry_store_get_record_crc(
+    az_iot_hub_client_telemetry_store const* store,
+    _az_telemetry_store_record_header const* header,
+    int32_t offset)
+{
+  uint32_t const crc = _az_telemetry_store_crc32(
+      0,
+      (uint8_t const*)&header->sequence,
+      (int32_t)(offsetof(_az_telemetry_store_record_header, crc)
+                - offsetof(_az_telemetry_store_record_header, sequence)));
+
+  return _az_telemetry_store_crc32(
+      crc,
+      _az_telemetry_store_at(store, offset + _az_TELEMETRY_STORE_RECORD_HEADER_SIZE),
+      (int32_t)(header->topic_size + header->payload_size));
+}
+
+// The buffer might not be aligned for the header structures, so they are copied in and out.
+AZ_INLINE _az_telemetry_store_record_header _az_telemetry_store_read_record_header(
+    az_iot_hub_client_telemetry_store const* store,
+    int32_t offset)
+{
+  _az_telemetry_store_record_header header;
+  memcpy(&header, _az_telemetry_store_at(store, offset), sizeof(header));
+  return header;
+}
+
+static void _az_telemetry_store_write_record_header(
+    az_iot_hub_client_telemetry_store* ref_store,
+    int32_t offset,
+    _az_telemetry_store_record_header const* header)
+{
+  memcpy(_az_telemetry_store_at(ref_store, offset), header, sizeof(*header));
+}
+
+// Records left in the buffer by a previous store keep valid CRCs, and one in sequence with the new
+// head would be recovered as a live message, so the whole buffer is cleared.
+static void _az_telemetry_store_format(az_iot_hub_client_telemetry_store* ref_store)
+{
+  az_span_fill(ref_store->_internal.buffer, 0);
+
+  ref_store->_internal.head = _az_TELEMETRY_STORE_RING_START;
+  ref_store->_internal.tail = _az_TELEMETRY_STORE_RING_START;
+  ref_store->_internal.wrap = az_span_size(ref_store->_internal.buffer);
+  ref_store->_internal.count = 0;
+  ref_store->_internal.head_sequence = 1;
+  ref_store->_internal.generation = 0;
+  ref_store->_internal.head_dirty = true;
+}
+
+static bool _az_telemetry_store_read_header(
+    az_iot_hub_client_telemetry_store const* store,
+    int32_t slot,
+    _az_telemetry_store_header* out_header)
+{
+  memcpy(
+      out_header,
+      _az_telemetry_store_at(store, slot * (int32_t)sizeof(*out_header)),
+      sizeof(*out_header));
+
+  int32_t const buffer_size = az_span_size(store->_internal.buffer);
+  return out_header->magic == _az_TELEMETRY_STORE_HEADER_MAGIC
+      && out_header->crc == _az_telemetry_store_get_header_crc(out_header)
+      && out_header->buffer_size == (uint32_t)buffer_size
+      && out_header->head >= (uint32_t)_az_TELEMETRY_STORE_RING_START
+      && out_header->head <= (uint32_t)buffer_size;
+}
+
+// Walks the records from the durable head, accepting records while they are intact and in
+// sequence.
+static void _az_telemetry_store_recover(
+    az_iot_hub_client_telemetry_store* ref_store,
+    _az_telemetry_store_header const* header)
+{
+  int32_t const end = az_span_size(ref_store->_internal.buffer);
+  int32_t const head = (int32_t)header->head;
+  uint32_t expected_sequence = header->head_sequence;
+  int32_t position = head;
+  int32_t wrap = end;
+  bool wrapped = false;
+  int32_t count = 0;
+
+  while (true)
+  {
+    bool wrap_here = end - position < _az_TELEMETRY_STORE_RECORD_HEADER_SIZE;
+
+    if (!wrap_here)
+    {
+      _az_telemetry_store_record_header const record
+          = _az_telemetry_store_read_record_header(ref_store, position);
+
+      if (record.magic == _az_TELEMETRY_STORE_WRAP_MAGIC && record.sequence == expected_sequence
+          && record.topic_size == 0 && record.payload_size == 0
+          && record.crc == _az_telemetry_store_get_record_crc(ref_store, &record, position))
+      {
+        wrap_here = true;
+      }
+      else
+      {
+        int32_t const limit = wrapped ? head : end;
+        if (record.magic != _az_TELEMETRY_STORE_RECORD_MAGIC
+            || record.sequence != expected_sequence || record.topic_size == 0
+            || record.topic_size > (uint32_t)(limit - position)
+            || record.payload_size > (uint32_t)(limit - position))
+        {
+          break;
+        }
+
+        int32_t const size = _az_telemetry_store_get_record_size(
+            record.topic_size, record.payload_size);
+        if (size > limit - position
+            || *_az_telemetry_store_at(
+                   ref_store,
+                   position + _az_TELEMETRY_STORE_RECORD_HEADER_SIZE + (int32_t)record.topic_size
+                       - 1)
+                != '\0'
+            || record.crc != _az_telemetry_store_get_record_crc(ref_store, &record, position))
+        {
+          break;
+        }
+
+        position += size;
+        expected_sequence++;
+        count++;
+        continue;
+      }
+    }
+
+    // Only one wrap is possible: the second pass stops at the head.
+    if (wrapped || position == _az_TELEMETRY_STORE_RING_START)
+    {
+      break;
+    }
+    wrapped = true;
+    wrap = position;
+    position = _az_TELEMETRY_STORE_RING_START;
+  }
+
+  ref_store->_internal.generation = header->generation;
+  ref_store->_internal.head_sequence = header->head_sequence;
+  ref_store->_internal.count = count;
+  ref_store->_internal.head_dirty = false;
+
+  if (count == 0)
+  {
+    ref_store->_internal.head = _az_TELEMETRY_STORE_RING_START;
+    ref_store->_internal.tail = _az_TELEMETRY_STORE_RING_START;
+    ref_store->_internal.wrap = end;
+    ref_store->_internal.head_dirty = head != _az_TELEMETRY_STORE_RING_START;
+  }
+  else if (head == wrap)
+  {
+    // The head record itself is past the wrap.
+    ref_store->_internal.head = _az_TELEMETRY_STORE_RING_START;
+    ref_store->_internal.tail = position;
+    ref_store->_internal.wrap = end;
+    ref_store->_internal.head_dirty = true;
+  }
+  else
+  {
+    ref_store->_internal.head = head;
+    ref_store->_internal.tail = position;
+    ref_store->_internal.wrap = wrap;
+  }
+}
+
+static void _az_telemetry_store_remove_oldest(az_iot_hub_client_telemetry_store* ref_store)
+{
+  _az_telemetry_store_record_header const record
+      = _az_telemetry_store_read_record_header(ref_store, ref_store->_internal.head);
+
+  ref_store->_internal.head
+      += _az_telemetry_store_get_record_size(record.topic_size, record.payload_size);
+  ref_store->_internal.head_sequence++;
+  ref_store->_internal.count--;
+  ref_store->_internal.head_dirty = true;
+
+  if (ref_store->_internal.head == ref_store->_internal.wrap)
+  {
+    ref_store->_internal.head = _az_TELEMETRY_STORE_RING_START;
+    ref_store->_internal.wrap = az_span_size(ref_store->_internal.buffer);
+  }
+}
+
+AZ_NODISCARD az_iot_hub_client_telemetry_store_options
+az_iot_hub_client_telemetry_store_options_default(void)
+{
+  return (az_iot_hub_client_telemetry_store_options){
+    .sync_callback = NULL,
+    .sync_context = NULL,
+    .sync_interval = _az_TELEMETRY_STORE_DEFAULT_SYNC_INTERVAL,
+  };
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_store_init(
+    az_iot_hub_client_telemetry_store* out_store,
+    az_span buffer,
+    az_iot_hub_client_telemetry_store_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_store);
+  _az_PRECONDITION_VALID_SPAN(buffer, 0, false);
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(buffer, AZ_IOT_HUB_CLIENT_TELEMETRY_STORE_MIN_BUFFER_SIZE);
+
+  *out_store = (az_iot_hub_client_telemetry_store){
+    ._internal = {
+      .buffer = buffer,
+      .options = options == NULL ? az_iot_hub_client_telemetry_store_options_default() : *options,
+    },
+  };
+
+  _az_PRECONDITION(out_store->_internal.options.sync_interval >= 0);
+
+  _az_telemetry_store_header headers[2];
+  bool const valid0 = _az_telemetry_store_read_header(out_store, 0, &headers[0]);
+  bool const valid1 = _az_telemetry_store_read_header(out_store, 1, &headers[1]);
+
+  if (valid0 && valid1)
+  {
+    _az_telemetry_store_recover(
+        out_store,
+        (int32_t)(headers[1].generation - headers[0].generation) > 0 ? &headers[1] : &headers[0]);
+  }
+  else if (valid0 || valid1)
+  {
+    _az_telemetry_store_recover(out_store, valid0 ? &headers[0] : &headers[1]);
+  }
+  else
+  {
+    _az_telemetry_store_format(out_store);
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_iot_hub_client_telemetry_store_sync(az_iot_hub_client_telemetry_store* ref_store)
+{
+  _az_PRECONDITION_NOT_NULL(ref_store);
+
+  bool const head_dirty = ref_store->_internal.head_dirty;
+  if (head_dirty)
+  {
+    ref_store->_internal.generation++;
+
+    _az_telemetry_store_header header = {
+      .magic = _az_TELEMETRY_STORE_HEADER_MAGIC,
+      .generation = ref_store->_internal.generation,
+      .head = (uint32_t)ref_store->_internal.head,
+      .head_sequence = ref_store->_internal.head_sequence,
+      .buffer_size = (uint32_t)az_span_size(ref_store->_internal.buffer),
+      .crc = 0,
+    };
+    header.crc = _az_telemetry_store_get_header_crc(&header);
+
+    memcpy(
+        _az_telemetry_store_at(
+            ref_store, (int32_t)(header.generation & 1U) * (int32_t)sizeof(header)),
+        &header,
+        sizeof(header));
+    ref_store->_internal.head_dirty = false;
+  }
+
+  if (ref_store->_internal.options.sync_callback != NULL)
+  {
+    az_result const result
+        = ref_store->_internal.options.sync_callback(ref_store->_internal.options.sync_context);
+    if (az_result_failed(result))
+    {
+      // Rewrite the same header slot next time, leaving the previous durable header intact.
+      if (head_dirty)
+      {
+        ref_store->_internal.generation--;
+        ref_store->_internal.head_dirty = true;
+      }
+      return result;
+    }
+  }
+
+  ref_store->_internal.unsynced_count = 0;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_store_append(
+    az_iot_hub_client_telemetry_store* ref_store,
+    az_span topic,
+    az_span payload)
+{
+  _az_PRECONDITION_NOT_NULL(ref_store);
+  _az_PRECONDITION_VALID_SPAN(topic, 1, false);
+  _az_PRECONDITION_VALID_SPAN(payload, 0, true);
+
+  int32_t const end = az_span_size(ref_store->_internal.buffer);
+  uint32_t const topic_size = (uint32_t)az_span_size(topic) + 1U;
+  uint32_t const payload_size = (uint32_t)az_span_size(payload);
+  int32_t const size = _az_telemetry_store_get_record_size(topic_size, payload_size);
+
+  if (size > end - _az_TELEMETRY_STORE_RING_START)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  // Find room for the record, only updating the in-memory state: nothing is written until the
+  // removals it depends on are durable.
+  int32_t wrap_marker = -1;
+  while (true)
+  {
+    int32_t const head = ref_store->_internal.head;
+    int32_t const tail = ref_store->_internal.tail;
+
+    if (ref_store->_internal.count == 0)
+    {
+      if (head != _az_TELEMETRY_STORE_RING_START || tail != _az_TELEMETRY_STORE_RING_START)
+      {
+        ref_store->_internal.head = _az_TELEMETRY_STORE_RING_START;
+        ref_store->_internal.tail = _az_TELEMETRY_STORE_RING_START;
+        ref_store->_internal.head_dirty = true;
+      }
+      ref_store->_internal.wrap = end;
+      wrap_marker = -1;
+      break;
+    }
+
+    if (tail > head)
+    {
+      if (end - tail >= size)
+      {
+        break;
+      }
+
+      wrap_marker = end - tail >= _az_TELEMETRY_STORE_RECORD_HEADER_SIZE ? tail : -1;
+      ref_store->_internal.wrap = tail;
+      ref_store->_internal.tail = _az_TELEMETRY_STORE_RING_START;
+    }
+    else if (head - tail >= size)
+    {
+      break;
+    }
+    else
+    {
+      _az_telemetry_store_remove_oldest(ref_store);
+      ref_store->_internal.evicted_count++;
+    }
+  }
+
+  if (ref_store->_internal.head_dirty)
+  {
+    _az_RETURN_IF_FAILED(az_iot_hub_client_telemetry_store_sync(ref_store));
+  }
+
+  uint32_t const sequence
+      = ref_store->_internal.head_sequence + (uint32_t)ref_store->_internal.count;
+
+  if (wrap_marker >= 0)
+  {
+    _az_telemetry_store_record_header marker = {
+      .magic = _az_TELEMETRY_STORE_WRAP_MAGIC,
+      .sequence = sequence,
+      .topic_size = 0,
+      .payload_size = 0,
+      .crc = 0,
+    };
+    marker.crc = _az_telemetry_store_get_record_crc(ref_store, &marker, wrap_marker);
+    _az_telemetry_store_write_record_header(ref_store, wrap_marker, &marker);
+  }
+
+  int32_t const tail = ref_store->_internal.tail;
+  az_span remainder = az_span_slice(
+      ref_store->_internal.buffer, tail + _az_TELEMETRY_STORE_RECORD_HEADER_SIZE, tail + size);
+  remainder = az_span_copy(remainder, topic);
+  remainder = az_span_copy_u8(remainder, '\0');
+  remainder = az_span_copy(remainder, payload);
+  az_span_fill(remainder, 0);
+
+  _az_telemetry_store_record_header record = {
+    .magic = _az_TELEMETRY_STORE_RECORD_MAGIC,
+    .sequence = sequence,
+    .topic_size = topic_size,
+    .payload_size = payload_size,
+    .crc = 0,
+  };
+  record.crc = _az_telemetry_store_get_record_crc(ref_store, &record, tail);
+  _az_telemetry_store_write_record_header(ref_store, tail, &record);
+
+  ref_store->_internal.tail = tail + size;
+  ref_store->_internal.count++;
+  ref_store->_internal.unsynced_count++;
+
+  if (ref_store->_internal.options.sync_interval > 0
+      && ref_store->_internal.unsynced_count >= ref_store->_internal.options.sync_interval)
+  {
+    _az_RETURN_IF_FAILED(az_iot_hub_client_telemetry_store_sync(ref_store));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_telemetry_store_peek(
+    az_iot_hub_client_telemetry_store const* store,
+    az_iot_hub_client_telemetry_store_message* out_message)
+{
+  _az_PRECONDITION_NOT_NULL(store);
+  _az_PRECONDITION_NOT_NULL(out_message);
+
+  if (store->_internal.count == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  int32_t const head = store->_internal.head;
+  _az_telemetry_store_record_header const record
+      = _az_telemetry_store_read_record_header(store, head);
+
+  uint8_t* const topic
+      = _az_telemetry_store_at(store, head + _az_TELEMETRY_STORE_RECORD_HEADER_SIZE);
+  out_message->topic = az_span_create(topic, (int32_t)record.topic_size - 1);
+  out_message->payload
+      = az_span_create(topic + record.topic_size, (int32_t)record.payload_size);
+  out_message->sequence = record.sequence;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_iot_hub_client_telemetry_store_remove(az_iot_hub_client_telemetry_store* ref_store)
+{
+  _az_PRECONDITION_NOT_NULL(ref_store);
+
+  if (ref_store->_internal.count == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  _az_telemetry_store_remove_oldest(ref_store);
+  return AZ_OK;
+}
@@ -0,0 +1,262 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_json.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_hub_client_twin_shadow.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+static const az_span twin_shadow_desired_name = AZ_SPAN_LITERAL_FROM_STR("desired");
+static const az_span twin_shadow_version_name = AZ_SPAN_LITERAL_FROM_STR("$version");
+
+enum
+{
+  // Property names with escape sequences are unescaped into a buffer of this size.
+  _az_IOT_HUB_CLIENT_TWIN_SHADOW_NAME_BUFFER_SIZE = 128,
+};
+
+// Moves a reader from the beginning of an object to the value of its member with the given name.
+static AZ_NODISCARD az_result _az_twin_shadow_find_member(az_json_reader* ref_reader, az_span name)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_reader));
+
+  while (ref_reader->token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    bool const found = az_json_token_is_text_equal(&ref_reader->token, name);
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_reader));
+    if (found)
+    {
+      return AZ_OK;
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_reader));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(ref_reader));
+  }
+
+  return AZ_ERROR_ITEM_NOT_FOUND;
+}
+
+static AZ_NODISCARD az_result
+_az_twin_shadow_copy_value(az_json_writer* ref_writer, az_json_reader* ref_reader)
+{
+  az_span text = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_iot_json_reader_get_value_text(ref_reader, &text));
+  return az_json_writer_append_json_text(ref_writer, text);
+}
+
+// Writes the RFC 7396 merge of a patch value into a target value. The target is NULL if it doesn't
+// exist. Both readers are at the first token of their value, and are left unchanged. Recursion is
+// bounded by the nesting depth of the patch, which IoT Hub limits to 10 for desired properties.
+static AZ_NODISCARD az_result _az_twin_shadow_merge(
+    az_json_writer* ref_writer,
+    az_json_reader const* target,
+    az_json_reader const* patch)
+{
+  az_json_reader patch_reader = *patch;
+  if (patch->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return _az_twin_shadow_copy_value(ref_writer, &patch_reader);
+  }
+
+  char name_buffer[_az_IOT_HUB_CLIENT_TWIN_SHADOW_NAME_BUFFER_SIZE];
+  az_span name = AZ_SPAN_EMPTY;
+  bool const target_is_object = target != NULL && target->token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT;
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_writer));
+
+  // Members of the target, in their order, replaced, merged or removed by the patch.
+  if (target_is_object)
+  {
+    az_json_reader target_reader = *target;
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&target_reader));
+
+    while (target_reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+    {
+      _az_RETURN_IF_FAILED(_az_iot_json_token_get_property_name(
+          &target_reader.token,
+          name_buffer,
+          _az_IOT_HUB_CLIENT_TWIN_SHADOW_NAME_BUFFER_SIZE,
+          &name));
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&target_reader));
+
+      patch_reader = *patch;
+      az_result const result = _az_twin_shadow_find_member(&patch_reader, name);
+      if (result == AZ_ERROR_ITEM_NOT_FOUND)
+      {
+        _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, name));
+        _az_RETURN_IF_FAILED(_az_twin_shadow_copy_value(ref_writer, &target_reader));
+      }
+      else
+      {
+        _az_RETURN_IF_FAILED(result);
+        if (patch_reader.token.kind != AZ_JSON_TOKEN_NULL)
+        {
+          _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, name));
+          _az_RETURN_IF_FAILED(_az_twin_shadow_merge(ref_writer, &target_reader, &patch_reader));
+        }
+        _az_RETURN_IF_FAILED(az_json_reader_skip_children(&target_reader));
+      }
+
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&target_reader));
+    }
+  }
+
+  // Members of the patch that are new to the target, without their null members.
+  patch_reader = *patch;
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&patch_reader));
+
+  while (patch_reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    _az_RETURN_IF_FAILED(_az_iot_json_token_get_property_name(
+        &patch_reader.token, name_buffer, _az_IOT_HUB_CLIENT_TWIN_SHADOW_NAME_BUFFER_SIZE, &name));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&patch_reader));
+
+    bool is_new = true;
+    if (target_is_object)
+    {
+      az_json_reader target_reader = *target;
+      az_result const result = _az_twin_shadow_find_member(&target_reader, name);
+      if (result != AZ_ERROR_ITEM_NOT_FOUND)
+      {
+        _az_RETURN_IF_FAILED(result);
+        is_new = false;
+      }
+    }
+
+    if (is_new && patch_reader.token.kind != AZ_JSON_TOKEN_NULL)
+    {
+      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, name));
+      _az_RETURN_IF_FAILED(_az_twin_shadow_merge(ref_writer, NULL, &patch_reader));
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_skip_children(&patch_reader));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&patch_reader));
+  }
+
+  return az_json_writer_append_end_object(ref_writer);
+}
+
+// Gets the $version member of an object, given a reader at its beginning.
+static AZ_NODISCARD az_result
+_az_twin_shadow_get_version(az_json_reader const* object_reader, int32_t* out_version)
+{
+  az_json_reader reader = *object_reader;
+  _az_RETURN_IF_FAILED(_az_twin_shadow_find_member(&reader, twin_shadow_version_name));
+  return az_json_token_get_int32(&reader.token, out_version);
+}
+
+// Initializes a reader at the beginning of a JSON object.
+static AZ_NODISCARD az_result
+_az_twin_shadow_begin_object(az_json_reader* out_reader, az_span json_object)
+{
+  _az_RETURN_IF_FAILED(az_json_reader_init(out_reader, json_object, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(out_reader));
+  return out_reader->token.kind == AZ_JSON_TOKEN_BEGIN_OBJECT ? AZ_OK : AZ_ERROR_UNEXPECTED_CHAR;
+}
+
+AZ_NODISCARD az_result
+az_iot_hub_client_twin_shadow_init(az_iot_hub_client_twin_shadow* out_shadow, az_span buffer)
+{
+  _az_PRECONDITION_NOT_NULL(out_shadow);
+  _az_PRECONDITION_VALID_SPAN(buffer, 2, false);
+
+  *out_shadow = (az_iot_hub_client_twin_shadow){
+    ._internal = {
+      .buffer = buffer,
+      .document = AZ_SPAN_EMPTY,
+      .version = -1,
+    },
+  };
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_twin_shadow_set_document(
+    az_iot_hub_client_twin_shadow* ref_shadow,
+    az_span twin_document)
+{
+  _az_PRECONDITION_NOT_NULL(ref_shadow);
+  _az_PRECONDITION_VALID_SPAN(twin_document, 1, false);
+
+  az_json_reader reader;
+  _az_RETURN_IF_FAILED(_az_twin_shadow_begin_object(&reader, twin_document));
+  _az_RETURN_IF_FAILED(_az_twin_shadow_find_member(&reader, twin_shadow_desired_name));
+  if (reader.token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  int32_t version = 0;
+  _az_RETURN_IF_FAILED(_az_twin_shadow_get_version(&reader, &version));
+
+  az_span desired = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_iot_json_reader_get_value_text(&reader, &desired));
+
+  az_span const destination = az_span_slice(
+      ref_shadow->_internal.buffer, 0, az_span_size(ref_shadow->_internal.buffer) / 2);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(destination, az_span_size(desired));
+
+  az_span_copy(destination, desired);
+  ref_shadow->_internal.document = az_span_slice(destination, 0, az_span_size(desired));
+  ref_shadow->_internal.version = version;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_twin_shadow_apply_patch(
+    az_iot_hub_client_twin_shadow* ref_shadow,
+    az_span desired_patch)
+{
+  _az_PRECONDITION_NOT_NULL(ref_shadow);
+  _az_PRECONDITION_VALID_SPAN(desired_patch, 1, false);
+
+  az_json_reader patch_reader;
+  _az_RETURN_IF_FAILED(_az_twin_shadow_begin_object(&patch_reader, desired_patch));
+
+  int32_t patch_version = 0;
+  _az_RETURN_IF_FAILED(_az_twin_shadow_get_version(&patch_reader, &patch_version));
+
+  if (ref_shadow->_internal.version < 0)
+  {
+    return AZ_ERROR_IOT_TWIN_VERSION_GAP;
+  }
+
+  if (patch_version <= ref_shadow->_internal.version)
+  {
+    // Already applied.
+    return AZ_OK;
+  }
+
+  if (patch_version != ref_shadow->_internal.version + 1)
+  {
+    return AZ_ERROR_IOT_TWIN_VERSION_GAP;
+  }
+
+  az_json_reader target_reader;
+  _az_RETURN_IF_FAILED(
+      _az_twin_shadow_begin_object(&target_reader, ref_shadow->_internal.document));
+
+  // Merge into the half of the buffer that doesn't hold the document.
+  az_span const buffer = ref_shadow->_internal.buffer;
+  int32_t const half_size = az_span_size(buffer) / 2;
+  az_span const destination = az_span_ptr(ref_shadow->_internal.document) == az_span_ptr(buffer)
+      ? az_span_slice(buffer, half_size, half_size * 2)
+      : az_span_slice(buffer, 0, half_size);
+
+  az_json_writer writer;
+  _az_RETURN_IF_FAILED(az_json_writer_init(&writer, destination, NULL));
+  _az_RETURN_IF_FAILED(_az_twin_shadow_merge(&writer, &target_reader, &patch_reader));
+
+  ref_shadow->_internal.document = az_json_writer_get_bytes_used_in_destination(&writer);
+  ref_shadow->_internal.version = patch_version;
+
+  return AZ_OK;
+}
@@ -0,0 +1,468 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_hub_gateway.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+static const az_span gateway_topic_devices_prefix = AZ_SPAN_LITERAL_FROM_STR("devices/");
+static const az_span gateway_topic_modules_prefix = AZ_SPAN_LITERAL_FROM_STR("modules/");
+static const az_span gateway_module_separator = AZ_SPAN_LITERAL_FROM_STR("/");
+static const az_span gateway_topic_modules_infix = AZ_SPAN_LITERAL_FROM_STR("/modules/");
+
+enum
+{
+  _az_IOT_HUB_GATEWAY_EMPTY_BUCKET = -1,
+};
+
+// The buckets form an open-addressing table with linear probing: each bucket holds the index of a
+// device, or -1. Removal shifts the following entries of the probe sequence back instead of
+// leaving tombstones, so lookups never get slower as devices come and go.
+
+// The devices are also kept in a binary min-heap ordered by SAS token expiration. The heap has one
+// entry per device, so entry i, the index of a device, is stored in devices[i], and each device
+// keeps its own position in the heap so that it can be moved when its expiration changes.
+
+AZ_INLINE uint64_t
+_az_iot_hub_gateway_get_heap_expiration(az_iot_hub_gateway_device const* devices, int32_t position)
+{
+  return devices[devices[position]._internal.sas_expiration_heap_entry]
+      ._internal.sas_expiration_epoch_time;
+}
+
+AZ_INLINE void _az_iot_hub_gateway_set_heap_entry(
+    az_iot_hub_gateway_device* devices,
+    int32_t position,
+    int32_t device_index)
+{
+  devices[position]._internal.sas_expiration_heap_entry = device_index;
+  devices[device_index]._internal.sas_expiration_heap_position = position;
+}
+
+// Moves the heap entry at position up while it expires before its parent, then down while one of
+// its children expires before it.
+static void _az_iot_hub_gateway_sift_heap_entry(
+    az_iot_hub_gateway_device* devices,
+    int32_t heap_length,
+    int32_t position)
+{
+  int32_t const device_index = devices[position]._internal.sas_expiration_heap_entry;
+  uint64_t const expiration = devices[device_index]._internal.sas_expiration_epoch_time;
+
+  while (position > 0)
+  {
+    int32_t const parent = (position - 1) / 2;
+    if (_az_iot_hub_gateway_get_heap_expiration(devices, parent) <= expiration)
+    {
+      break;
+    }
+    _az_iot_hub_gateway_set_heap_entry(
+        devices, position, devices[parent]._internal.sas_expiration_heap_entry);
+    position = parent;
+  }
+
+  while (true)
+  {
+    int32_t child = (2 * position) + 1;
+    if (child >= heap_length)
+    {
+      break;
+    }
+    if (child + 1 < heap_length
+        && _az_iot_hub_gateway_get_heap_expiration(devices, child + 1)
+            < _az_iot_hub_gateway_get_heap_expiration(devices, child))
+    {
+      child++;
+    }
+    if (_az_iot_hub_gateway_get_heap_expiration(devices, child) >= expiration)
+    {
+      break;
+    }
+    _az_iot_hub_gateway_set_heap_entry(
+        devices, position, devices[child]._internal.sas_expiration_heap_entry);
+    position = child;
+  }
+
+  _az_iot_hub_gateway_set_heap_entry(devices, position, device_index);
+}
+
+AZ_INLINE uint32_t _az_iot_hub_gateway_hash(az_span device_id, az_span module_id)
+{
+  uint32_t hash = _az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, device_id);
+  if (az_span_size(module_id) > 0)
+  {
+    hash = _az_iot_fnv1a(_az_iot_fnv1a(hash, gateway_module_separator), module_id);
+  }
+  return hash;
+}
+
+AZ_INLINE bool _az_iot_hub_gateway_device_matches(
+    az_iot_hub_gateway_device const* device,
+    uint32_t hash,
+    az_span device_id,
+    az_span module_id)
+{
+  return device->_internal.hash == hash
+      && az_span_is_content_equal(device->_internal.client._internal.device_id, device_id)
+      && az_span_is_content_equal(device->_internal.client._internal.options.module_id, module_id);
+}
+
+// Returns the bucket holding the device, or the empty bucket that ends its probe sequence.
+static uint32_t _az_iot_hub_gateway_find_bucket(
+    az_iot_hub_gateway const* gateway,
+    uint32_t hash,
+    az_span device_id,
+    az_span module_id)
+{
+  uint32_t const mask = gateway->_internal.bucket_mask;
+  uint32_t bucket = hash & mask;
+
+  while (true)
+  {
+    int32_t const device_index = gateway->_internal.buckets[bucket];
+    if (device_index == _az_IOT_HUB_GATEWAY_EMPTY_BUCKET
+        || _az_iot_hub_gateway_device_matches(
+            &gateway->_internal.devices[device_index], hash, device_id, module_id))
+    {
+      return bucket;
+    }
+    bucket = (bucket + 1U) & mask;
+  }
+}
+
+// Returns the slot of the topic prefixes buffer holding the topic prefix of the device at
+// device_index.
+AZ_INLINE az_span
+_az_iot_hub_gateway_get_topic_prefix_slot(az_iot_hub_gateway const* gateway, int32_t device_index)
+{
+  int32_t const slot_size = gateway->_internal.topic_prefix_slot_size;
+  return az_span_slice(
+      gateway->_internal.topic_prefixes_buffer,
+      device_index * slot_size,
+      (device_index + 1) * slot_size);
+}
+
+// Writes `devices/{device_id}/` or `devices/{device_id}/modules/{module_id}/` to slot.
+AZ_NODISCARD static az_result _az_iot_hub_gateway_write_topic_prefix(
+    az_span slot,
+    az_span device_id,
+    az_span module_id,
+    az_span* out_topic_prefix)
+{
+  int32_t required_size = az_span_size(gateway_topic_devices_prefix) + az_span_size(device_id) + 1;
+  if (az_span_size(module_id) > 0)
+  {
+    required_size += az_span_size(gateway_topic_modules_infix) + az_span_size(module_id);
+  }
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(slot, required_size);
+
+  az_span remainder = az_span_copy(slot, gateway_topic_devices_prefix);
+  remainder = az_span_copy(remainder, device_id);
+  if (az_span_size(module_id) > 0)
+  {
+    remainder = az_span_copy(remainder, gateway_topic_modules_infix);
+    remainder = az_span_copy(remainder, module_id);
+  }
+  az_span_copy_u8(remainder, '/');
+
+  *out_topic_prefix = az_span_slice(slot, 0, required_size);
+  return AZ_OK;
+}
+
+// Returns the bucket holding the device at device_index.
+static uint32_t
+_az_iot_hub_gateway_find_device_bucket(az_iot_hub_gateway const* gateway, int32_t device_index)
+{
+  uint32_t const mask = gateway->_internal.bucket_mask;
+  uint32_t bucket = gateway->_internal.devices[device_index]._internal.hash & mask;
+
+  while (gateway->_internal.buckets[bucket] != device_index)
+  {
+    bucket = (bucket + 1U) & mask;
+  }
+  return bucket;
+}
+
+AZ_NODISCARD az_result az_iot_hub_gateway_init(
+    az_iot_hub_gateway* out_gateway,
+    az_span iot_hub_hostname,
+    az_iot_hub_gateway_device devices[],
+    int32_t devices_capacity,
+    az_span topic_prefixes_buffer,
+    int32_t buckets[],
+    int32_t buckets_length)
+{
+  _az_PRECONDITION_NOT_NULL(out_gateway);
+  _az_PRECONDITION_VALID_SPAN(iot_hub_hostname, 1, false);
+  _az_PRECONDITION_NOT_NULL(devices);
+  _az_PRECONDITION(devices_capacity > 0);
+  _az_PRECONDITION_VALID_SPAN(topic_prefixes_buffer, devices_capacity, false);
+  _az_PRECONDITION_NOT_NULL(buckets);
+  _az_PRECONDITION(buckets_length > devices_capacity);
+  _az_PRECONDITION((buckets_length & (buckets_length - 1)) == 0);
+
+  *out_gateway = (az_iot_hub_gateway){
+    ._internal = {
+      .iot_hub_hostname = iot_hub_hostname,
+      .devices = devices,
+      .devices_capacity = devices_capacity,
+      .devices_length = 0,
+      .topic_prefixes_buffer = topic_prefixes_buffer,
+      .topic_prefix_slot_size = az_span_size(topic_prefixes_buffer) / devices_capacity,
+      .buckets = buckets,
+      .bucket_mask = (uint32_t)buckets_length - 1U,
+    },
+  };
+
+  for (int32_t i = 0; i < buckets_length; i++)
+  {
+    buckets[i] = _az_IOT_HUB_GATEWAY_EMPTY_BUCKET;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_gateway_add_device(
+    az_iot_hub_gateway* ref_gateway,
+    az_span device_id,
+    az_iot_hub_client_options const* options,
+    void* user_context,
+    int32_t* out_device_index)
+{
+  _az_PRECONDITION_NOT_NULL(ref_gateway);
+  _az_PRECONDITION_VALID_SPAN(device_id, 1, false);
+
+  az_span const module_id = options == NULL ? AZ_SPAN_EMPTY : options->module_id;
+  uint32_t const hash = _az_iot_hub_gateway_hash(device_id, module_id);
+  uint32_t const bucket = _az_iot_hub_gateway_find_bucket(ref_gateway, hash, device_id, module_id);
+
+  if (ref_gateway->_internal.buckets[bucket] != _az_IOT_HUB_GATEWAY_EMPTY_BUCKET)
+  {
+    return AZ_ERROR_ARG;
+  }
+
+  if (ref_gateway->_internal.devices_length == ref_gateway->_internal.devices_capacity)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  int32_t const device_index = ref_gateway->_internal.devices_length;
+  az_iot_hub_gateway_device* const device = &ref_gateway->_internal.devices[device_index];
+
+  _az_RETURN_IF_FAILED(_az_iot_hub_gateway_write_topic_prefix(
+      _az_iot_hub_gateway_get_topic_prefix_slot(ref_gateway, device_index),
+      device_id,
+      module_id,
+      &device->_internal.topic_prefix));
+  _az_RETURN_IF_FAILED(az_iot_hub_client_init(
+      &device->_internal.client, ref_gateway->_internal.iot_hub_hostname, device_id, options));
+  device->_internal.sas_expiration_epoch_time = 0;
+  device->_internal.user_context = user_context;
+  device->_internal.hash = hash;
+
+  ref_gateway->_internal.buckets[bucket] = device_index;
+  ref_gateway->_internal.devices_length++;
+
+  // The expiration of a new device is 0, so it is the first to renew until its expiration is set.
+  _az_iot_hub_gateway_set_heap_entry(ref_gateway->_internal.devices, device_index, device_index);
+  _az_iot_hub_gateway_sift_heap_entry(
+      ref_gateway->_internal.devices, ref_gateway->_internal.devices_length, device_index);
+
+  if (out_device_index != NULL)
+  {
+    *out_device_index = device_index;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_iot_hub_gateway_remove_device(az_iot_hub_gateway* ref_gateway, int32_t device_index)
+{
+  _az_PRECONDITION_NOT_NULL(ref_gateway);
+  _az_PRECONDITION_RANGE(0, device_index, ref_gateway->_internal.devices_length - 1);
+
+  uint32_t const mask = ref_gateway->_internal.bucket_mask;
+  int32_t* const buckets = ref_gateway->_internal.buckets;
+
+  // Empty the device's bucket, then move back any later entry of the probe sequence whose home
+  // bucket is at or before the emptied one.
+  uint32_t empty = _az_iot_hub_gateway_find_device_bucket(ref_gateway, device_index);
+  uint32_t bucket = (empty + 1U) & mask;
+  buckets[empty] = _az_IOT_HUB_GATEWAY_EMPTY_BUCKET;
+
+  while (buckets[bucket] != _az_IOT_HUB_GATEWAY_EMPTY_BUCKET)
+  {
+    uint32_t const home = ref_gateway->_internal.devices[buckets[bucket]]._internal.hash & mask;
+    if (((bucket - home) & mask) >= ((bucket - empty) & mask))
+    {
+      buckets[empty] = buckets[bucket];
+      buckets[bucket] = _az_IOT_HUB_GATEWAY_EMPTY_BUCKET;
+      empty = bucket;
+    }
+    bucket = (bucket + 1U) & mask;
+  }
+
+  // Replace the device's heap entry with the last one, which shrinks the heap by one.
+  az_iot_hub_gateway_device* const devices = ref_gateway->_internal.devices;
+  int32_t const last = --ref_gateway->_internal.devices_length;
+  int32_t const heap_position = devices[device_index]._internal.sas_expiration_heap_position;
+  if (heap_position != last)
+  {
+    _az_iot_hub_gateway_set_heap_entry(
+        devices, heap_position, devices[last]._internal.sas_expiration_heap_entry);
+    _az_iot_hub_gateway_sift_heap_entry(devices, last, heap_position);
+  }
+
+  // Keep the devices contiguous by moving the last one into the freed slot.
+  if (device_index != last)
+  {
+    buckets[_az_iot_hub_gateway_find_device_bucket(ref_gateway, last)] = device_index;
+
+    // The heap entry stored in the freed slot stays there, and the heap entry of the moved device
+    // follows it to its new index.
+    az_iot_hub_gateway_device* const device = &devices[device_index];
+    int32_t const heap_entry = device->_internal.sas_expiration_heap_entry;
+    *device = devices[last];
+    device->_internal.sas_expiration_heap_entry = heap_entry;
+    devices[device->_internal.sas_expiration_heap_position]._internal.sas_expiration_heap_entry
+        = device_index;
+
+    // The topic prefix moves along to the slot of its new index.
+    az_span const slot = _az_iot_hub_gateway_get_topic_prefix_slot(ref_gateway, device_index);
+    az_span_copy(slot, device->_internal.topic_prefix);
+    device->_internal.topic_prefix
+        = az_span_slice(slot, 0, az_span_size(device->_internal.topic_prefix));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_gateway_find_device(
+    az_iot_hub_gateway const* gateway,
+    az_span device_id,
+    az_span module_id,
+    int32_t* out_device_index)
+{
+  _az_PRECONDITION_NOT_NULL(gateway);
+  _az_PRECONDITION_NOT_NULL(out_device_index);
+
+  int32_t const device_index = gateway->_internal.buckets[_az_iot_hub_gateway_find_bucket(
+      gateway, _az_iot_hub_gateway_hash(device_id, module_id), device_id, module_id)];
+
+  if (device_index == _az_IOT_HUB_GATEWAY_EMPTY_BUCKET)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_device_index = device_index;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_gateway_route_received_topic(
+    az_iot_hub_gateway const* gateway,
+    az_span received_topic,
+    int32_t* out_device_index)
+{
+  _az_PRECONDITION_NOT_NULL(gateway);
+  _az_PRECONDITION_VALID_SPAN(received_topic, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_device_index);
+
+  int32_t const prefix_size = az_span_size(gateway_topic_devices_prefix);
+  if (az_span_size(received_topic) <= prefix_size
+      || !az_span_is_content_equal(
+          az_span_slice(received_topic, 0, prefix_size), gateway_topic_devices_prefix))
+  {
+    return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+  }
+
+  az_span remainder = az_span_slice_to_end(received_topic, prefix_size);
+  int32_t index = az_span_find(remainder, gateway_module_separator);
+  if (index <= 0)
+  {
+    return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+  }
+
+  az_span const device_id = az_span_slice(remainder, 0, index);
+  az_span module_id = AZ_SPAN_EMPTY;
+
+  remainder = az_span_slice_to_end(remainder, index + 1);
+  int32_t const modules_prefix_size = az_span_size(gateway_topic_modules_prefix);
+  if (az_span_size(remainder) > modules_prefix_size
+      && az_span_is_content_equal(
+          az_span_slice(remainder, 0, modules_prefix_size), gateway_topic_modules_prefix))
+  {
+    remainder = az_span_slice_to_end(remainder, modules_prefix_size);
+    index = az_span_find(remainder, gateway_module_separator);
+    if (index <= 0)
+    {
+      return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+    }
+    module_id = az_span_slice(remainder, 0, index);
+    remainder = az_span_slice_to_end(remainder, index + 1);
+  }
+
+  // The topic prefix ends where the remainder begins.
+  az_span const topic_prefix = az_span_slice(
+      received_topic, 0, (int32_t)(az_span_ptr(remainder) - az_span_ptr(received_topic)));
+  uint32_t const hash = _az_iot_hub_gateway_hash(device_id, module_id);
+  uint32_t const mask = gateway->_internal.bucket_mask;
+  uint32_t bucket = hash & mask;
+
+  while (true)
+  {
+    int32_t const device_index = gateway->_internal.buckets[bucket];
+    if (device_index == _az_IOT_HUB_GATEWAY_EMPTY_BUCKET)
+    {
+      return AZ_ERROR_IOT_TOPIC_NO_MATCH;
+    }
+
+    az_iot_hub_gateway_device const* const device = &gateway->_internal.devices[device_index];
+    if (device->_internal.hash == hash
+        && az_span_is_content_equal(device->_internal.topic_prefix, topic_prefix))
+    {
+      *out_device_index = device_index;
+      return AZ_OK;
+    }
+    bucket = (bucket + 1U) & mask;
+  }
+}
+
+AZ_NODISCARD az_result az_iot_hub_gateway_get_next_sas_expiration(
+    az_iot_hub_gateway const* gateway,
+    int32_t* out_device_index)
+{
+  _az_PRECONDITION_NOT_NULL(gateway);
+  _az_PRECONDITION_NOT_NULL(out_device_index);
+
+  if (gateway->_internal.devices_length == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_device_index = gateway->_internal.devices[0]._internal.sas_expiration_heap_entry;
+  return AZ_OK;
+}
+
+void az_iot_hub_gateway_set_device_sas_expiration(
+    az_iot_hub_gateway* ref_gateway,
+    int32_t device_index,
+    uint64_t token_expiration_epoch_time)
+{
+  _az_PRECONDITION_NOT_NULL(ref_gateway);
+  _az_PRECONDITION_RANGE(0, device_index, ref_gateway->_internal.devices_length - 1);
+
+  az_iot_hub_gateway_device* const devices = ref_gateway->_internal.devices;
+  devices[device_index]._internal.sas_expiration_epoch_time = token_expiration_epoch_time;
+  _az_iot_hub_gateway_sift_heap_entry(
+      devices,
+      ref_gateway->_internal.devices_length,
+      devices[device_index]._internal.sas_expiration_heap_position);
+}
@@ -20,8 +20,27 @@ static const az_span str_get_iotdps_get_operationstatus
 
 // From the protocol described in
 // https://docs.microsoft.com/azure/iot-dps/iot-dps-mqtt-support#registering-a-device
-static const az_span prov_registration_id_label = AZ_SPAN_LITERAL_FROM_STR("registrationId");
-static const az_span prov_payload_label = AZ_SPAN_LITERAL_FROM_STR("payload");
+// The members of a register request written to its payload.
+typedef struct
+{
+  az_span registration_id;
+  az_span payload;
+} _az_iot_provisioning_client_request_payload;
+
+static const az_json_binding_field request_fields[] = {
+  { .key = AZ_SPAN_LITERAL_FROM_STR("registrationId"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(_az_iot_provisioning_client_request_payload, registration_id) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("payload"),
+    .type = AZ_JSON_BINDING_JSON,
+    .offset = offsetof(_az_iot_provisioning_client_request_payload, payload) },
+};
+
+static const az_json_binding request_binding = {
+  .fields = request_fields,
+  .fields_length = (int32_t)(sizeof(request_fields) / sizeof(az_json_binding_field)),
+  .size = sizeof(_az_iot_provisioning_client_request_payload),
+};
 
 // $dps/registrations/res/
 AZ_INLINE az_span _az_iot_provisioning_get_dps_registrations_res()
@@ -261,125 +280,124 @@ https://docs.microsoft.com/rest/api/iot-dps/device/runtime-registration/register
     "lastUpdatedDateTimeUtc":"2020-04-10T03:11:13.2096201Z",
     "etag":"IjYxMDA4ZDQ2LTAwMDAtMDEwMC0wMDAwLTVlOGZlM2QxMDAwMCI="}}
 */
-AZ_INLINE az_result _az_iot_provisioning_client_parse_payload_error_code(
-    az_json_reader* jr,
-    az_iot_provisioning_client_registration_state* out_state)
-{
-  if (az_json_token_is_text_equal(&jr->token, AZ_SPAN_FROM_STR("errorCode")))
-  {
-    _az_RETURN_IF_FAILED(az_json_reader_next_token(jr));
-    _az_RETURN_IF_FAILED(az_json_token_get_uint32(&jr->token, &out_state->extended_error_code));
-    out_state->error_code = _az_iot_status_from_extended_status(out_state->extended_error_code);
-
-    return AZ_OK;
-  }
-
-  return AZ_ERROR_ITEM_NOT_FOUND;
-}
-
-AZ_INLINE az_result
-_az_iot_provisioning_client_get_json_object_span(az_json_reader* jr, az_span* out_span)
+static const az_json_binding_field registration_state_fields[] = {
+  { .key = AZ_SPAN_LITERAL_FROM_STR("assignedHub"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(az_iot_provisioning_client_registration_state, assigned_hub_hostname),
+    .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+    .rejects_null = true },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("deviceId"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(az_iot_provisioning_client_registration_state, device_id),
+    .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+    .rejects_null = true },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("errorCode"),
+    .type = AZ_JSON_BINDING_UINT32,
+    .offset = offsetof(az_iot_provisioning_client_registration_state, extended_error_code),
+    .type_mismatch_result = AZ_ERROR_JSON_INVALID_STATE,
+    .rejects_null = true },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("errorMessage"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(az_iot_provisioning_client_registration_state, error_message),
+    .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+    .rejects_null = true },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("lastUpdatedDateTimeUtc"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(az_iot_provisioning_client_registration_state, error_timestamp),
+    .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+    .rejects_null = true },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("payload"),
+    .type = AZ_JSON_BINDING_JSON_OBJECT,
+    .offset = offsetof(az_iot_provisioning_client_registration_state, payload) },
+};
+
+static const az_json_binding registration_state_binding = {
+  .fields = registration_state_fields,
+  .fields_length = (int32_t)(sizeof(registration_state_fields) / sizeof(az_json_binding_field)),
+  .size = sizeof(az_iot_provisioning_client_registration_state),
+  .ends_at_invalid_property = true,
+};
+
+// The members of a register response read from its payload.
+typedef struct
 {
-  *out_span = jr->token.slice;
-
-  if (jr->token.kind == AZ_JSON_TOKEN_NULL)
-  {
-    *out_span = AZ_SPAN_EMPTY;
-    return AZ_OK;
-  }
-
-  if (jr->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
-  {
-    return AZ_ERROR_UNEXPECTED_CHAR;
-  }
-
-  _az_RETURN_IF_FAILED(az_json_reader_skip_children(jr));
-  _az_PRECONDITION(jr->token.kind == AZ_JSON_TOKEN_END_OBJECT);
+  az_span operation_id;
+  az_span operation_status;
+  az_iot_provisioning_client_registration_state registration_state;
+} _az_iot_provisioning_client_response_payload;
 
-  int32_t payload_len = (int32_t)(az_span_ptr(jr->token.slice) - az_span_ptr(*out_span)) + 1;
-  *out_span = az_span_create(az_span_ptr(*out_span), payload_len);
-
-  return AZ_OK;
-}
-
-AZ_INLINE az_result _az_iot_provisioning_client_payload_registration_state_parse(
-    az_json_reader* jr,
-    az_iot_provisioning_client_registration_state* out_state)
+// The fields of a register response, in the order the service writes them.
+enum
 {
-  if (jr->token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
-  {
-    return AZ_ERROR_UNEXPECTED_CHAR;
-  }
-
-  bool found_assigned_hub = false;
-  bool found_device_id = false;
-
-  while (az_result_succeeded(az_json_reader_next_token(jr))
-         && jr->token.kind != AZ_JSON_TOKEN_END_OBJECT)
-  {
-    if (az_json_token_is_text_equal(&jr->token, AZ_SPAN_FROM_STR("assignedHub")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(jr));
-      if (jr->token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_state->assigned_hub_hostname = jr->token.slice;
-      found_assigned_hub = true;
-    }
-    else if (az_json_token_is_text_equal(&jr->token, AZ_SPAN_FROM_STR("deviceId")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(jr));
-      if (jr->token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_state->device_id = jr->token.slice;
-      found_device_id = true;
-    }
-    else if (az_json_token_is_text_equal(&jr->token, AZ_SPAN_FROM_STR("payload")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(jr));
-      _az_RETURN_IF_FAILED(
-          _az_iot_provisioning_client_get_json_object_span(jr, &out_state->payload));
-    }
-    else if (az_json_token_is_text_equal(&jr->token, AZ_SPAN_FROM_STR("errorMessage")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(jr));
-      if (jr->token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_state->error_message = jr->token.slice;
-    }
-    else if (az_json_token_is_text_equal(&jr->token, AZ_SPAN_FROM_STR("lastUpdatedDateTimeUtc")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(jr));
-      if (jr->token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_state->error_timestamp = jr->token.slice;
-    }
-    else if (az_result_succeeded(
-                 _az_iot_provisioning_client_parse_payload_error_code(jr, out_state)))
-    {
-      // Do nothing
-    }
-    else
-    {
-      // ignore other tokens
-      _az_RETURN_IF_FAILED(az_json_reader_skip_children(jr));
-    }
-  }
-
-  if (found_assigned_hub != found_device_id)
-  {
-    return AZ_ERROR_ITEM_NOT_FOUND;
-  }
-
-  return AZ_OK;
-}
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_OPERATION_ID,
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_STATUS,
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_REGISTRATION_STATE,
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_ERROR_CODE,
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_TRACKING_ID,
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_MESSAGE,
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_TIMESTAMP_UTC,
+  _az_IOT_PROVISIONING_RESPONSE_FIELD_COUNT,
+};
+
+static const az_json_binding_field response_fields[_az_IOT_PROVISIONING_RESPONSE_FIELD_COUNT] = {
+  [_az_IOT_PROVISIONING_RESPONSE_FIELD_OPERATION_ID]
+  = { .key = AZ_SPAN_LITERAL_FROM_STR("operationId"),
+      .type = AZ_JSON_BINDING_STRING,
+      .offset = offsetof(_az_iot_provisioning_client_response_payload, operation_id),
+      .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+      .rejects_null = true },
+  [_az_IOT_PROVISIONING_RESPONSE_FIELD_STATUS]
+  = { .key = AZ_SPAN_LITERAL_FROM_STR("status"),
+      .type = AZ_JSON_BINDING_STRING,
+      .offset = offsetof(_az_iot_provisioning_client_response_payload, operation_status),
+      .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+      .rejects_null = true },
+  [_az_IOT_PROVISIONING_RESPONSE_FIELD_REGISTRATION_STATE]
+  = { .key = AZ_SPAN_LITERAL_FROM_STR("registrationState"),
+      .type = AZ_JSON_BINDING_OBJECT,
+      .offset = offsetof(_az_iot_provisioning_client_response_payload, registration_state),
+      .binding = &registration_state_binding,
+      .rejects_null = true },
+  [_az_IOT_PROVISIONING_RESPONSE_FIELD_ERROR_CODE]
+  = { .key = AZ_SPAN_LITERAL_FROM_STR("errorCode"),
+      .type = AZ_JSON_BINDING_UINT32,
+      .offset = offsetof(
+          _az_iot_provisioning_client_response_payload,
+          registration_state.extended_error_code),
+      .type_mismatch_result = AZ_ERROR_JSON_INVALID_STATE,
+      .rejects_null = true },
+  [_az_IOT_PROVISIONING_RESPONSE_FIELD_TRACKING_ID]
+  = { .key = AZ_SPAN_LITERAL_FROM_STR("trackingId"),
+      .type = AZ_JSON_BINDING_STRING,
+      .offset = offsetof(
+          _az_iot_provisioning_client_response_payload,
+          registration_state.error_tracking_id),
+      .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+      .rejects_null = true },
+  [_az_IOT_PROVISIONING_RESPONSE_FIELD_MESSAGE]
+  = { .key = AZ_SPAN_LITERAL_FROM_STR("message"),
+      .type = AZ_JSON_BINDING_STRING,
+      .offset = offsetof(
+          _az_iot_provisioning_client_response_payload,
+          registration_state.error_message),
+      .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+      .rejects_null = true },
+  [_az_IOT_PROVISIONING_RESPONSE_FIELD_TIMESTAMP_UTC]
+  = { .key = AZ_SPAN_LITERAL_FROM_STR("timestampUtc"),
+      .type = AZ_JSON_BINDING_STRING,
+      .offset = offsetof(
+          _az_iot_provisioning_client_response_payload,
+          registration_state.error_timestamp),
+      .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+      .rejects_null = true },
+};
+
+static const az_json_binding response_binding = {
+  .fields = response_fields,
+  .fields_length = _az_IOT_PROVISIONING_RESPONSE_FIELD_COUNT,
+  .size = sizeof(_az_iot_provisioning_client_response_payload),
+  .ends_at_invalid_property = true,
+};
 
 AZ_NODISCARD static az_result _az_iot_provisioning_client_parse_operation_status(
     az_span response_operation_status,
@@ -388,31 +406,46 @@ AZ_NODISCARD static az_result _az_iot_provisioning_client_parse_operation_status
   _az_PRECONDITION_VALID_SPAN(response_operation_status, 0, false);
   _az_PRECONDITION_NOT_NULL(out_operation_status);
 
-  if (az_span_is_content_equal(response_operation_status, AZ_SPAN_FROM_STR("assigning")))
+  // The length of a status, and its first character for the two of length 8, selects the only
+  // candidate, which one comparison confirms.
+  az_span expected = AZ_SPAN_EMPTY;
+  az_iot_provisioning_client_operation_status operation_status = AZ_IOT_PROVISIONING_STATUS_FAILED;
+  switch (az_span_size(response_operation_status))
   {
-    *out_operation_status = AZ_IOT_PROVISIONING_STATUS_ASSIGNING;
-  }
-  else if (az_span_is_content_equal(response_operation_status, AZ_SPAN_FROM_STR("assigned")))
-  {
-    *out_operation_status = AZ_IOT_PROVISIONING_STATUS_ASSIGNED;
-  }
-  else if (az_span_is_content_equal(response_operation_status, AZ_SPAN_FROM_STR("failed")))
-  {
-    *out_operation_status = AZ_IOT_PROVISIONING_STATUS_FAILED;
-  }
-  else if (az_span_is_content_equal(response_operation_status, AZ_SPAN_FROM_STR("unassigned")))
-  {
-    *out_operation_status = AZ_IOT_PROVISIONING_STATUS_UNASSIGNED;
-  }
-  else if (az_span_is_content_equal(response_operation_status, AZ_SPAN_FROM_STR("disabled")))
-  {
-    *out_operation_status = AZ_IOT_PROVISIONING_STATUS_DISABLED;
+    case 6:
+      expected = AZ_SPAN_FROM_STR("failed");
+      operation_status = AZ_IOT_PROVISIONING_STATUS_FAILED;
+      break;
+    case 8:
+      if (az_span_ptr(response_operation_status)[0] == 'a')
+      {
+        expected = AZ_SPAN_FROM_STR("assigned");
+        operation_status = AZ_IOT_PROVISIONING_STATUS_ASSIGNED;
+      }
+      else
+      {
+        expected = AZ_SPAN_FROM_STR("disabled");
+        operation_status = AZ_IOT_PROVISIONING_STATUS_DISABLED;
+      }
+      break;
+    case 9:
+      expected = AZ_SPAN_FROM_STR("assigning");
+      operation_status = AZ_IOT_PROVISIONING_STATUS_ASSIGNING;
+      break;
+    case 10:
+      expected = AZ_SPAN_FROM_STR("unassigned");
+      operation_status = AZ_IOT_PROVISIONING_STATUS_UNASSIGNED;
+      break;
+    default:
+      return AZ_ERROR_UNEXPECTED_CHAR;
   }
-  else
+
+  if (!az_span_is_content_equal(response_operation_status, expected))
   {
     return AZ_ERROR_UNEXPECTED_CHAR;
   }
 
+  *out_operation_status = operation_status;
   return AZ_OK;
 }
 
@@ -423,95 +456,45 @@ AZ_INLINE az_result az_iot_provisioning_client_parse_payload(
   // Parse the payload:
   az_json_reader jr;
   _az_RETURN_IF_FAILED(az_json_reader_init(&jr, received_payload, NULL));
-
   _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
-  if (jr.token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+
+  _az_iot_provisioning_client_response_payload payload
+      = { .operation_id = AZ_SPAN_EMPTY,
+          .operation_status = AZ_SPAN_EMPTY,
+          .registration_state = _az_iot_provisioning_registration_state_default() };
+  uint32_t present = 0;
+
+  // The bindings keep the results of the earlier hand-written parser: a value of the wrong type,
+  // null included, fails, and an error between properties, such as a payload cut short there, ends
+  // the payload with the properties read before it.
+  _az_RETURN_IF_FAILED(az_json_binding_read(&jr, &response_binding, &payload, &present));
+
+  out_response->operation_id = payload.operation_id;
+  out_response->registration_state = payload.registration_state;
+  out_response->registration_state.error_code
+      = _az_iot_status_from_extended_status(payload.registration_state.extended_error_code);
+
+  // The registration state has either both the assigned hub and the device ID, or neither.
+  if ((az_span_ptr(payload.registration_state.assigned_hub_hostname) == NULL)
+      != (az_span_ptr(payload.registration_state.device_id) == NULL))
   {
-    return AZ_ERROR_UNEXPECTED_CHAR;
+    return AZ_ERROR_ITEM_NOT_FOUND;
   }
 
-  out_response->registration_state = _az_iot_provisioning_registration_state_default();
-
-  bool found_operation_id = false;
-  bool found_operation_status = false;
-  bool found_error = false;
-
-  while (az_result_succeeded(az_json_reader_next_token(&jr))
-         && jr.token.kind != AZ_JSON_TOKEN_END_OBJECT)
+  if ((present & (1U << _az_IOT_PROVISIONING_RESPONSE_FIELD_STATUS)) != 0)
   {
-    if (az_json_token_is_text_equal(&jr.token, AZ_SPAN_FROM_STR("operationId")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
-      if (jr.token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_response->operation_id = jr.token.slice;
-      found_operation_id = true;
-    }
-    else if (az_json_token_is_text_equal(&jr.token, AZ_SPAN_FROM_STR("status")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
-      if (jr.token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      _az_RETURN_IF_FAILED(_az_iot_provisioning_client_parse_operation_status(
-          jr.token.slice, &out_response->operation_status));
-
-      found_operation_status = true;
-    }
-    else if (az_json_token_is_text_equal(&jr.token, AZ_SPAN_FROM_STR("registrationState")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
-      _az_RETURN_IF_FAILED(_az_iot_provisioning_client_payload_registration_state_parse(
-          &jr, &out_response->registration_state));
-    }
-    else if (az_json_token_is_text_equal(&jr.token, AZ_SPAN_FROM_STR("trackingId")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
-      if (jr.token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_response->registration_state.error_tracking_id = jr.token.slice;
-    }
-    else if (az_json_token_is_text_equal(&jr.token, AZ_SPAN_FROM_STR("message")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
-      if (jr.token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_response->registration_state.error_message = jr.token.slice;
-    }
-    else if (az_json_token_is_text_equal(&jr.token, AZ_SPAN_FROM_STR("timestampUtc")))
-    {
-      _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
-      if (jr.token.kind != AZ_JSON_TOKEN_STRING)
-      {
-        return AZ_ERROR_ITEM_NOT_FOUND;
-      }
-      out_response->registration_state.error_timestamp = jr.token.slice;
-    }
-    else if (az_result_succeeded(_az_iot_provisioning_client_parse_payload_error_code(
-                 &jr, &out_response->registration_state)))
-    {
-      found_error = true;
-    }
-    else
-    {
-      // ignore other tokens
-      _az_RETURN_IF_FAILED(az_json_reader_skip_children(&jr));
-    }
+    _az_RETURN_IF_FAILED(_az_iot_provisioning_client_parse_operation_status(
+        payload.operation_status, &out_response->operation_status));
   }
 
-  if (!(found_operation_status && found_operation_id))
+  uint32_t const operation_fields = (1U << _az_IOT_PROVISIONING_RESPONSE_FIELD_OPERATION_ID)
+      | (1U << _az_IOT_PROVISIONING_RESPONSE_FIELD_STATUS);
+  if ((present & operation_fields) != operation_fields)
   {
     out_response->operation_id = AZ_SPAN_EMPTY;
     out_response->operation_status = AZ_IOT_PROVISIONING_STATUS_FAILED;
 
-    if (!found_error)
+    if ((present & (1U << _az_IOT_PROVISIONING_RESPONSE_FIELD_ERROR_CODE)) == 0)
     {
       return AZ_ERROR_ITEM_NOT_FOUND;
     }
@@ -558,9 +541,12 @@ AZ_NODISCARD az_result az_iot_provisioning_client_parse_received_topic_and_paylo
   _az_PRECONDITION_VALID_SPAN(received_payload, 1, false);
   _az_PRECONDITION_NOT_NULL(out_response);
 
+  // The topic is parsed in one pass: the prefix, the status, then each property.
   az_span str_dps_registrations_res = _az_iot_provisioning_get_dps_registrations_res();
-  int32_t idx = az_span_find(received_topic, str_dps_registrations_res);
-  if (idx != 0)
+  int32_t const prefix_size = az_span_size(str_dps_registrations_res);
+  if (az_span_size(received_topic) < prefix_size
+      || !az_span_is_content_equal(
+          az_span_slice(received_topic, 0, prefix_size), str_dps_registrations_res))
   {
     return AZ_ERROR_IOT_TOPIC_NO_MATCH;
   }
@@ -569,25 +555,30 @@ AZ_NODISCARD az_result az_iot_provisioning_client_parse_received_topic_and_paylo
   _az_LOG_WRITE(AZ_LOG_MQTT_RECEIVED_PAYLOAD, received_payload);
 
   // Parse the status.
-  az_span remainder = az_span_slice_to_end(received_topic, az_span_size(str_dps_registrations_res));
+  az_span remainder = az_span_slice_to_end(received_topic, prefix_size);
 
   int32_t index = 0;
   az_span int_slice = _az_span_token(remainder, AZ_SPAN_FROM_STR("/"), &remainder, &index);
   _az_RETURN_IF_FAILED(az_span_atou32(int_slice, (uint32_t*)(&out_response->status)));
 
-  // Parse the optional retry-after= field.
+  // Parse the optional retry-after= property.
   az_span retry_after = AZ_SPAN_FROM_STR("retry-after=");
-  idx = az_span_find(remainder, retry_after);
-  if (idx != -1)
+  int32_t const retry_after_size = az_span_size(retry_after);
+  out_response->retry_after_seconds = 0;
+  if (az_span_size(remainder) > 0 && az_span_ptr(remainder)[0] == '?')
   {
-    remainder = az_span_slice_to_end(remainder, idx + az_span_size(retry_after));
-    int_slice = _az_span_token(remainder, AZ_SPAN_FROM_STR("&"), &remainder, &index);
-
-    _az_RETURN_IF_FAILED(az_span_atou32(int_slice, &out_response->retry_after_seconds));
+    remainder = az_span_slice_to_end(remainder, 1);
   }
-  else
+
+  while (az_span_size(remainder) > 0)
   {
-    out_response->retry_after_seconds = 0;
+    az_span property = _az_span_token(remainder, AZ_SPAN_FROM_STR("&"), &remainder, &index);
+    if (az_span_size(property) >= retry_after_size
+        && az_span_is_content_equal(az_span_slice(property, 0, retry_after_size), retry_after))
+    {
+      _az_RETURN_IF_FAILED(az_span_atou32(
+          az_span_slice_to_end(property, retry_after_size), &out_response->retry_after_seconds));
+    }
   }
 
   _az_RETURN_IF_FAILED(az_iot_provisioning_client_parse_payload(received_payload, out_response));
@@ -619,20 +610,14 @@ AZ_NODISCARD az_result az_iot_provisioning_client_register_get_request_payload(
   az_json_writer json_writer;
   az_span payload_buffer = az_span_create(mqtt_payload, (int32_t)mqtt_payload_size);
 
-  _az_RETURN_IF_FAILED(az_json_writer_init(&json_writer, payload_buffer, NULL));
-  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(&json_writer));
-  _az_RETURN_IF_FAILED(
-      az_json_writer_append_property_name(&json_writer, prov_registration_id_label));
-  _az_RETURN_IF_FAILED(
-      az_json_writer_append_string(&json_writer, client->_internal.registration_id));
-
-  if (az_span_size(custom_payload_property) > 0)
-  {
-    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(&json_writer, prov_payload_label));
-    _az_RETURN_IF_FAILED(az_json_writer_append_json_text(&json_writer, custom_payload_property));
-  }
+  // The custom payload is not written when it is empty.
+  _az_iot_provisioning_client_request_payload const request = {
+    .registration_id = client->_internal.registration_id,
+    .payload = custom_payload_property,
+  };
 
-  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(&json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_init(&json_writer, payload_buffer, NULL));
+  _az_RETURN_IF_FAILED(az_json_binding_write(&json_writer, &request_binding, &request));
   *out_mqtt_payload_length
       = (size_t)az_span_size(az_json_writer_get_bytes_used_in_destination(&json_writer));
   ;
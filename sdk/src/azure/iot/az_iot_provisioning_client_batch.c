@@ -0,0 +1,417 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_base64.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_provisioning_client.h>
+#include <azure/iot/az_iot_provisioning_client_batch.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+#include <azure/iot/internal/az_iot_sha256_internal.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_MAX_IN_FLIGHT = 64,
+  _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_RESPONSE_TIMEOUT_MSEC = 30000,
+  _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_RETRY_AFTER_SECONDS = 3,
+  _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_TICK_MSEC = 1000,
+};
+
+// Registrations that are pending or in flight are scheduled on the timer wheel at the time their
+// next request is due.
+
+AZ_INLINE bool _az_iot_provisioning_client_batch_is_scheduled(
+    az_iot_provisioning_client_batch_registration const* registration)
+{
+  return registration->_internal.status == AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_PENDING
+      || registration->_internal.status == AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_IN_FLIGHT;
+}
+
+static void
+_az_iot_provisioning_client_batch_unlink(az_iot_provisioning_client_batch* ref_batch, int32_t index)
+{
+  _az_iot_timer_wheel_unlink(&ref_batch->_internal.wheel, index);
+
+  if (ref_batch->_internal.registrations[index]._internal.status
+      == AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_IN_FLIGHT)
+  {
+    ref_batch->_internal.in_flight_count--;
+  }
+}
+
+// Filters the due requests down to those in flight, whose response timed out: they don't take
+// more room in flight when published again.
+static bool _az_iot_provisioning_client_batch_is_in_flight(int32_t index, void* user_context)
+{
+  az_iot_provisioning_client_batch const* const batch
+      = (az_iot_provisioning_client_batch const*)user_context;
+  return batch->_internal.registrations[index]._internal.status
+      == AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_IN_FLIGHT;
+}
+
+// Decodes the group key, and computes the raw device key: the HMAC-SHA256 of the registration ID.
+static az_result _az_iot_provisioning_client_batch_derive_raw_device_key(
+    az_span group_key,
+    az_span registration_id,
+    az_span out_device_key)
+{
+  // Decoding checks room for the most bytes the text could hold, before discounting its padding.
+  uint8_t group_key_buffer[_az_IOT_SHA256_BLOCK_SIZE + 2];
+  az_span const group_key_span = AZ_SPAN_FROM_BUFFER(group_key_buffer);
+  int32_t group_key_size = 0;
+  _az_RETURN_IF_FAILED(az_base64_decode(group_key_span, group_key, &group_key_size));
+
+  _az_iot_hmac_sha256(
+      az_span_slice(group_key_span, 0, group_key_size), registration_id, out_device_key);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_iot_provisioning_client_batch_options
+az_iot_provisioning_client_batch_options_default(void)
+{
+  return (az_iot_provisioning_client_batch_options){
+    .client_options = az_iot_provisioning_client_options_default(),
+    .max_in_flight = _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_MAX_IN_FLIGHT,
+    .response_timeout_msec = _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_RESPONSE_TIMEOUT_MSEC,
+    .default_retry_after_seconds = _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_RETRY_AFTER_SECONDS,
+    .tick_msec = _az_IOT_PROVISIONING_CLIENT_BATCH_DEFAULT_TICK_MSEC,
+  };
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_init(
+    az_iot_provisioning_client_batch* out_batch,
+    az_span global_device_hostname,
+    az_span id_scope,
+    az_iot_provisioning_client_batch_registration registrations[],
+    int32_t registrations_length,
+    az_iot_provisioning_client_batch_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_batch);
+  _az_PRECONDITION_VALID_SPAN(global_device_hostname, 1, false);
+  _az_PRECONDITION_VALID_SPAN(id_scope, 1, false);
+  _az_PRECONDITION_NOT_NULL(registrations);
+  _az_PRECONDITION(registrations_length > 0);
+
+  *out_batch = (az_iot_provisioning_client_batch){
+    ._internal = {
+      .global_device_endpoint = global_device_hostname,
+      .id_scope = id_scope,
+      .registrations = registrations,
+      .registrations_length = registrations_length,
+      .in_flight_count = 0,
+      .options = options == NULL ? az_iot_provisioning_client_batch_options_default() : *options,
+    },
+  };
+
+  _az_PRECONDITION(out_batch->_internal.options.max_in_flight > 0);
+  _az_PRECONDITION(out_batch->_internal.options.response_timeout_msec >= 0);
+  _az_PRECONDITION(out_batch->_internal.options.tick_msec > 0);
+
+  for (int32_t i = 0; i < registrations_length; i++)
+  {
+    registrations[i] = (az_iot_provisioning_client_batch_registration){ 0 };
+  }
+
+  _az_iot_timer_wheel_init(
+      &out_batch->_internal.wheel,
+      &registrations[0]._internal.timer,
+      (int32_t)sizeof(az_iot_provisioning_client_batch_registration),
+      out_batch->_internal.options.tick_msec);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_add(
+    az_iot_provisioning_client_batch* ref_batch,
+    az_span registration_id,
+    void* user_context,
+    int32_t* out_index)
+{
+  _az_PRECONDITION_NOT_NULL(ref_batch);
+  _az_PRECONDITION_VALID_SPAN(registration_id, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_index);
+
+  az_iot_provisioning_client_batch_registration* const registrations
+      = ref_batch->_internal.registrations;
+
+  int32_t index = 0;
+  while (index < ref_batch->_internal.registrations_length
+         && registrations[index]._internal.status != AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_UNUSED)
+  {
+    index++;
+  }
+
+  if (index == ref_batch->_internal.registrations_length)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  registrations[index] = (az_iot_provisioning_client_batch_registration){
+    ._internal = {
+      .registration_id = registration_id,
+      .user_context = user_context,
+      .status = AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_PENDING,
+      .operation_id_length = 0,
+    },
+  };
+  _az_iot_timer_wheel_link(&ref_batch->_internal.wheel, index, now);
+
+  *out_index = index;
+  return AZ_OK;
+}
+
+void az_iot_provisioning_client_batch_remove(
+    az_iot_provisioning_client_batch* ref_batch,
+    int32_t index)
+{
+  _az_PRECONDITION_NOT_NULL(ref_batch);
+  _az_PRECONDITION_RANGE(0, index, ref_batch->_internal.registrations_length - 1);
+
+  az_iot_provisioning_client_batch_registration* const registration
+      = &ref_batch->_internal.registrations[index];
+  _az_PRECONDITION(
+      registration->_internal.status != AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_UNUSED);
+
+  if (_az_iot_provisioning_client_batch_is_scheduled(registration))
+  {
+    _az_iot_provisioning_client_batch_unlink(ref_batch, index);
+  }
+
+  *registration = (az_iot_provisioning_client_batch_registration){ 0 };
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_get_client(
+    az_iot_provisioning_client_batch const* batch,
+    int32_t index,
+    az_iot_provisioning_client* out_client)
+{
+  _az_PRECONDITION_NOT_NULL(batch);
+  _az_PRECONDITION_RANGE(0, index, batch->_internal.registrations_length - 1);
+  _az_PRECONDITION(
+      batch->_internal.registrations[index]._internal.status
+      != AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_UNUSED);
+  _az_PRECONDITION_NOT_NULL(out_client);
+
+  return az_iot_provisioning_client_init(
+      out_client,
+      batch->_internal.global_device_endpoint,
+      batch->_internal.id_scope,
+      batch->_internal.registrations[index]._internal.registration_id,
+      &batch->_internal.options.client_options);
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_get_next_request(
+    az_iot_provisioning_client_batch* ref_batch,
+    int32_t* out_index,
+    az_iot_provisioning_client_batch_request* out_request,
+    char* mqtt_topic,
+    size_t mqtt_topic_size,
+    size_t* out_mqtt_topic_length)
+{
+  _az_PRECONDITION_NOT_NULL(ref_batch);
+  _az_PRECONDITION_NOT_NULL(out_index);
+  _az_PRECONDITION_NOT_NULL(out_request);
+  _az_PRECONDITION_NOT_NULL(mqtt_topic);
+  _az_PRECONDITION(mqtt_topic_size > 0);
+
+  if (az_iot_provisioning_client_batch_get_pending_count(ref_batch) == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  bool const window_full
+      = ref_batch->_internal.in_flight_count >= ref_batch->_internal.options.max_in_flight;
+  int32_t const index = _az_iot_timer_wheel_find_expired(
+      &ref_batch->_internal.wheel,
+      now,
+      window_full ? _az_iot_provisioning_client_batch_is_in_flight : NULL,
+      ref_batch);
+  if (index == _az_IOT_TIMER_WHEEL_NO_ENTRY)
+  {
+    return window_full ? AZ_ERROR_NOT_ENOUGH_SPACE : AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  az_iot_provisioning_client_batch_registration* const registration
+      = &ref_batch->_internal.registrations[index];
+  az_iot_provisioning_client client;
+  _az_RETURN_IF_FAILED(az_iot_provisioning_client_batch_get_client(ref_batch, index, &client));
+
+  az_iot_provisioning_client_batch_request request
+      = AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_REGISTER;
+  if (registration->_internal.operation_id_length == 0)
+  {
+    _az_RETURN_IF_FAILED(az_iot_provisioning_client_register_get_publish_topic(
+        &client, mqtt_topic, mqtt_topic_size, out_mqtt_topic_length));
+  }
+  else
+  {
+    request = AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_QUERY_STATUS;
+    _az_RETURN_IF_FAILED(az_iot_provisioning_client_query_status_get_publish_topic(
+        &client,
+        az_span_create(
+            registration->_internal.operation_id, registration->_internal.operation_id_length),
+        mqtt_topic,
+        mqtt_topic_size,
+        out_mqtt_topic_length));
+  }
+
+  // The request is due again if its response doesn't arrive in time.
+  _az_iot_provisioning_client_batch_unlink(ref_batch, index);
+  registration->_internal.status = AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_IN_FLIGHT;
+  _az_iot_timer_wheel_link(
+      &ref_batch->_internal.wheel, index, now + ref_batch->_internal.options.response_timeout_msec);
+  ref_batch->_internal.in_flight_count++;
+
+  *out_index = index;
+  *out_request = request;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_handle_response(
+    az_iot_provisioning_client_batch* ref_batch,
+    int32_t index,
+    az_iot_provisioning_client_register_response const* response)
+{
+  _az_PRECONDITION_NOT_NULL(ref_batch);
+  _az_PRECONDITION_RANGE(0, index, ref_batch->_internal.registrations_length - 1);
+  _az_PRECONDITION(
+      ref_batch->_internal.registrations[index]._internal.status
+      != AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_UNUSED);
+  _az_PRECONDITION_NOT_NULL(response);
+
+  az_iot_provisioning_client_batch_registration* const registration
+      = &ref_batch->_internal.registrations[index];
+  if (!_az_iot_provisioning_client_batch_is_scheduled(registration))
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  bool const retriable = az_iot_status_retriable(response->status);
+  if (!retriable && az_iot_provisioning_client_operation_complete(response->operation_status))
+  {
+    _az_iot_provisioning_client_batch_unlink(ref_batch, index);
+    registration->_internal.status
+        = response->operation_status == AZ_IOT_PROVISIONING_STATUS_ASSIGNED
+        ? AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_ASSIGNED
+        : AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_FAILED;
+    return AZ_OK;
+  }
+
+  if (!retriable)
+  {
+    int32_t const operation_id_length = az_span_size(response->operation_id);
+    if (operation_id_length > AZ_IOT_PROVISIONING_CLIENT_BATCH_OPERATION_ID_MAX_SIZE)
+    {
+      return AZ_ERROR_NOT_ENOUGH_SPACE;
+    }
+
+    az_span_copy(AZ_SPAN_FROM_BUFFER(registration->_internal.operation_id), response->operation_id);
+    registration->_internal.operation_id_length = operation_id_length;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  uint32_t const retry_after_seconds = response->retry_after_seconds > 0
+      ? response->retry_after_seconds
+      : ref_batch->_internal.options.default_retry_after_seconds;
+
+  _az_iot_provisioning_client_batch_unlink(ref_batch, index);
+  registration->_internal.status = AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_PENDING;
+  _az_iot_timer_wheel_link(
+      &ref_batch->_internal.wheel, index, now + (int64_t)retry_after_seconds * 1000);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_derive_device_key(
+    az_span group_key,
+    az_span registration_id,
+    az_span device_key_buffer,
+    az_span* out_device_key)
+{
+  _az_PRECONDITION_VALID_SPAN(group_key, 1, false);
+  _az_PRECONDITION_VALID_SPAN(registration_id, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_device_key);
+
+  if (az_span_size(device_key_buffer) < AZ_IOT_PROVISIONING_CLIENT_BATCH_DEVICE_KEY_BUFFER_SIZE)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  uint8_t device_key[_az_IOT_SHA256_DIGEST_SIZE];
+  _az_RETURN_IF_FAILED(_az_iot_provisioning_client_batch_derive_raw_device_key(
+      group_key, registration_id, AZ_SPAN_FROM_BUFFER(device_key)));
+
+  int32_t device_key_size = 0;
+  _az_RETURN_IF_FAILED(
+      az_base64_encode(device_key_buffer, AZ_SPAN_FROM_BUFFER(device_key), &device_key_size));
+
+  *out_device_key = az_span_slice(device_key_buffer, 0, device_key_size);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_provisioning_client_batch_sas_get_password(
+    az_iot_provisioning_client_batch const* batch,
+    int32_t index,
+    az_span group_key,
+    uint64_t token_expiration_epoch_time,
+    char* mqtt_password,
+    size_t mqtt_password_size,
+    size_t* out_mqtt_password_length)
+{
+  _az_PRECONDITION_NOT_NULL(batch);
+  _az_PRECONDITION_RANGE(0, index, batch->_internal.registrations_length - 1);
+  _az_PRECONDITION_VALID_SPAN(group_key, 1, false);
+  _az_PRECONDITION(token_expiration_epoch_time > 0);
+  _az_PRECONDITION_NOT_NULL(mqtt_password);
+  _az_PRECONDITION(mqtt_password_size > 0);
+
+  az_iot_provisioning_client client;
+  _az_RETURN_IF_FAILED(az_iot_provisioning_client_batch_get_client(batch, index, &client));
+
+  uint8_t device_key[_az_IOT_SHA256_DIGEST_SIZE];
+  _az_RETURN_IF_FAILED(_az_iot_provisioning_client_batch_derive_raw_device_key(
+      group_key, client._internal.registration_id, AZ_SPAN_FROM_BUFFER(device_key)));
+
+  // The signature is shorter than the password, which holds its URL encoded resource string and
+  // expiration time, so the password buffer holds it until it is signed.
+  az_span signature = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(az_iot_provisioning_client_sas_get_signature(
+      &client,
+      token_expiration_epoch_time,
+      az_span_create((uint8_t*)mqtt_password, (int32_t)mqtt_password_size),
+      &signature));
+
+  uint8_t signature_hmac[_az_IOT_SHA256_DIGEST_SIZE];
+  _az_iot_hmac_sha256(
+      AZ_SPAN_FROM_BUFFER(device_key), signature, AZ_SPAN_FROM_BUFFER(signature_hmac));
+
+  uint8_t base64_signature_hmac[AZ_IOT_PROVISIONING_CLIENT_BATCH_DEVICE_KEY_BUFFER_SIZE];
+  int32_t base64_signature_hmac_size = 0;
+  _az_RETURN_IF_FAILED(az_base64_encode(
+      AZ_SPAN_FROM_BUFFER(base64_signature_hmac),
+      AZ_SPAN_FROM_BUFFER(signature_hmac),
+      &base64_signature_hmac_size));
+
+  return az_iot_provisioning_client_sas_get_password(
+      &client,
+      az_span_create(base64_signature_hmac, base64_signature_hmac_size),
+      token_expiration_epoch_time,
+      AZ_SPAN_EMPTY,
+      mqtt_password,
+      mqtt_password_size,
+      out_mqtt_password_length);
+}
@@ -0,0 +1,193 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include <azure/core/az_platform.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_request_table.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  _az_IOT_REQUEST_TABLE_DEFAULT_TICK_MSEC = 1000,
+};
+
+// The entry of request ID id is always (id - 1) % entries_length, which makes lookups by request
+// ID constant time. Pending entries are scheduled on the timer wheel at their deadline.
+
+AZ_INLINE int32_t
+_az_iot_request_table_get_index(az_iot_request_table const* table, uint32_t request_id)
+{
+  return (int32_t)((request_id - 1U) % (uint32_t)table->_internal.entries_length);
+}
+
+static void _az_iot_request_table_remove_entry(
+    az_iot_request_table* ref_table,
+    int32_t index,
+    void** out_user_context)
+{
+  az_iot_request_table_entry* const entry = &ref_table->_internal.entries[index];
+
+  _az_iot_timer_wheel_unlink(&ref_table->_internal.wheel, index);
+
+  if (out_user_context != NULL)
+  {
+    *out_user_context = entry->_internal.user_context;
+  }
+
+  entry->_internal.request_id = 0;
+  entry->_internal.user_context = NULL;
+}
+
+AZ_NODISCARD az_iot_request_table_options az_iot_request_table_options_default(void)
+{
+  return (az_iot_request_table_options){
+    .tick_msec = _az_IOT_REQUEST_TABLE_DEFAULT_TICK_MSEC,
+  };
+}
+
+AZ_NODISCARD az_result az_iot_request_table_init(
+    az_iot_request_table* out_table,
+    az_iot_request_table_entry entries[],
+    int32_t entries_length,
+    az_iot_request_table_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_table);
+  _az_PRECONDITION_NOT_NULL(entries);
+  _az_PRECONDITION(entries_length > 0);
+
+  *out_table = (az_iot_request_table){
+    ._internal = {
+      .entries = entries,
+      .entries_length = entries_length,
+      .next_request_id = 1,
+      .options = options == NULL ? az_iot_request_table_options_default() : *options,
+    },
+  };
+
+  _az_PRECONDITION(out_table->_internal.options.tick_msec > 0);
+
+  for (int32_t i = 0; i < entries_length; i++)
+  {
+    entries[i] = (az_iot_request_table_entry){ 0 };
+  }
+
+  _az_iot_timer_wheel_init(
+      &out_table->_internal.wheel,
+      &entries[0]._internal.timer,
+      (int32_t)sizeof(az_iot_request_table_entry),
+      out_table->_internal.options.tick_msec);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_request_table_add(
+    az_iot_request_table* ref_table,
+    void* user_context,
+    int32_t timeout_msec,
+    az_span request_id_buffer,
+    az_span* out_request_id)
+{
+  _az_PRECONDITION_NOT_NULL(ref_table);
+  _az_PRECONDITION(timeout_msec >= 0);
+  _az_PRECONDITION_VALID_SPAN(
+      request_id_buffer, AZ_IOT_REQUEST_TABLE_REQUEST_ID_BUFFER_SIZE, false);
+  _az_PRECONDITION_NOT_NULL(out_request_id);
+
+  if (az_iot_request_table_get_count(ref_table) >= ref_table->_internal.entries_length)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  // Request IDs are handed out in order, skipping those whose entry is still in use. Since the
+  // table isn't full, a free entry is found within two passes over the entries, the second one
+  // covering the jump when request IDs wrap back to 1.
+  uint32_t request_id = 0;
+  int32_t index = 0;
+  for (int32_t attempt = 0; attempt < 2 * ref_table->_internal.entries_length; attempt++)
+  {
+    uint32_t const candidate = ref_table->_internal.next_request_id;
+    ref_table->_internal.next_request_id = candidate == UINT32_MAX ? 1 : candidate + 1U;
+
+    index = _az_iot_request_table_get_index(ref_table, candidate);
+    if (ref_table->_internal.entries[index]._internal.request_id == 0)
+    {
+      request_id = candidate;
+      break;
+    }
+  }
+
+  if (request_id == 0)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_span remainder = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(az_span_u32toa(request_id_buffer, request_id, &remainder));
+
+  az_iot_request_table_entry* const entry = &ref_table->_internal.entries[index];
+  entry->_internal.user_context = user_context;
+  entry->_internal.request_id = request_id;
+  _az_iot_timer_wheel_link(&ref_table->_internal.wheel, index, now + timeout_msec);
+
+  *out_request_id = az_span_slice(
+      request_id_buffer, 0, az_span_size(request_id_buffer) - az_span_size(remainder));
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_request_table_remove(
+    az_iot_request_table* ref_table,
+    az_span request_id,
+    void** out_user_context)
+{
+  _az_PRECONDITION_NOT_NULL(ref_table);
+  _az_PRECONDITION_VALID_SPAN(request_id, 1, false);
+
+  uint32_t id = 0;
+  if (az_result_failed(az_span_atou32(request_id, &id)) || id == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  int32_t const index = _az_iot_request_table_get_index(ref_table, id);
+  if (ref_table->_internal.entries[index]._internal.request_id != id)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  _az_iot_request_table_remove_entry(ref_table, index, out_user_context);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_iot_request_table_get_expired(az_iot_request_table* ref_table, void** out_user_context)
+{
+  _az_PRECONDITION_NOT_NULL(ref_table);
+
+  if (az_iot_request_table_get_count(ref_table) == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  int32_t const index
+      = _az_iot_timer_wheel_find_expired(&ref_table->_internal.wheel, now, NULL, NULL);
+  if (index == _az_IOT_TIMER_WHEEL_NO_ENTRY)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  _az_iot_request_table_remove_entry(ref_table, index, out_user_context);
+  return AZ_OK;
+}
@@ -0,0 +1,182 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/az_iot_retry_backoff.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <azure/core/internal/az_log_internal.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  _az_IOT_RETRY_BACKOFF_DEFAULT_MIN_DELAY_MSEC = 1000,
+  _az_IOT_RETRY_BACKOFF_DEFAULT_MAX_DELAY_MSEC = 100000,
+  _az_IOT_RETRY_BACKOFF_DECORRELATED_JITTER_FACTOR = 3,
+};
+
+// The jitter comes from a 32-bit xorshift generator. Its state is the FNV-1a hash of the seed,
+// passed through the MurmurHash3 finalizer so that similar seeds, such as device IDs differing
+// only in their last character, start far apart.
+
+AZ_INLINE uint32_t _az_iot_retry_backoff_mix(uint32_t hash)
+{
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6BU;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+AZ_INLINE uint32_t _az_iot_retry_backoff_next_random(az_iot_retry_backoff* ref_backoff)
+{
+  uint32_t state = ref_backoff->_internal.random_state;
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  ref_backoff->_internal.random_state = state;
+  return state;
+}
+
+// Returns a random delay between min_msec and max_msec, inclusive.
+AZ_INLINE int32_t _az_iot_retry_backoff_random_delay(
+    az_iot_retry_backoff* ref_backoff,
+    int32_t min_msec,
+    int32_t max_msec)
+{
+  uint32_t const range = (uint32_t)(max_msec - min_msec) + 1U;
+  return min_msec + (int32_t)(_az_iot_retry_backoff_next_random(ref_backoff) % range);
+}
+
+// Returns the minimum delay doubled for every attempt, capped at the maximum delay.
+AZ_INLINE int32_t _az_iot_retry_backoff_exponential_delay(az_iot_retry_backoff const* backoff)
+{
+  int32_t const max_msec = backoff->_internal.options.max_retry_delay_msec;
+  int16_t const attempt = backoff->_internal.attempt;
+  if (attempt > 30)
+  {
+    return max_msec;
+  }
+
+  int64_t const delay = (int64_t)backoff->_internal.options.min_retry_delay_msec << attempt;
+  return delay > max_msec ? max_msec : (int32_t)delay;
+}
+
+AZ_NODISCARD az_iot_retry_backoff_options az_iot_retry_backoff_options_default(void)
+{
+  return (az_iot_retry_backoff_options){
+    .strategy = AZ_IOT_RETRY_BACKOFF_DECORRELATED_JITTER,
+    .min_retry_delay_msec = _az_IOT_RETRY_BACKOFF_DEFAULT_MIN_DELAY_MSEC,
+    .max_retry_delay_msec = _az_IOT_RETRY_BACKOFF_DEFAULT_MAX_DELAY_MSEC,
+  };
+}
+
+AZ_NODISCARD az_result az_iot_retry_backoff_init(
+    az_iot_retry_backoff* out_backoff,
+    az_span seed,
+    az_iot_retry_backoff_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_backoff);
+  _az_PRECONDITION_VALID_SPAN(seed, 1, false);
+
+  *out_backoff = (az_iot_retry_backoff){
+    ._internal = {
+      .options = options == NULL ? az_iot_retry_backoff_options_default() : *options,
+      .random_state = _az_iot_retry_backoff_mix(_az_iot_fnv1a(_az_IOT_FNV1A_OFFSET_BASIS, seed)),
+    },
+  };
+
+  _az_PRECONDITION(out_backoff->_internal.options.min_retry_delay_msec > 0);
+  _az_PRECONDITION(
+      out_backoff->_internal.options.min_retry_delay_msec
+      <= out_backoff->_internal.options.max_retry_delay_msec);
+
+  // A xorshift generator stays at 0 forever.
+  if (out_backoff->_internal.random_state == 0)
+  {
+    out_backoff->_internal.random_state = _az_IOT_FNV1A_OFFSET_BASIS;
+  }
+
+  az_iot_retry_backoff_reset(out_backoff);
+  return AZ_OK;
+}
+
+AZ_NODISCARD int32_t az_iot_retry_backoff_get_delay(
+    az_iot_retry_backoff* ref_backoff,
+    int32_t operation_msec,
+    uint32_t retry_after_seconds)
+{
+  _az_PRECONDITION_NOT_NULL(ref_backoff);
+  _az_PRECONDITION_RANGE(0, operation_msec, INT32_MAX - 1);
+
+  if (_az_LOG_SHOULD_WRITE(AZ_LOG_IOT_RETRY))
+  {
+    _az_LOG_WRITE(AZ_LOG_IOT_RETRY, AZ_SPAN_EMPTY);
+  }
+
+  az_iot_retry_backoff_options const* const options = &ref_backoff->_internal.options;
+  int32_t delay = 0;
+
+  switch (options->strategy)
+  {
+    case AZ_IOT_RETRY_BACKOFF_FULL_JITTER:
+      delay = _az_iot_retry_backoff_random_delay(
+          ref_backoff, 0, _az_iot_retry_backoff_exponential_delay(ref_backoff));
+      break;
+
+    case AZ_IOT_RETRY_BACKOFF_EXPONENTIAL:
+      delay = _az_iot_retry_backoff_exponential_delay(ref_backoff);
+      break;
+
+    case AZ_IOT_RETRY_BACKOFF_DECORRELATED_JITTER:
+    default:
+    {
+      int64_t const max_delay = (int64_t)ref_backoff->_internal.previous_delay_msec
+          * _az_IOT_RETRY_BACKOFF_DECORRELATED_JITTER_FACTOR;
+      delay = _az_iot_retry_backoff_random_delay(
+          ref_backoff,
+          options->min_retry_delay_msec,
+          max_delay > options->max_retry_delay_msec ? options->max_retry_delay_msec
+                                                    : (int32_t)max_delay);
+      ref_backoff->_internal.previous_delay_msec = delay;
+      break;
+    }
+  }
+
+  if (ref_backoff->_internal.attempt < INT16_MAX)
+  {
+    ref_backoff->_internal.attempt++;
+  }
+
+  delay = delay > operation_msec ? delay - operation_msec : 0;
+
+  // The service knows best when it can take the device back.
+  if (retry_after_seconds > 0)
+  {
+    int32_t const retry_after_msec = retry_after_seconds >= (uint32_t)(INT32_MAX / 1000)
+        ? INT32_MAX
+        : (int32_t)retry_after_seconds * 1000;
+    if (retry_after_msec > delay)
+    {
+      delay = retry_after_msec;
+    }
+  }
+
+  return delay;
+}
+
+void az_iot_retry_backoff_reset(az_iot_retry_backoff* ref_backoff)
+{
+  _az_PRECONDITION_NOT_NULL(ref_backoff);
+
+  ref_backoff->_internal.attempt = 0;
+  ref_backoff->_internal.previous_delay_msec = ref_backoff->_internal.options.min_retry_delay_msec;
+}
@@ -0,0 +1,229 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/iot/internal/az_iot_sha256_internal.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+static const uint32_t sha256_round_constants[64] = {
+  0x428A2F98U, 0x71374491U, 0xB5C0FBCFU, 0xE9B5DBA5U, 0x3956C25BU, 0x59F111F1U, 0x923F82A4U,
+  0xAB1C5ED5U, 0xD807AA98U, 0x12835B01U, 0x243185BEU, 0x550C7DC3U, 0x72BE5D74U, 0x80DEB1FEU,
+  0x9BDC06A7U, 0xC19BF174U, 0xE49B69C1U, 0xEFBE4786U, 0x0FC19DC6U, 0x240CA1CCU, 0x2DE92C6FU,
+  0x4A7484AAU, 0x5CB0A9DCU, 0x76F988DAU, 0x983E5152U, 0xA831C66DU, 0xB00327C8U, 0xBF597FC7U,
+  0xC6E00BF3U, 0xD5A79147U, 0x06CA6351U, 0x14292967U, 0x27B70A85U, 0x2E1B2138U, 0x4D2C6DFCU,
+  0x53380D13U, 0x650A7354U, 0x766A0ABBU, 0x81C2C92EU, 0x92722C85U, 0xA2BFE8A1U, 0xA81A664BU,
+  0xC24B8B70U, 0xC76C51A3U, 0xD192E819U, 0xD6990624U, 0xF40E3585U, 0x106AA070U, 0x19A4C116U,
+  0x1E376C08U, 0x2748774CU, 0x34B0BCB5U, 0x391C0CB3U, 0x4ED8AA4AU, 0x5B9CCA4FU, 0x682E6FF3U,
+  0x748F82EEU, 0x78A5636FU, 0x84C87814U, 0x8CC70208U, 0x90BEFFFAU, 0xA4506CEBU, 0xBEF9A3F7U,
+  0xC67178F2U,
+};
+
+AZ_INLINE uint32_t _az_iot_sha256_rotate_right(uint32_t value, uint32_t count)
+{
+  return (value >> count) | (value << (32U - count));
+}
+
+static void _az_iot_sha256_process_block(_az_iot_sha256* ref_sha256, uint8_t const* block)
+{
+  uint32_t schedule[64];
+  for (int32_t i = 0; i < 16; i++)
+  {
+    schedule[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16
+        | (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+  }
+
+  for (int32_t i = 16; i < 64; i++)
+  {
+    uint32_t const s0 = _az_iot_sha256_rotate_right(schedule[i - 15], 7)
+        ^ _az_iot_sha256_rotate_right(schedule[i - 15], 18) ^ (schedule[i - 15] >> 3);
+    uint32_t const s1 = _az_iot_sha256_rotate_right(schedule[i - 2], 17)
+        ^ _az_iot_sha256_rotate_right(schedule[i - 2], 19) ^ (schedule[i - 2] >> 10);
+    schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+  }
+
+  uint32_t a = ref_sha256->state[0];
+  uint32_t b = ref_sha256->state[1];
+  uint32_t c = ref_sha256->state[2];
+  uint32_t d = ref_sha256->state[3];
+  uint32_t e = ref_sha256->state[4];
+  uint32_t f = ref_sha256->state[5];
+  uint32_t g = ref_sha256->state[6];
+  uint32_t h = ref_sha256->state[7];
+
+  for (int32_t i = 0; i < 64; i++)
+  {
+    uint32_t const s1 = _az_iot_sha256_rotate_right(e, 6) ^ _az_iot_sha256_rotate_right(e, 11)
+        ^ _az_iot_sha256_rotate_right(e, 25);
+    uint32_t const choice = (e & f) ^ (~e & g);
+    uint32_t const temp1 = h + s1 + choice + sha256_round_constants[i] + schedule[i];
+    uint32_t const s0 = _az_iot_sha256_rotate_right(a, 2) ^ _az_iot_sha256_rotate_right(a, 13)
+        ^ _az_iot_sha256_rotate_right(a, 22);
+    uint32_t const majority = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t const temp2 = s0 + majority;
+
+    h = g;
+    g = f;
+    f = e;
+    e = d + temp1;
+    d = c;
+    c = b;
+    b = a;
+    a = temp1 + temp2;
+  }
+
+  ref_sha256->state[0] += a;
+  ref_sha256->state[1] += b;
+  ref_sha256->state[2] += c;
+  ref_sha256->state[3] += d;
+  ref_sha256->state[4] += e;
+  ref_sha256->state[5] += f;
+  ref_sha256->state[6] += g;
+  ref_sha256->state[7] += h;
+}
+
+void _az_iot_sha256_init(_az_iot_sha256* out_sha256)
+{
+  _az_PRECONDITION_NOT_NULL(out_sha256);
+
+  *out_sha256 = (_az_iot_sha256){
+    .state = {
+      0x6A09E667U,
+      0xBB67AE85U,
+      0x3C6EF372U,
+      0xA54FF53AU,
+      0x510E527FU,
+      0x9B05688CU,
+      0x1F83D9ABU,
+      0x5BE0CD19U,
+    },
+    .length = 0,
+    .block_length = 0,
+  };
+}
+
+void _az_iot_sha256_update(_az_iot_sha256* ref_sha256, az_span data)
+{
+  _az_PRECONDITION_NOT_NULL(ref_sha256);
+
+  uint8_t const* data_ptr = az_span_ptr(data);
+  int32_t data_size = az_span_size(data);
+  ref_sha256->length += (uint64_t)data_size;
+
+  // Complete the pending block first.
+  if (ref_sha256->block_length > 0)
+  {
+    while (data_size > 0 && ref_sha256->block_length < _az_IOT_SHA256_BLOCK_SIZE)
+    {
+      ref_sha256->block[ref_sha256->block_length++] = *data_ptr++;
+      data_size--;
+    }
+
+    if (ref_sha256->block_length < _az_IOT_SHA256_BLOCK_SIZE)
+    {
+      return;
+    }
+
+    _az_iot_sha256_process_block(ref_sha256, ref_sha256->block);
+    ref_sha256->block_length = 0;
+  }
+
+  // Process whole blocks in place, without copying them.
+  while (data_size >= _az_IOT_SHA256_BLOCK_SIZE)
+  {
+    _az_iot_sha256_process_block(ref_sha256, data_ptr);
+    data_ptr += _az_IOT_SHA256_BLOCK_SIZE;
+    data_size -= _az_IOT_SHA256_BLOCK_SIZE;
+  }
+
+  while (data_size > 0)
+  {
+    ref_sha256->block[ref_sha256->block_length++] = *data_ptr++;
+    data_size--;
+  }
+}
+
+void _az_iot_sha256_final(_az_iot_sha256* ref_sha256, az_span out_digest)
+{
+  _az_PRECONDITION_NOT_NULL(ref_sha256);
+  _az_PRECONDITION_VALID_SPAN(out_digest, _az_IOT_SHA256_DIGEST_SIZE, false);
+
+  uint64_t const length_bits = ref_sha256->length * 8U;
+
+  // Pad with a 1 bit, then 0 bits up to the last 8 bytes of a block, which hold the length.
+  ref_sha256->block[ref_sha256->block_length++] = 0x80;
+  if (ref_sha256->block_length > _az_IOT_SHA256_BLOCK_SIZE - 8)
+  {
+    while (ref_sha256->block_length < _az_IOT_SHA256_BLOCK_SIZE)
+    {
+      ref_sha256->block[ref_sha256->block_length++] = 0;
+    }
+    _az_iot_sha256_process_block(ref_sha256, ref_sha256->block);
+    ref_sha256->block_length = 0;
+  }
+
+  while (ref_sha256->block_length < _az_IOT_SHA256_BLOCK_SIZE - 8)
+  {
+    ref_sha256->block[ref_sha256->block_length++] = 0;
+  }
+
+  for (int32_t i = 0; i < 8; i++)
+  {
+    ref_sha256->block[_az_IOT_SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(length_bits >> (i * 8));
+  }
+  _az_iot_sha256_process_block(ref_sha256, ref_sha256->block);
+
+  uint8_t* digest_ptr = az_span_ptr(out_digest);
+  for (int32_t i = 0; i < 8; i++)
+  {
+    digest_ptr[i * 4] = (uint8_t)(ref_sha256->state[i] >> 24);
+    digest_ptr[i * 4 + 1] = (uint8_t)(ref_sha256->state[i] >> 16);
+    digest_ptr[i * 4 + 2] = (uint8_t)(ref_sha256->state[i] >> 8);
+    digest_ptr[i * 4 + 3] = (uint8_t)ref_sha256->state[i];
+  }
+}
+
+void _az_iot_hmac_sha256(az_span key, az_span data, az_span out_digest)
+{
+  _az_PRECONDITION_VALID_SPAN(key, 0, true);
+  _az_PRECONDITION_VALID_SPAN(out_digest, _az_IOT_SHA256_DIGEST_SIZE, false);
+
+  _az_iot_sha256 sha256;
+  uint8_t key_block[_az_IOT_SHA256_BLOCK_SIZE] = { 0 };
+  if (az_span_size(key) > _az_IOT_SHA256_BLOCK_SIZE)
+  {
+    _az_iot_sha256_init(&sha256);
+    _az_iot_sha256_update(&sha256, key);
+    _az_iot_sha256_final(&sha256, AZ_SPAN_FROM_BUFFER(key_block));
+  }
+  else
+  {
+    az_span_copy(AZ_SPAN_FROM_BUFFER(key_block), key);
+  }
+
+  // H((K ^ opad) || H((K ^ ipad) || data)), where ipad is 0x36 and opad is 0x5C repeated.
+  uint8_t pad[_az_IOT_SHA256_BLOCK_SIZE];
+  for (int32_t i = 0; i < _az_IOT_SHA256_BLOCK_SIZE; i++)
+  {
+    pad[i] = (uint8_t)(key_block[i] ^ 0x36);
+  }
+
+  uint8_t inner_digest[_az_IOT_SHA256_DIGEST_SIZE];
+  _az_iot_sha256_init(&sha256);
+  _az_iot_sha256_update(&sha256, AZ_SPAN_FROM_BUFFER(pad));
+  _az_iot_sha256_update(&sha256, data);
+  _az_iot_sha256_final(&sha256, AZ_SPAN_FROM_BUFFER(inner_digest));
+
+  for (int32_t i = 0; i < _az_IOT_SHA256_BLOCK_SIZE; i++)
+  {
+    pad[i] = (uint8_t)(key_block[i] ^ 0x5C);
+  }
+
+  _az_iot_sha256_init(&sha256);
+  _az_iot_sha256_update(&sha256, AZ_SPAN_FROM_BUFFER(pad));
+  _az_iot_sha256_update(&sha256, AZ_SPAN_FROM_BUFFER(inner_digest));
+  _az_iot_sha256_final(&sha256, out_digest);
+}
@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/internal/az_iot_common_internal.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+// Scheduled entries are linked, through the previous and next indexes of their node, into the list
+// of the slot of their deadline's tick. tick is the first tick whose slot may hold an expired entry
+// that wasn't found yet.
+
+AZ_INLINE int32_t _az_iot_timer_wheel_get_slot(int64_t tick)
+{
+  return (int32_t)(tick & (_az_IOT_TIMER_WHEEL_SIZE - 1));
+}
+
+AZ_INLINE int64_t _az_iot_timer_wheel_get_tick(_az_iot_timer_wheel const* wheel, int64_t msec)
+{
+  return msec / wheel->_internal.tick_msec;
+}
+
+void _az_iot_timer_wheel_init(
+    _az_iot_timer_wheel* out_wheel,
+    _az_iot_timer_wheel_node* first_node,
+    int32_t node_stride,
+    int32_t tick_msec)
+{
+  _az_PRECONDITION_NOT_NULL(out_wheel);
+  _az_PRECONDITION_NOT_NULL(first_node);
+  _az_PRECONDITION(node_stride >= (int32_t)sizeof(_az_iot_timer_wheel_node));
+  _az_PRECONDITION(tick_msec > 0);
+
+  *out_wheel = (_az_iot_timer_wheel){
+    ._internal = {
+      .first_node = first_node,
+      .node_stride = node_stride,
+      .tick_msec = tick_msec,
+      .count = 0,
+      .tick = 0,
+    },
+  };
+
+  for (int32_t i = 0; i < _az_IOT_TIMER_WHEEL_SIZE; i++)
+  {
+    out_wheel->_internal.slots[i] = _az_IOT_TIMER_WHEEL_NO_ENTRY;
+  }
+}
+
+void _az_iot_timer_wheel_link(_az_iot_timer_wheel* ref_wheel, int32_t index, int64_t deadline_msec)
+{
+  int64_t const tick = _az_iot_timer_wheel_get_tick(ref_wheel, deadline_msec);
+
+  // No slot needs to be visited for the ticks before the earliest deadline.
+  if (ref_wheel->_internal.count == 0 || tick < ref_wheel->_internal.tick)
+  {
+    ref_wheel->_internal.tick = tick;
+  }
+
+  int32_t* const head = &ref_wheel->_internal.slots[_az_iot_timer_wheel_get_slot(tick)];
+  _az_iot_timer_wheel_node* const node = _az_iot_timer_wheel_get_node(ref_wheel, index);
+
+  node->deadline_msec = deadline_msec;
+  node->previous = _az_IOT_TIMER_WHEEL_NO_ENTRY;
+  node->next = *head;
+  if (*head != _az_IOT_TIMER_WHEEL_NO_ENTRY)
+  {
+    _az_iot_timer_wheel_get_node(ref_wheel, *head)->previous = index;
+  }
+  *head = index;
+  ref_wheel->_internal.count++;
+}
+
+void _az_iot_timer_wheel_unlink(_az_iot_timer_wheel* ref_wheel, int32_t index)
+{
+  _az_iot_timer_wheel_node const* const node = _az_iot_timer_wheel_get_node(ref_wheel, index);
+
+  if (node->previous == _az_IOT_TIMER_WHEEL_NO_ENTRY)
+  {
+    ref_wheel->_internal.slots[_az_iot_timer_wheel_get_slot(
+        _az_iot_timer_wheel_get_tick(ref_wheel, node->deadline_msec))]
+        = node->next;
+  }
+  else
+  {
+    _az_iot_timer_wheel_get_node(ref_wheel, node->previous)->next = node->next;
+  }
+
+  if (node->next != _az_IOT_TIMER_WHEEL_NO_ENTRY)
+  {
+    _az_iot_timer_wheel_get_node(ref_wheel, node->next)->previous = node->previous;
+  }
+
+  ref_wheel->_internal.count--;
+}
+
+AZ_NODISCARD int32_t _az_iot_timer_wheel_find_expired(
+    _az_iot_timer_wheel* ref_wheel,
+    int64_t now_msec,
+    _az_iot_timer_wheel_filter_fn filter,
+    void* filter_context)
+{
+  if (ref_wheel->_internal.count == 0)
+  {
+    return _az_IOT_TIMER_WHEEL_NO_ENTRY;
+  }
+
+  int64_t const now_tick = _az_iot_timer_wheel_get_tick(ref_wheel, now_msec);
+
+  // After a full turn of the wheel, every slot has been visited.
+  if (now_tick - ref_wheel->_internal.tick >= _az_IOT_TIMER_WHEEL_SIZE)
+  {
+    ref_wheel->_internal.tick = now_tick - _az_IOT_TIMER_WHEEL_SIZE + 1;
+  }
+
+  int64_t tick = ref_wheel->_internal.tick;
+  bool advance = true;
+  while (true)
+  {
+    // A slot also holds the entries of later turns of the wheel, which are not expired yet.
+    int32_t index = ref_wheel->_internal.slots[_az_iot_timer_wheel_get_slot(tick)];
+    while (index != _az_IOT_TIMER_WHEEL_NO_ENTRY)
+    {
+      _az_iot_timer_wheel_node const* const node = _az_iot_timer_wheel_get_node(ref_wheel, index);
+      if (node->deadline_msec <= now_msec)
+      {
+        if (filter == NULL || filter(index, filter_context))
+        {
+          return index;
+        }
+        advance = false;
+      }
+      index = node->next;
+    }
+
+    // The slot of the current tick is visited again, as its entries expire during the tick.
+    if (tick >= now_tick)
+    {
+      return _az_IOT_TIMER_WHEEL_NO_ENTRY;
+    }
+
+    tick++;
+    if (advance)
+    {
+      ref_wheel->_internal.tick = tick;
+    }
+  }
+}
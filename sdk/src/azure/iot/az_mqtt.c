@@ -0,0 +1,609 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+#include <azure/iot/az_mqtt.h>
+
+#include <azure/core/_az_cfg.h>
+
+static const az_span mqtt_protocol_name_span = AZ_SPAN_LITERAL_FROM_STR("MQTT");
+
+enum
+{
+  _az_MQTT_PROTOCOL_LEVEL_3_1_1 = 4,
+  _az_MQTT_CONNECT_FLAG_USER_NAME = 0x80,
+  _az_MQTT_CONNECT_FLAG_PASSWORD = 0x40,
+  _az_MQTT_CONNECT_FLAG_CLEAN_SESSION = 0x02,
+  _az_MQTT_PUBLISH_FLAG_DUPLICATE = 0x08,
+  _az_MQTT_PUBLISH_FLAG_RETAIN = 0x01,
+  _az_MQTT_SUBSCRIBE_FLAGS = 0x02,
+  _az_MQTT_MAX_STRING_LENGTH = UINT16_MAX,
+  _az_MQTT_MAX_FIXED_HEADER_SIZE = 5,
+  _az_MQTT_PACKET_TYPE_RESERVED = 15,
+};
+
+// Fixed header
+
+AZ_INLINE int32_t _az_mqtt_get_remaining_length_size(int32_t remaining_length)
+{
+  return remaining_length < 128 ? 1
+      : remaining_length < 16384 ? 2
+      : remaining_length < 2097152 ? 3
+                                   : 4;
+}
+
+// Adds the size of a part of a packet to its remaining length, checking first that the sum does not
+// exceed the largest remaining length, so that it cannot overflow.
+AZ_NODISCARD AZ_INLINE az_result _az_mqtt_add_length(int32_t* ref_remaining_length, int32_t size)
+{
+  if (size > AZ_MQTT_MAX_REMAINING_LENGTH - *ref_remaining_length)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  *ref_remaining_length += size;
+  return AZ_OK;
+}
+
+// Writes the fixed header and returns the rest of the destination, after checking that the whole
+// packet fits.
+static az_result _az_mqtt_write_fixed_header(
+    az_span destination,
+    az_mqtt_packet_type type,
+    uint8_t flags,
+    int32_t remaining_length,
+    int32_t written_remaining_length,
+    az_span* out_remainder)
+{
+  if (remaining_length > AZ_MQTT_MAX_REMAINING_LENGTH)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(
+      destination,
+      1 + _az_mqtt_get_remaining_length_size(remaining_length) + written_remaining_length);
+
+  destination = az_span_copy_u8(destination, (uint8_t)(((uint32_t)type << 4U) | flags));
+
+  // The remaining length is encoded 7 bits at a time, least significant first, with the high bit
+  // set on every byte but the last.
+  uint32_t length = (uint32_t)remaining_length;
+  do
+  {
+    uint8_t encoded_byte = (uint8_t)(length % 128U);
+    length /= 128U;
+    if (length > 0)
+    {
+      encoded_byte |= 0x80U;
+    }
+    destination = az_span_copy_u8(destination, encoded_byte);
+  } while (length > 0);
+
+  *out_remainder = destination;
+  return AZ_OK;
+}
+
+AZ_INLINE az_span _az_mqtt_write_u16(az_span destination, uint16_t value)
+{
+  destination = az_span_copy_u8(destination, (uint8_t)(value >> 8U));
+  return az_span_copy_u8(destination, (uint8_t)(value & 0xFFU));
+}
+
+AZ_INLINE az_span _az_mqtt_write_string(az_span destination, az_span value)
+{
+  destination = _az_mqtt_write_u16(destination, (uint16_t)az_span_size(value));
+  return az_span_copy(destination, value);
+}
+
+// Encoders
+
+AZ_NODISCARD az_result
+az_mqtt_encode_connect(az_span destination, az_mqtt_connect const* connect, int32_t* out_written)
+{
+  _az_PRECONDITION_NOT_NULL(connect);
+  _az_PRECONDITION_VALID_SPAN(connect->client_id, 0, true);
+  _az_PRECONDITION(az_span_size(connect->client_id) <= _az_MQTT_MAX_STRING_LENGTH);
+  _az_PRECONDITION(az_span_size(connect->user_name) <= _az_MQTT_MAX_STRING_LENGTH);
+  _az_PRECONDITION(az_span_size(connect->password) <= _az_MQTT_MAX_STRING_LENGTH);
+  _az_PRECONDITION(az_span_size(connect->password) == 0 || az_span_size(connect->user_name) > 0);
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  uint8_t flags = connect->clean_session ? _az_MQTT_CONNECT_FLAG_CLEAN_SESSION : 0;
+
+  // Variable header: protocol name, protocol level, connect flags and keep alive, then the length
+  // prefix of the client ID.
+  int32_t remaining_length = 2 + az_span_size(mqtt_protocol_name_span) + 1 + 1 + 2 + 2;
+  _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, az_span_size(connect->client_id)));
+
+  if (az_span_size(connect->user_name) > 0)
+  {
+    flags |= _az_MQTT_CONNECT_FLAG_USER_NAME;
+    _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, 2));
+    _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, az_span_size(connect->user_name)));
+  }
+
+  if (az_span_size(connect->password) > 0)
+  {
+    flags |= _az_MQTT_CONNECT_FLAG_PASSWORD;
+    _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, 2));
+    _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, az_span_size(connect->password)));
+  }
+
+  az_span remainder;
+  _az_RETURN_IF_FAILED(_az_mqtt_write_fixed_header(
+      destination,
+      AZ_MQTT_PACKET_TYPE_CONNECT,
+      0,
+      remaining_length,
+      remaining_length,
+      &remainder));
+
+  remainder = _az_mqtt_write_string(remainder, mqtt_protocol_name_span);
+  remainder = az_span_copy_u8(remainder, _az_MQTT_PROTOCOL_LEVEL_3_1_1);
+  remainder = az_span_copy_u8(remainder, flags);
+  remainder = _az_mqtt_write_u16(remainder, connect->keep_alive_seconds);
+  remainder = _az_mqtt_write_string(remainder, connect->client_id);
+
+  if (az_span_size(connect->user_name) > 0)
+  {
+    remainder = _az_mqtt_write_string(remainder, connect->user_name);
+  }
+
+  if (az_span_size(connect->password) > 0)
+  {
+    remainder = _az_mqtt_write_string(remainder, connect->password);
+  }
+
+  *out_written = _az_span_diff(remainder, destination);
+  return AZ_OK;
+}
+
+static az_result _az_mqtt_encode_publish(
+    az_span destination,
+    az_mqtt_publish const* publish,
+    bool include_payload,
+    int32_t* out_written)
+{
+  _az_PRECONDITION_NOT_NULL(publish);
+  _az_PRECONDITION_VALID_SPAN(publish->topic, 1, false);
+  _az_PRECONDITION(az_span_size(publish->topic) <= _az_MQTT_MAX_STRING_LENGTH);
+  _az_PRECONDITION_RANGE(AZ_MQTT_QOS_AT_MOST_ONCE, publish->qos, AZ_MQTT_QOS_EXACTLY_ONCE);
+  _az_PRECONDITION(publish->qos == AZ_MQTT_QOS_AT_MOST_ONCE || publish->packet_id != 0);
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  uint8_t flags = (uint8_t)((uint32_t)publish->qos << 1U);
+  if (publish->duplicate)
+  {
+    flags |= _az_MQTT_PUBLISH_FLAG_DUPLICATE;
+  }
+  if (publish->retain)
+  {
+    flags |= _az_MQTT_PUBLISH_FLAG_RETAIN;
+  }
+
+  // The length prefix of the topic, and the packet identifier above QoS 0.
+  int32_t remaining_length = publish->qos != AZ_MQTT_QOS_AT_MOST_ONCE ? 2 + 2 : 2;
+  _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, az_span_size(publish->topic)));
+
+  int32_t const header_length = remaining_length;
+  _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, az_span_size(publish->payload)));
+
+  az_span remainder;
+  _az_RETURN_IF_FAILED(_az_mqtt_write_fixed_header(
+      destination,
+      AZ_MQTT_PACKET_TYPE_PUBLISH,
+      flags,
+      remaining_length,
+      include_payload ? remaining_length : header_length,
+      &remainder));
+
+  remainder = _az_mqtt_write_string(remainder, publish->topic);
+
+  if (publish->qos != AZ_MQTT_QOS_AT_MOST_ONCE)
+  {
+    remainder = _az_mqtt_write_u16(remainder, publish->packet_id);
+  }
+
+  if (include_payload)
+  {
+    remainder = az_span_copy(remainder, publish->payload);
+  }
+
+  *out_written = _az_span_diff(remainder, destination);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_mqtt_encode_publish(az_span destination, az_mqtt_publish const* publish, int32_t* out_written)
+{
+  return _az_mqtt_encode_publish(destination, publish, true, out_written);
+}
+
+AZ_NODISCARD az_result az_mqtt_encode_publish_header(
+    az_span destination,
+    az_mqtt_publish const* publish,
+    int32_t* out_written)
+{
+  return _az_mqtt_encode_publish(destination, publish, false, out_written);
+}
+
+AZ_NODISCARD az_result
+az_mqtt_encode_puback(az_span destination, uint16_t packet_id, int32_t* out_written)
+{
+  _az_PRECONDITION(packet_id != 0);
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  az_span remainder;
+  _az_RETURN_IF_FAILED(
+      _az_mqtt_write_fixed_header(destination, AZ_MQTT_PACKET_TYPE_PUBACK, 0, 2, 2, &remainder));
+
+  remainder = _az_mqtt_write_u16(remainder, packet_id);
+
+  *out_written = _az_span_diff(remainder, destination);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_mqtt_encode_subscribe(
+    az_span destination,
+    uint16_t packet_id,
+    az_mqtt_subscription const subscriptions[],
+    int32_t subscriptions_length,
+    int32_t* out_written)
+{
+  _az_PRECONDITION(packet_id != 0);
+  _az_PRECONDITION_NOT_NULL(subscriptions);
+  _az_PRECONDITION(subscriptions_length > 0);
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  int32_t remaining_length = 2;
+  for (int32_t i = 0; i < subscriptions_length; i++)
+  {
+    _az_PRECONDITION_VALID_SPAN(subscriptions[i].topic_filter, 1, false);
+    _az_PRECONDITION(az_span_size(subscriptions[i].topic_filter) <= _az_MQTT_MAX_STRING_LENGTH);
+    _az_PRECONDITION_RANGE(
+        AZ_MQTT_QOS_AT_MOST_ONCE, subscriptions[i].qos, AZ_MQTT_QOS_EXACTLY_ONCE);
+
+    _az_RETURN_IF_FAILED(_az_mqtt_add_length(&remaining_length, 2 + 1));
+    _az_RETURN_IF_FAILED(
+        _az_mqtt_add_length(&remaining_length, az_span_size(subscriptions[i].topic_filter)));
+  }
+
+  az_span remainder;
+  _az_RETURN_IF_FAILED(_az_mqtt_write_fixed_header(
+      destination,
+      AZ_MQTT_PACKET_TYPE_SUBSCRIBE,
+      _az_MQTT_SUBSCRIBE_FLAGS,
+      remaining_length,
+      remaining_length,
+      &remainder));
+
+  remainder = _az_mqtt_write_u16(remainder, packet_id);
+
+  for (int32_t i = 0; i < subscriptions_length; i++)
+  {
+    remainder = _az_mqtt_write_string(remainder, subscriptions[i].topic_filter);
+    remainder = az_span_copy_u8(remainder, (uint8_t)subscriptions[i].qos);
+  }
+
+  *out_written = _az_span_diff(remainder, destination);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_mqtt_encode_pingreq(az_span destination, int32_t* out_written)
+{
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  az_span remainder;
+  _az_RETURN_IF_FAILED(
+      _az_mqtt_write_fixed_header(destination, AZ_MQTT_PACKET_TYPE_PINGREQ, 0, 0, 0, &remainder));
+
+  *out_written = _az_span_diff(remainder, destination);
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_mqtt_encode_disconnect(az_span destination, int32_t* out_written)
+{
+  _az_PRECONDITION_NOT_NULL(out_written);
+
+  az_span remainder;
+  _az_RETURN_IF_FAILED(_az_mqtt_write_fixed_header(
+      destination, AZ_MQTT_PACKET_TYPE_DISCONNECT, 0, 0, 0, &remainder));
+
+  *out_written = _az_span_diff(remainder, destination);
+  return AZ_OK;
+}
+
+// Decoder
+
+AZ_NODISCARD az_result az_mqtt_decoder_init(az_mqtt_decoder* out_decoder, az_span buffer)
+{
+  _az_PRECONDITION_NOT_NULL(out_decoder);
+  _az_PRECONDITION_VALID_SPAN(buffer, _az_MQTT_MAX_FIXED_HEADER_SIZE, false);
+
+  *out_decoder = (az_mqtt_decoder){
+    ._internal = {
+      .buffer = buffer,
+      .buffered = 0,
+      .packet_size = 0,
+      .skip_size = 0,
+    },
+  };
+
+  return AZ_OK;
+}
+
+// Gets the size of the packet starting at data, once enough of its fixed header is available.
+static az_result _az_mqtt_get_packet_size(az_span data, int32_t* out_packet_size)
+{
+  uint8_t const* const bytes = az_span_ptr(data);
+  int32_t const size = az_span_size(data);
+
+  if (size == 0)
+  {
+    return AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET;
+  }
+
+  // Packet types 0 and 15 are reserved.
+  uint8_t const type = bytes[0] >> 4U;
+  if (type == 0 || type == _az_MQTT_PACKET_TYPE_RESERVED)
+  {
+    return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+  }
+
+  uint32_t remaining_length = 0;
+  for (int32_t i = 1; i < _az_MQTT_MAX_FIXED_HEADER_SIZE; i++)
+  {
+    if (i >= size)
+    {
+      return AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET;
+    }
+
+    remaining_length |= (uint32_t)(bytes[i] & 0x7FU) << (7U * (uint32_t)(i - 1));
+    if ((bytes[i] & 0x80U) == 0)
+    {
+      if (remaining_length > AZ_MQTT_MAX_REMAINING_LENGTH)
+      {
+        return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+      }
+
+      *out_packet_size = i + 1 + (int32_t)remaining_length;
+      return AZ_OK;
+    }
+  }
+
+  // The remaining length is at most 4 bytes long, which caps it at AZ_MQTT_MAX_REMAINING_LENGTH.
+  return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+}
+
+AZ_INLINE uint16_t _az_mqtt_read_u16(uint8_t const* bytes)
+{
+  return (uint16_t)(((uint32_t)bytes[0] << 8U) | bytes[1]);
+}
+
+static az_result _az_mqtt_decode_publish(uint8_t flags, az_span body, az_mqtt_publish* out_publish)
+{
+  az_mqtt_qos const qos = (az_mqtt_qos)((flags >> 1U) & 0x3U);
+  if (qos > AZ_MQTT_QOS_EXACTLY_ONCE || az_span_size(body) < 2)
+  {
+    return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+  }
+
+  int32_t const topic_length = _az_mqtt_read_u16(az_span_ptr(body));
+  int32_t header_length = 2 + topic_length + (qos != AZ_MQTT_QOS_AT_MOST_ONCE ? 2 : 0);
+  if (topic_length == 0 || header_length > az_span_size(body))
+  {
+    return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+  }
+
+  *out_publish = (az_mqtt_publish){
+    .topic = az_span_slice(body, 2, 2 + topic_length),
+    .payload = az_span_slice_to_end(body, header_length),
+    .qos = qos,
+    .packet_id = 0,
+    .retain = (flags & _az_MQTT_PUBLISH_FLAG_RETAIN) != 0,
+    .duplicate = (flags & _az_MQTT_PUBLISH_FLAG_DUPLICATE) != 0,
+  };
+
+  if (qos != AZ_MQTT_QOS_AT_MOST_ONCE)
+  {
+    out_publish->packet_id = _az_mqtt_read_u16(az_span_ptr(body) + 2 + topic_length);
+    if (out_publish->packet_id == 0)
+    {
+      return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+    }
+  }
+
+  return AZ_OK;
+}
+
+// Decodes the whole packet in packet, whose size was checked by _az_mqtt_get_packet_size.
+static az_result _az_mqtt_decode_packet(az_span packet, az_mqtt_packet* out_packet)
+{
+  uint8_t const first_byte = az_span_ptr(packet)[0];
+  uint8_t const flags = first_byte & 0x0FU;
+  az_mqtt_packet_type const type = (az_mqtt_packet_type)(first_byte >> 4U);
+
+  int32_t body_offset = 2;
+  while ((az_span_ptr(packet)[body_offset - 1] & 0x80U) != 0)
+  {
+    body_offset++;
+  }
+
+  az_span const body = az_span_slice_to_end(packet, body_offset);
+  uint8_t const* const body_bytes = az_span_ptr(body);
+  int32_t const body_size = az_span_size(body);
+
+  *out_packet = (az_mqtt_packet){ .type = type };
+
+  switch (type)
+  {
+    case AZ_MQTT_PACKET_TYPE_CONNACK:
+      if (flags != 0 || body_size != 2 || (body_bytes[0] & 0xFEU) != 0)
+      {
+        return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+      }
+      out_packet->connack.session_present = (body_bytes[0] & 0x01U) != 0;
+      out_packet->connack.return_code = body_bytes[1];
+      return AZ_OK;
+
+    case AZ_MQTT_PACKET_TYPE_PUBLISH:
+      return _az_mqtt_decode_publish(flags, body, &out_packet->publish);
+
+    case AZ_MQTT_PACKET_TYPE_PUBACK:
+      if (flags != 0 || body_size != 2)
+      {
+        return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+      }
+      out_packet->packet_id = _az_mqtt_read_u16(body_bytes);
+      return out_packet->packet_id == 0 ? AZ_ERROR_IOT_MQTT_MALFORMED_PACKET : AZ_OK;
+
+    case AZ_MQTT_PACKET_TYPE_SUBACK:
+      if (flags != 0 || body_size < 3)
+      {
+        return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+      }
+      for (int32_t i = 2; i < body_size; i++)
+      {
+        if (body_bytes[i] > AZ_MQTT_QOS_EXACTLY_ONCE && body_bytes[i] != AZ_MQTT_SUBACK_FAILURE)
+        {
+          return AZ_ERROR_IOT_MQTT_MALFORMED_PACKET;
+        }
+      }
+      out_packet->suback.packet_id = _az_mqtt_read_u16(body_bytes);
+      out_packet->suback.return_codes = az_span_slice_to_end(body, 2);
+      return out_packet->suback.packet_id == 0 ? AZ_ERROR_IOT_MQTT_MALFORMED_PACKET : AZ_OK;
+
+    case AZ_MQTT_PACKET_TYPE_PINGRESP:
+      return (flags != 0 || body_size != 0) ? AZ_ERROR_IOT_MQTT_MALFORMED_PACKET : AZ_OK;
+
+    default:
+      // Packets a client does not expect to receive are reported by type only.
+      return AZ_OK;
+  }
+}
+
+// Decodes the next packet of data, with no bytes of a too large packet left to skip.
+static az_result _az_mqtt_decoder_decode(
+    az_mqtt_decoder* ref_decoder,
+    az_span data,
+    int32_t* out_consumed,
+    az_mqtt_packet* out_packet)
+{
+  az_span const buffer = ref_decoder->_internal.buffer;
+  int32_t packet_size = ref_decoder->_internal.packet_size;
+  *out_consumed = 0;
+
+  // Fast path: nothing is buffered and data holds the whole packet, so decode it in place.
+  if (ref_decoder->_internal.buffered == 0)
+  {
+    az_result const result = _az_mqtt_get_packet_size(data, &packet_size);
+    if (az_result_succeeded(result) && packet_size <= az_span_size(data))
+    {
+      *out_consumed = packet_size;
+      return _az_mqtt_decode_packet(az_span_slice(data, 0, packet_size), out_packet);
+    }
+
+    if (result == AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET)
+    {
+      packet_size = 0;
+    }
+    else
+    {
+      _az_RETURN_IF_FAILED(result);
+    }
+  }
+
+  // Otherwise, accumulate the packet in the buffer: first the fixed header, one byte at a time
+  // until its size is known, then the rest of the packet at once.
+  while (true)
+  {
+    int32_t const buffered = ref_decoder->_internal.buffered;
+    int32_t const wanted = packet_size > 0 ? packet_size - buffered : 1;
+
+    if (buffered + wanted > az_span_size(buffer))
+    {
+      // The packet size is known at this point, so the rest of the packet is skipped to keep
+      // decoding in step with the stream.
+      uint8_t const first_byte
+          = buffered > 0 ? az_span_ptr(buffer)[0] : az_span_ptr(data)[*out_consumed];
+      *out_packet = (az_mqtt_packet){ .type = (az_mqtt_packet_type)(first_byte >> 4U) };
+      ref_decoder->_internal.skip_size = packet_size - buffered;
+      ref_decoder->_internal.buffered = 0;
+      ref_decoder->_internal.packet_size = 0;
+      return AZ_ERROR_IOT_MQTT_PACKET_TOO_LARGE;
+    }
+
+    if (*out_consumed == az_span_size(data))
+    {
+      break;
+    }
+
+    int32_t const available = az_span_size(data) - *out_consumed;
+    int32_t const copied = wanted < available ? wanted : available;
+    az_span_copy(
+        az_span_slice_to_end(buffer, buffered),
+        az_span_slice(data, *out_consumed, *out_consumed + copied));
+    *out_consumed += copied;
+    ref_decoder->_internal.buffered = buffered + copied;
+
+    if (packet_size == 0)
+    {
+      az_result const result = _az_mqtt_get_packet_size(
+          az_span_slice(buffer, 0, ref_decoder->_internal.buffered), &packet_size);
+      if (result == AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET)
+      {
+        continue;
+      }
+
+      if (az_result_failed(result))
+      {
+        ref_decoder->_internal.buffered = 0;
+        return result;
+      }
+    }
+
+    if (ref_decoder->_internal.buffered == packet_size)
+    {
+      ref_decoder->_internal.buffered = 0;
+      ref_decoder->_internal.packet_size = 0;
+      return _az_mqtt_decode_packet(az_span_slice(buffer, 0, packet_size), out_packet);
+    }
+  }
+
+  ref_decoder->_internal.packet_size = packet_size;
+  return AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET;
+}
+
+AZ_NODISCARD az_result az_mqtt_decoder_decode(
+    az_mqtt_decoder* ref_decoder,
+    az_span data,
+    int32_t* out_consumed,
+    az_mqtt_packet* out_packet)
+{
+  _az_PRECONDITION_NOT_NULL(ref_decoder);
+  _az_PRECONDITION_VALID_SPAN(data, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_consumed);
+  _az_PRECONDITION_NOT_NULL(out_packet);
+
+  // First skip what is left of a packet too large for the buffer.
+  int32_t const skip_size = ref_decoder->_internal.skip_size;
+  int32_t const skipped = skip_size < az_span_size(data) ? skip_size : az_span_size(data);
+  ref_decoder->_internal.skip_size = skip_size - skipped;
+  if (ref_decoder->_internal.skip_size > 0)
+  {
+    *out_consumed = skipped;
+    return AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET;
+  }
+
+  az_result const result = _az_mqtt_decoder_decode(
+      ref_decoder, az_span_slice_to_end(data, skipped), out_consumed, out_packet);
+  *out_consumed += skipped;
+  return result;
+}
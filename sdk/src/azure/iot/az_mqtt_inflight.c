@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+
+#include <azure/core/az_platform.h>
+#include <azure/core/az_result.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_mqtt.h>
+
+#include <azure/core/_az_cfg.h>
+
+enum
+{
+  _az_MQTT_INFLIGHT_DEFAULT_RETRANSMIT_TIMEOUT_MSEC = 20000,
+  _az_MQTT_MAX_PACKET_ID = UINT16_MAX,
+};
+
+// Packet identifiers are assigned so that identifier id always lives in entry (id - 1) % length,
+// which makes lookups by identifier constant time. The heap of deadlines is stored in the same
+// entries: heap_entry of the entry at index i is the index of the entry at heap position i, and
+// heap_position of an entry is where it currently is in the heap.
+
+AZ_INLINE int32_t _az_mqtt_inflight_get_index(az_mqtt_inflight const* inflight, uint16_t packet_id)
+{
+  return (int32_t)(((uint32_t)packet_id - 1U) % (uint32_t)inflight->_internal.entries_length);
+}
+
+AZ_INLINE az_mqtt_inflight_entry* _az_mqtt_inflight_get_heap_entry(
+    az_mqtt_inflight const* inflight,
+    int32_t heap_position)
+{
+  return &inflight->_internal
+              .entries[inflight->_internal.entries[heap_position]._internal.heap_entry];
+}
+
+static void _az_mqtt_inflight_heap_swap(
+    az_mqtt_inflight* ref_inflight,
+    int32_t heap_position1,
+    int32_t heap_position2)
+{
+  az_mqtt_inflight_entry* const entries = ref_inflight->_internal.entries;
+  int32_t const entry1 = entries[heap_position1]._internal.heap_entry;
+  int32_t const entry2 = entries[heap_position2]._internal.heap_entry;
+
+  entries[heap_position1]._internal.heap_entry = entry2;
+  entries[heap_position2]._internal.heap_entry = entry1;
+  entries[entry1]._internal.heap_position = heap_position2;
+  entries[entry2]._internal.heap_position = heap_position1;
+}
+
+static void _az_mqtt_inflight_heap_sift_up(az_mqtt_inflight* ref_inflight, int32_t heap_position)
+{
+  while (heap_position > 0)
+  {
+    int32_t const parent = (heap_position - 1) / 2;
+    if (_az_mqtt_inflight_get_heap_entry(ref_inflight, parent)->_internal.deadline_msec
+        <= _az_mqtt_inflight_get_heap_entry(ref_inflight, heap_position)->_internal.deadline_msec)
+    {
+      break;
+    }
+
+    _az_mqtt_inflight_heap_swap(ref_inflight, parent, heap_position);
+    heap_position = parent;
+  }
+}
+
+static void _az_mqtt_inflight_heap_sift_down(az_mqtt_inflight* ref_inflight, int32_t heap_position)
+{
+  int32_t const count = ref_inflight->_internal.count;
+
+  while (true)
+  {
+    int32_t smallest = heap_position;
+    for (int32_t child = (2 * heap_position) + 1;
+         child <= (2 * heap_position) + 2 && child < count;
+         child++)
+    {
+      if (_az_mqtt_inflight_get_heap_entry(ref_inflight, child)->_internal.deadline_msec
+          < _az_mqtt_inflight_get_heap_entry(ref_inflight, smallest)->_internal.deadline_msec)
+      {
+        smallest = child;
+      }
+    }
+
+    if (smallest == heap_position)
+    {
+      return;
+    }
+
+    _az_mqtt_inflight_heap_swap(ref_inflight, heap_position, smallest);
+    heap_position = smallest;
+  }
+}
+
+AZ_NODISCARD az_mqtt_inflight_options az_mqtt_inflight_options_default(void)
+{
+  return (az_mqtt_inflight_options){
+    .max_in_flight = 0,
+    .retransmit_timeout_msec = _az_MQTT_INFLIGHT_DEFAULT_RETRANSMIT_TIMEOUT_MSEC,
+  };
+}
+
+AZ_NODISCARD az_result az_mqtt_inflight_init(
+    az_mqtt_inflight* out_inflight,
+    az_mqtt_inflight_entry entries[],
+    int32_t entries_length,
+    az_mqtt_inflight_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_inflight);
+  _az_PRECONDITION_NOT_NULL(entries);
+  _az_PRECONDITION_RANGE(1, entries_length, _az_MQTT_MAX_PACKET_ID);
+
+  *out_inflight = (az_mqtt_inflight){
+    ._internal = {
+      .entries = entries,
+      .entries_length = entries_length,
+      .count = 0,
+      .next_packet_id = 1,
+      .options = options == NULL ? az_mqtt_inflight_options_default() : *options,
+    },
+  };
+
+  _az_PRECONDITION_RANGE(0, out_inflight->_internal.options.max_in_flight, entries_length);
+  _az_PRECONDITION(out_inflight->_internal.options.retransmit_timeout_msec >= 0);
+
+  if (out_inflight->_internal.options.max_in_flight == 0)
+  {
+    out_inflight->_internal.options.max_in_flight = entries_length;
+  }
+
+  for (int32_t i = 0; i < entries_length; i++)
+  {
+    entries[i] = (az_mqtt_inflight_entry){ 0 };
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_mqtt_inflight_add(az_mqtt_inflight* ref_inflight, void* user_context, uint16_t* out_packet_id)
+{
+  _az_PRECONDITION_NOT_NULL(ref_inflight);
+  _az_PRECONDITION_NOT_NULL(out_packet_id);
+
+  if (ref_inflight->_internal.count >= ref_inflight->_internal.options.max_in_flight)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  // Identifiers are handed out in order, skipping those whose entry is still in flight. Since the
+  // table is not full, a free entry is found within two passes over the entries (one more than
+  // needed to cover the jump when identifiers wrap from 65535 back to 1).
+  uint16_t packet_id = 0;
+  int32_t index = 0;
+  for (int32_t attempt = 0; attempt < 2 * ref_inflight->_internal.entries_length; attempt++)
+  {
+    uint16_t const candidate = ref_inflight->_internal.next_packet_id;
+    ref_inflight->_internal.next_packet_id
+        = candidate == _az_MQTT_MAX_PACKET_ID ? 1 : (uint16_t)(candidate + 1U);
+
+    index = _az_mqtt_inflight_get_index(ref_inflight, candidate);
+    if (ref_inflight->_internal.entries[index]._internal.packet_id == 0)
+    {
+      packet_id = candidate;
+      break;
+    }
+  }
+
+  if (packet_id == 0)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_mqtt_inflight_entry* const entry = &ref_inflight->_internal.entries[index];
+  int32_t const heap_position = ref_inflight->_internal.count++;
+
+  entry->_internal.user_context = user_context;
+  entry->_internal.deadline_msec = now + ref_inflight->_internal.options.retransmit_timeout_msec;
+  entry->_internal.packet_id = packet_id;
+  entry->_internal.heap_position = heap_position;
+  ref_inflight->_internal.entries[heap_position]._internal.heap_entry = index;
+  _az_mqtt_inflight_heap_sift_up(ref_inflight, heap_position);
+
+  *out_packet_id = packet_id;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_mqtt_inflight_ack(
+    az_mqtt_inflight* ref_inflight,
+    uint16_t packet_id,
+    void** out_user_context)
+{
+  _az_PRECONDITION_NOT_NULL(ref_inflight);
+
+  az_mqtt_inflight_entry* const entry
+      = packet_id == 0 ? NULL
+                       : &ref_inflight->_internal
+                              .entries[_az_mqtt_inflight_get_index(ref_inflight, packet_id)];
+
+  if (entry == NULL || entry->_internal.packet_id != packet_id)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  if (out_user_context != NULL)
+  {
+    *out_user_context = entry->_internal.user_context;
+  }
+
+  // Move the last heap element into the removed position, then restore the heap order.
+  int32_t const heap_position = entry->_internal.heap_position;
+  int32_t const last = --ref_inflight->_internal.count;
+  if (heap_position != last)
+  {
+    _az_mqtt_inflight_heap_swap(ref_inflight, heap_position, last);
+    _az_mqtt_inflight_heap_sift_down(ref_inflight, heap_position);
+    _az_mqtt_inflight_heap_sift_up(ref_inflight, heap_position);
+  }
+
+  entry->_internal.packet_id = 0;
+  entry->_internal.user_context = NULL;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_mqtt_inflight_get_expired(
+    az_mqtt_inflight* ref_inflight,
+    uint16_t* out_packet_id,
+    void** out_user_context)
+{
+  _az_PRECONDITION_NOT_NULL(ref_inflight);
+  _az_PRECONDITION_NOT_NULL(out_packet_id);
+
+  if (ref_inflight->_internal.count == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  int64_t now = 0;
+  _az_RETURN_IF_FAILED(az_platform_clock_msec(&now));
+
+  az_mqtt_inflight_entry* const entry = _az_mqtt_inflight_get_heap_entry(ref_inflight, 0);
+  if (entry->_internal.deadline_msec > now)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_packet_id = entry->_internal.packet_id;
+  if (out_user_context != NULL)
+  {
+    *out_user_context = entry->_internal.user_context;
+  }
+
+  entry->_internal.deadline_msec = now + ref_inflight->_internal.options.retransmit_timeout_msec;
+  _az_mqtt_inflight_heap_sift_down(ref_inflight, 0);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_mqtt_inflight_get_next_deadline(az_mqtt_inflight const* inflight, int64_t* out_deadline_msec)
+{
+  _az_PRECONDITION_NOT_NULL(inflight);
+  _az_PRECONDITION_NOT_NULL(out_deadline_msec);
+
+  if (inflight->_internal.count == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  *out_deadline_msec = _az_mqtt_inflight_get_heap_entry(inflight, 0)->_internal.deadline_msec;
+  return AZ_OK;
+}
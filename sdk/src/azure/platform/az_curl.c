@@ -6,6 +6,7 @@
 #include <azure/core/az_span.h>
 #include <azure/core/internal/az_result_internal.h>
 #include <azure/core/internal/az_span_internal.h>
+#include <azure/platform/az_curl.h>
 
 #include <stdlib.h>
 
@@ -62,10 +63,192 @@ static AZ_NODISCARD az_result _az_http_client_curl_code_to_result(CURLcode code)
 #define _az_RETURN_IF_CURL_FAILED(exp) \
   _az_RETURN_IF_FAILED(_az_http_client_curl_code_to_result(exp))
 
+// Shared state configured by az_http_client_curl_init(). When share is NULL every request runs on
+// an independent easy handle.
+static struct
+{
+  CURLSH* share;
+  az_http_client_curl_options options;
+} _az_http_client_curl_state = { 0 };
+
+static void _az_http_client_curl_share_lock(
+    CURL* handle,
+    curl_lock_data data,
+    curl_lock_access access,
+    void* userptr)
+{
+  (void)handle;
+  (void)data;
+  (void)access;
+  (void)userptr;
+
+  _az_http_client_curl_state.options.lock(_az_http_client_curl_state.options.lock_context);
+}
+
+static void _az_http_client_curl_share_unlock(CURL* handle, curl_lock_data data, void* userptr)
+{
+  (void)handle;
+  (void)data;
+  (void)userptr;
+
+  _az_http_client_curl_state.options.unlock(_az_http_client_curl_state.options.lock_context);
+}
+
+static AZ_NODISCARD az_result _az_http_client_curl_share_set(CURLSH* share, curl_lock_data data)
+{
+  return curl_share_setopt(share, CURLSHOPT_SHARE, data) == CURLSHE_OK ? AZ_OK
+                                                                        : AZ_ERROR_NOT_SUPPORTED;
+}
+
+AZ_NODISCARD az_http_client_curl_options az_http_client_curl_options_default(void)
+{
+  return (az_http_client_curl_options){
+    .share_dns_cache = true,
+    .share_ssl_sessions = true,
+    .share_connections = true,
+    .enable_http2 = true,
+    .lock = NULL,
+    .unlock = NULL,
+    .lock_context = NULL,
+    .timing_callback = NULL,
+    .timing_context = NULL,
+  };
+}
+
+static AZ_NODISCARD az_result _az_http_client_curl_share_init(CURLSH* share)
+{
+  az_http_client_curl_options const* const options = &_az_http_client_curl_state.options;
+
+  if (options->share_dns_cache)
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_curl_share_set(share, CURL_LOCK_DATA_DNS));
+  }
+
+  if (options->share_ssl_sessions)
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_curl_share_set(share, CURL_LOCK_DATA_SSL_SESSION));
+  }
+
+  if (options->share_connections)
+  {
+#if LIBCURL_VERSION_NUM >= 0x073900 // 7.57.0
+    _az_RETURN_IF_FAILED(_az_http_client_curl_share_set(share, CURL_LOCK_DATA_CONNECT));
+#else
+    return AZ_ERROR_NOT_SUPPORTED;
+#endif
+  }
+
+  if (options->lock != NULL)
+  {
+    if (curl_share_setopt(share, CURLSHOPT_LOCKFUNC, _az_http_client_curl_share_lock) != CURLSHE_OK
+        || curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, _az_http_client_curl_share_unlock)
+            != CURLSHE_OK)
+    {
+      return AZ_ERROR_HTTP_ADAPTER;
+    }
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_http_client_curl_init(az_http_client_curl_options const* options)
+{
+  az_http_client_curl_options const resolved_options
+      = options == NULL ? az_http_client_curl_options_default() : *options;
+
+  _az_PRECONDITION((resolved_options.lock == NULL) == (resolved_options.unlock == NULL));
+
+  // libcurl documents the shared connection cache as not thread-safe, even with lock callbacks,
+  // and locks are only needed when requests are sent from several threads.
+  if (resolved_options.share_connections && resolved_options.lock != NULL)
+  {
+    return AZ_ERROR_ARG;
+  }
+
+#if LIBCURL_VERSION_NUM < 0x072B00 // 7.43.0
+  if (resolved_options.enable_http2)
+  {
+    return AZ_ERROR_NOT_SUPPORTED;
+  }
+#endif
+
+  az_http_client_curl_deinit();
+  _az_http_client_curl_state.options = resolved_options;
+
+  if (!resolved_options.share_dns_cache && !resolved_options.share_ssl_sessions
+      && !resolved_options.share_connections)
+  {
+    return AZ_OK;
+  }
+
+  CURLSH* const share = curl_share_init();
+  if (share == NULL)
+  {
+    return AZ_ERROR_HTTP_ADAPTER;
+  }
+
+  az_result const result = _az_http_client_curl_share_init(share);
+  if (az_result_failed(result))
+  {
+    (void)curl_share_cleanup(share);
+    _az_http_client_curl_state.options = (az_http_client_curl_options){ 0 };
+    return result;
+  }
+
+  _az_http_client_curl_state.share = share;
+  return AZ_OK;
+}
+
+void az_http_client_curl_deinit(void)
+{
+  if (_az_http_client_curl_state.share != NULL)
+  {
+    (void)curl_share_cleanup(_az_http_client_curl_state.share);
+  }
+
+  _az_http_client_curl_state.share = NULL;
+  _az_http_client_curl_state.options = (az_http_client_curl_options){ 0 };
+}
+
+/**
+ * @brief applies the options given to az_http_client_curl_init() to a new easy handle.
+ */
+static AZ_NODISCARD az_result _az_http_client_curl_apply_options(CURL* ref_curl)
+{
+  if (_az_http_client_curl_state.share != NULL)
+  {
+    _az_RETURN_IF_CURL_FAILED(
+        curl_easy_setopt(ref_curl, CURLOPT_SHARE, _az_http_client_curl_state.share));
+  }
+
+#if LIBCURL_VERSION_NUM >= 0x072B00 // 7.43.0
+  if (_az_http_client_curl_state.options.enable_http2)
+  {
+    // Fall back to HTTP/1.1 when the server (or the libcurl build) does not support HTTP/2.
+    (void)curl_easy_setopt(ref_curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_PIPEWAIT, 1L));
+  }
+#endif
+
+  return AZ_OK;
+}
+
 AZ_NODISCARD AZ_INLINE az_result _az_http_client_curl_init(CURL** out)
 {
   *out = curl_easy_init();
-  return AZ_OK;
+  if (*out == NULL)
+  {
+    return AZ_ERROR_HTTP_ADAPTER;
+  }
+
+  az_result const result = _az_http_client_curl_apply_options(*out);
+  if (az_result_failed(result))
+  {
+    curl_easy_cleanup(*out);
+    *out = NULL;
+  }
+
+  return result;
 }
 
 AZ_NODISCARD AZ_INLINE az_result _az_http_client_curl_done(CURL** pp)
@@ -78,6 +261,66 @@ AZ_NODISCARD AZ_INLINE az_result _az_http_client_curl_done(CURL** pp)
   return AZ_OK;
 }
 
+#if LIBCURL_VERSION_NUM >= 0x073D00 // 7.61.0
+static int64_t _az_http_client_curl_get_time_usec(CURL* ref_curl, CURLINFO info)
+{
+  curl_off_t value = 0;
+  return curl_easy_getinfo(ref_curl, info, &value) == CURLE_OK ? (int64_t)value : 0;
+}
+#endif
+
+/**
+ * @brief reads the connection and TLS timing of the last transfer of \p ref_curl and reports it to
+ * the timing callback.
+ */
+static void _az_http_client_curl_report_timing(
+    CURL* ref_curl,
+    az_http_request const* request,
+    az_result result)
+{
+  az_http_client_curl_timing timing = { 0 };
+
+#if LIBCURL_VERSION_NUM >= 0x073D00 // 7.61.0
+  timing.name_lookup_usec = _az_http_client_curl_get_time_usec(ref_curl, CURLINFO_NAMELOOKUP_TIME_T);
+  timing.connect_usec = _az_http_client_curl_get_time_usec(ref_curl, CURLINFO_CONNECT_TIME_T);
+  timing.app_connect_usec
+      = _az_http_client_curl_get_time_usec(ref_curl, CURLINFO_APPCONNECT_TIME_T);
+  timing.first_byte_usec
+      = _az_http_client_curl_get_time_usec(ref_curl, CURLINFO_STARTTRANSFER_TIME_T);
+  timing.total_usec = _az_http_client_curl_get_time_usec(ref_curl, CURLINFO_TOTAL_TIME_T);
+#endif
+
+  long new_connections = 0;
+  if (curl_easy_getinfo(ref_curl, CURLINFO_NUM_CONNECTS, &new_connections) == CURLE_OK)
+  {
+    timing.new_connections = (int32_t)new_connections;
+  }
+
+#if LIBCURL_VERSION_NUM >= 0x073200 // 7.50.0
+  long http_version = 0;
+  if (curl_easy_getinfo(ref_curl, CURLINFO_HTTP_VERSION, &http_version) == CURLE_OK)
+  {
+    switch (http_version)
+    {
+      case CURL_HTTP_VERSION_1_0:
+        timing.http_version = 10;
+        break;
+      case CURL_HTTP_VERSION_1_1:
+        timing.http_version = 11;
+        break;
+      case CURL_HTTP_VERSION_2_0:
+        timing.http_version = 20;
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+
+  _az_http_client_curl_state.options.timing_callback(
+      request, result, &timing, _az_http_client_curl_state.options.timing_context);
+}
+
 /**
  * @brief writes a header key and value to a buffer as a 0-terminated string and using a separator
  * span in between. Returns error as soon as any of the write operations fails
@@ -611,6 +854,11 @@ az_http_client_send_request(az_http_request const* request, az_http_response* re
   az_result process_result
       = _az_http_client_curl_send_request_impl_process(curl, request, ref_response);
 
+  if (_az_http_client_curl_state.options.timing_callback != NULL)
+  {
+    _az_http_client_curl_report_timing(curl, request, process_result);
+  }
+
   // no matter if error or not, call curl done before returning to let curl clean everything
   _az_RETURN_IF_FAILED(_az_http_client_curl_done(&curl));
 
@@ -41,10 +41,55 @@ static void az_context_test(void** state)
   assert_true(expiration == 0);
 }
 
+static void az_context_chain_test(void** state)
+{
+  (void)state;
+
+  void const* const key1 = "k1";
+  void const* const key2 = "k2";
+  az_context root = az_context_create_with_expiration(&az_context_application, 1000);
+  az_context with_key1 = az_context_create_with_value(&root, key1, "v1");
+
+  az_context chain[20];
+  chain[0] = az_context_create_with_expiration(&with_key1, 500);
+  for (size_t i = 1; i < _az_COUNTOF(chain); i++)
+  {
+    chain[i] = az_context_create_with_expiration(&chain[i - 1], (int64_t)(900 - i));
+  }
+
+  az_context with_key2 = az_context_create_with_value(&chain[_az_COUNTOF(chain) - 1], key2, "v2");
+  az_context leaf = az_context_create_with_expiration(&with_key2, 2000);
+  az_context sibling = az_context_create_with_expiration(&root, 700);
+
+  assert_int_equal(az_context_get_expiration(&leaf), 500);
+  assert_false(az_context_has_expired(&leaf, 500));
+  assert_true(az_context_has_expired(&leaf, 501));
+
+  void const* value = NULL;
+  assert_int_equal(az_context_get_value(&leaf, key1, &value), AZ_OK);
+  assert_string_equal((char const*)value, "v1");
+  assert_int_equal(az_context_get_value(&leaf, key2, &value), AZ_OK);
+  assert_string_equal((char const*)value, "v2");
+  assert_int_equal(az_context_get_value(&sibling, key2, &value), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_null(value);
+
+  // Canceling a node after its children were created cancels them, and only them.
+  az_context_cancel(&chain[5]);
+  assert_int_equal(az_context_get_expiration(&leaf), 0);
+  assert_int_equal(az_context_get_expiration(&chain[4]), 500);
+  assert_int_equal(az_context_get_expiration(&sibling), 700);
+
+  az_context after_cancel = az_context_create_with_expiration(&leaf, 3000);
+  assert_int_equal(az_context_get_expiration(&after_cancel), 0);
+  assert_int_equal(az_context_get_value(&after_cancel, key1, &value), AZ_OK);
+  assert_string_equal((char const*)value, "v1");
+}
+
 int test_az_context()
 {
   const struct CMUnitTest tests[] = {
     cmocka_unit_test(az_context_test),
+    cmocka_unit_test(az_context_chain_test),
   };
   return cmocka_run_group_tests_name("az_core_context", tests, NULL, NULL);
 }
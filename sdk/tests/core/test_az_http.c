@@ -1187,6 +1187,190 @@ static void test_http_response_append_overflow_on_second_call(void** state)
   }
 }
 
+static void test_http_request_append_range_header(void** state)
+{
+  (void)state;
+
+  uint8_t url_buffer[32];
+  uint8_t headers_buffer[2 * sizeof(_az_http_request_header)];
+  az_span const url = AZ_SPAN_FROM_STR("https://test.local/file.bin");
+  az_span_copy(AZ_SPAN_FROM_BUFFER(url_buffer), url);
+
+  az_http_request request;
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          az_http_method_get(),
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          az_span_size(url),
+          AZ_SPAN_FROM_BUFFER(headers_buffer),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+
+  uint8_t value_buffer[_az_HTTP_RANGE_HEADER_VALUE_SIZE];
+  assert_return_code(
+      az_http_request_append_range_header(
+          &request, AZ_SPAN_FROM_BUFFER(value_buffer), 1024, 2047),
+      AZ_OK);
+
+  az_span name;
+  az_span value;
+  assert_return_code(az_http_request_get_header(&request, 0, &name, &value), AZ_OK);
+  assert_true(az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Range")));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("bytes=1024-2047")));
+
+  // The largest range fits in _az_HTTP_RANGE_HEADER_VALUE_SIZE bytes.
+  uint8_t largest_value_buffer[_az_HTTP_RANGE_HEADER_VALUE_SIZE];
+  assert_return_code(
+      az_http_request_append_range_header(
+          &request, AZ_SPAN_FROM_BUFFER(largest_value_buffer), INT64_MAX - 1, INT64_MAX),
+      AZ_OK);
+  assert_return_code(az_http_request_get_header(&request, 1, &name, &value), AZ_OK);
+  assert_true(az_span_is_content_equal(
+      value, AZ_SPAN_FROM_STR("bytes=9223372036854775806-9223372036854775807")));
+
+  uint8_t small_value_buffer[12];
+  assert_int_equal(
+      az_http_request_append_range_header(
+          &request, AZ_SPAN_FROM_BUFFER(small_value_buffer), 1024, 2047),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static az_result test_get_content_range(
+    az_span response_span,
+    az_http_response_content_range* out_content_range)
+{
+  az_http_response response;
+  assert_return_code(az_http_response_init(&response, response_span), AZ_OK);
+  return az_http_response_get_content_range(&response, out_content_range);
+}
+
+static void test_http_response_http2_status_line(void** state)
+{
+  (void)state;
+
+  // libcurl reports the status line of HTTP/2 and HTTP/3 responses without a minor version.
+  {
+    az_http_response response = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_response_init(
+        &response, AZ_SPAN_FROM_STR("HTTP/2 200 \r\ncontent-length: 0\r\n\r\n")));
+
+    az_http_response_status_line status_line = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+    assert_int_equal(status_line.major_version, 2);
+    assert_int_equal(status_line.minor_version, 0);
+    assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_OK);
+    assert_int_equal(az_span_size(status_line.reason_phrase), 0);
+
+    az_span header_name = AZ_SPAN_EMPTY;
+    az_span header_value = AZ_SPAN_EMPTY;
+    TEST_EXPECT_SUCCESS(az_http_response_get_next_header(&response, &header_name, &header_value));
+    assert_true(az_span_is_content_equal(header_name, AZ_SPAN_FROM_STR("content-length")));
+  }
+
+  {
+    az_http_response response = { 0 };
+    TEST_EXPECT_SUCCESS(
+        az_http_response_init(&response, AZ_SPAN_FROM_STR("HTTP/3 404 Not Found\r\n\r\n")));
+
+    az_http_response_status_line status_line = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+    assert_int_equal(status_line.major_version, 3);
+    assert_int_equal(status_line.minor_version, 0);
+    assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_NOT_FOUND);
+    assert_true(az_span_is_content_equal(status_line.reason_phrase, AZ_SPAN_FROM_STR("Not Found")));
+  }
+
+  // HTTP/1 still needs a minor version.
+  {
+    az_http_response response = { 0 };
+    TEST_EXPECT_SUCCESS(
+        az_http_response_init(&response, AZ_SPAN_FROM_STR("HTTP/1 200 OK\r\n\r\n")));
+
+    az_http_response_status_line status_line = { 0 };
+    assert_int_equal(
+        az_http_response_get_status_line(&response, &status_line), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+}
+
+static void test_http_response_get_content_range(void** state)
+{
+  (void)state;
+
+  az_http_response_content_range content_range;
+
+  {
+    az_http_response response;
+    assert_return_code(
+        az_http_response_init(
+            &response,
+            AZ_SPAN_FROM_STR("HTTP/1.1 206 Partial Content\r\n"
+                             "Content-Length: 4\r\n"
+                             "content-range: bytes 1024-1027/10000\r\n"
+                             "\r\n"
+                             "body")),
+        AZ_OK);
+    assert_return_code(az_http_response_get_content_range(&response, &content_range), AZ_OK);
+    assert_true(content_range.first_byte == 1024);
+    assert_true(content_range.last_byte == 1027);
+    assert_true(content_range.complete_length == 10000);
+
+    // The body can be read next.
+    az_span body;
+    assert_return_code(az_http_response_get_body(&response, &body), AZ_OK);
+    assert_true(az_span_is_content_equal(body, AZ_SPAN_FROM_STR("body")));
+  }
+
+  // The server does not know the size of the resource.
+  assert_return_code(
+      test_get_content_range(
+          AZ_SPAN_FROM_STR("HTTP/1.1 206 Partial Content\r\n"
+                           "Content-Range: bytes 0-0/*\r\n"
+                           "\r\n"),
+          &content_range),
+      AZ_OK);
+  assert_true(content_range.first_byte == 0);
+  assert_true(content_range.last_byte == 0);
+  assert_true(content_range.complete_length == -1);
+
+  assert_int_equal(
+      test_get_content_range(
+          AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                           "Content-Length: 0\r\n"
+                           "\r\n"),
+          &content_range),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  az_span const invalid_ranges[] = {
+    AZ_SPAN_LITERAL_FROM_STR("bytes */10000"),
+    AZ_SPAN_LITERAL_FROM_STR("items 0-1/10"),
+    AZ_SPAN_LITERAL_FROM_STR("bytes 5-4/10"),
+    AZ_SPAN_LITERAL_FROM_STR("bytes 0-10/10"),
+    AZ_SPAN_LITERAL_FROM_STR("bytes 0-9"),
+    AZ_SPAN_LITERAL_FROM_STR("bytes 0-9/"),
+    AZ_SPAN_LITERAL_FROM_STR("bytes a-9/10"),
+  };
+  for (size_t i = 0; i < sizeof(invalid_ranges) / sizeof(invalid_ranges[0]); i++)
+  {
+    uint8_t response_buffer[128];
+    az_span remainder = az_span_copy(
+        AZ_SPAN_FROM_BUFFER(response_buffer),
+        AZ_SPAN_FROM_STR("HTTP/1.1 206 Partial Content\r\nContent-Range: "));
+    remainder = az_span_copy(remainder, invalid_ranges[i]);
+    remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("\r\n\r\n"));
+
+    assert_int_equal(
+        test_get_content_range(
+            az_span_slice(
+                AZ_SPAN_FROM_BUFFER(response_buffer),
+                0,
+                (int32_t)sizeof(response_buffer) - az_span_size(remainder)),
+            &content_range),
+        AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER);
+  }
+}
+
 int test_az_http()
 {
 #ifndef AZ_NO_PRECONDITION_CHECKING
@@ -1210,6 +1394,9 @@ int test_az_http()
     cmocka_unit_test(test_http_response_append_overflow),
     cmocka_unit_test(test_http_response_append),
     cmocka_unit_test(test_http_response_append_overflow_on_second_call),
+    cmocka_unit_test(test_http_request_append_range_header),
+    cmocka_unit_test(test_http_response_get_content_range),
+    cmocka_unit_test(test_http_response_http2_status_line),
   };
   return cmocka_run_group_tests_name("az_core_http", tests, NULL, NULL);
 }
@@ -2982,6 +2982,186 @@ static void test_az_json_reader_chunked(void** state)
   assert_true(az_span_is_content_equal(expected, az_span_create_from_str(m.name_string)));
 }
 
+// The "manifest" string embeds escaped JSON text, with escaped whitespace between its tokens, and
+// with strings that are escaped within the JSON text, within the embedding string, or both.
+static az_span const escaped_json_payload = AZ_SPAN_LITERAL_FROM_STR(
+    "{\"manifest\":\"{\\\"name\\\":\\\"a\\\\\\\"b\\\\\\\\c\\\",\\n\\t\\\"url\\\":"
+    "\\\"http:\\\\/\\\\/x\\\",\\\"p\\\":\\\"a\\/b\\\",\\\"size\\\":1024\\n,\\\"ok\\\":true,"
+    "\\\"list\\\":[1.5,null],\\\"\\u0041\\\":-2}\"}");
+
+static az_span _az_buffers160_one[160] = { 0 };
+
+static void _az_read_escaped_json_string(az_json_reader* json_reader, az_span expected)
+{
+  char value[16] = { 0 };
+  int32_t value_length = 0;
+
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_STRING);
+  assert_true(az_json_token_is_text_equal(&json_reader->token, expected));
+  TEST_EXPECT_SUCCESS(
+      az_json_token_get_string(&json_reader->token, value, sizeof(value), &value_length));
+  assert_int_equal(value_length, az_span_size(expected));
+  assert_true(az_span_is_content_equal(expected, az_span_create_from_str(value)));
+}
+
+static void _az_read_escaped_json_property_name(az_json_reader* json_reader, az_span expected)
+{
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_PROPERTY_NAME);
+  assert_true(az_json_token_is_text_equal(&json_reader->token, expected));
+}
+
+static void _az_read_escaped_json(az_json_reader* json_reader)
+{
+  int32_t int32_value = 0;
+  double double_value = 0;
+
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_BEGIN_OBJECT);
+
+  _az_read_escaped_json_property_name(json_reader, AZ_SPAN_FROM_STR("name"));
+  _az_read_escaped_json_string(json_reader, AZ_SPAN_FROM_STR("a\"b\\c"));
+  assert_false(az_json_token_is_text_equal(&json_reader->token, AZ_SPAN_FROM_STR("a\"b\\")));
+  assert_false(az_json_token_is_text_equal(&json_reader->token, AZ_SPAN_FROM_STR("a\"b\\cd")));
+
+  _az_read_escaped_json_property_name(json_reader, AZ_SPAN_FROM_STR("url"));
+  _az_read_escaped_json_string(json_reader, AZ_SPAN_FROM_STR("http://x"));
+
+  _az_read_escaped_json_property_name(json_reader, AZ_SPAN_FROM_STR("p"));
+  _az_read_escaped_json_string(json_reader, AZ_SPAN_FROM_STR("a/b"));
+
+  _az_read_escaped_json_property_name(json_reader, AZ_SPAN_FROM_STR("size"));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_NUMBER);
+  TEST_EXPECT_SUCCESS(az_json_token_get_int32(&json_reader->token, &int32_value));
+  assert_int_equal(int32_value, 1024);
+
+  _az_read_escaped_json_property_name(json_reader, AZ_SPAN_FROM_STR("ok"));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_TRUE);
+
+  _az_read_escaped_json_property_name(json_reader, AZ_SPAN_FROM_STR("list"));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_BEGIN_ARRAY);
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  TEST_EXPECT_SUCCESS(az_json_token_get_double(&json_reader->token, &double_value));
+  assert_true(_is_double_equal(double_value, 1.5, 1e-15));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_NULL);
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_END_ARRAY);
+
+  _az_read_escaped_json_property_name(json_reader, AZ_SPAN_FROM_STR("A"));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  TEST_EXPECT_SUCCESS(az_json_token_get_int32(&json_reader->token, &int32_value));
+  assert_int_equal(int32_value, -2);
+
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(json_reader));
+  assert_int_equal(json_reader->token.kind, AZ_JSON_TOKEN_END_OBJECT);
+  assert_int_equal(az_json_reader_next_token(json_reader), AZ_ERROR_JSON_READER_DONE);
+}
+
+static void _az_read_escaped_json_from_buffers(az_span* buffers, int32_t number_of_buffers)
+{
+  az_json_reader outer_reader;
+  TEST_EXPECT_SUCCESS(az_json_reader_chunked_init(&outer_reader, buffers, number_of_buffers, NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&outer_reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&outer_reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&outer_reader));
+  assert_int_equal(outer_reader.token.kind, AZ_JSON_TOKEN_STRING);
+
+  az_json_reader json_reader;
+  TEST_EXPECT_SUCCESS(
+      az_json_reader_init_from_string_token(&json_reader, &outer_reader.token, NULL));
+  _az_read_escaped_json(&json_reader);
+
+  // Reading the embedded JSON text doesn't move the outer reader.
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&outer_reader));
+  assert_int_equal(outer_reader.token.kind, AZ_JSON_TOKEN_END_OBJECT);
+}
+
+static void test_az_json_reader_escaped(void** state)
+{
+  (void)state;
+
+  az_span json = escaped_json_payload;
+  assert_true(az_span_size(json) <= 160);
+
+  // Contiguous
+  az_json_reader outer_reader;
+  TEST_EXPECT_SUCCESS(az_json_reader_init(&outer_reader, json, NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&outer_reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&outer_reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&outer_reader));
+
+  az_json_reader json_reader;
+  TEST_EXPECT_SUCCESS(az_json_reader_init_escaped(&json_reader, outer_reader.token.slice, NULL));
+  _az_read_escaped_json(&json_reader);
+
+  // Split in half, and split at every byte, so that the escape sequences are split too.
+  az_span buffers_half[2] = { 0 };
+  _az_split_buffers(json, buffers_half);
+  _az_read_escaped_json_from_buffers(buffers_half, 2);
+
+  _az_split_buffers_single_byte(json, _az_buffers160_one);
+  _az_read_escaped_json_from_buffers(_az_buffers160_one, az_span_size(json));
+
+  // A single escaped value.
+  TEST_EXPECT_SUCCESS(
+      az_json_reader_init_escaped(&json_reader, AZ_SPAN_FROM_STR("\\\"a\\\""), NULL));
+  _az_read_escaped_json_string(&json_reader, AZ_SPAN_FROM_STR("a"));
+  assert_int_equal(az_json_reader_next_token(&json_reader), AZ_ERROR_JSON_READER_DONE);
+
+  TEST_EXPECT_SUCCESS(az_json_reader_init_escaped(&json_reader, AZ_SPAN_FROM_STR("12\\n"), NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&json_reader));
+  assert_int_equal(json_reader.token.kind, AZ_JSON_TOKEN_NUMBER);
+  assert_int_equal(az_json_reader_next_token(&json_reader), AZ_ERROR_JSON_READER_DONE);
+}
+
+static void test_az_json_reader_escaped_invalid(void** state)
+{
+  (void)state;
+
+  az_span const invalid_json[] = {
+    // Unescaped quotes
+    AZ_SPAN_LITERAL_FROM_STR("{\"a\":1}"),
+    AZ_SPAN_LITERAL_FROM_STR("{\\\"a\":1}"),
+    // Escaped characters that aren't whitespace or a quote between tokens
+    AZ_SPAN_LITERAL_FROM_STR("{\\/\\\"a\\\":1}"),
+    AZ_SPAN_LITERAL_FROM_STR("[1,\\b2]"),
+    // Control characters within strings
+    AZ_SPAN_LITERAL_FROM_STR("[\\\"a\\nb\\\"]"),
+    AZ_SPAN_LITERAL_FROM_STR("[\\\"a\\u000Ab\\\"]"),
+    // Invalid escape sequences within strings
+    AZ_SPAN_LITERAL_FROM_STR("[\\\"a\\\\qb\\\"]"),
+    AZ_SPAN_LITERAL_FROM_STR("[\\\"a\\\\\\nb\\\"]"),
+    AZ_SPAN_LITERAL_FROM_STR("[\\\"a\\\\u00Gb\\\"]"),
+    AZ_SPAN_LITERAL_FROM_STR("[\\\"a\\u0022b\\\"]"),
+  };
+
+  for (size_t i = 0; i < sizeof(invalid_json) / sizeof(invalid_json[0]); i++)
+  {
+    az_json_reader json_reader;
+    TEST_EXPECT_SUCCESS(az_json_reader_init_escaped(&json_reader, invalid_json[i], NULL));
+
+    az_result result = AZ_OK;
+    while (az_result_succeeded(result))
+    {
+      result = az_json_reader_next_token(&json_reader);
+    }
+    assert_int_equal(result, AZ_ERROR_UNEXPECTED_CHAR);
+  }
+
+  // The string ends before the embedded JSON text does.
+  az_json_reader json_reader;
+  TEST_EXPECT_SUCCESS(
+      az_json_reader_init_escaped(&json_reader, AZ_SPAN_FROM_STR("[\\\"a\\\""), NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&json_reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&json_reader));
+  assert_int_equal(az_json_reader_next_token(&json_reader), AZ_ERROR_UNEXPECTED_END);
+}
+
 static void _az_span_free(az_span* p)
 {
   if (p == NULL)
@@ -3369,6 +3549,585 @@ static void test_json_writer_total_bytes_overflow(void** state)
       az_json_writer_append_string(&writer, AZ_SPAN_FROM_STR("ab")), AZ_ERROR_NOT_ENOUGH_SPACE);
 }
 
+typedef struct
+{
+  az_span name;
+  int32_t reading;
+} test_binding_sensor;
+
+typedef struct
+{
+  az_span id;
+  bool enabled;
+  uint32_t interval;
+  int64_t offset;
+  uint64_t serial;
+  double ratio;
+  test_binding_sensor main_sensor;
+  test_binding_sensor sensors[2];
+  int32_t sensors_count;
+  az_span tags[3];
+  int32_t tags_count;
+  az_span extra;
+} test_binding_device;
+
+static const az_json_binding_field test_binding_sensor_fields[] = {
+  { .key = AZ_SPAN_LITERAL_FROM_STR("name"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(test_binding_sensor, name) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("reading"),
+    .type = AZ_JSON_BINDING_INT32,
+    .offset = offsetof(test_binding_sensor, reading) },
+};
+
+static const az_json_binding test_binding_sensor_binding = {
+  .fields = test_binding_sensor_fields,
+  .fields_length = 2,
+  .size = sizeof(test_binding_sensor),
+};
+
+static const az_json_binding_field test_binding_device_fields[] = {
+  { .key = AZ_SPAN_LITERAL_FROM_STR("id"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(test_binding_device, id) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("enabled"),
+    .type = AZ_JSON_BINDING_BOOLEAN,
+    .offset = offsetof(test_binding_device, enabled) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("interval"),
+    .type = AZ_JSON_BINDING_UINT32,
+    .offset = offsetof(test_binding_device, interval) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("offset"),
+    .type = AZ_JSON_BINDING_INT64,
+    .offset = offsetof(test_binding_device, offset) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("serial"),
+    .type = AZ_JSON_BINDING_UINT64,
+    .offset = offsetof(test_binding_device, serial) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("ratio"),
+    .type = AZ_JSON_BINDING_DOUBLE,
+    .offset = offsetof(test_binding_device, ratio),
+    .fractional_digits = 2 },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("main"),
+    .type = AZ_JSON_BINDING_OBJECT,
+    .offset = offsetof(test_binding_device, main_sensor),
+    .binding = &test_binding_sensor_binding },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("sensors"),
+    .type = AZ_JSON_BINDING_OBJECT,
+    .offset = offsetof(test_binding_device, sensors),
+    .binding = &test_binding_sensor_binding,
+    .array_capacity = 2,
+    .array_count_offset = offsetof(test_binding_device, sensors_count) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("tags"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(test_binding_device, tags),
+    .array_capacity = 3,
+    .array_count_offset = offsetof(test_binding_device, tags_count) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("extra"),
+    .type = AZ_JSON_BINDING_JSON,
+    .offset = offsetof(test_binding_device, extra) },
+};
+
+static const az_json_binding test_binding_device_binding = {
+  .fields = test_binding_device_fields,
+  .fields_length = 10,
+  .size = sizeof(test_binding_device),
+};
+
+static az_result
+test_binding_read(az_span json, test_binding_device* out_device, uint32_t* out_present)
+{
+  az_json_reader reader = { 0 };
+  _az_RETURN_IF_FAILED(az_json_reader_init(&reader, json, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+  *out_device = (test_binding_device){ 0 };
+  _az_RETURN_IF_FAILED(
+      az_json_binding_read(&reader, &test_binding_device_binding, out_device, out_present));
+  assert_int_equal(reader.token.kind, AZ_JSON_TOKEN_END_OBJECT);
+  return AZ_OK;
+}
+
+static void test_az_json_binding_read(void** state)
+{
+  (void)state;
+
+  az_span json = AZ_SPAN_FROM_STR(
+      "{\"id\":\"dev\\\"1\",\"enabled\":true,\"interval\":30,\"offset\":-5,"
+      "\"serial\":18446744073709551615,\"ratio\":0.25,"
+      "\"main\":{\"name\":\"temp\",\"reading\":-40,\"unit\":\"C\"},"
+      "\"sensors\":[{\"name\":\"a\",\"reading\":1},{\"reading\":2,\"name\":\"b\"}],"
+      "\"tags\":[\"x\",\"y\"],\"extra\":{\"nested\":[1,{\"deep\":true}]}}");
+
+  test_binding_device device;
+  uint32_t present = 0;
+  assert_int_equal(test_binding_read(json, &device, &present), AZ_OK);
+
+  assert_int_equal(present, 0x3FF);
+  assert_true(az_span_is_content_equal(device.id, AZ_SPAN_FROM_STR("dev\\\"1")));
+  assert_true(device.enabled);
+  assert_int_equal(device.interval, 30);
+  assert_true(device.offset == -5);
+  assert_true(device.serial == UINT64_MAX);
+  assert_true(_is_double_equal(device.ratio, 0.25, 1e-9));
+  assert_true(az_span_is_content_equal(device.main_sensor.name, AZ_SPAN_FROM_STR("temp")));
+  assert_int_equal(device.main_sensor.reading, -40);
+  assert_int_equal(device.sensors_count, 2);
+  assert_true(az_span_is_content_equal(device.sensors[0].name, AZ_SPAN_FROM_STR("a")));
+  assert_int_equal(device.sensors[0].reading, 1);
+  assert_true(az_span_is_content_equal(device.sensors[1].name, AZ_SPAN_FROM_STR("b")));
+  assert_int_equal(device.sensors[1].reading, 2);
+  assert_int_equal(device.tags_count, 2);
+  assert_true(az_span_is_content_equal(device.tags[0], AZ_SPAN_FROM_STR("x")));
+  assert_true(az_span_is_content_equal(device.tags[1], AZ_SPAN_FROM_STR("y")));
+  assert_true(az_span_is_content_equal(
+      device.extra, AZ_SPAN_FROM_STR("{\"nested\":[1,{\"deep\":true}]}")));
+}
+
+static void test_az_json_binding_read_unknown_null_and_reordered(void** state)
+{
+  (void)state;
+
+  test_binding_device device;
+  uint32_t present = 0;
+
+  // Unknown properties of any kind are skipped, null values leave their member as it is, and
+  // properties may come in any order.
+  az_span json = AZ_SPAN_FROM_STR(
+      "{\"unknown\":{\"id\":\"no\",\"tags\":[\"no\"]},\"interval\":7,\"i\":1,\"idd\":[],"
+      "\"tags\":null,\"ratio\":null,\"id\":\"yes\",\"enabled\":false,\"other\":[[],{}]}");
+  assert_int_equal(test_binding_read(json, &device, &present), AZ_OK);
+  assert_int_equal(present, 0x7);
+  assert_true(az_span_is_content_equal(device.id, AZ_SPAN_FROM_STR("yes")));
+  assert_false(device.enabled);
+  assert_int_equal(device.interval, 7);
+  assert_int_equal(device.tags_count, 0);
+  assert_true(_is_double_equal(device.ratio, 0, 1e-9));
+
+  // Escaped property names are compared on their text, and a repeated property overwrites the
+  // value read before.
+  json = AZ_SPAN_FROM_STR("{\"id\":\"one\",\"id\":\"two\",\"\\/id\":\"three\",\"i\\nd\":\"four\"}");
+  assert_int_equal(test_binding_read(json, &device, &present), AZ_OK);
+  assert_int_equal(present, 0x1);
+  assert_true(az_span_is_content_equal(device.id, AZ_SPAN_FROM_STR("two")));
+
+  json = AZ_SPAN_FROM_STR("{}");
+  assert_int_equal(test_binding_read(json, &device, &present), AZ_OK);
+  assert_int_equal(present, 0);
+  assert_int_equal(az_span_size(device.id), 0);
+
+  // The reader may be on the property name whose value is the object.
+  az_json_reader reader = { 0 };
+  json = AZ_SPAN_FROM_STR("{\"device\":{\"id\":\"inner\"},\"id\":\"outer\"}");
+  TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, json, NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  device = (test_binding_device){ 0 };
+  TEST_EXPECT_SUCCESS(az_json_binding_read(&reader, &test_binding_device_binding, &device, NULL));
+  assert_true(az_span_is_content_equal(device.id, AZ_SPAN_FROM_STR("inner")));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  assert_true(az_json_token_is_text_equal(&reader.token, AZ_SPAN_FROM_STR("id")));
+}
+
+static void test_az_json_binding_read_invalid(void** state)
+{
+  (void)state;
+
+  test_binding_device device;
+  uint32_t present = 0;
+
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("[1]"), &device, &present), AZ_ERROR_UNEXPECTED_CHAR);
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("{\"id\":1}"), &device, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("{\"enabled\":\"true\"}"), &device, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("{\"interval\":-1}"), &device, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("{\"main\":[]}"), &device, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("{\"tags\":\"x\"}"), &device, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("{\"extra\":\"x\"}"), &device, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  assert_int_equal(
+      test_binding_read(AZ_SPAN_FROM_STR("{\"main\":{\"reading\":1.5}}"), &device, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  // Arrays longer than their member fail, with the elements that fit read.
+  assert_int_equal(
+      test_binding_read(
+          AZ_SPAN_FROM_STR("{\"tags\":[\"a\",\"b\",\"c\",\"d\"]}"), &device, &present),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(device.tags_count, 3);
+
+  // The properties read before an error are recorded.
+  assert_int_equal(
+      test_binding_read(
+          AZ_SPAN_FROM_STR("{\"id\":\"a\",\"interval\":3,\"main\":{\"name\":"), &device, &present),
+      AZ_ERROR_UNEXPECTED_END);
+  assert_int_equal(present, 0x5);
+  assert_true(az_span_is_content_equal(device.id, AZ_SPAN_FROM_STR("a")));
+}
+
+typedef struct
+{
+  az_span name;
+  uint32_t code;
+  az_span details;
+} test_binding_status;
+
+static const az_json_binding_field test_binding_status_fields[] = {
+  { .key = AZ_SPAN_LITERAL_FROM_STR("name"),
+    .type = AZ_JSON_BINDING_STRING,
+    .offset = offsetof(test_binding_status, name),
+    .type_mismatch_result = AZ_ERROR_ITEM_NOT_FOUND,
+    .rejects_null = true },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("code"),
+    .type = AZ_JSON_BINDING_UINT32,
+    .offset = offsetof(test_binding_status, code) },
+  { .key = AZ_SPAN_LITERAL_FROM_STR("details"),
+    .type = AZ_JSON_BINDING_JSON_OBJECT,
+    .offset = offsetof(test_binding_status, details) },
+};
+
+static const az_json_binding test_binding_status_binding = {
+  .fields = test_binding_status_fields,
+  .fields_length = (int32_t)(sizeof(test_binding_status_fields) / sizeof(az_json_binding_field)),
+  .size = sizeof(test_binding_status),
+  .ends_at_invalid_property = true,
+};
+
+static az_result
+test_binding_read_status(az_span json, test_binding_status* out_status, uint32_t* out_present)
+{
+  az_json_reader reader = { 0 };
+  _az_RETURN_IF_FAILED(az_json_reader_init(&reader, json, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  *out_status = (test_binding_status){ 0 };
+  return az_json_binding_read(&reader, &test_binding_status_binding, out_status, out_present);
+}
+
+static void test_az_json_binding_read_field_options(void** state)
+{
+  (void)state;
+
+  test_binding_status status;
+  uint32_t present = 0;
+
+  // A field may report a value of the wrong type, null included, with its own result.
+  assert_int_equal(
+      test_binding_read_status(AZ_SPAN_FROM_STR("{\"name\":1}"), &status, &present),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      test_binding_read_status(AZ_SPAN_FROM_STR("{\"name\":null}"), &status, &present),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      test_binding_read_status(AZ_SPAN_FROM_STR("{\"code\":\"1\"}"), &status, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  TEST_EXPECT_SUCCESS(
+      test_binding_read_status(AZ_SPAN_FROM_STR("{\"code\":null}"), &status, &present));
+  assert_int_equal(present, 0);
+
+  // A JSON object member only accepts the text of an object.
+  TEST_EXPECT_SUCCESS(test_binding_read_status(
+      AZ_SPAN_FROM_STR("{\"details\":{\"a\":[1]},\"code\":2}"), &status, &present));
+  assert_int_equal(present, 0x6);
+  assert_true(az_span_is_content_equal(status.details, AZ_SPAN_FROM_STR("{\"a\":[1]}")));
+  assert_int_equal(
+      test_binding_read_status(AZ_SPAN_FROM_STR("{\"details\":[1]}"), &status, &present),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  // An error where a property name is expected ends the object with the properties read before,
+  // while an error within a value still fails.
+  TEST_EXPECT_SUCCESS(test_binding_read_status(
+      AZ_SPAN_FROM_STR("{\"name\":\"a\",}"), &status, &present));
+  assert_int_equal(present, 0x1);
+  TEST_EXPECT_SUCCESS(test_binding_read_status(
+      AZ_SPAN_FROM_STR("{\"name\":\"a\" \"code\":1}"), &status, &present));
+  assert_int_equal(present, 0x1);
+  TEST_EXPECT_SUCCESS(
+      test_binding_read_status(AZ_SPAN_FROM_STR("{\"code\":1,"), &status, &present));
+  assert_int_equal(status.code, 1);
+  assert_int_equal(
+      test_binding_read_status(AZ_SPAN_FROM_STR("{\"code\":"), &status, &present),
+      AZ_ERROR_UNEXPECTED_END);
+
+  // A JSON object member is written only when it is the text of an object.
+  uint8_t buffer[64] = { 0 };
+  az_json_writer writer = { 0 };
+  status = (test_binding_status){ .name = AZ_SPAN_FROM_STR("a"),
+                                  .details = AZ_SPAN_FROM_STR("{\"b\":true}") };
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(buffer), NULL));
+  TEST_EXPECT_SUCCESS(az_json_binding_write(&writer, &test_binding_status_binding, &status));
+  assert_true(az_span_is_content_equal(
+      az_json_writer_get_bytes_used_in_destination(&writer),
+      AZ_SPAN_FROM_STR("{\"name\":\"a\",\"code\":0,\"details\":{\"b\":true}}")));
+  int32_t size = 0;
+  status.details = AZ_SPAN_FROM_STR("[true]");
+  assert_int_equal(
+      az_json_binding_get_write_size(&test_binding_status_binding, &status, &size),
+      AZ_ERROR_UNEXPECTED_CHAR);
+}
+
+// Writes a device the way it would be written without a binding.
+static az_result test_binding_write_by_hand(az_json_writer* ref_writer, test_binding_device* device)
+{
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_writer));
+  if (az_span_size(device->id) > 0)
+  {
+    _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("id")));
+    _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_writer, device->id));
+  }
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("enabled")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_bool(ref_writer, device->enabled));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("interval")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_double(ref_writer, device->interval, 0));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("offset")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_double(ref_writer, (double)device->offset, 0));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("serial")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_double(ref_writer, (double)device->serial, 0));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("ratio")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_double(ref_writer, device->ratio, 2));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("main")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("name")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_writer, device->main_sensor.name));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("reading")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_writer, device->main_sensor.reading));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_writer));
+
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("sensors")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_writer));
+  for (int32_t i = 0; i < device->sensors_count; i++)
+  {
+    _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_writer));
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("name")));
+    _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_writer, device->sensors[i].name));
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("reading")));
+    _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_writer, device->sensors[i].reading));
+    _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_writer));
+  }
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_writer));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("tags")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_writer));
+  for (int32_t i = 0; i < device->tags_count; i++)
+  {
+    _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_writer, device->tags[i]));
+  }
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_writer));
+
+  if (az_span_size(device->extra) > 0)
+  {
+    _az_RETURN_IF_FAILED(
+        az_json_writer_append_property_name(ref_writer, AZ_SPAN_FROM_STR("extra")));
+    _az_RETURN_IF_FAILED(az_json_writer_append_json_text(ref_writer, device->extra));
+  }
+  return az_json_writer_append_end_object(ref_writer);
+}
+
+static void test_az_json_binding_write(void** state)
+{
+  (void)state;
+
+  test_binding_device device = {
+    .id = AZ_SPAN_FROM_STR("dev\"1\n\x01"),
+    .enabled = true,
+    .interval = 30,
+    .offset = -5,
+    .serial = 1234567890123ULL,
+    .ratio = 0.25,
+    .main_sensor = { .name = AZ_SPAN_FROM_STR("temp"), .reading = -40 },
+    .sensors = { { .name = AZ_SPAN_FROM_STR("a"), .reading = 1 },
+                 { .name = AZ_SPAN_FROM_STR("b\\"), .reading = INT32_MIN } },
+    .sensors_count = 2,
+    .tags = { AZ_SPAN_FROM_STR("x"), AZ_SPAN_FROM_STR("") },
+    .tags_count = 2,
+    .extra = AZ_SPAN_FROM_STR("{\"nested\":[1,{\"deep\":true}]}"),
+  };
+
+  uint8_t expected_buffer[512] = { 0 };
+  uint8_t actual_buffer[512] = { 0 };
+
+  for (int32_t i = 0; i < 2; i++)
+  {
+    // The second time, with the members that are not written because they are empty.
+    if (i == 1)
+    {
+      device.id = AZ_SPAN_EMPTY;
+      device.extra = AZ_SPAN_EMPTY;
+      device.enabled = false;
+      device.sensors_count = 0;
+      device.tags_count = 0;
+    }
+
+    az_json_writer expected_writer = { 0 };
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_init(&expected_writer, AZ_SPAN_FROM_BUFFER(expected_buffer), NULL));
+    TEST_EXPECT_SUCCESS(test_binding_write_by_hand(&expected_writer, &device));
+    az_span const expected = az_json_writer_get_bytes_used_in_destination(&expected_writer);
+
+    int32_t size = 0;
+    TEST_EXPECT_SUCCESS(
+        az_json_binding_get_write_size(&test_binding_device_binding, &device, &size));
+    assert_int_equal(size, az_span_size(expected));
+
+    az_json_writer writer = { 0 };
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(actual_buffer), NULL));
+    TEST_EXPECT_SUCCESS(az_json_binding_write(&writer, &test_binding_device_binding, &device));
+    assert_true(
+        az_span_is_content_equal(az_json_writer_get_bytes_used_in_destination(&writer), expected));
+    assert_int_equal(writer.total_bytes_written, size);
+  }
+}
+
+static void test_az_json_binding_write_nested_and_invalid(void** state)
+{
+  (void)state;
+
+  test_binding_sensor sensor = { .name = AZ_SPAN_FROM_STR("a"), .reading = 7 };
+  uint8_t buffer[64] = { 0 };
+
+  // The object is written as any other value, after a comma if need be.
+  az_json_writer writer = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(buffer), NULL));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+  TEST_EXPECT_SUCCESS(az_json_binding_write(&writer, &test_binding_sensor_binding, &sensor));
+  TEST_EXPECT_SUCCESS(az_json_binding_write(&writer, &test_binding_sensor_binding, &sensor));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_int32(&writer, 1));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+  assert_true(az_span_is_content_equal(
+      az_json_writer_get_bytes_used_in_destination(&writer),
+      AZ_SPAN_FROM_STR("[{\"name\":\"a\",\"reading\":7},{\"name\":\"a\",\"reading\":7},1]")));
+
+  // Nothing is written when the object does not fit.
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, az_span_create(buffer, 23), NULL));
+  assert_int_equal(
+      az_json_binding_write(&writer, &test_binding_sensor_binding, &sensor),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(writer.total_bytes_written, 0);
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, az_span_create(buffer, 24), NULL));
+  TEST_EXPECT_SUCCESS(az_json_binding_write(&writer, &test_binding_sensor_binding, &sensor));
+
+  // Raw JSON text must be a single, complete JSON value.
+  test_binding_device device = { .extra = AZ_SPAN_FROM_STR("{\"a\":") };
+  int32_t size = 0;
+  assert_int_equal(
+      az_json_binding_get_write_size(&test_binding_device_binding, &device, &size),
+      AZ_ERROR_UNEXPECTED_END);
+  device.extra = AZ_SPAN_FROM_STR("1 2");
+  assert_int_equal(
+      az_json_binding_get_write_size(&test_binding_device_binding, &device, &size),
+      AZ_ERROR_UNEXPECTED_CHAR);
+  device.extra = AZ_SPAN_FROM_STR("\"text\"");
+  TEST_EXPECT_SUCCESS(az_json_binding_get_write_size(&test_binding_device_binding, &device, &size));
+}
+
+static void test_az_json_query_read(void** state)
+{
+  (void)state;
+
+  az_span const json = AZ_SPAN_FROM_STR(
+      "{\"desired\":{\"thermostat1\":{\"__t\":\"c\",\"targetTemperature\":21.5},"
+      "\"skipped\":{\"targetTemperature\":1,\"$version\":2},\"$version\":7,"
+      "\"thermostat2\":{\"targetTemperature\":[1,2]}},"
+      "\"reported\":{\"serial\":\"a\\/b\",\"thermostat1\":{\"maxTemp\":30}}}");
+
+  az_span const paths[] = {
+    AZ_SPAN_LITERAL_FROM_STR("desired.$version"),
+    AZ_SPAN_LITERAL_FROM_STR("desired.thermostat1.targetTemperature"),
+    AZ_SPAN_LITERAL_FROM_STR("desired.thermostat2"),
+    AZ_SPAN_LITERAL_FROM_STR("desired.thermostat2.targetTemperature"),
+    AZ_SPAN_LITERAL_FROM_STR("reported.serial"),
+    AZ_SPAN_LITERAL_FROM_STR("reported.thermostat1.minTemp"),
+    AZ_SPAN_LITERAL_FROM_STR("$version"),
+  };
+  az_json_token values[7];
+  uint32_t found = 0;
+
+  az_json_reader reader = { 0 };
+  TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, json, NULL));
+  TEST_EXPECT_SUCCESS(az_json_query_read(&reader, paths, 7, values, &found));
+  assert_int_equal(found, 0x1F);
+  assert_int_equal(reader.token.kind, AZ_JSON_TOKEN_END_OBJECT);
+  assert_int_equal(reader.current_depth, 0);
+
+  int32_t version = 0;
+  TEST_EXPECT_SUCCESS(az_json_token_get_int32(&values[0], &version));
+  assert_int_equal(version, 7);
+  double target_temperature = 0;
+  TEST_EXPECT_SUCCESS(az_json_token_get_double(&values[1], &target_temperature));
+  assert_true(_is_double_equal(target_temperature, 21.5, 1e-9));
+  assert_int_equal(values[2].kind, AZ_JSON_TOKEN_BEGIN_OBJECT);
+  assert_int_equal(values[3].kind, AZ_JSON_TOKEN_BEGIN_ARRAY);
+  assert_true(az_json_token_is_text_equal(&values[4], AZ_SPAN_FROM_STR("a/b")));
+  assert_int_equal(values[5].kind, AZ_JSON_TOKEN_NONE);
+  assert_int_equal(values[6].kind, AZ_JSON_TOKEN_NONE);
+
+  // Property names with escaped characters are matched on their text.
+  az_span const escaped_paths[] = { AZ_SPAN_LITERAL_FROM_STR("a/b.c") };
+  TEST_EXPECT_SUCCESS(az_json_reader_init(
+      &reader, AZ_SPAN_FROM_STR("{\"a\\/b\":{\"c\":true}}"), NULL));
+  TEST_EXPECT_SUCCESS(az_json_query_read(&reader, escaped_paths, 1, values, NULL));
+  assert_int_equal(values[0].kind, AZ_JSON_TOKEN_TRUE);
+}
+
+static void test_az_json_query_read_first_value_and_invalid(void** state)
+{
+  (void)state;
+
+  az_span const paths[] = {
+    AZ_SPAN_LITERAL_FROM_STR("a"),
+    AZ_SPAN_LITERAL_FROM_STR("b.c"),
+  };
+  az_json_token values[2];
+  uint32_t found = 0;
+  az_json_reader reader = { 0 };
+
+  // The first value of a property is kept, and reading stops once all the paths are found, so the
+  // rest of the document is not read.
+  TEST_EXPECT_SUCCESS(az_json_reader_init(
+      &reader, AZ_SPAN_FROM_STR("{\"a\":1,\"b\":{\"c\":2},\"a\":3,\"b\":{\"c\":"), NULL));
+  TEST_EXPECT_SUCCESS(az_json_reader_next_token(&reader));
+  TEST_EXPECT_SUCCESS(az_json_query_read(&reader, paths, 2, values, &found));
+  assert_int_equal(found, 0x3);
+  assert_true(az_span_is_content_equal(values[0].slice, AZ_SPAN_FROM_STR("1")));
+  assert_true(az_span_is_content_equal(values[1].slice, AZ_SPAN_FROM_STR("2")));
+
+  // A path whose parent is not an object is not found.
+  TEST_EXPECT_SUCCESS(
+      az_json_reader_init(&reader, AZ_SPAN_FROM_STR("{\"b\":[{\"c\":1}],\"a\":null}"), NULL));
+  TEST_EXPECT_SUCCESS(az_json_query_read(&reader, paths, 2, values, &found));
+  assert_int_equal(found, 0x1);
+  assert_int_equal(values[0].kind, AZ_JSON_TOKEN_NULL);
+  assert_int_equal(values[1].kind, AZ_JSON_TOKEN_NONE);
+
+  TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, AZ_SPAN_FROM_STR("[{\"a\":1}]"), NULL));
+  assert_int_equal(
+      az_json_query_read(&reader, paths, 2, values, &found), AZ_ERROR_UNEXPECTED_CHAR);
+
+  // The paths found before an error are recorded.
+  TEST_EXPECT_SUCCESS(
+      az_json_reader_init(&reader, AZ_SPAN_FROM_STR("{\"a\":1,\"b\":{\"d\":"), NULL));
+  assert_int_equal(
+      az_json_query_read(&reader, paths, 2, values, &found), AZ_ERROR_UNEXPECTED_END);
+  assert_int_equal(found, 0x1);
+}
+
 int test_az_json()
 {
   const struct CMUnitTest tests[]
@@ -3393,10 +4152,20 @@ int test_az_json()
           cmocka_unit_test(test_az_json_token_literal),
           cmocka_unit_test(test_az_json_token_copy),
           cmocka_unit_test(test_az_json_reader_chunked),
+          cmocka_unit_test(test_az_json_reader_escaped),
+          cmocka_unit_test(test_az_json_reader_escaped_invalid),
           cmocka_unit_test(test_az_json_string_unescape),
           cmocka_unit_test(test_az_json_string_unescape_same_buffer),
           cmocka_unit_test(test_json_writer_escape_length_matches_written),
           cmocka_unit_test(test_json_writer_escape_boundary),
-          cmocka_unit_test(test_json_writer_total_bytes_overflow) };
+          cmocka_unit_test(test_json_writer_total_bytes_overflow),
+          cmocka_unit_test(test_az_json_binding_read),
+          cmocka_unit_test(test_az_json_binding_read_unknown_null_and_reordered),
+          cmocka_unit_test(test_az_json_binding_read_invalid),
+          cmocka_unit_test(test_az_json_binding_read_field_options),
+          cmocka_unit_test(test_az_json_binding_write),
+          cmocka_unit_test(test_az_json_binding_write_nested_and_invalid),
+          cmocka_unit_test(test_az_json_query_read),
+          cmocka_unit_test(test_az_json_query_read_first_value_and_invalid) };
   return cmocka_run_group_tests_name("az_core_json", tests, NULL, NULL);
 }
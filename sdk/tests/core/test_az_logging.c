@@ -21,6 +21,10 @@
 
 #define TEST_EXPECT_SUCCESS(exp) assert_true(az_result_succeeded(exp))
 
+#ifdef _az_MOCK_ENABLED
+az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec);
+#endif // _az_MOCK_ENABLED
+
 static bool _log_invoked_for_http_request = false;
 static bool _log_invoked_for_http_response = false;
 
@@ -399,6 +403,55 @@ static void test_az_log_everything_on_null(void** state)
   }
 }
 
+static void test_az_log_classifications(void** state)
+{
+  (void)state;
+  {
+    az_log_set_message_callback(_log_listener_count_logs);
+
+    az_log_classification const classifications[] = { AZ_LOG_HTTP_REQUEST, AZ_LOG_HTTP_RETRY };
+    assert_int_equal(
+        az_log_set_classifications(classifications, (int32_t)_az_COUNTOF(classifications)), AZ_OK);
+
+    _number_of_log_attempts = 0;
+
+    assert_true(_az_BUILT_WITH_LOGGING(true, false) == _az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_REQUEST));
+    assert_true(_az_BUILT_WITH_LOGGING(true, false) == _az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_RETRY));
+    assert_false(_az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_RESPONSE));
+    assert_false(_az_LOG_SHOULD_WRITE((az_log_classification)12345));
+
+    _az_LOG_WRITE(AZ_LOG_HTTP_REQUEST, AZ_SPAN_EMPTY);
+    _az_LOG_WRITE(AZ_LOG_HTTP_RESPONSE, AZ_SPAN_EMPTY);
+    assert_int_equal(_az_BUILT_WITH_LOGGING(1, 0), _number_of_log_attempts);
+
+    // Only classifications defined by the SDK can be set, and a failure leaves the filter as is.
+    az_log_classification const invalid_classifications[]
+        = { AZ_LOG_HTTP_RESPONSE, (az_log_classification)12345 };
+    assert_int_equal(
+        az_log_set_classifications(
+            invalid_classifications, (int32_t)_az_COUNTOF(invalid_classifications)),
+        _az_BUILT_WITH_LOGGING(AZ_ERROR_ARG, AZ_OK));
+    assert_false(_az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_RESPONSE));
+
+    // Without a message callback, nothing is logged.
+    az_log_set_message_callback(NULL);
+    assert_false(_az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_REQUEST));
+    az_log_set_message_callback(_log_listener_count_logs);
+
+    // An empty list filters out everything.
+    assert_int_equal(az_log_set_classifications(NULL, 0), AZ_OK);
+    assert_false(_az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_REQUEST));
+
+    // Setting a filter callback replaces the bitmask.
+    az_log_set_classification_filter_callback(_should_write_http_retry_only);
+    assert_false(_az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_REQUEST));
+    assert_true(_az_BUILT_WITH_LOGGING(true, false) == _az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_RETRY));
+
+    az_log_set_message_callback(NULL);
+    az_log_set_classification_filter_callback(NULL);
+  }
+}
+
 #define _az_TEST_LOG_URL_PREFIX "HTTP Request : GET "
 #define _az_TEST_LOG_URL_PROTOCOL "https://"
 #define _az_TEST_LOG_URL_HOST ".microsoft.com"
@@ -519,6 +572,152 @@ static void test_az_log_http_request_buffer_size(void** state)
 #undef _az_TEST_LOG_URL_HOST
 #undef _az_TEST_LOG_MAX_URL_SIZE
 
+#if defined(_az_MOCK_ENABLED) && !defined(AZ_NO_LOGGING)
+static int32_t _ring_buffer_records_count = 0;
+
+static void _ring_buffer_record_listener(
+    az_log_classification classification,
+    int64_t timestamp_msec,
+    az_span message,
+    void* user_context)
+{
+  (void)user_context;
+  _ring_buffer_records_count++;
+
+  switch (_ring_buffer_records_count)
+  {
+    case 1:
+      assert_int_equal(classification, AZ_LOG_HTTP_RETRY);
+      assert_int_equal(timestamp_msec, 300);
+      assert_true(az_span_is_content_equal(message, AZ_SPAN_FROM_STR("retry")));
+      break;
+    case 2:
+      assert_int_equal(classification, AZ_LOG_HTTP_RETRY);
+      assert_int_equal(timestamp_msec, 400);
+      assert_true(az_span_is_content_equal(message, AZ_SPAN_FROM_STR("0123456789abcdef")));
+      break;
+    case 3:
+      assert_int_equal(classification, AZ_LOG_HTTP_RETRY);
+      assert_int_equal(timestamp_msec, 500);
+      assert_true(az_span_is_content_equal(message, AZ_SPAN_FROM_STR("fedcba9876543210")));
+      break;
+    default:
+      assert_true(false);
+      break;
+  }
+}
+
+static void test_az_log_ring_buffer(void** state)
+{
+  (void)state;
+
+  uint8_t headers[4 * 1024] = { 0 };
+  az_http_request request = { 0 };
+  az_span url = AZ_SPAN_FROM_STR("https://www.example.com");
+  TEST_EXPECT_SUCCESS(az_http_request_init(
+      &request,
+      &az_context_application,
+      az_http_method_get(),
+      url,
+      az_span_size(url),
+      AZ_SPAN_FROM_BUFFER(headers),
+      AZ_SPAN_EMPTY));
+
+  TEST_EXPECT_SUCCESS(az_http_request_append_header(
+      &request, AZ_SPAN_FROM_STR("Header1"), AZ_SPAN_FROM_STR("Value1")));
+  TEST_EXPECT_SUCCESS(az_http_request_append_header(
+      &request,
+      AZ_SPAN_FROM_STR("Header2"),
+      AZ_SPAN_FROM_STR("ZZZZYYYYXXXXWWWWVVVVUUUUTTTTSSSSRRRRQQQQPPPPOOOONNNN")));
+  TEST_EXPECT_SUCCESS(az_http_request_append_header(
+      &request,
+      AZ_SPAN_FROM_STR("Header3"),
+      AZ_SPAN_FROM_STR("111111222222333333444444555555666666777777888888abc")));
+  TEST_EXPECT_SUCCESS(az_http_request_append_header(
+      &request, AZ_SPAN_FROM_STR("authorization"), AZ_SPAN_FROM_STR("BigSecret!")));
+
+  uint8_t response_buf[1024] = { 0 };
+  az_span response_span
+      = AZ_SPAN_FROM_STR("HTTP/1.1 404 Not Found\r\n"
+                         "Header11: Value11\r\n"
+                         "Header22: NNNNOOOOPPPPQQQQRRRRSSSSTTTTUUUUVVVVWWWWXXXXYYYYZZZZ\r\n"
+                         "Header33:\r\n"
+                         "Header44: cba888888777777666666555555444444333333222222111111\r\n"
+                         "\r\n"
+                         "KKKKKJJJJJIIIIIHHHHHGGGGGFFFFFEEEEEDDDDDCCCCCBBBBBAAAAA");
+  az_span_copy(AZ_SPAN_FROM_BUFFER(response_buf), response_span);
+
+  az_http_response response = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(
+      &response, az_span_slice(AZ_SPAN_FROM_BUFFER(response_buf), 0, az_span_size(response_span))));
+
+  uint64_t ring_buf[512] = { 0 };
+  az_log_ring_buffer ring_buffer = { 0 };
+  assert_int_equal(
+      az_log_ring_buffer_init(&ring_buffer, az_span_create((uint8_t*)ring_buf, 32)),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  TEST_EXPECT_SUCCESS(az_log_ring_buffer_init(
+      &ring_buffer, az_span_create((uint8_t*)ring_buf, (int32_t)sizeof(ring_buf))));
+
+  az_log_set_message_callback(_log_listener);
+  az_log_set_classification_filter_callback(NULL);
+  az_log_set_ring_buffer(&ring_buffer);
+
+  // Records are stored, and only formatted when the ring buffer is drained.
+  {
+    _reset_log_invocation_status();
+    will_return(__wrap_az_platform_clock_msec, 100);
+    will_return(__wrap_az_platform_clock_msec, 200);
+    will_return(__wrap_az_platform_clock_msec, 300);
+
+    _az_http_policy_logging_log_http_request(&request);
+    _az_http_policy_logging_log_http_response(&response, 3456, &request);
+    _az_LOG_WRITE(AZ_LOG_HTTP_RETRY, AZ_SPAN_FROM_STR("retry"));
+
+    // The request and response are copied: changing them does not change what is logged.
+    request._internal.headers_length = 0;
+    az_span_fill(AZ_SPAN_FROM_BUFFER(response_buf), 'x');
+
+    assert_false(_log_invoked_for_http_request);
+    assert_false(_log_invoked_for_http_response);
+
+    assert_int_equal(az_log_ring_buffer_drain(&ring_buffer, 2, NULL, NULL), 2);
+    assert_true(_log_invoked_for_http_request);
+    assert_true(_log_invoked_for_http_response);
+
+    _ring_buffer_records_count = 0;
+    assert_int_equal(
+        az_log_ring_buffer_drain(&ring_buffer, -1, _ring_buffer_record_listener, NULL), 1);
+    assert_int_equal(az_log_ring_buffer_drain(&ring_buffer, -1, NULL, NULL), 0);
+    assert_int_equal(az_log_ring_buffer_get_dropped_count(&ring_buffer), 0);
+  }
+
+  // Records that do not fit are dropped, and records never wrap around the end of the buffer.
+  {
+    TEST_EXPECT_SUCCESS(
+        az_log_ring_buffer_init(&ring_buffer, az_span_create((uint8_t*)ring_buf, 64)));
+
+    will_return(__wrap_az_platform_clock_msec, 400);
+    _az_LOG_WRITE(AZ_LOG_HTTP_RETRY, AZ_SPAN_FROM_STR("0123456789abcdef"));
+    _az_LOG_WRITE(AZ_LOG_HTTP_RETRY, AZ_SPAN_FROM_STR("dropped"));
+    assert_int_equal(az_log_ring_buffer_get_dropped_count(&ring_buffer), 1);
+
+    _ring_buffer_records_count = 1;
+    assert_int_equal(
+        az_log_ring_buffer_drain(&ring_buffer, -1, _ring_buffer_record_listener, NULL), 1);
+
+    will_return(__wrap_az_platform_clock_msec, 500);
+    _az_LOG_WRITE(AZ_LOG_HTTP_RETRY, AZ_SPAN_FROM_STR("fedcba9876543210"));
+    assert_int_equal(
+        az_log_ring_buffer_drain(&ring_buffer, -1, _ring_buffer_record_listener, NULL), 1);
+    assert_int_equal(_ring_buffer_records_count, 3);
+  }
+
+  az_log_set_ring_buffer(NULL);
+  az_log_set_message_callback(NULL);
+}
+#endif // defined(_az_MOCK_ENABLED) && !defined(AZ_NO_LOGGING)
+
 int test_az_logging()
 {
   const struct CMUnitTest tests[] = {
@@ -527,7 +726,11 @@ int test_az_logging()
     cmocka_unit_test(test_az_log_incorrect_list_fails_gracefully),
     cmocka_unit_test(test_az_log_everything_valid),
     cmocka_unit_test(test_az_log_everything_on_null),
+    cmocka_unit_test(test_az_log_classifications),
     cmocka_unit_test(test_az_log_http_request_buffer_size),
+#if defined(_az_MOCK_ENABLED) && !defined(AZ_NO_LOGGING)
+    cmocka_unit_test(test_az_log_ring_buffer),
+#endif // defined(_az_MOCK_ENABLED) && !defined(AZ_NO_LOGGING)
   };
   return cmocka_run_group_tests_name("az_core_logging", tests, NULL, NULL);
 }
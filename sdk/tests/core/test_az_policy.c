@@ -44,6 +44,8 @@ void test_az_http_pipeline_policy_credential(void** state);
 void test_az_http_pipeline_policy_retry(void** state);
 void test_az_http_pipeline_policy_retry_with_header(void** state);
 void test_az_http_pipeline_policy_retry_with_header_2(void** state);
+void test_az_http_pipeline_policy_instrumentation(void** state);
+void test_az_http_pipeline_policy_instrumentation_clock_fails(void** state);
 #endif // _az_MOCK_ENABLED
 
 static az_result test_policy_transport(
@@ -54,6 +56,7 @@ static az_result test_policy_transport(
 
 void test_az_http_pipeline_policy_apiversion(void** state);
 void test_az_http_pipeline_policy_telemetry(void** state);
+void test_az_http_histogram_get_value_at_percentile(void** state);
 
 az_result test_policy_transport(
     _az_http_policy* ref_policies,
@@ -206,6 +209,40 @@ void test_az_http_pipeline_policy_apiversion(void** state)
       az_http_pipeline_policy_apiversion(policies, &api_version, &request, NULL), AZ_OK);
 }
 
+void test_az_http_histogram_get_value_at_percentile(void** state)
+{
+  (void)state;
+
+  az_http_metrics metrics;
+  az_http_metrics_init(&metrics);
+  az_http_histogram* histogram = &metrics.attempt_duration_msec;
+
+  assert_int_equal(az_http_histogram_get_value_at_percentile(histogram, 50), 0);
+
+  // Values below 8 are exact. 8 sub-buckets per power of two above that, so 100 falls in
+  // [96, 103] and 1000 in [960, 1023].
+  int32_t const values[] = { 1, 2, 3, 4, 5, 6, 7, 100, 100, 1000 };
+  for (size_t i = 0; i < _az_COUNTOF(values); i++)
+  {
+    histogram->buckets[i < 7 ? values[i] : (values[i] == 100 ? 36 : 63)]++;
+    histogram->count++;
+  }
+  histogram->max = 1000;
+
+  assert_int_equal(az_http_histogram_get_value_at_percentile(histogram, 0), 1);
+  assert_int_equal(az_http_histogram_get_value_at_percentile(histogram, 50), 5);
+  assert_int_equal(az_http_histogram_get_value_at_percentile(histogram, 70), 7);
+  assert_int_equal(az_http_histogram_get_value_at_percentile(histogram, 90), 103);
+  assert_int_equal(az_http_histogram_get_value_at_percentile(histogram, 99), 1000);
+  assert_int_equal(az_http_histogram_get_value_at_percentile(histogram, 100), 1000);
+
+  az_http_metrics snapshot;
+  az_http_metrics_snapshot(&metrics, &snapshot);
+  assert_int_equal(snapshot.attempt_duration_msec.count, 10);
+  assert_int_equal(
+      az_http_histogram_get_value_at_percentile(&snapshot.attempt_duration_msec, 90), 103);
+}
+
 #ifdef _az_MOCK_ENABLED
 
 const az_span retry_response = AZ_SPAN_LITERAL_FROM_STR("HTTP/1.1 408 Request Timeout\r\n"
@@ -272,6 +309,184 @@ az_result test_policy_transport_retry_response_with_header_2(
   return AZ_OK;
 }
 
+static az_result test_policy_transport_append_retry_response_with_header(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_options;
+  (void)ref_request;
+  assert_return_code(az_http_response_append(ref_response, retry_response_with_header), AZ_OK);
+  return AZ_OK;
+}
+
+static int32_t instrumentation_callback_count = 0;
+
+static void test_instrumentation_callback(
+    az_http_instrumentation_attempt const* attempt,
+    void* user_context)
+{
+  assert_ptr_equal(user_context, &instrumentation_callback_count);
+  instrumentation_callback_count++;
+
+  assert_int_equal(attempt->result, AZ_OK);
+  assert_int_equal(attempt->status_code, AZ_HTTP_STATUS_CODE_REQUEST_TIMEOUT);
+  assert_int_equal(attempt->attempt, instrumentation_callback_count);
+  assert_int_equal(attempt->duration_msec, instrumentation_callback_count == 1 ? 15 : 7);
+  // "GET" + "url" + "Content-Type" + "json"
+  assert_int_equal(attempt->request_size, 22);
+  assert_int_equal(attempt->response_size, az_span_size(retry_response_with_header));
+}
+
+void test_az_http_pipeline_policy_instrumentation(void** state)
+{
+  (void)state;
+
+  uint8_t buf[100] = { 0 };
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  uint8_t response_buf[200] = { 0 };
+
+  az_span url_span = AZ_SPAN_FROM_BUFFER(buf);
+  (void)az_span_copy(url_span, AZ_SPAN_FROM_STR("url"));
+  az_http_request request;
+
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          az_http_method_get(),
+          url_span,
+          3,
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+  assert_return_code(
+      az_http_request_append_header(
+          &request, AZ_SPAN_FROM_STR("Content-Type"), AZ_SPAN_FROM_STR("json")),
+      AZ_OK);
+
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  retry_options.max_retries = 1;
+
+  az_http_metrics metrics;
+  az_http_metrics_init(&metrics);
+  az_http_policy_instrumentation_options instrumentation_options = {
+    .metrics = &metrics,
+    .callback = test_instrumentation_callback,
+    .callback_context = &instrumentation_callback_count,
+  };
+  instrumentation_callback_count = 0;
+
+  _az_http_policy policies[2] = {
+            {
+              ._internal = {
+                .process = az_http_pipeline_policy_instrumentation,
+                .options = &instrumentation_options,
+              },
+            },
+            {
+              ._internal = {
+                .process = test_policy_transport_append_retry_response_with_header,
+                .options = NULL,
+              },
+            },
+        };
+
+  // Attempt #1 takes 15ms, the retry policy then checks the context, and attempt #2 takes 7ms.
+  will_return(__wrap_az_platform_clock_msec, 10);
+  will_return(__wrap_az_platform_clock_msec, 25);
+  will_return(__wrap_az_platform_clock_msec, 30);
+  will_return(__wrap_az_platform_clock_msec, 40);
+  will_return(__wrap_az_platform_clock_msec, 47);
+
+  az_http_response response;
+  assert_return_code(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+  assert_return_code(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response), AZ_OK);
+
+  assert_int_equal(instrumentation_callback_count, 2);
+
+  az_http_metrics snapshot;
+  az_http_metrics_snapshot(&metrics, &snapshot);
+  assert_int_equal(snapshot.attempt_count, 2);
+  assert_int_equal(snapshot.retry_count, 1);
+  assert_int_equal(snapshot.failure_count, 0);
+  assert_int_equal(snapshot.status_code_class_count[3], 2);
+  assert_int_equal(snapshot.status_code_class_count[1], 0);
+  assert_int_equal(snapshot.attempt_duration_msec.count, 2);
+  assert_int_equal(snapshot.attempt_duration_msec.max, 15);
+  assert_int_equal(
+      az_http_histogram_get_value_at_percentile(&snapshot.attempt_duration_msec, 50), 7);
+  assert_int_equal(
+      az_http_histogram_get_value_at_percentile(&snapshot.attempt_duration_msec, 100), 15);
+  assert_int_equal(snapshot.request_size.max, 22);
+
+  // The response is left unread for the caller.
+  assert_int_equal(
+      az_http_response_get_status_code(&response), AZ_HTTP_STATUS_CODE_REQUEST_TIMEOUT);
+}
+
+static az_result test_policy_transport_fail(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_options;
+  (void)ref_request;
+  (void)ref_response;
+  return AZ_ERROR_HTTP_RESPONSE_OVERFLOW;
+}
+
+void test_az_http_pipeline_policy_instrumentation_clock_fails(void** state)
+{
+  (void)state;
+
+  az_http_request request = { 0 };
+  az_http_response response = { 0 };
+
+  az_http_metrics metrics;
+  az_http_metrics_init(&metrics);
+  az_http_policy_instrumentation_options instrumentation_options = {
+    .metrics = &metrics,
+    .callback = NULL,
+    .callback_context = NULL,
+  };
+
+  _az_http_policy policies[1] = {
+            {
+              ._internal = {
+                .process = test_policy_transport_fail,
+                .options = NULL,
+              },
+            },
+        };
+
+  // A negative clock value makes the mock clock fail. The attempt is still sent, its result is
+  // returned instead of the error of the clock, and nothing is recorded.
+  will_return(__wrap_az_platform_clock_msec, -1);
+  assert_int_equal(
+      az_http_pipeline_policy_instrumentation(
+          policies, &instrumentation_options, &request, &response),
+      AZ_ERROR_HTTP_RESPONSE_OVERFLOW);
+
+  will_return(__wrap_az_platform_clock_msec, 10);
+  will_return(__wrap_az_platform_clock_msec, -1);
+  assert_int_equal(
+      az_http_pipeline_policy_instrumentation(
+          policies, &instrumentation_options, &request, &response),
+      AZ_ERROR_HTTP_RESPONSE_OVERFLOW);
+
+  az_http_metrics snapshot;
+  az_http_metrics_snapshot(&metrics, &snapshot);
+  assert_int_equal(snapshot.attempt_count, 0);
+  assert_int_equal(snapshot.failure_count, 0);
+  assert_int_equal(snapshot.attempt_duration_msec.count, 0);
+}
+
 void test_az_http_pipeline_policy_retry(void** state)
 {
   (void)state;
@@ -416,7 +631,7 @@ az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec)
 {
   _az_PRECONDITION_NOT_NULL(out_clock_msec);
   *out_clock_msec = (int64_t)mock();
-  return AZ_OK;
+  return *out_clock_msec < 0 ? AZ_ERROR_DEPENDENCY_NOT_PROVIDED : AZ_OK;
 }
 
 az_result __wrap_az_platform_sleep_msec(int32_t milliseconds);
@@ -439,9 +654,12 @@ int test_az_policy()
     cmocka_unit_test(test_az_http_pipeline_policy_retry),
     cmocka_unit_test(test_az_http_pipeline_policy_retry_with_header),
     cmocka_unit_test(test_az_http_pipeline_policy_retry_with_header_2),
+    cmocka_unit_test(test_az_http_pipeline_policy_instrumentation),
+    cmocka_unit_test(test_az_http_pipeline_policy_instrumentation_clock_fails),
 #endif // _az_MOCK_ENABLED
     cmocka_unit_test(test_az_http_pipeline_policy_apiversion),
     cmocka_unit_test(test_az_http_pipeline_policy_telemetry),
+    cmocka_unit_test(test_az_http_histogram_get_value_at_percentile),
   };
   return cmocka_run_group_tests_name("az_core_policy", tests, NULL, NULL);
 }
@@ -16,6 +16,7 @@ int main()
   int result = 0;
 
   result += test_az_iot_adu();
+  result += test_az_iot_adu_client_download();
 
   return result;
 }
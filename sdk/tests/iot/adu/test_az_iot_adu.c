@@ -623,6 +623,37 @@ static void test_az_iot_adu_client_parse_update_manifest_NULL_update_manifest_fa
   ASSERT_PRECONDITION_CHECKED(az_iot_adu_client_parse_update_manifest(&adu_client, &reader, NULL));
 }
 
+static void test_az_iot_adu_client_parse_update_manifest_compact_NULL_update_manifest_fail(
+    void** state)
+{
+  (void)state;
+
+  az_iot_adu_client adu_client;
+  az_json_reader reader;
+  uint8_t arena[64];
+  int32_t arena_size;
+
+  assert_int_equal(az_iot_adu_client_init(&adu_client, NULL), AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_adu_client_parse_update_manifest_compact(
+      &adu_client, &reader, AZ_SPAN_FROM_BUFFER(arena), NULL, &arena_size));
+}
+
+static void test_az_iot_adu_client_parse_service_properties_compact_NULL_request_fail(void** state)
+{
+  (void)state;
+
+  az_iot_adu_client adu_client;
+  az_json_reader reader;
+  uint8_t arena[64];
+  int32_t arena_size;
+
+  assert_int_equal(az_iot_adu_client_init(&adu_client, NULL), AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_adu_client_parse_service_properties_compact(
+      &adu_client, &reader, AZ_SPAN_FROM_BUFFER(arena), NULL, &arena_size));
+}
+
 #endif // AZ_NO_PRECONDITION_CHECKING
 
 static void test_az_iot_adu_client_init_succeed(void** state)
@@ -778,6 +809,202 @@ static void test_az_iot_adu_client_get_agent_state_long_payload_with_retry_succe
       sizeof(expected_agent_state_long_payload_with_retry) - 1);
 }
 
+static void assert_agent_state_template_payload_equal(
+    az_iot_adu_client* client,
+    az_iot_adu_client_device_properties* device_properties,
+    az_iot_adu_client_agent_state_template const* agent_state_template,
+    az_iot_adu_client_agent_state agent_state,
+    az_iot_adu_client_workflow* workflow,
+    az_iot_adu_client_install_result* last_install_result)
+{
+  az_json_writer jw;
+  uint8_t payload_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span payload;
+
+  assert_int_equal(
+      az_json_writer_init(&jw, az_span_create(payload_buffer, sizeof(payload_buffer)), NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_get_agent_state_payload(
+          client, device_properties, agent_state, workflow, last_install_result, &jw),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_get_payload(
+          agent_state_template, agent_state, workflow, last_install_result, &payload),
+      AZ_OK);
+  assert_true(
+      az_span_is_content_equal(payload, az_json_writer_get_bytes_used_in_destination(&jw)));
+}
+
+static void test_az_iot_adu_client_agent_state_template_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_adu_client client;
+  az_iot_adu_client_agent_state_template agent_state_template;
+  uint8_t template_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span payload;
+
+  assert_int_equal(az_iot_adu_client_init(&client, NULL), AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_init(
+          &client,
+          &adu_device_properties,
+          AZ_SPAN_FROM_BUFFER(template_buffer),
+          &agent_state_template),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_get_payload(
+          &agent_state_template, AZ_IOT_ADU_CLIENT_AGENT_STATE_IDLE, NULL, NULL, &payload),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(
+      payload,
+      az_span_create(expected_agent_state_payload, sizeof(expected_agent_state_payload) - 1)));
+
+  az_iot_adu_client_workflow workflow = {
+    .action = AZ_IOT_ADU_CLIENT_SERVICE_ACTION_APPLY_DEPLOYMENT,
+    .id = az_span_create(workflow_id, sizeof(workflow_id) - 1),
+    .retry_timestamp
+    = az_span_create(workflow_retry_timestamp, sizeof(workflow_retry_timestamp) - 1),
+  };
+  az_iot_adu_client_install_result install_result = {
+    .result_code = result_code,
+    .extended_result_code = extended_result_code,
+    .result_details = result_details,
+    .step_results_count = 1,
+  };
+  install_result.step_results[0].result_code = result_code;
+  install_result.step_results[0].extended_result_code = extended_result_code;
+  install_result.step_results[0].result_details = result_details;
+
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_get_payload(
+          &agent_state_template,
+          AZ_IOT_ADU_CLIENT_AGENT_STATE_IDLE,
+          &workflow,
+          &install_result,
+          &payload),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(
+      payload,
+      az_span_create(
+          expected_agent_state_long_payload_with_retry,
+          sizeof(expected_agent_state_long_payload_with_retry) - 1)));
+
+  // Successive reports, longer and shorter, keep the parts rendered once.
+  assert_agent_state_template_payload_equal(
+      &client,
+      &adu_device_properties,
+      &agent_state_template,
+      AZ_IOT_ADU_CLIENT_AGENT_STATE_DEPLOYMENT_IN_PROGRESS,
+      &workflow,
+      NULL);
+  install_result.result_details = AZ_SPAN_FROM_STR("Failed \"step\"");
+  install_result.step_results_count = 2;
+  install_result.step_results[1].result_code = 701;
+  install_result.step_results[1].extended_result_code = -1;
+  install_result.step_results[1].result_details = AZ_SPAN_EMPTY;
+  workflow.retry_timestamp = AZ_SPAN_EMPTY;
+  assert_agent_state_template_payload_equal(
+      &client,
+      &adu_device_properties,
+      &agent_state_template,
+      AZ_IOT_ADU_CLIENT_AGENT_STATE_FAILED,
+      &workflow,
+      &install_result);
+  assert_agent_state_template_payload_equal(
+      &client,
+      &adu_device_properties,
+      &agent_state_template,
+      AZ_IOT_ADU_CLIENT_AGENT_STATE_IDLE,
+      NULL,
+      NULL);
+}
+
+static void test_az_iot_adu_client_agent_state_template_custom_properties_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_adu_client client;
+  az_iot_adu_client_options options = az_iot_adu_client_options_default();
+  az_iot_adu_client_agent_state_template agent_state_template;
+  uint8_t template_buffer[TEST_SPAN_BUFFER_SIZE];
+
+  options.device_compatibility_properties = AZ_SPAN_FROM_STR("manufacturer,model,location");
+  assert_int_equal(az_iot_adu_client_init(&client, &options), AZ_OK);
+
+  az_iot_adu_device_custom_properties custom_properties = { .count = 1 };
+  custom_properties.names[0] = AZ_SPAN_FROM_STR("location");
+  custom_properties.values[0] = AZ_SPAN_FROM_STR("US");
+
+  az_iot_adu_client_device_properties device_properties = adu_device_properties;
+  device_properties.custom_properties = &custom_properties;
+  device_properties.delivery_optimization_agent_version = AZ_SPAN_FROM_STR("DU;lib/v0.6.0");
+
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_init(
+          &client, &device_properties, AZ_SPAN_FROM_BUFFER(template_buffer), &agent_state_template),
+      AZ_OK);
+  assert_agent_state_template_payload_equal(
+      &client,
+      &device_properties,
+      &agent_state_template,
+      AZ_IOT_ADU_CLIENT_AGENT_STATE_IDLE,
+      NULL,
+      NULL);
+}
+
+static void test_az_iot_adu_client_agent_state_template_not_enough_space_fail(void** state)
+{
+  (void)state;
+
+  az_iot_adu_client client;
+  az_iot_adu_client_agent_state_template agent_state_template;
+  uint8_t template_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span payload;
+
+  assert_int_equal(az_iot_adu_client_init(&client, NULL), AZ_OK);
+
+  // The buffer holds one payload and the parts rendered once.
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_init(
+          &client,
+          &adu_device_properties,
+          az_span_create(template_buffer, sizeof(expected_agent_state_payload) - 1),
+          &agent_state_template),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  az_span const expected_payload
+      = az_span_create(expected_agent_state_payload, sizeof(expected_agent_state_payload) - 1);
+  int32_t const suffix_size = az_span_size(expected_payload)
+      - az_span_find(expected_payload, AZ_SPAN_FROM_STR(",\"installedUpdateId\""));
+  az_span const buffer
+      = az_span_create(template_buffer, az_span_size(expected_payload) + suffix_size);
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_init(
+          &client, &adu_device_properties, buffer, &agent_state_template),
+      AZ_OK);
+
+  az_iot_adu_client_workflow workflow = {
+    .action = AZ_IOT_ADU_CLIENT_SERVICE_ACTION_APPLY_DEPLOYMENT,
+    .id = az_span_create(workflow_id, sizeof(workflow_id) - 1),
+    .retry_timestamp = AZ_SPAN_EMPTY,
+  };
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_get_payload(
+          &agent_state_template, AZ_IOT_ADU_CLIENT_AGENT_STATE_IDLE, &workflow, NULL, &payload),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // A failed report leaves the template usable.
+  assert_int_equal(
+      az_iot_adu_client_agent_state_template_get_payload(
+          &agent_state_template, AZ_IOT_ADU_CLIENT_AGENT_STATE_IDLE, NULL, NULL, &payload),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(payload, expected_payload));
+}
+
 static void test_az_iot_adu_client_get_service_properties_response_succeed(void** state)
 {
   (void)state;
@@ -1055,6 +1282,75 @@ static void test_az_iot_adu_client_parse_service_properties_too_many_file_url_va
       AZ_ERROR_NOT_ENOUGH_SPACE);
 }
 
+static void test_az_iot_adu_client_parse_service_properties_compact_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_adu_client adu_client;
+  az_json_reader reader;
+  uint64_t arena[16];
+  az_iot_adu_client_compact_update_request request;
+  int32_t arena_size;
+
+  assert_int_equal(az_iot_adu_client_init(&adu_client, NULL), AZ_OK);
+
+  // More file urls than az_iot_adu_client_update_request holds, the null one being skipped.
+  assert_int_equal(
+      az_json_reader_init(
+          &reader,
+          az_span_create(
+              adu_request_payload_too_many_file_url_value,
+              sizeof(adu_request_payload_too_many_file_url_value) - 1),
+          NULL),
+      AZ_OK);
+  assert_int_equal(az_json_reader_next_token(&reader), AZ_OK);
+  assert_int_equal(az_json_reader_next_token(&reader), AZ_OK);
+
+  assert_int_equal(
+      az_iot_adu_client_parse_service_properties_compact(
+          &adu_client,
+          &reader,
+          az_span_create((uint8_t*)arena, sizeof(arena)),
+          &request,
+          &arena_size),
+      AZ_OK);
+
+  assert_int_equal(request.workflow.action, AZ_IOT_ADU_CLIENT_SERVICE_ACTION_APPLY_DEPLOYMENT);
+  assert_int_equal(az_span_size(request.update_manifest_signature) > 0, true);
+  assert_int_equal(request.file_urls_count, 3);
+  assert_int_equal(arena_size, 3 * sizeof(az_iot_adu_client_file_url));
+  assert_true(
+      az_span_is_content_equal(request.file_urls[0].id, AZ_SPAN_FROM_STR("f2f4a804ca17afbae")));
+  assert_true(
+      az_span_is_content_equal(request.file_urls[1].id, AZ_SPAN_FROM_STR("f9fec76f10aede60e")));
+  assert_true(
+      az_span_is_content_equal(request.file_urls[2].id, AZ_SPAN_FROM_STR("f9fec76f10aedeabc")));
+  assert_true(az_span_is_content_equal(
+      az_span_slice_to_end(request.file_urls[2].url, az_span_size(request.file_urls[2].url) - 16),
+      AZ_SPAN_FROM_STR("contoso-v1.1.bin")));
+
+  // One byte less than the arena needed is not enough.
+  assert_int_equal(
+      az_json_reader_init(
+          &reader,
+          az_span_create(
+              adu_request_payload_too_many_file_url_value,
+              sizeof(adu_request_payload_too_many_file_url_value) - 1),
+          NULL),
+      AZ_OK);
+  assert_int_equal(az_json_reader_next_token(&reader), AZ_OK);
+  assert_int_equal(az_json_reader_next_token(&reader), AZ_OK);
+
+  assert_int_equal(
+      az_iot_adu_client_parse_service_properties_compact(
+          &adu_client,
+          &reader,
+          az_span_create((uint8_t*)arena, arena_size - 1),
+          &request,
+          &arena_size),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
 static void test_az_iot_adu_client_parse_service_properties_payload_reverse_order_succeed(
     void** state)
 {
@@ -1359,6 +1655,48 @@ static void test_az_iot_adu_client_parse_update_manifest_payload_reverse_order_s
       adu_request_manifest_reverse_order, sizeof(adu_request_manifest_reverse_order));
 }
 
+static void test_az_iot_adu_client_parse_update_manifest_escaped_succeed(void** state)
+{
+  (void)state;
+  az_iot_adu_client adu_client;
+  az_json_reader reader;
+  az_iot_adu_client_update_request request;
+  az_iot_adu_client_update_manifest update_manifest;
+
+  assert_int_equal(az_iot_adu_client_init(&adu_client, NULL), AZ_OK);
+
+  assert_int_equal(
+      az_json_reader_init(
+          &reader, az_span_create(adu_request_payload, sizeof(adu_request_payload) - 1), NULL),
+      AZ_OK);
+  assert_int_equal(az_json_reader_next_token(&reader), AZ_OK);
+  assert_int_equal(az_json_reader_next_token(&reader), AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_parse_service_properties(&adu_client, &reader, &request), AZ_OK);
+
+  // The update manifest is parsed where it is, without unescaping it into a scratch buffer first.
+  assert_int_equal(az_json_reader_init_escaped(&reader, request.update_manifest, NULL), AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_parse_update_manifest(&adu_client, &reader, &update_manifest), AZ_OK);
+
+  assert_true(az_span_is_content_equal(
+      update_manifest.manifest_version,
+      az_span_create(manifest_version, sizeof(manifest_version) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.update_id.provider,
+      az_span_create(update_id_provider, sizeof(update_id_provider) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.instructions.steps[0].handler,
+      az_span_create(instructions_steps_handler, sizeof(instructions_steps_handler) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[0].file_name,
+      az_span_create(files_filename, sizeof(files_filename) - 1)));
+  assert_int_equal(update_manifest.files[0].size_in_bytes, files_size_in_bytes);
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[0].hashes[0].hash_value,
+      az_span_create(files_hashes_sha, sizeof(files_hashes_sha) - 1)));
+}
+
 static void test_az_iot_adu_client_parse_update_manifest_payload_too_many_file_ids_fail(
     void** state)
 {
@@ -1407,6 +1745,209 @@ static void test_az_iot_adu_client_parse_update_manifest_payload_too_many_total_
       AZ_ERROR_NOT_ENOUGH_SPACE);
 }
 
+static void parse_update_manifest_compact(
+    uint8_t* request_manifest,
+    int32_t request_manifest_size,
+    az_span arena,
+    az_iot_adu_client_compact_update_manifest* update_manifest,
+    int32_t* arena_size)
+{
+  az_iot_adu_client adu_client;
+  az_json_reader reader;
+
+  assert_int_equal(az_iot_adu_client_init(&adu_client, NULL), AZ_OK);
+  assert_int_equal(
+      az_json_reader_init(
+          &reader, az_span_create(request_manifest, request_manifest_size - 1), NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_parse_update_manifest_compact(
+          &adu_client, &reader, arena, update_manifest, arena_size),
+      AZ_OK);
+}
+
+static void parse_update_manifest_compact_succeed(
+    uint8_t* request_manifest,
+    int32_t request_manifest_size)
+{
+  // Aligned, so the arena holds exactly the steps, files and hashes of the manifest.
+  uint64_t arena[32];
+  az_iot_adu_client_compact_update_manifest update_manifest;
+  int32_t arena_size;
+
+  parse_update_manifest_compact(
+      request_manifest,
+      request_manifest_size,
+      az_span_create((uint8_t*)arena, sizeof(arena)),
+      &update_manifest,
+      &arena_size);
+
+  assert_int_equal(
+      arena_size,
+      sizeof(az_iot_adu_client_compact_update_manifest_step) + sizeof(az_span)
+          + sizeof(az_iot_adu_client_compact_update_manifest_file)
+          + sizeof(az_iot_adu_client_update_manifest_file_hash));
+
+  assert_true(az_span_is_content_equal(
+      update_manifest.manifest_version,
+      az_span_create(manifest_version, sizeof(manifest_version) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.update_id.provider,
+      az_span_create(update_id_provider, sizeof(update_id_provider) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.update_id.name, az_span_create(update_id_name, sizeof(update_id_name) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.update_id.version,
+      az_span_create(update_id_version, sizeof(update_id_version) - 1)));
+
+  assert_int_equal(update_manifest.steps_count, 1);
+  assert_true(az_span_is_content_equal(
+      update_manifest.steps[0].handler,
+      az_span_create(instructions_steps_handler, sizeof(instructions_steps_handler) - 1)));
+  assert_int_equal(update_manifest.steps[0].files_count, 1);
+  assert_true(az_span_is_content_equal(
+      update_manifest.steps[0].files[0],
+      az_span_create(instructions_steps_file, sizeof(instructions_steps_file) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.steps[0].handler_properties.installed_criteria,
+      az_span_create(
+          instructions_steps_handler_properties_install_criteria,
+          sizeof(instructions_steps_handler_properties_install_criteria) - 1)));
+
+  assert_int_equal(update_manifest.files_count, 1);
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[0].id, az_span_create(files_id, sizeof(files_id) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[0].file_name,
+      az_span_create(files_filename, sizeof(files_filename) - 1)));
+  assert_int_equal(update_manifest.files[0].size_in_bytes, files_size_in_bytes);
+  assert_int_equal(update_manifest.files[0].hashes_count, 1);
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[0].hashes[0].hash_type,
+      az_span_create(files_hash_id, sizeof(files_hash_id) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[0].hashes[0].hash_value,
+      az_span_create(files_hashes_sha, sizeof(files_hashes_sha) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.create_date_time,
+      az_span_create(created_date_time, sizeof(created_date_time) - 1)));
+}
+
+static void test_az_iot_adu_client_parse_update_manifest_compact_succeed(void** state)
+{
+  (void)state;
+  parse_update_manifest_compact_succeed(adu_request_manifest, sizeof(adu_request_manifest));
+  parse_update_manifest_compact_succeed(
+      adu_request_manifest_unused_fields, sizeof(adu_request_manifest_unused_fields));
+  parse_update_manifest_compact_succeed(
+      adu_request_manifest_unknown_nested_fields,
+      sizeof(adu_request_manifest_unknown_nested_fields));
+  parse_update_manifest_compact_succeed(
+      adu_request_manifest_reverse_order, sizeof(adu_request_manifest_reverse_order));
+}
+
+static void test_az_iot_adu_client_parse_update_manifest_compact_many_files_succeed(void** state)
+{
+  (void)state;
+  uint64_t arena[64];
+  az_iot_adu_client_compact_update_manifest update_manifest;
+  int32_t arena_size;
+
+  // More file ids in a step than az_iot_adu_client_update_manifest holds.
+  parse_update_manifest_compact(
+      adu_request_manifest_too_many_file_ids,
+      sizeof(adu_request_manifest_too_many_file_ids),
+      az_span_create((uint8_t*)arena, sizeof(arena)),
+      &update_manifest,
+      &arena_size);
+
+  assert_int_equal(update_manifest.steps_count, 1);
+  assert_int_equal(update_manifest.steps[0].files_count, 4);
+  assert_true(az_span_is_content_equal(
+      update_manifest.steps[0].files[0], AZ_SPAN_FROM_STR("f2f4a804ca17afbae")));
+  assert_true(az_span_is_content_equal(
+      update_manifest.steps[0].files[1], AZ_SPAN_FROM_STR("f06bfc80808396ed5")));
+  assert_true(az_span_is_content_equal(
+      update_manifest.steps[0].files[2], AZ_SPAN_FROM_STR("f9fec76f10aede60e")));
+  assert_true(az_span_is_content_equal(
+      update_manifest.steps[0].files[3], AZ_SPAN_FROM_STR("f9fec76f10aedeabc")));
+
+  // More files than az_iot_adu_client_update_manifest holds.
+  parse_update_manifest_compact(
+      adu_request_manifest_too_many_total_files,
+      sizeof(adu_request_manifest_too_many_total_files),
+      az_span_create((uint8_t*)arena, sizeof(arena)),
+      &update_manifest,
+      &arena_size);
+
+  assert_int_equal(
+      arena_size,
+      sizeof(az_iot_adu_client_compact_update_manifest_step) + 2 * sizeof(az_span)
+          + 3 * sizeof(az_iot_adu_client_compact_update_manifest_file)
+          + 3 * sizeof(az_iot_adu_client_update_manifest_file_hash));
+  assert_int_equal(update_manifest.steps[0].files_count, 2);
+  assert_int_equal(update_manifest.files_count, 3);
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[0].id, az_span_create(files_id, sizeof(files_id) - 1)));
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[1].id, AZ_SPAN_FROM_STR("f06bfc80808396ed5")));
+  assert_true(az_span_is_content_equal(
+      update_manifest.files[2].id, AZ_SPAN_FROM_STR("f9fec76f10aede60e")));
+
+  // Each file has its own hash, starting with 'x', '2' and '3' respectively.
+  for (uint32_t i = 0; i < update_manifest.files_count; i++)
+  {
+    assert_int_equal(update_manifest.files[i].size_in_bytes, files_size_in_bytes);
+    assert_int_equal(update_manifest.files[i].hashes_count, 1);
+    assert_int_equal(az_span_ptr(update_manifest.files[i].hashes[0].hash_value)[0], "x23"[i]);
+  }
+}
+
+static void test_az_iot_adu_client_parse_update_manifest_compact_arena_too_small_fail(
+    void** state)
+{
+  (void)state;
+  az_iot_adu_client adu_client;
+  az_json_reader reader;
+  uint64_t arena[64];
+  az_iot_adu_client_compact_update_manifest update_manifest;
+  int32_t arena_size;
+
+  assert_int_equal(az_iot_adu_client_init(&adu_client, NULL), AZ_OK);
+
+  parse_update_manifest_compact(
+      adu_request_manifest_too_many_total_files,
+      sizeof(adu_request_manifest_too_many_total_files),
+      az_span_create((uint8_t*)arena, sizeof(arena)),
+      &update_manifest,
+      &arena_size);
+
+  // The arena needed is enough, one byte less is not.
+  parse_update_manifest_compact(
+      adu_request_manifest_too_many_total_files,
+      sizeof(adu_request_manifest_too_many_total_files),
+      az_span_create((uint8_t*)arena, arena_size),
+      &update_manifest,
+      &arena_size);
+
+  assert_int_equal(
+      az_json_reader_init(
+          &reader,
+          az_span_create(
+              adu_request_manifest_too_many_total_files,
+              sizeof(adu_request_manifest_too_many_total_files) - 1),
+          NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_parse_update_manifest_compact(
+          &adu_client,
+          &reader,
+          az_span_create((uint8_t*)arena, arena_size - 1),
+          &update_manifest,
+          &arena_size),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
 #ifdef _MSC_VER
 // warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
 #pragma warning(disable : 4113)
@@ -1433,12 +1974,18 @@ int test_az_iot_adu()
     cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_NULL_client_fail),
     cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_NULL_reader_fail),
     cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_NULL_update_manifest_fail),
+    cmocka_unit_test(
+        test_az_iot_adu_client_parse_update_manifest_compact_NULL_update_manifest_fail),
+    cmocka_unit_test(test_az_iot_adu_client_parse_service_properties_compact_NULL_request_fail),
 #endif // AZ_NO_PRECONDITION_CHECKING
     cmocka_unit_test(test_az_iot_adu_client_init_succeed),
     cmocka_unit_test(test_az_iot_adu_is_component_device_update_succeed),
     cmocka_unit_test(test_az_iot_adu_client_get_agent_state_payload_succeed),
     cmocka_unit_test(test_az_iot_adu_client_get_agent_state_long_payload_succeed),
     cmocka_unit_test(test_az_iot_adu_client_get_agent_state_long_payload_with_retry_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_agent_state_template_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_agent_state_template_custom_properties_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_agent_state_template_not_enough_space_fail),
     cmocka_unit_test(test_az_iot_adu_client_get_service_properties_response_succeed),
     cmocka_unit_test(test_az_iot_adu_client_parse_service_properties_succeed),
     cmocka_unit_test(test_az_iot_adu_client_parse_service_properties_with_retry_succeed),
@@ -1447,6 +1994,7 @@ int test_az_iot_adu()
     cmocka_unit_test(
         test_az_iot_adu_client_parse_service_properties_multiple_file_url_values_succeed),
     cmocka_unit_test(test_az_iot_adu_client_parse_service_properties_too_many_file_url_values_fail),
+    cmocka_unit_test(test_az_iot_adu_client_parse_service_properties_compact_succeed),
     cmocka_unit_test(test_az_iot_adu_client_parse_service_properties_payload_reverse_order_succeed),
     cmocka_unit_test(
         test_az_iot_adu_client_parse_service_properties_payload_unknown_action_null_manifest),
@@ -1458,8 +2006,13 @@ int test_az_iot_adu()
     cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_unused_fields_succeed),
     cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_unknown_nested_fields_succeed),
     cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_payload_reverse_order_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_escaped_succeed),
     cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_payload_too_many_file_ids_fail),
-    cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_payload_too_many_total_files_fail)
+    cmocka_unit_test(
+        test_az_iot_adu_client_parse_update_manifest_payload_too_many_total_files_fail),
+    cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_compact_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_compact_many_files_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_parse_update_manifest_compact_arena_too_small_fail)
   };
   return cmocka_run_group_tests_name("az_iot_adu", tests, setup, NULL);
 }
@@ -2,3 +2,4 @@
 // SPDX-License-Identifier: MIT
 
 int test_az_iot_adu();
+int test_az_iot_adu_client_download();
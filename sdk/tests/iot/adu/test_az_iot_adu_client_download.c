@@ -0,0 +1,980 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_adu.h"
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/iot/az_iot_adu_client.h>
+#include <azure/iot/az_iot_adu_client_download.h>
+#include <azure/iot/az_iot_common.h>
+#include <azure/iot/internal/az_iot_sha256_internal.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#define TEST_FILE_SIZE 10000
+#define TEST_SMALL_FILE_SIZE 100
+#define TEST_CHUNK_SIZE 1024
+#define TEST_RESPONSE_BUFFER_SIZE (TEST_CHUNK_SIZE + 128)
+#define TEST_URL_BUFFER_SIZE 64
+
+// The SHA-256 hashes of the first TEST_FILE_SIZE and TEST_SMALL_FILE_SIZE bytes of the test file.
+#define TEST_FILE_SHA256 "xr7BqYzxyPNQwcqc1+1ZiuTnTjLvleg5bP1kEpw03CQ="
+#define TEST_SMALL_FILE_SHA256 "Vv7ksSsoDqHnwbVQACuxizQsy9cinNSxR+oHqhppEpQ="
+
+static const az_span test_escaped_url = AZ_SPAN_LITERAL_FROM_STR("http:\\/\\/test.local\\/f1.bin");
+static const az_span test_url = AZ_SPAN_LITERAL_FROM_STR("http://test.local/f1.bin");
+
+static void test_sha256_digest(az_span data, int32_t update_size, char const* expected_hex)
+{
+  _az_iot_sha256 sha256;
+  _az_iot_sha256_init(&sha256);
+  for (int32_t i = 0; i < az_span_size(data); i += update_size)
+  {
+    int32_t const end = i + update_size < az_span_size(data) ? i + update_size : az_span_size(data);
+    _az_iot_sha256_update(&sha256, az_span_slice(data, i, end));
+  }
+
+  uint8_t digest[_az_IOT_SHA256_DIGEST_SIZE];
+  _az_iot_sha256_final(&sha256, AZ_SPAN_FROM_BUFFER(digest));
+
+  char digest_hex[_az_IOT_SHA256_DIGEST_SIZE * 2 + 1];
+  for (int32_t i = 0; i < _az_IOT_SHA256_DIGEST_SIZE; i++)
+  {
+    digest_hex[i * 2] = "0123456789abcdef"[digest[i] >> 4];
+    digest_hex[i * 2 + 1] = "0123456789abcdef"[digest[i] & 0x0F];
+  }
+  digest_hex[_az_IOT_SHA256_DIGEST_SIZE * 2] = '\0';
+  assert_string_equal(digest_hex, expected_hex);
+}
+
+static void test_az_iot_sha256_succeed(void** state)
+{
+  (void)state;
+
+  az_span const two_blocks
+      = AZ_SPAN_FROM_STR("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+
+  test_sha256_digest(
+      AZ_SPAN_EMPTY, 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  test_sha256_digest(
+      AZ_SPAN_FROM_STR("abc"),
+      3,
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+  // The digest does not depend on how the data is split.
+  for (int32_t update_size = 1; update_size <= az_span_size(two_blocks); update_size++)
+  {
+    test_sha256_digest(
+        two_blocks,
+        update_size,
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  }
+}
+
+static void test_get_update(
+    az_iot_adu_client_update_request* out_request,
+    az_iot_adu_client_update_manifest_file* out_file,
+    int64_t size_in_bytes,
+    az_span sha256)
+{
+  memset(out_request, 0, sizeof(*out_request));
+  out_request->file_urls[0].id = AZ_SPAN_FROM_STR("f0");
+  out_request->file_urls[0].url = AZ_SPAN_FROM_STR("http:\\/\\/test.local\\/f0.bin");
+  out_request->file_urls[1].id = AZ_SPAN_FROM_STR("f1");
+  out_request->file_urls[1].url = test_escaped_url;
+  out_request->file_urls_count = 2;
+
+  memset(out_file, 0, sizeof(*out_file));
+  out_file->id = AZ_SPAN_FROM_STR("f1");
+  out_file->file_name = AZ_SPAN_FROM_STR("f1.bin");
+  out_file->size_in_bytes = size_in_bytes;
+  out_file->hashes[0].hash_type = AZ_SPAN_FROM_STR("md5");
+  out_file->hashes[0].hash_value = AZ_SPAN_FROM_STR("1B2M2Y8AsgTpgAmY7PhCfg==");
+  out_file->hashes[1].hash_type = AZ_SPAN_FROM_STR("sha256");
+  out_file->hashes[1].hash_value = sha256;
+  out_file->hashes_count = 2;
+}
+
+AZ_NODISCARD static az_result test_sink_unused(az_span chunk, int64_t offset, void* user_context)
+{
+  (void)chunk;
+  (void)offset;
+  (void)user_context;
+  return AZ_OK;
+}
+
+static void test_az_iot_adu_client_download_file_not_found_fail(void** state)
+{
+  (void)state;
+
+  uint8_t url_buffer[TEST_URL_BUFFER_SIZE];
+  uint8_t response_buffer[TEST_RESPONSE_BUFFER_SIZE];
+  az_iot_adu_client_update_request request;
+  az_iot_adu_client_update_manifest_file file;
+
+  // No url for the file.
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+  file.id = AZ_SPAN_FROM_STR("f2");
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink_unused,
+          NULL,
+          NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // No sha256 hash for the file.
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+  file.hashes_count = 1;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink_unused,
+          NULL,
+          NULL),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // The sha256 hash is not a SHA-256 digest.
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR("1B2M2Y8AsgTpgAmY7PhCfg=="));
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink_unused,
+          NULL,
+          NULL),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  // The url does not fit.
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          az_span_create(url_buffer, 8),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink_unused,
+          NULL,
+          NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_adu_client_download_scheduler_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_adu_client_update_request request;
+  az_iot_adu_client_update_manifest_file file;
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+
+  // 10 ranges, the last one of 784 bytes.
+  uint8_t progress[2] = { 0xFF, 0xFF };
+  az_iot_adu_client_download_scheduler scheduler;
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_init(
+          &scheduler, &file, TEST_CHUNK_SIZE, AZ_SPAN_FROM_BUFFER(progress), false),
+      AZ_OK);
+  assert_int_equal(progress[0], 0);
+  assert_int_equal(progress[1], 0);
+
+  az_iot_adu_client_download_range ranges[_az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT];
+  for (int32_t i = 0; i < _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT; i++)
+  {
+    assert_int_equal(
+        az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[i]), AZ_OK);
+    assert_int_equal(ranges[i].index, i);
+    assert_true(ranges[i].offset == (int64_t)i * TEST_CHUNK_SIZE);
+    assert_int_equal(ranges[i].size, TEST_CHUNK_SIZE);
+  }
+
+  az_iot_adu_client_download_range range;
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_next_range(&scheduler, &range),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // A released range is handed out again, before the ones never handed out.
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_complete_range(&scheduler, &ranges[0]), AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_release_range(&scheduler, &ranges[1]), AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_complete_range(&scheduler, &ranges[1]),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(progress[0], 0x01);
+
+  assert_int_equal(az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[0]), AZ_OK);
+  assert_int_equal(ranges[0].index, 1);
+  assert_int_equal(az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[1]), AZ_OK);
+  assert_int_equal(ranges[1].index, 4);
+
+  for (int32_t i = 0; i < _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT; i++)
+  {
+    assert_int_equal(
+        az_iot_adu_client_download_scheduler_complete_range(&scheduler, &ranges[i]), AZ_OK);
+  }
+  assert_int_equal(progress[0], 0x1F);
+
+  // Resuming counts the ranges received, and ignores the bits past the last range.
+  progress[1] = 0xFC;
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_init(
+          &scheduler, &file, TEST_CHUNK_SIZE, AZ_SPAN_FROM_BUFFER(progress), true),
+      AZ_OK);
+  assert_int_equal(progress[1], 0);
+  assert_false(az_iot_adu_client_download_scheduler_is_complete(&scheduler));
+
+  for (int32_t i = 0; i < _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT; i++)
+  {
+    assert_int_equal(
+        az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[i]), AZ_OK);
+    assert_int_equal(ranges[i].index, 5 + i);
+  }
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_complete_range(&scheduler, &ranges[0]), AZ_OK);
+  assert_int_equal(az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[0]), AZ_OK);
+  assert_int_equal(ranges[0].index, 9);
+  assert_true(ranges[0].offset == 9 * TEST_CHUNK_SIZE);
+  assert_int_equal(ranges[0].size, TEST_FILE_SIZE - 9 * TEST_CHUNK_SIZE);
+
+  // Every remaining range is in flight.
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_complete_range(&scheduler, &ranges[1]), AZ_OK);
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_next_range(&scheduler, &range), AZ_ERROR_ITEM_NOT_FOUND);
+
+  for (int32_t i = 0; i < _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT; i++)
+  {
+    if (i == 1)
+    {
+      continue;
+    }
+
+    assert_int_equal(
+        az_iot_adu_client_download_scheduler_complete_range(&scheduler, &ranges[i]), AZ_OK);
+  }
+  assert_true(az_iot_adu_client_download_scheduler_is_complete(&scheduler));
+  assert_int_equal(progress[0], 0xFF);
+  assert_int_equal(progress[1], 0x03);
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_next_range(&scheduler, &range), AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+#ifdef _az_MOCK_ENABLED
+
+// A stand-in for the HTTP server hosting the update files. It serves the ranges of a generated
+// file of TEST_FILE_SIZE bytes.
+static struct
+{
+  bool ignore_range;
+  int32_t fail_count;
+  int32_t corrupt_offset;
+  int32_t range_shift;
+  int32_t body_shortfall;
+  int32_t content_length_shift;
+  int32_t request_count;
+} test_server;
+
+static uint8_t test_file_byte(int32_t offset) { return (uint8_t)(offset * 7 + offset / 256); }
+
+AZ_NODISCARD static az_result test_append_number(az_http_response* ref_response, int32_t number)
+{
+  uint8_t buffer[12];
+  az_span remainder;
+  _az_RETURN_IF_FAILED(az_span_i32toa(AZ_SPAN_FROM_BUFFER(buffer), number, &remainder));
+  return az_http_response_append(
+      ref_response, az_span_create(buffer, (int32_t)sizeof(buffer) - az_span_size(remainder)));
+}
+
+az_result __wrap_az_http_client_send_request(
+    az_http_request const* request,
+    az_http_response* ref_response);
+az_result __wrap_az_http_client_send_request(
+    az_http_request const* request,
+    az_http_response* ref_response)
+{
+  test_server.request_count++;
+
+  az_span url;
+  assert_int_equal(az_http_request_get_url(request, &url), AZ_OK);
+  assert_true(az_span_is_content_equal(url, test_url));
+
+  assert_int_equal(az_http_request_headers_count(request), 1);
+  az_span name;
+  az_span value;
+  assert_int_equal(az_http_request_get_header(request, 0, &name, &value), AZ_OK);
+  assert_true(az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Range")));
+  assert_true(az_span_is_content_equal(az_span_slice(value, 0, 6), AZ_SPAN_FROM_STR("bytes=")));
+
+  if (test_server.fail_count > 0)
+  {
+    test_server.fail_count--;
+    return az_http_response_append(
+        ref_response,
+        AZ_SPAN_FROM_STR("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n"));
+  }
+
+  int32_t const dash = az_span_find(value, AZ_SPAN_FROM_STR("-"));
+  int32_t first = 0;
+  int32_t last = 0;
+  assert_int_equal(az_span_atoi32(az_span_slice(value, 6, dash), &first), AZ_OK);
+  assert_int_equal(az_span_atoi32(az_span_slice_to_end(value, dash + 1), &last), AZ_OK);
+  assert_true(first <= last && last < TEST_FILE_SIZE);
+
+  // A misbehaving server sends another range than the one requested.
+  first += test_server.range_shift;
+  last += test_server.range_shift;
+
+  if (test_server.ignore_range)
+  {
+    first = 0;
+    last = TEST_SMALL_FILE_SIZE - 1;
+    _az_RETURN_IF_FAILED(
+        az_http_response_append(ref_response, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n")));
+  }
+  else
+  {
+    _az_RETURN_IF_FAILED(az_http_response_append(
+        ref_response, AZ_SPAN_FROM_STR("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes ")));
+    _az_RETURN_IF_FAILED(test_append_number(ref_response, first));
+    _az_RETURN_IF_FAILED(az_http_response_append(ref_response, AZ_SPAN_FROM_STR("-")));
+    _az_RETURN_IF_FAILED(test_append_number(ref_response, last));
+    _az_RETURN_IF_FAILED(az_http_response_append(ref_response, AZ_SPAN_FROM_STR("/10000\r\n")));
+  }
+
+  _az_RETURN_IF_FAILED(az_http_response_append(ref_response, AZ_SPAN_FROM_STR("Content-Length: ")));
+  _az_RETURN_IF_FAILED(
+      test_append_number(ref_response, last - first + 1 + test_server.content_length_shift));
+  _az_RETURN_IF_FAILED(az_http_response_append(ref_response, AZ_SPAN_FROM_STR("\r\n\r\n")));
+
+  uint8_t body[TEST_RESPONSE_BUFFER_SIZE];
+  assert_true(last - first < TEST_RESPONSE_BUFFER_SIZE);
+  for (int32_t offset = first; offset <= last; offset++)
+  {
+    body[offset - first] = offset == test_server.corrupt_offset ? (uint8_t)~test_file_byte(offset)
+                                                                : test_file_byte(offset);
+  }
+  // A connection closed early leaves the body short of its Content-Length.
+  return az_http_response_append(
+      ref_response, az_span_create(body, last - first + 1 - test_server.body_shortfall));
+}
+
+typedef struct
+{
+  uint8_t file[TEST_FILE_SIZE];
+  int64_t next_offset;
+  int32_t chunk_count;
+} test_sink_context;
+
+AZ_NODISCARD static az_result test_sink(az_span chunk, int64_t offset, void* user_context)
+{
+  test_sink_context* context = (test_sink_context*)user_context;
+
+  // The chunks arrive in order and without gaps.
+  assert_true(offset == context->next_offset);
+  assert_true(az_span_size(chunk) <= TEST_CHUNK_SIZE);
+  memcpy(context->file + offset, az_span_ptr(chunk), (size_t)az_span_size(chunk));
+
+  context->next_offset += az_span_size(chunk);
+  context->chunk_count++;
+  return AZ_OK;
+}
+
+static az_iot_adu_client_download_options test_get_options(void)
+{
+  az_iot_adu_client_download_options options = az_iot_adu_client_download_options_default();
+  options.chunk_size = TEST_CHUNK_SIZE;
+  options.retry_options.retry_delay_msec = 1;
+  options.retry_options.max_retry_delay_msec = 1;
+  return options;
+}
+
+static void test_reset_server(void)
+{
+  test_server.ignore_range = false;
+  test_server.fail_count = 0;
+  test_server.corrupt_offset = -1;
+  test_server.range_shift = 0;
+  test_server.body_shortfall = 0;
+  test_server.content_length_shift = 0;
+  test_server.request_count = 0;
+}
+
+static void test_az_iot_adu_client_download_file_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t url_buffer[TEST_URL_BUFFER_SIZE];
+  uint8_t response_buffer[TEST_RESPONSE_BUFFER_SIZE];
+  az_iot_adu_client_update_request request;
+  az_iot_adu_client_update_manifest_file file;
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+  az_iot_adu_client_download_options const options = test_get_options();
+
+  static test_sink_context sink_context;
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_OK);
+
+  int32_t const chunk_count = (TEST_FILE_SIZE + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE;
+  assert_int_equal(test_server.request_count, chunk_count);
+  assert_int_equal(sink_context.chunk_count, chunk_count);
+  assert_true(sink_context.next_offset == TEST_FILE_SIZE);
+  for (int32_t offset = 0; offset < TEST_FILE_SIZE; offset++)
+  {
+    assert_int_equal(sink_context.file[offset], test_file_byte(offset));
+  }
+
+  // A failed range request is retried.
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  test_server.fail_count = 2;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_OK);
+  assert_int_equal(test_server.request_count, chunk_count + 2);
+  assert_int_equal(sink_context.chunk_count, chunk_count);
+
+  // A server ignoring the range may send a file that fits in one chunk.
+  test_get_update(&request, &file, TEST_SMALL_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_SMALL_FILE_SHA256));
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  test_server.ignore_range = true;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_OK);
+  assert_int_equal(sink_context.chunk_count, 1);
+  assert_true(sink_context.next_offset == TEST_SMALL_FILE_SIZE);
+}
+
+static void test_instrumentation_callback(
+    az_http_instrumentation_attempt const* attempt,
+    void* user_context)
+{
+  assert_non_null(attempt);
+  assert_true(attempt->request_size > 0);
+  (*(int32_t*)user_context)++;
+}
+
+static void test_az_iot_adu_client_download_file_instrumentation_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t url_buffer[TEST_URL_BUFFER_SIZE];
+  uint8_t response_buffer[TEST_RESPONSE_BUFFER_SIZE];
+  az_iot_adu_client_update_request request;
+  az_iot_adu_client_update_manifest_file file;
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+
+  az_http_metrics metrics;
+  az_http_metrics_init(&metrics);
+  int32_t callback_count = 0;
+  az_iot_adu_client_download_options options = test_get_options();
+  options.instrumentation_options.metrics = &metrics;
+  options.instrumentation_options.callback = test_instrumentation_callback;
+  options.instrumentation_options.callback_context = &callback_count;
+
+  static test_sink_context sink_context;
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  test_server.fail_count = 2;
+
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_OK);
+
+  // Every attempt is reported, including the retries of the failed one.
+  int32_t const chunk_count = (TEST_FILE_SIZE + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE;
+  az_http_metrics snapshot;
+  az_http_metrics_snapshot(&metrics, &snapshot);
+  assert_int_equal(snapshot.attempt_count, chunk_count + 2);
+  assert_int_equal(snapshot.retry_count, 2);
+  assert_int_equal(snapshot.status_code_class_count[1], chunk_count);
+  assert_int_equal(snapshot.status_code_class_count[4], 2);
+  assert_int_equal(callback_count, chunk_count + 2);
+}
+
+static void test_az_iot_adu_client_download_file_fail(void** state)
+{
+  (void)state;
+
+  uint8_t url_buffer[TEST_URL_BUFFER_SIZE];
+  uint8_t response_buffer[TEST_RESPONSE_BUFFER_SIZE];
+  az_iot_adu_client_update_request request;
+  az_iot_adu_client_update_manifest_file file;
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+  az_iot_adu_client_download_options options = test_get_options();
+
+  static test_sink_context sink_context;
+
+  // A corrupted byte is only detected once the whole file has been received.
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  test_server.corrupt_offset = TEST_FILE_SIZE / 2;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_ERROR_IOT_ADU_FILE_HASH_MISMATCH);
+  assert_true(sink_context.next_offset == TEST_FILE_SIZE);
+
+  // A server ignoring the range of a file larger than a chunk.
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  test_server.ignore_range = true;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED);
+  assert_int_equal(sink_context.chunk_count, 0);
+
+  // The whole file of a server ignoring the range is short of its Content-Length.
+  az_iot_adu_client_update_request small_request;
+  az_iot_adu_client_update_manifest_file small_file;
+  test_get_update(
+      &small_request, &small_file, TEST_SMALL_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_SMALL_FILE_SHA256));
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  test_server.ignore_range = true;
+  test_server.body_shortfall = 1;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &small_request,
+          &small_file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED);
+  assert_int_equal(sink_context.chunk_count, 0);
+
+  // The retries run out.
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  test_server.fail_count = options.retry_options.max_retries + 1;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED);
+
+  // The response buffer does not hold a chunk.
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  options.chunk_size = TEST_RESPONSE_BUFFER_SIZE;
+  assert_int_equal(
+      az_iot_adu_client_download_file(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+typedef struct
+{
+  uint8_t file[TEST_FILE_SIZE];
+  int32_t write_count;
+} test_file_context;
+
+AZ_NODISCARD static az_result test_positional_sink(
+    az_span chunk,
+    int64_t offset,
+    void* user_context)
+{
+  test_file_context* context = (test_file_context*)user_context;
+  assert_true(offset + az_span_size(chunk) <= TEST_FILE_SIZE);
+  memcpy(context->file + offset, az_span_ptr(chunk), (size_t)az_span_size(chunk));
+  context->write_count++;
+  return AZ_OK;
+}
+
+AZ_NODISCARD static az_result test_source(az_span destination, int64_t offset, void* user_context)
+{
+  test_file_context* context = (test_file_context*)user_context;
+  assert_true(offset + az_span_size(destination) <= TEST_FILE_SIZE);
+  memcpy(az_span_ptr(destination), context->file + offset, (size_t)az_span_size(destination));
+  return AZ_OK;
+}
+
+// Fetches the ranges in flight in reverse order, as concurrent requests could complete.
+static void test_fetch_in_flight(
+    az_iot_adu_client_download_scheduler* scheduler,
+    az_iot_adu_client_download_range const* ranges,
+    int32_t range_count,
+    az_span url,
+    test_file_context* file_context)
+{
+  uint8_t response_buffer[TEST_RESPONSE_BUFFER_SIZE];
+  az_iot_adu_client_download_options const options = test_get_options();
+
+  for (int32_t i = range_count - 1; i >= 0; i--)
+  {
+    assert_int_equal(
+        az_iot_adu_client_download_fetch_range(
+            url,
+            &ranges[i],
+            &az_context_application,
+            AZ_SPAN_FROM_BUFFER(response_buffer),
+            test_positional_sink,
+            file_context,
+            &options),
+        AZ_OK);
+    assert_int_equal(
+        az_iot_adu_client_download_scheduler_complete_range(scheduler, &ranges[i]), AZ_OK);
+  }
+}
+
+// Downloads a file by ranges, loses power after some of them, and resumes from the persisted
+// progress bitmap without fetching the ranges already received again.
+static void test_az_iot_adu_client_download_scheduler_resume_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t url_buffer[TEST_URL_BUFFER_SIZE];
+  az_iot_adu_client_update_request request;
+  az_iot_adu_client_update_manifest_file file;
+  test_get_update(&request, &file, TEST_FILE_SIZE, AZ_SPAN_FROM_STR(TEST_FILE_SHA256));
+
+  az_span url;
+  assert_int_equal(
+      az_iot_adu_client_download_get_url(&request, &file, AZ_SPAN_FROM_BUFFER(url_buffer), &url),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(url, test_url));
+
+  static test_file_context file_context;
+  memset(&file_context, 0, sizeof(file_context));
+  test_reset_server();
+
+  int32_t const range_count = (TEST_FILE_SIZE + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE;
+  uint8_t progress[2];
+  uint8_t persisted_progress[2];
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_get_progress_size(TEST_FILE_SIZE, TEST_CHUNK_SIZE),
+      (int32_t)sizeof(progress));
+
+  az_iot_adu_client_download_scheduler scheduler;
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_init(
+          &scheduler, &file, TEST_CHUNK_SIZE, AZ_SPAN_FROM_BUFFER(progress), false),
+      AZ_OK);
+
+  az_iot_adu_client_download_range ranges[_az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT];
+  for (int32_t i = 0; i < _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT; i++)
+  {
+    assert_int_equal(
+        az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[i]), AZ_OK);
+  }
+  test_fetch_in_flight(
+      &scheduler, ranges, _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT, url, &file_context);
+  memcpy(persisted_progress, progress, sizeof(progress));
+
+  // Power is lost while two more ranges are in flight: only the persisted progress remains.
+  assert_int_equal(az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[0]), AZ_OK);
+  assert_int_equal(az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[1]), AZ_OK);
+  memcpy(progress, persisted_progress, sizeof(progress));
+  int32_t const received_count = test_server.request_count;
+
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_init(
+          &scheduler, &file, TEST_CHUNK_SIZE, AZ_SPAN_FROM_BUFFER(progress), true),
+      AZ_OK);
+  assert_false(az_iot_adu_client_download_scheduler_is_complete(&scheduler));
+
+  while (!az_iot_adu_client_download_scheduler_is_complete(&scheduler))
+  {
+    int32_t in_flight_count = 0;
+    while (in_flight_count < _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT
+           && az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[in_flight_count])
+               == AZ_OK)
+    {
+      // The ranges received before the power loss are not fetched again.
+      assert_true(
+          ranges[in_flight_count].index >= _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT);
+      in_flight_count++;
+    }
+    test_fetch_in_flight(&scheduler, ranges, in_flight_count, url, &file_context);
+  }
+
+  assert_int_equal(test_server.request_count, range_count);
+  assert_int_equal(
+      test_server.request_count - received_count,
+      range_count - _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT);
+  assert_int_equal(file_context.write_count, range_count);
+
+  uint8_t buffer[700];
+  assert_int_equal(
+      az_iot_adu_client_download_verify_file(
+          &file, AZ_SPAN_FROM_BUFFER(buffer), test_source, &file_context),
+      AZ_OK);
+
+  file_context.file[TEST_FILE_SIZE - 1]++;
+  assert_int_equal(
+      az_iot_adu_client_download_verify_file(
+          &file, AZ_SPAN_FROM_BUFFER(buffer), test_source, &file_context),
+      AZ_ERROR_IOT_ADU_FILE_HASH_MISMATCH);
+}
+
+static void test_az_iot_adu_client_download_fetch_range_fail(void** state)
+{
+  (void)state;
+
+  uint8_t response_buffer[TEST_RESPONSE_BUFFER_SIZE];
+  az_iot_adu_client_download_options const options = test_get_options();
+  az_iot_adu_client_download_range const range = { .offset = 0, .size = 100, .index = 0 };
+
+  static test_file_context file_context;
+  memset(&file_context, 0, sizeof(file_context));
+
+  // Parallel ranges need a server supporting them.
+  test_reset_server();
+  test_server.ignore_range = true;
+  assert_int_equal(
+      az_iot_adu_client_download_fetch_range(
+          test_url,
+          &range,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_positional_sink,
+          &file_context,
+          &options),
+      AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED);
+
+  // The server sends another range.
+  test_reset_server();
+  test_server.range_shift = 1;
+  assert_int_equal(
+      az_iot_adu_client_download_fetch_range(
+          test_url,
+          &range,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_positional_sink,
+          &file_context,
+          &options),
+      AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED);
+  assert_int_equal(file_context.write_count, 0);
+
+  // The body of the range is short of the bytes requested.
+  test_reset_server();
+  test_server.body_shortfall = 1;
+  assert_int_equal(
+      az_iot_adu_client_download_fetch_range(
+          test_url,
+          &range,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_positional_sink,
+          &file_context,
+          &options),
+      AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED);
+  assert_int_equal(file_context.write_count, 0);
+
+  // The Content-Length of the range is not the size requested.
+  test_reset_server();
+  test_server.content_length_shift = 1;
+  assert_int_equal(
+      az_iot_adu_client_download_fetch_range(
+          test_url,
+          &range,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_positional_sink,
+          &file_context,
+          &options),
+      AZ_ERROR_IOT_ADU_DOWNLOAD_FAILED);
+  assert_int_equal(file_context.write_count, 0);
+}
+
+// Downloads a file of an update with more file urls than #az_iot_adu_client_update_request holds,
+// parsed in the compact model.
+static void test_az_iot_adu_client_download_compact_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_adu_client_file_url file_urls[] = {
+    { .id = AZ_SPAN_LITERAL_FROM_STR("f0"),
+      .url = AZ_SPAN_LITERAL_FROM_STR("http:\\/\\/test.local\\/f0.bin") },
+    { .id = AZ_SPAN_LITERAL_FROM_STR("f2"),
+      .url = AZ_SPAN_LITERAL_FROM_STR("http:\\/\\/test.local\\/f2.bin") },
+    { .id = AZ_SPAN_LITERAL_FROM_STR("f1"), .url = test_escaped_url },
+  };
+  az_iot_adu_client_compact_update_request request;
+  memset(&request, 0, sizeof(request));
+  request.file_urls = file_urls;
+  request.file_urls_count = 3;
+
+  az_iot_adu_client_update_manifest_file_hash hashes[] = {
+    { .hash_type = AZ_SPAN_LITERAL_FROM_STR("sha256"),
+      .hash_value = AZ_SPAN_LITERAL_FROM_STR(TEST_FILE_SHA256) },
+  };
+  az_iot_adu_client_compact_update_manifest_file const file = {
+    .id = AZ_SPAN_LITERAL_FROM_STR("f1"),
+    .file_name = AZ_SPAN_LITERAL_FROM_STR("f1.bin"),
+    .size_in_bytes = TEST_FILE_SIZE,
+    .hashes = hashes,
+    .hashes_count = 1,
+  };
+
+  uint8_t url_buffer[TEST_URL_BUFFER_SIZE];
+  az_span url;
+  assert_int_equal(
+      az_iot_adu_client_download_get_url_compact(
+          &request, &file, AZ_SPAN_FROM_BUFFER(url_buffer), &url),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(url, test_url));
+
+  uint8_t response_buffer[TEST_RESPONSE_BUFFER_SIZE];
+  az_iot_adu_client_download_options const options = test_get_options();
+  static test_sink_context sink_context;
+  memset(&sink_context, 0, sizeof(sink_context));
+  test_reset_server();
+  assert_int_equal(
+      az_iot_adu_client_download_file_compact(
+          &request,
+          &file,
+          &az_context_application,
+          AZ_SPAN_FROM_BUFFER(url_buffer),
+          AZ_SPAN_FROM_BUFFER(response_buffer),
+          test_sink,
+          &sink_context,
+          &options),
+      AZ_OK);
+  assert_true(sink_context.next_offset == TEST_FILE_SIZE);
+
+  // The same file, downloaded by ranges.
+  static test_file_context file_context;
+  memset(&file_context, 0, sizeof(file_context));
+  uint8_t progress[2];
+  az_iot_adu_client_download_scheduler scheduler;
+  assert_int_equal(
+      az_iot_adu_client_download_scheduler_init_compact(
+          &scheduler, &file, TEST_CHUNK_SIZE, AZ_SPAN_FROM_BUFFER(progress), false),
+      AZ_OK);
+
+  az_iot_adu_client_download_range ranges[_az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT];
+  while (!az_iot_adu_client_download_scheduler_is_complete(&scheduler))
+  {
+    int32_t in_flight_count = 0;
+    while (in_flight_count < _az_IOT_ADU_CLIENT_DOWNLOAD_MAX_RANGES_IN_FLIGHT
+           && az_iot_adu_client_download_scheduler_next_range(&scheduler, &ranges[in_flight_count])
+               == AZ_OK)
+    {
+      in_flight_count++;
+    }
+    test_fetch_in_flight(&scheduler, ranges, in_flight_count, url, &file_context);
+  }
+
+  uint8_t buffer[700];
+  assert_int_equal(
+      az_iot_adu_client_download_verify_file_compact(
+          &file, AZ_SPAN_FROM_BUFFER(buffer), test_source, &file_context),
+      AZ_OK);
+
+  file_context.file[0]++;
+  assert_int_equal(
+      az_iot_adu_client_download_verify_file_compact(
+          &file, AZ_SPAN_FROM_BUFFER(buffer), test_source, &file_context),
+      AZ_ERROR_IOT_ADU_FILE_HASH_MISMATCH);
+}
+
+#endif // _az_MOCK_ENABLED
+
+int test_az_iot_adu_client_download()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_sha256_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_download_file_not_found_fail),
+    cmocka_unit_test(test_az_iot_adu_client_download_scheduler_succeed),
+#ifdef _az_MOCK_ENABLED
+    cmocka_unit_test(test_az_iot_adu_client_download_file_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_download_file_instrumentation_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_download_file_fail),
+    cmocka_unit_test(test_az_iot_adu_client_download_scheduler_resume_succeed),
+    cmocka_unit_test(test_az_iot_adu_client_download_fetch_range_fail),
+    cmocka_unit_test(test_az_iot_adu_client_download_compact_succeed),
+#endif // _az_MOCK_ENABLED
+  };
+  return cmocka_run_group_tests_name("az_iot_adu_client_download", tests, NULL, NULL);
+}
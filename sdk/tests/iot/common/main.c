@@ -16,6 +16,9 @@ int main()
   int result = 0;
 
   result += test_az_iot_common();
+  result += test_az_iot_request_table();
+  result += test_az_iot_retry_backoff();
+  result += test_az_mqtt();
 
   return result;
 }
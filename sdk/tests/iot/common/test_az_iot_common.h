@@ -2,3 +2,9 @@
 // SPDX-License-Identifier: MIT
 
 int test_az_iot_common();
+
+int test_az_iot_request_table();
+
+int test_az_iot_retry_backoff();
+
+int test_az_mqtt();
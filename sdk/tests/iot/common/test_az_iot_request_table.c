@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_common.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_request_table.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#define TEST_ENTRY_COUNT 4
+
+static void test_az_iot_request_table_remove_unknown_fail(void** state)
+{
+  (void)state;
+
+  az_iot_request_table_entry entries[TEST_ENTRY_COUNT];
+  az_iot_request_table table;
+  assert_int_equal(az_iot_request_table_init(&table, entries, TEST_ENTRY_COUNT, NULL), AZ_OK);
+  assert_int_equal(az_iot_request_table_get_count(&table), 0);
+
+  void* context = NULL;
+  assert_int_equal(
+      az_iot_request_table_remove(&table, AZ_SPAN_FROM_STR("1"), &context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_request_table_remove(&table, AZ_SPAN_FROM_STR("0"), &context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_request_table_remove(&table, AZ_SPAN_FROM_STR("abc"), &context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // The clock isn't read while no request is pending.
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+#ifdef _az_MOCK_ENABLED
+
+static void test_az_iot_request_table_add_remove_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_request_table_entry entries[TEST_ENTRY_COUNT];
+  az_iot_request_table table;
+  assert_int_equal(az_iot_request_table_init(&table, entries, TEST_ENTRY_COUNT, NULL), AZ_OK);
+
+  int contexts[TEST_ENTRY_COUNT] = { 0 };
+  uint8_t buffers[TEST_ENTRY_COUNT][AZ_IOT_REQUEST_TABLE_REQUEST_ID_BUFFER_SIZE];
+  az_span request_ids[TEST_ENTRY_COUNT];
+
+  will_return_always(__wrap_az_platform_clock_msec, 0);
+  for (int32_t i = 0; i < TEST_ENTRY_COUNT; i++)
+  {
+    assert_int_equal(
+        az_iot_request_table_add(
+            &table, &contexts[i], 5000, AZ_SPAN_FROM_BUFFER(buffers[i]), &request_ids[i]),
+        AZ_OK);
+  }
+  assert_true(az_span_is_content_equal(request_ids[0], AZ_SPAN_FROM_STR("1")));
+  assert_true(az_span_is_content_equal(request_ids[3], AZ_SPAN_FROM_STR("4")));
+  assert_int_equal(az_iot_request_table_get_count(&table), TEST_ENTRY_COUNT);
+
+  // The table is full.
+  uint8_t buffer[AZ_IOT_REQUEST_TABLE_REQUEST_ID_BUFFER_SIZE];
+  az_span request_id = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_request_table_add(&table, NULL, 5000, AZ_SPAN_FROM_BUFFER(buffer), &request_id),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // Responses can arrive in any order, and only once.
+  void* context = NULL;
+  assert_int_equal(az_iot_request_table_remove(&table, request_ids[2], &context), AZ_OK);
+  assert_ptr_equal(context, &contexts[2]);
+  assert_int_equal(
+      az_iot_request_table_remove(&table, request_ids[2], &context), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_iot_request_table_remove(&table, request_ids[0], &context), AZ_OK);
+  assert_ptr_equal(context, &contexts[0]);
+  assert_int_equal(az_iot_request_table_get_count(&table), 2);
+
+  // Request IDs keep increasing, skipping the ones whose entry is still in use.
+  assert_int_equal(
+      az_iot_request_table_add(&table, NULL, 5000, AZ_SPAN_FROM_BUFFER(buffer), &request_id),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(request_id, AZ_SPAN_FROM_STR("5")));
+  assert_int_equal(
+      az_iot_request_table_add(&table, NULL, 5000, AZ_SPAN_FROM_BUFFER(buffer), &request_id),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(request_id, AZ_SPAN_FROM_STR("7")));
+
+  // A stale request ID mapping to a reused entry isn't matched.
+  assert_int_equal(
+      az_iot_request_table_remove(&table, AZ_SPAN_FROM_STR("3"), &context),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_iot_request_table_remove(&table, AZ_SPAN_FROM_STR("7"), NULL), AZ_OK);
+  assert_int_equal(az_iot_request_table_remove(&table, request_ids[1], &context), AZ_OK);
+  assert_ptr_equal(context, &contexts[1]);
+
+  // Many requests cycle through the table while one stays pending.
+  for (int32_t i = 0; i < 1000; i++)
+  {
+    assert_int_equal(
+        az_iot_request_table_add(&table, NULL, 5000, AZ_SPAN_FROM_BUFFER(buffer), &request_id),
+        AZ_OK);
+    assert_false(az_span_is_content_equal(request_id, request_ids[3]));
+    assert_int_equal(az_iot_request_table_remove(&table, request_id, NULL), AZ_OK);
+  }
+  assert_int_equal(az_iot_request_table_get_count(&table), 2);
+}
+
+static void test_az_iot_request_table_get_expired_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_request_table_entry entries[TEST_ENTRY_COUNT];
+  az_iot_request_table_options options = az_iot_request_table_options_default();
+  options.tick_msec = 100;
+
+  az_iot_request_table table;
+  assert_int_equal(az_iot_request_table_init(&table, entries, TEST_ENTRY_COUNT, &options), AZ_OK);
+
+  int contexts[3] = { 0 };
+  uint8_t buffer[AZ_IOT_REQUEST_TABLE_REQUEST_ID_BUFFER_SIZE];
+  az_span request_id = AZ_SPAN_EMPTY;
+
+  // Deadlines at 1250, 1350 and, one turn of the wheel later, 1250 + 6400.
+  int32_t const timeouts[3] = { 1000, 1100, 7400 };
+  will_return_count(__wrap_az_platform_clock_msec, 250, 3);
+  for (int32_t i = 0; i < 3; i++)
+  {
+    assert_int_equal(
+        az_iot_request_table_add(
+            &table, &contexts[i], timeouts[i], AZ_SPAN_FROM_BUFFER(buffer), &request_id),
+        AZ_OK);
+  }
+
+  void* context = NULL;
+  will_return(__wrap_az_platform_clock_msec, 1249);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_ERROR_ITEM_NOT_FOUND);
+
+  // The request in the same slot but due one turn later doesn't expire.
+  will_return_count(__wrap_az_platform_clock_msec, 1300, 2);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_OK);
+  assert_ptr_equal(context, &contexts[0]);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_ERROR_ITEM_NOT_FOUND);
+
+  will_return_count(__wrap_az_platform_clock_msec, 1350, 2);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_OK);
+  assert_ptr_equal(context, &contexts[1]);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_ERROR_ITEM_NOT_FOUND);
+
+  // A jump of more than a turn of the wheel visits every slot once.
+  will_return_count(__wrap_az_platform_clock_msec, 100000, 2);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_OK);
+  assert_ptr_equal(context, &contexts[2]);
+  assert_int_equal(az_iot_request_table_get_count(&table), 0);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_ERROR_ITEM_NOT_FOUND);
+
+  // A request that got its response doesn't expire.
+  will_return_count(__wrap_az_platform_clock_msec, 200000, 2);
+  assert_int_equal(
+      az_iot_request_table_add(&table, NULL, 0, AZ_SPAN_FROM_BUFFER(buffer), &request_id), AZ_OK);
+  assert_int_equal(
+      az_iot_request_table_add(
+          &table, &contexts[0], 0, AZ_SPAN_FROM_BUFFER(buffer), &request_id),
+      AZ_OK);
+  assert_int_equal(az_iot_request_table_remove(&table, AZ_SPAN_FROM_STR("4"), NULL), AZ_OK);
+  will_return_count(__wrap_az_platform_clock_msec, 200000, 2);
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_OK);
+  assert_ptr_equal(context, &contexts[0]);
+  assert_true(az_span_is_content_equal(request_id, AZ_SPAN_FROM_STR("5")));
+  assert_int_equal(az_iot_request_table_get_expired(&table, &context), AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+#endif // _az_MOCK_ENABLED
+
+int test_az_iot_request_table()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_request_table_remove_unknown_fail),
+#ifdef _az_MOCK_ENABLED
+    cmocka_unit_test(test_az_iot_request_table_add_remove_succeed),
+    cmocka_unit_test(test_az_iot_request_table_get_expired_succeed),
+#endif // _az_MOCK_ENABLED
+  };
+  return cmocka_run_group_tests_name("az_iot_request_table", tests, NULL, NULL);
+}
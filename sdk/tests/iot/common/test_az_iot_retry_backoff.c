@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_common.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_retry_backoff.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmocka.h>
+
+#define TEST_DEVICE_COUNT 10000
+#define TEST_HISTOGRAM_BUCKET_COUNT 20
+#define TEST_DEVICE_ID_SIZE 16
+
+static az_iot_retry_backoff_options test_get_options(az_iot_retry_backoff_strategy strategy)
+{
+  az_iot_retry_backoff_options options = az_iot_retry_backoff_options_default();
+  options.strategy = strategy;
+  options.min_retry_delay_msec = 1000;
+  options.max_retry_delay_msec = 10000;
+  return options;
+}
+
+static void test_az_iot_retry_backoff_exponential_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_retry_backoff_options const options = test_get_options(AZ_IOT_RETRY_BACKOFF_EXPONENTIAL);
+  az_iot_retry_backoff backoff;
+  assert_int_equal(az_iot_retry_backoff_init(&backoff, AZ_SPAN_FROM_STR("dev"), &options), AZ_OK);
+
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 0), 1000);
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 0), 2000);
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 500, 0), 3500);
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 0), 8000);
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 0), 10000);
+  assert_int_equal(az_iot_retry_backoff_get_attempt(&backoff), 5);
+
+  for (int32_t i = 0; i < 100; i++)
+  {
+    assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 0), 10000);
+  }
+
+  // The operation took longer than the delay.
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 20000, 0), 0);
+
+  // The retry-after delay of the service wins over a shorter one.
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 30), 30000);
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 3), 10000);
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, UINT32_MAX), INT32_MAX);
+
+  az_iot_retry_backoff_reset(&backoff);
+  assert_int_equal(az_iot_retry_backoff_get_attempt(&backoff), 0);
+  assert_int_equal(az_iot_retry_backoff_get_delay(&backoff, 0, 0), 1000);
+}
+
+static void test_az_iot_retry_backoff_jitter_range_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_retry_backoff_options const decorrelated
+      = test_get_options(AZ_IOT_RETRY_BACKOFF_DECORRELATED_JITTER);
+  az_iot_retry_backoff_options const full = test_get_options(AZ_IOT_RETRY_BACKOFF_FULL_JITTER);
+
+  az_iot_retry_backoff decorrelated_backoff;
+  az_iot_retry_backoff full_backoff;
+  assert_int_equal(
+      az_iot_retry_backoff_init(&decorrelated_backoff, AZ_SPAN_FROM_STR("dev"), &decorrelated),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_retry_backoff_init(&full_backoff, AZ_SPAN_FROM_STR("dev"), &full), AZ_OK);
+
+  int32_t previous_delay = 1000;
+  int32_t full_max_delay = 1000;
+  for (int32_t i = 0; i < 1000; i++)
+  {
+    // Each decorrelated delay is between the minimum delay and three times the previous one.
+    int32_t const delay = az_iot_retry_backoff_get_delay(&decorrelated_backoff, 0, 0);
+    assert_in_range(delay, 1000, previous_delay * 3 > 10000 ? 10000 : previous_delay * 3);
+    previous_delay = delay;
+
+    int32_t const full_delay = az_iot_retry_backoff_get_delay(&full_backoff, 0, 0);
+    assert_true(full_delay >= 0 && full_delay <= full_max_delay);
+    full_max_delay = full_max_delay * 2 > 10000 ? 10000 : full_max_delay * 2;
+  }
+
+  // The same seed gives the same delays.
+  az_iot_retry_backoff other_backoff;
+  assert_int_equal(
+      az_iot_retry_backoff_init(&other_backoff, AZ_SPAN_FROM_STR("dev"), &decorrelated), AZ_OK);
+  assert_int_equal(
+      az_iot_retry_backoff_init(&decorrelated_backoff, AZ_SPAN_FROM_STR("dev"), &decorrelated),
+      AZ_OK);
+  for (int32_t i = 0; i < 10; i++)
+  {
+    assert_int_equal(
+        az_iot_retry_backoff_get_delay(&decorrelated_backoff, 0, 0),
+        az_iot_retry_backoff_get_delay(&other_backoff, 0, 0));
+  }
+}
+
+// Simulates a fleet disconnected at the same time, and checks that the first reconnection
+// attempts are spread evenly over the jitter interval rather than arriving together.
+static void test_az_iot_retry_backoff_fleet_spread_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_retry_backoff_options const options
+      = test_get_options(AZ_IOT_RETRY_BACKOFF_DECORRELATED_JITTER);
+
+  // The first decorrelated delay is between 1000 and 3000 milliseconds.
+  int32_t const bucket_msec = 2000 / TEST_HISTOGRAM_BUCKET_COUNT;
+  int32_t histogram[TEST_HISTOGRAM_BUCKET_COUNT] = { 0 };
+
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    char device_id[TEST_DEVICE_ID_SIZE];
+    int const length = snprintf(device_id, sizeof(device_id), "device-%d", (int)i);
+
+    az_iot_retry_backoff backoff;
+    assert_int_equal(
+        az_iot_retry_backoff_init(
+            &backoff, az_span_create((uint8_t*)device_id, length), &options),
+        AZ_OK);
+
+    int32_t const delay = az_iot_retry_backoff_get_delay(&backoff, 0, 0);
+    assert_in_range(delay, 1000, 3000);
+    histogram[delay == 3000 ? TEST_HISTOGRAM_BUCKET_COUNT - 1 : (delay - 1000) / bucket_msec]++;
+  }
+
+  // Each bucket receives its share of the arrivals, within 20%.
+  int32_t const expected = TEST_DEVICE_COUNT / TEST_HISTOGRAM_BUCKET_COUNT;
+  for (int32_t i = 0; i < TEST_HISTOGRAM_BUCKET_COUNT; i++)
+  {
+    assert_in_range(histogram[i], expected * 8 / 10, expected * 12 / 10);
+  }
+}
+
+int test_az_iot_retry_backoff()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_retry_backoff_exponential_succeed),
+    cmocka_unit_test(test_az_iot_retry_backoff_jitter_range_succeed),
+    cmocka_unit_test(test_az_iot_retry_backoff_fleet_spread_succeed),
+  };
+  return cmocka_run_group_tests_name("az_iot_retry_backoff", tests, NULL, NULL);
+}
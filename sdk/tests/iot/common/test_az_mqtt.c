@@ -0,0 +1,563 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_common.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_mqtt.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#define TEST_SPAN_BUFFER_SIZE 256
+
+static const uint8_t test_connect_packet[] = {
+  0x10, 0x1E, 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0xC2, 0x00, 0xF0, 0x00, 0x03, 'd', 'e',
+  'v',  0x00, 0x06, 'h',  'u', 'b', '/', 'd', 'v', 0x00, 0x05, 'S',  'A',  'S',  '=', '1',
+};
+
+static uint8_t test_publish_packet[] = {
+  0x32, 0x0E, 0x00, 0x05, 't', '/', 'a', '/', 'b', 0x12, 0x34, 'h', 'e', 'l', 'l', 'o',
+};
+
+static const az_mqtt_publish test_publish = {
+  .topic = AZ_SPAN_LITERAL_FROM_STR("t/a/b"),
+  .payload = AZ_SPAN_LITERAL_FROM_STR("hello"),
+  .qos = AZ_MQTT_QOS_AT_LEAST_ONCE,
+  .packet_id = 0x1234,
+  .retain = false,
+  .duplicate = false,
+};
+
+static void test_az_mqtt_encode_connect_succeed(void** state)
+{
+  (void)state;
+
+  az_mqtt_connect const connect = {
+    .client_id = AZ_SPAN_LITERAL_FROM_STR("dev"),
+    .user_name = AZ_SPAN_LITERAL_FROM_STR("hub/dv"),
+    .password = AZ_SPAN_LITERAL_FROM_STR("SAS=1"),
+    .keep_alive_seconds = 240,
+    .clean_session = true,
+  };
+
+  uint8_t buffer[TEST_SPAN_BUFFER_SIZE];
+  int32_t written = 0;
+  assert_int_equal(
+      az_mqtt_encode_connect(AZ_SPAN_FROM_BUFFER(buffer), &connect, &written), AZ_OK);
+  assert_int_equal(written, sizeof(test_connect_packet));
+  assert_memory_equal(buffer, test_connect_packet, sizeof(test_connect_packet));
+
+  assert_int_equal(
+      az_mqtt_encode_connect(az_span_create(buffer, written - 1), &connect, &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_mqtt_encode_publish_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_SPAN_BUFFER_SIZE];
+  int32_t written = 0;
+  assert_int_equal(
+      az_mqtt_encode_publish(AZ_SPAN_FROM_BUFFER(buffer), &test_publish, &written), AZ_OK);
+  assert_int_equal(written, sizeof(test_publish_packet));
+  assert_memory_equal(buffer, test_publish_packet, sizeof(test_publish_packet));
+
+  // The header alone is the packet without its payload.
+  assert_int_equal(
+      az_mqtt_encode_publish_header(
+          az_span_create(buffer, sizeof(test_publish_packet) - 5), &test_publish, &written),
+      AZ_OK);
+  assert_int_equal(written, sizeof(test_publish_packet) - 5);
+  assert_memory_equal(buffer, test_publish_packet, sizeof(test_publish_packet) - 5);
+}
+
+static void test_az_mqtt_encode_publish_large_remaining_length_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t payload[200] = { 0 };
+  az_mqtt_publish const publish = {
+    .topic = AZ_SPAN_LITERAL_FROM_STR("t"),
+    .payload = AZ_SPAN_FROM_BUFFER(payload),
+    .qos = AZ_MQTT_QOS_AT_MOST_ONCE,
+    .packet_id = 0,
+    .retain = true,
+    .duplicate = false,
+  };
+
+  uint8_t buffer[TEST_SPAN_BUFFER_SIZE];
+  int32_t written = 0;
+  assert_int_equal(az_mqtt_encode_publish(AZ_SPAN_FROM_BUFFER(buffer), &publish, &written), AZ_OK);
+
+  // 203 bytes remaining, encoded in two bytes.
+  assert_int_equal(written, 1 + 2 + 203);
+  assert_int_equal(buffer[0], 0x31);
+  assert_int_equal(buffer[1], 0xCB);
+  assert_int_equal(buffer[2], 0x01);
+}
+
+static void test_az_mqtt_encode_control_packets_succeed(void** state)
+{
+  (void)state;
+
+  az_mqtt_subscription const subscriptions[] = {
+    { .topic_filter = AZ_SPAN_LITERAL_FROM_STR("a/#"), .qos = AZ_MQTT_QOS_AT_LEAST_ONCE },
+    { .topic_filter = AZ_SPAN_LITERAL_FROM_STR("b"), .qos = AZ_MQTT_QOS_AT_MOST_ONCE },
+  };
+  uint8_t const expected_subscribe[]
+      = { 0x82, 0x0C, 0x00, 0x07, 0x00, 0x03, 'a', '/', '#', 0x01, 0x00, 0x01, 'b', 0x00 };
+
+  uint8_t buffer[TEST_SPAN_BUFFER_SIZE];
+  int32_t written = 0;
+  assert_int_equal(
+      az_mqtt_encode_subscribe(AZ_SPAN_FROM_BUFFER(buffer), 7, subscriptions, 2, &written), AZ_OK);
+  assert_int_equal(written, sizeof(expected_subscribe));
+  assert_memory_equal(buffer, expected_subscribe, sizeof(expected_subscribe));
+
+  assert_int_equal(az_mqtt_encode_puback(AZ_SPAN_FROM_BUFFER(buffer), 0x0102, &written), AZ_OK);
+  assert_int_equal(written, 4);
+  assert_memory_equal(buffer, ((uint8_t[]){ 0x40, 0x02, 0x01, 0x02 }), 4);
+
+  assert_int_equal(az_mqtt_encode_pingreq(AZ_SPAN_FROM_BUFFER(buffer), &written), AZ_OK);
+  assert_int_equal(written, 2);
+  assert_memory_equal(buffer, ((uint8_t[]){ 0xC0, 0x00 }), 2);
+
+  assert_int_equal(az_mqtt_encode_disconnect(AZ_SPAN_FROM_BUFFER(buffer), &written), AZ_OK);
+  assert_int_equal(written, 2);
+  assert_memory_equal(buffer, ((uint8_t[]){ 0xE0, 0x00 }), 2);
+
+  assert_int_equal(
+      az_mqtt_encode_pingreq(az_span_create(buffer, 1), &written), AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static az_mqtt_subscription test_long_subscriptions[4100];
+
+static void test_az_mqtt_encode_too_long_fail(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_SPAN_BUFFER_SIZE];
+  int32_t written = 0;
+
+  // The sizes are only added up, so the spans need not be backed by memory of their size. A payload
+  // whose size would overflow the remaining length, or push it past its largest value, fails
+  // before anything is written.
+  az_mqtt_publish publish = test_publish;
+  publish.payload = az_span_create(buffer, INT32_MAX - 1);
+  assert_int_equal(
+      az_mqtt_encode_publish_header(AZ_SPAN_FROM_BUFFER(buffer), &publish, &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  publish.payload = az_span_create(buffer, AZ_MQTT_MAX_REMAINING_LENGTH - 2 - 5 - 2 + 1);
+  assert_int_equal(
+      az_mqtt_encode_publish_header(AZ_SPAN_FROM_BUFFER(buffer), &publish, &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // The largest payload is only limited by the destination.
+  publish.payload = az_span_create(buffer, AZ_MQTT_MAX_REMAINING_LENGTH - 2 - 5 - 2);
+  assert_int_equal(
+      az_mqtt_encode_publish_header(AZ_SPAN_FROM_BUFFER(buffer), &publish, &written), AZ_OK);
+  assert_int_equal(written, 1 + 4 + 2 + 5 + 2);
+  assert_memory_equal(buffer, ((uint8_t[]){ 0x32, 0xFF, 0xFF, 0xFF, 0x7F }), 5);
+
+  // Topic filters of the largest size add up past the largest remaining length.
+  az_span const topic_filter = az_span_create(buffer, UINT16_MAX);
+  int32_t const subscriptions_length = (int32_t)(
+      sizeof(test_long_subscriptions) / sizeof(test_long_subscriptions[0]));
+  for (int32_t i = 0; i < subscriptions_length; i++)
+  {
+    test_long_subscriptions[i].topic_filter = topic_filter;
+    test_long_subscriptions[i].qos = AZ_MQTT_QOS_AT_MOST_ONCE;
+  }
+  assert_int_equal(
+      az_mqtt_encode_subscribe(
+          AZ_SPAN_FROM_BUFFER(buffer), 1, test_long_subscriptions, subscriptions_length, &written),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_mqtt_decoder_decode_in_place_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t data[] = {
+    0x20, 0x02, 0x01, 0x00, // CONNACK, session present, accepted
+    0x90, 0x04, 0x00, 0x07, 0x01, 0x80, // SUBACK, QoS 1 granted and one failure
+    0x40, 0x02, 0x12, 0x34, // PUBACK
+    0xD0, 0x00, // PINGRESP
+  };
+
+  uint8_t decoder_buffer[16];
+  az_mqtt_decoder decoder;
+  assert_int_equal(az_mqtt_decoder_init(&decoder, AZ_SPAN_FROM_BUFFER(decoder_buffer)), AZ_OK);
+
+  az_span remaining = az_span_create(data, sizeof(data));
+  az_mqtt_packet packet;
+  int32_t consumed = 0;
+
+  assert_int_equal(az_mqtt_decoder_decode(&decoder, remaining, &consumed, &packet), AZ_OK);
+  assert_int_equal(consumed, 4);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_CONNACK);
+  assert_true(packet.connack.session_present);
+  assert_int_equal(packet.connack.return_code, 0);
+  remaining = az_span_slice_to_end(remaining, consumed);
+
+  assert_int_equal(az_mqtt_decoder_decode(&decoder, remaining, &consumed, &packet), AZ_OK);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_SUBACK);
+  assert_int_equal(packet.suback.packet_id, 7);
+  assert_int_equal(az_span_size(packet.suback.return_codes), 2);
+  assert_int_equal(az_span_ptr(packet.suback.return_codes)[1], AZ_MQTT_SUBACK_FAILURE);
+  remaining = az_span_slice_to_end(remaining, consumed);
+
+  assert_int_equal(az_mqtt_decoder_decode(&decoder, remaining, &consumed, &packet), AZ_OK);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_PUBACK);
+  assert_int_equal(packet.packet_id, 0x1234);
+  remaining = az_span_slice_to_end(remaining, consumed);
+
+  assert_int_equal(az_mqtt_decoder_decode(&decoder, remaining, &consumed, &packet), AZ_OK);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_PINGRESP);
+  remaining = az_span_slice_to_end(remaining, consumed);
+
+  assert_int_equal(
+      az_mqtt_decoder_decode(&decoder, remaining, &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET);
+  assert_int_equal(consumed, 0);
+}
+
+static void test_az_mqtt_decoder_decode_partial_reads_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t decoder_buffer[32];
+  az_mqtt_decoder decoder;
+  assert_int_equal(az_mqtt_decoder_init(&decoder, AZ_SPAN_FROM_BUFFER(decoder_buffer)), AZ_OK);
+
+  az_mqtt_packet packet;
+  int32_t consumed = 0;
+
+  // Feed the PUBLISH packet one byte at a time.
+  for (size_t i = 0; i < sizeof(test_publish_packet) - 1; i++)
+  {
+    assert_int_equal(
+        az_mqtt_decoder_decode(
+            &decoder, az_span_create(test_publish_packet + i, 1), &consumed, &packet),
+        AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET);
+    assert_int_equal(consumed, 1);
+  }
+
+  // The last read also holds the start of the next packet, which is left unconsumed.
+  uint8_t last_read[] = { 'o', 0x40, 0x02 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(last_read, sizeof(last_read)), &consumed, &packet),
+      AZ_OK);
+  assert_int_equal(consumed, 1);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_PUBLISH);
+  assert_true(az_span_is_content_equal(packet.publish.topic, test_publish.topic));
+  assert_true(az_span_is_content_equal(packet.publish.payload, test_publish.payload));
+  assert_int_equal(packet.publish.qos, AZ_MQTT_QOS_AT_LEAST_ONCE);
+  assert_int_equal(packet.publish.packet_id, 0x1234);
+  assert_false(packet.publish.retain);
+  assert_false(packet.publish.duplicate);
+
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(last_read + 1, 2), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET);
+  assert_int_equal(consumed, 2);
+
+  uint8_t rest[] = { 0x00, 0x09 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(rest, sizeof(rest)), &consumed, &packet),
+      AZ_OK);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_PUBACK);
+  assert_int_equal(packet.packet_id, 9);
+}
+
+static void test_az_mqtt_decoder_decode_invalid_fail(void** state)
+{
+  (void)state;
+
+  uint8_t decoder_buffer[8];
+  az_mqtt_decoder decoder;
+  assert_int_equal(az_mqtt_decoder_init(&decoder, AZ_SPAN_FROM_BUFFER(decoder_buffer)), AZ_OK);
+
+  az_mqtt_packet packet;
+  int32_t consumed = 0;
+
+  // The remaining length may not be longer than 4 bytes.
+  uint8_t bad_length[] = { 0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(bad_length, sizeof(bad_length)), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_MALFORMED_PACKET);
+
+  // CONNACK with reserved flags set.
+  uint8_t bad_connack[] = { 0x20, 0x02, 0x02, 0x00 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(bad_connack, sizeof(bad_connack)), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_MALFORMED_PACKET);
+
+  // Packet types 0 and 15 are reserved.
+  uint8_t reserved_type_0[] = { 0x00, 0x00 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(reserved_type_0, sizeof(reserved_type_0)), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_MALFORMED_PACKET);
+
+  uint8_t reserved_type_15[] = { 0xF0, 0x00 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder,
+          az_span_create(reserved_type_15, sizeof(reserved_type_15)),
+          &consumed,
+          &packet),
+      AZ_ERROR_IOT_MQTT_MALFORMED_PACKET);
+
+  // PUBACK and SUBACK may not carry packet identifier 0.
+  uint8_t zero_id_puback[] = { 0x40, 0x02, 0x00, 0x00 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(zero_id_puback, sizeof(zero_id_puback)), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_MALFORMED_PACKET);
+
+  uint8_t zero_id_suback[] = { 0x90, 0x03, 0x00, 0x00, 0x00 };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(zero_id_suback, sizeof(zero_id_suback)), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_MALFORMED_PACKET);
+}
+
+static void test_az_mqtt_decoder_decode_too_large_skip_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t decoder_buffer[8];
+  az_mqtt_decoder decoder;
+  assert_int_equal(az_mqtt_decoder_init(&decoder, AZ_SPAN_FROM_BUFFER(decoder_buffer)), AZ_OK);
+
+  az_mqtt_packet packet;
+  int32_t consumed = 0;
+
+  // The largest remaining length, in 4 bytes, is valid but does not fit in the buffer.
+  uint8_t max_length[] = { 0x30, 0xFF, 0xFF, 0xFF, 0x7F };
+  assert_int_equal(
+      az_mqtt_decoder_decode(
+          &decoder, az_span_create(max_length, sizeof(max_length)), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_PACKET_TOO_LARGE);
+  assert_int_equal(consumed, 0);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_PUBLISH);
+  assert_int_equal(az_mqtt_decoder_init(&decoder, AZ_SPAN_FROM_BUFFER(decoder_buffer)), AZ_OK);
+
+  // The bytes of a packet larger than the buffer are skipped, and the next packet is decoded.
+  uint8_t stream[sizeof(test_publish_packet) + 4];
+  az_span remainder = az_span_copy(
+      AZ_SPAN_FROM_BUFFER(stream),
+      az_span_create(test_publish_packet, sizeof(test_publish_packet)));
+  uint8_t puback[] = { 0x40, 0x02, 0x00, 0x09 };
+  az_span_copy(remainder, az_span_create(puback, sizeof(puback)));
+
+  // The first read holds a part of the fixed header only, and the second one completes it.
+  az_span data = AZ_SPAN_FROM_BUFFER(stream);
+  assert_int_equal(
+      az_mqtt_decoder_decode(&decoder, az_span_slice(data, 0, 1), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET);
+  assert_int_equal(consumed, 1);
+  data = az_span_slice_to_end(data, consumed);
+
+  assert_int_equal(
+      az_mqtt_decoder_decode(&decoder, az_span_slice(data, 0, 1), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_PACKET_TOO_LARGE);
+  assert_int_equal(consumed, 1);
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_PUBLISH);
+  data = az_span_slice_to_end(data, consumed);
+
+  // Reads ending within the skipped packet consume all of their bytes.
+  assert_int_equal(
+      az_mqtt_decoder_decode(&decoder, az_span_slice(data, 0, 2), &consumed, &packet),
+      AZ_ERROR_IOT_MQTT_INCOMPLETE_PACKET);
+  assert_int_equal(consumed, 2);
+  data = az_span_slice_to_end(data, consumed);
+
+  assert_int_equal(az_mqtt_decoder_decode(&decoder, data, &consumed, &packet), AZ_OK);
+  assert_int_equal(consumed, az_span_size(data));
+  assert_int_equal(packet.type, AZ_MQTT_PACKET_TYPE_PUBACK);
+  assert_int_equal(packet.packet_id, 9);
+}
+
+#ifdef _az_MOCK_ENABLED
+
+az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec);
+az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec)
+{
+  *out_clock_msec = (int64_t)mock();
+  return AZ_OK;
+}
+
+static void test_az_mqtt_inflight_add_ack_succeed(void** state)
+{
+  (void)state;
+
+  az_mqtt_inflight_entry entries[4];
+  az_mqtt_inflight_options options = az_mqtt_inflight_options_default();
+  options.max_in_flight = 3;
+
+  az_mqtt_inflight inflight;
+  assert_int_equal(az_mqtt_inflight_init(&inflight, entries, 4, &options), AZ_OK);
+
+  int contexts[4] = { 0 };
+  uint16_t packet_ids[4] = { 0 };
+
+  will_return_count(__wrap_az_platform_clock_msec, 0, 3);
+  for (int32_t i = 0; i < 3; i++)
+  {
+    assert_int_equal(az_mqtt_inflight_add(&inflight, &contexts[i], &packet_ids[i]), AZ_OK);
+    assert_int_equal(packet_ids[i], i + 1);
+  }
+  assert_int_equal(az_mqtt_inflight_get_count(&inflight), 3);
+
+  // The window is full.
+  assert_int_equal(
+      az_mqtt_inflight_add(&inflight, &contexts[3], &packet_ids[3]), AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  void* user_context = NULL;
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 2, &user_context), AZ_OK);
+  assert_ptr_equal(user_context, &contexts[1]);
+  assert_int_equal(az_mqtt_inflight_get_count(&inflight), 2);
+
+  // Duplicate, unknown and zero identifiers are not in flight.
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 2, NULL), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 5, NULL), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 0, NULL), AZ_ERROR_ITEM_NOT_FOUND);
+
+  // Identifiers keep increasing, skipping the entries that are still in flight.
+  will_return_count(__wrap_az_platform_clock_msec, 0, 1);
+  assert_int_equal(az_mqtt_inflight_add(&inflight, &contexts[3], &packet_ids[3]), AZ_OK);
+  assert_int_equal(packet_ids[3], 4);
+
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 1, NULL), AZ_OK);
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 3, NULL), AZ_OK);
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 4, &user_context), AZ_OK);
+  assert_ptr_equal(user_context, &contexts[3]);
+  assert_int_equal(az_mqtt_inflight_get_count(&inflight), 0);
+}
+
+static void test_az_mqtt_inflight_get_expired_succeed(void** state)
+{
+  (void)state;
+
+  az_mqtt_inflight_entry entries[8];
+  az_mqtt_inflight_options options = az_mqtt_inflight_options_default();
+  options.retransmit_timeout_msec = 100;
+
+  az_mqtt_inflight inflight;
+  assert_int_equal(az_mqtt_inflight_init(&inflight, entries, 8, &options), AZ_OK);
+
+  uint16_t packet_id = 0;
+  void* user_context = NULL;
+  int64_t deadline = 0;
+
+  assert_int_equal(
+      az_mqtt_inflight_get_next_deadline(&inflight, &deadline), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_mqtt_inflight_get_expired(&inflight, &packet_id, &user_context), AZ_ERROR_ITEM_NOT_FOUND);
+
+  // Packets 1 to 5 are sent at times 50, 10, 40, 20 and 30.
+  int64_t const send_times[] = { 50, 10, 40, 20, 30 };
+  for (size_t i = 0; i < sizeof(send_times) / sizeof(send_times[0]); i++)
+  {
+    will_return(__wrap_az_platform_clock_msec, send_times[i]);
+    assert_int_equal(az_mqtt_inflight_add(&inflight, NULL, &packet_id), AZ_OK);
+  }
+
+  assert_int_equal(az_mqtt_inflight_get_next_deadline(&inflight, &deadline), AZ_OK);
+  assert_int_equal(deadline, 110);
+
+  // Packet 3 is acknowledged before it expires.
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 3, NULL), AZ_OK);
+
+  // Nothing has expired yet.
+  will_return(__wrap_az_platform_clock_msec, 109);
+  assert_int_equal(
+      az_mqtt_inflight_get_expired(&inflight, &packet_id, &user_context), AZ_ERROR_ITEM_NOT_FOUND);
+
+  // At time 135, packets 2, 4 and 5 have expired, oldest first.
+  uint16_t const expected_ids[] = { 2, 4, 5 };
+  for (size_t i = 0; i < sizeof(expected_ids) / sizeof(expected_ids[0]); i++)
+  {
+    will_return(__wrap_az_platform_clock_msec, 135);
+    assert_int_equal(az_mqtt_inflight_get_expired(&inflight, &packet_id, &user_context), AZ_OK);
+    assert_int_equal(packet_id, expected_ids[i]);
+  }
+
+  will_return(__wrap_az_platform_clock_msec, 135);
+  assert_int_equal(
+      az_mqtt_inflight_get_expired(&inflight, &packet_id, &user_context), AZ_ERROR_ITEM_NOT_FOUND);
+
+  // Packet 1 is next, then the retransmitted packets, which were rescheduled to 235.
+  assert_int_equal(az_mqtt_inflight_get_next_deadline(&inflight, &deadline), AZ_OK);
+  assert_int_equal(deadline, 150);
+
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, 1, NULL), AZ_OK);
+  assert_int_equal(az_mqtt_inflight_get_next_deadline(&inflight, &deadline), AZ_OK);
+  assert_int_equal(deadline, 235);
+}
+
+static void test_az_mqtt_inflight_packet_id_wrap_succeed(void** state)
+{
+  (void)state;
+
+  az_mqtt_inflight_entry entries[3];
+  az_mqtt_inflight inflight;
+  assert_int_equal(az_mqtt_inflight_init(&inflight, entries, 3, NULL), AZ_OK);
+
+  uint16_t packet_id = 0;
+  uint16_t held_packet_id = 0;
+
+  // Keep one packet in flight while cycling through the whole identifier space.
+  will_return_always(__wrap_az_platform_clock_msec, 0);
+  assert_int_equal(az_mqtt_inflight_add(&inflight, NULL, &held_packet_id), AZ_OK);
+  assert_int_equal(held_packet_id, 1);
+
+  uint16_t previous_packet_id = held_packet_id;
+  for (int32_t i = 0; i < 70000; i++)
+  {
+    assert_int_equal(az_mqtt_inflight_add(&inflight, NULL, &packet_id), AZ_OK);
+    assert_int_not_equal(packet_id, 0);
+    assert_int_not_equal(packet_id, held_packet_id);
+    assert_true(packet_id > previous_packet_id || packet_id < 4);
+    previous_packet_id = packet_id;
+    assert_int_equal(az_mqtt_inflight_ack(&inflight, packet_id, NULL), AZ_OK);
+  }
+
+  assert_int_equal(az_mqtt_inflight_get_count(&inflight), 1);
+  assert_int_equal(az_mqtt_inflight_ack(&inflight, held_packet_id, NULL), AZ_OK);
+}
+
+#endif // _az_MOCK_ENABLED
+
+int test_az_mqtt()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_mqtt_encode_connect_succeed),
+    cmocka_unit_test(test_az_mqtt_encode_publish_succeed),
+    cmocka_unit_test(test_az_mqtt_encode_publish_large_remaining_length_succeed),
+    cmocka_unit_test(test_az_mqtt_encode_control_packets_succeed),
+    cmocka_unit_test(test_az_mqtt_encode_too_long_fail),
+    cmocka_unit_test(test_az_mqtt_decoder_decode_in_place_succeed),
+    cmocka_unit_test(test_az_mqtt_decoder_decode_partial_reads_succeed),
+    cmocka_unit_test(test_az_mqtt_decoder_decode_invalid_fail),
+    cmocka_unit_test(test_az_mqtt_decoder_decode_too_large_skip_succeed),
+#ifdef _az_MOCK_ENABLED
+    cmocka_unit_test(test_az_mqtt_inflight_add_ack_succeed),
+    cmocka_unit_test(test_az_mqtt_inflight_get_expired_succeed),
+    cmocka_unit_test(test_az_mqtt_inflight_packet_id_wrap_succeed),
+#endif // _az_MOCK_ENABLED
+  };
+  return cmocka_run_group_tests_name("az_mqtt", tests, NULL, NULL);
+}
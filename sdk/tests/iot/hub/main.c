@@ -20,9 +20,15 @@ int main()
   result += test_az_iot_hub_client_methods();
   result += test_az_iot_hub_client_sas_token();
   result += test_az_iot_hub_client_telemetry();
+  result += test_az_iot_hub_client_telemetry_batch();
+  result += test_az_iot_hub_client_telemetry_store();
+  result += test_az_iot_hub_gateway();
   result += test_az_iot_hub_client_twin();
+  result += test_az_iot_hub_client_twin_shadow();
+  result += test_az_iot_hub_client_commands_dispatch();
   result += test_az_iot_hub_client_commands();
   result += test_az_iot_hub_client_properties();
+  result += test_az_iot_hub_client_properties_tracker();
 
   return result;
 }
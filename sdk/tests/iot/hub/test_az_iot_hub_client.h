@@ -6,7 +6,13 @@ int test_az_iot_hub_client_c2d();
 int test_az_iot_hub_client_methods();
 int test_az_iot_hub_client_sas_token();
 int test_az_iot_hub_client_telemetry();
+int test_az_iot_hub_client_telemetry_batch();
+int test_az_iot_hub_client_telemetry_store();
+int test_az_iot_hub_gateway();
 int test_az_iot_hub_client_twin();
+int test_az_iot_hub_client_twin_shadow();
+int test_az_iot_hub_client_commands_dispatch();
 int test_az_iot_hub_client_telemetry_with_component();
 int test_az_iot_hub_client_commands();
 int test_az_iot_hub_client_properties();
+int test_az_iot_hub_client_properties_tracker();
@@ -0,0 +1,228 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client.h>
+#include <azure/iot/az_iot_hub_client_commands_dispatch.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmocka.h>
+
+#define TEST_COMMAND_COUNT 128
+#define TEST_BUCKET_COUNT 256
+#define TEST_NAME_SIZE 16
+#define TEST_TOPIC_SIZE 64
+
+static const az_span test_device_id = AZ_SPAN_LITERAL_FROM_STR("my_device");
+static const az_span test_device_hostname = AZ_SPAN_LITERAL_FROM_STR("myiothub.azure-devices.net");
+
+static char test_component_names[TEST_COMMAND_COUNT][TEST_NAME_SIZE];
+static char test_command_names[TEST_COMMAND_COUNT][TEST_NAME_SIZE];
+
+// Every fourth command belongs to the root interface, and the components share command names.
+static void test_get_command(int32_t i, az_span* out_component_name, az_span* out_command_name)
+{
+  int length = 0;
+  if (i % 4 == 0)
+  {
+    *out_component_name = AZ_SPAN_EMPTY;
+  }
+  else
+  {
+    length = snprintf(test_component_names[i], TEST_NAME_SIZE, "component%d", (int)(i % 4));
+    *out_component_name = az_span_create((uint8_t*)test_component_names[i], length);
+  }
+
+  length = snprintf(test_command_names[i], TEST_NAME_SIZE, "command%d", (int)(i / 4));
+  *out_command_name = az_span_create((uint8_t*)test_command_names[i], length);
+}
+
+static az_span test_get_topic(char* buffer, az_span component_name, az_span command_name)
+{
+  int const length = az_span_size(component_name) > 0
+      ? snprintf(
+          buffer,
+          TEST_TOPIC_SIZE,
+          "$iothub/methods/POST/%.*s*%.*s/?$rid=7",
+          (int)az_span_size(component_name),
+          (char*)az_span_ptr(component_name),
+          (int)az_span_size(command_name),
+          (char*)az_span_ptr(command_name))
+      : snprintf(
+          buffer,
+          TEST_TOPIC_SIZE,
+          "$iothub/methods/POST/%.*s/?$rid=7",
+          (int)az_span_size(command_name),
+          (char*)az_span_ptr(command_name));
+  return az_span_create((uint8_t*)buffer, length);
+}
+
+static void test_add_commands(
+    az_iot_hub_client_commands_dispatch* dispatch,
+    az_iot_hub_client_commands_dispatch_entry* entries,
+    int32_t* buckets)
+{
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_init(
+          dispatch, entries, TEST_COMMAND_COUNT, buckets, TEST_BUCKET_COUNT),
+      AZ_OK);
+
+  for (int32_t i = 0; i < TEST_COMMAND_COUNT; i++)
+  {
+    az_span component_name;
+    az_span command_name;
+    test_get_command(i, &component_name, &command_name);
+
+    int32_t command_index = -1;
+    assert_int_equal(
+        az_iot_hub_client_commands_dispatch_add(
+            dispatch, component_name, command_name, &command_index),
+        AZ_OK);
+    assert_int_equal(command_index, i);
+  }
+}
+
+static void test_az_iot_hub_client_commands_dispatch_parse_received_topic_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_commands_dispatch_entry entries[TEST_COMMAND_COUNT];
+  int32_t buckets[TEST_BUCKET_COUNT];
+  az_iot_hub_client_commands_dispatch dispatch;
+  test_add_commands(&dispatch, entries, buckets);
+  assert_int_equal(az_iot_hub_client_commands_dispatch_get_count(&dispatch), TEST_COMMAND_COUNT);
+
+  for (int32_t i = 0; i < TEST_COMMAND_COUNT; i++)
+  {
+    az_span component_name;
+    az_span command_name;
+    test_get_command(i, &component_name, &command_name);
+
+    char topic[TEST_TOPIC_SIZE];
+    az_iot_hub_client_command_request request;
+    int32_t command_index = -1;
+    assert_int_equal(
+        az_iot_hub_client_commands_dispatch_parse_received_topic(
+            &dispatch,
+            &client,
+            test_get_topic(topic, component_name, command_name),
+            &request,
+            &command_index),
+        AZ_OK);
+    assert_int_equal(command_index, i);
+    assert_true(az_span_is_content_equal(request.component_name, component_name));
+    assert_true(az_span_is_content_equal(request.command_name, command_name));
+    assert_true(az_span_is_content_equal(request.request_id, AZ_SPAN_FROM_STR("7")));
+  }
+}
+
+static void test_az_iot_hub_client_commands_dispatch_parse_received_topic_not_found(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_commands_dispatch_entry entries[TEST_COMMAND_COUNT];
+  int32_t buckets[TEST_BUCKET_COUNT];
+  az_iot_hub_client_commands_dispatch dispatch;
+  test_add_commands(&dispatch, entries, buckets);
+
+  az_iot_hub_client_command_request request;
+  int32_t command_index = -1;
+
+  // A command of an unknown component is not found, but the request is still parsed.
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_parse_received_topic(
+          &dispatch,
+          &client,
+          AZ_SPAN_FROM_STR("$iothub/methods/POST/component9*command0/?$rid=1"),
+          &request,
+          &command_index),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(command_index, -1);
+  assert_true(az_span_is_content_equal(request.component_name, AZ_SPAN_FROM_STR("component9")));
+  assert_true(az_span_is_content_equal(request.command_name, AZ_SPAN_FROM_STR("command0")));
+  assert_true(az_span_is_content_equal(request.request_id, AZ_SPAN_FROM_STR("1")));
+
+  // Without a component name, the separator is part of the command name.
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_parse_received_topic(
+          &dispatch,
+          &client,
+          AZ_SPAN_FROM_STR("$iothub/methods/POST/*command1/?$rid=1"),
+          &request,
+          &command_index),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_span_size(request.component_name), 0);
+  assert_true(az_span_is_content_equal(request.command_name, AZ_SPAN_FROM_STR("*command1")));
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_parse_received_topic(
+          &dispatch,
+          &client,
+          AZ_SPAN_FROM_STR("$iothub/methods/POST/command99/?$rid=1"),
+          &request,
+          &command_index),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_span_size(request.component_name), 0);
+  assert_true(az_span_is_content_equal(request.command_name, AZ_SPAN_FROM_STR("command99")));
+
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_parse_received_topic(
+          &dispatch,
+          &client,
+          AZ_SPAN_FROM_STR("$iothub/twin/res/200/?$rid=1"),
+          &request,
+          &command_index),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+}
+
+static void test_az_iot_hub_client_commands_dispatch_add_fail(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client_commands_dispatch_entry entries[2];
+  int32_t buckets[4];
+  az_iot_hub_client_commands_dispatch dispatch;
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_init(&dispatch, entries, 2, buckets, 4), AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_add(
+          &dispatch, AZ_SPAN_FROM_STR("thermostat"), AZ_SPAN_FROM_STR("reboot"), NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_add(
+          &dispatch, AZ_SPAN_FROM_STR("thermostat"), AZ_SPAN_FROM_STR("reboot"), NULL),
+      AZ_ERROR_ARG);
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_add(
+          &dispatch, AZ_SPAN_EMPTY, AZ_SPAN_FROM_STR("reboot"), NULL),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_commands_dispatch_add(
+          &dispatch, AZ_SPAN_EMPTY, AZ_SPAN_FROM_STR("getMaxMinReport"), NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_iot_hub_client_commands_dispatch_get_count(&dispatch), 2);
+}
+
+int test_az_iot_hub_client_commands_dispatch()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_hub_client_commands_dispatch_parse_received_topic_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_commands_dispatch_parse_received_topic_not_found),
+    cmocka_unit_test(test_az_iot_hub_client_commands_dispatch_add_fail),
+  };
+  return cmocka_run_group_tests_name("az_iot_hub_client_commands_dispatch", tests, NULL, NULL);
+}
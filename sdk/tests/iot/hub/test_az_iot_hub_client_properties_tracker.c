@@ -0,0 +1,243 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client.h>
+#include <azure/iot/az_iot_hub_client_properties_tracker.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#define TEST_ENTRY_COUNT 8
+#define TEST_PATCH_BUFFER_SIZE 256
+#define TEST_SNAPSHOT_BUFFER_SIZE 512
+
+static const az_span test_device_id = AZ_SPAN_LITERAL_FROM_STR("my_device");
+static const az_span test_device_hostname = AZ_SPAN_LITERAL_FROM_STR("myiothub.azure-devices.net");
+
+static const az_span test_snapshot = AZ_SPAN_LITERAL_FROM_STR(
+    "{\"serial\":\"abc\",\"temperature\":21.5,"
+    "\"thermostat1\":{\"__t\":\"c\",\"maxTemp\":30,\"range\":{\"lo\":1,\"hi\":2}},"
+    "\"config\":{\"mode\":\"eco\"}}");
+
+static void test_get_patch(
+    az_iot_hub_client_properties_tracker* tracker,
+    az_iot_hub_client const* client,
+    az_span snapshot,
+    az_span expected_patch)
+{
+  uint8_t patch_buffer[TEST_PATCH_BUFFER_SIZE];
+  az_span patch = AZ_SPAN_FROM_STR("unchanged");
+  assert_int_equal(
+      az_iot_hub_client_properties_tracker_get_patch(
+          tracker, client, snapshot, AZ_SPAN_FROM_BUFFER(patch_buffer), &patch),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(patch, expected_patch));
+}
+
+static void test_az_iot_hub_client_properties_tracker_get_patch_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_properties_tracker_entry entries[TEST_ENTRY_COUNT];
+  uint8_t snapshot_buffer[TEST_SNAPSHOT_BUFFER_SIZE];
+  az_iot_hub_client_properties_tracker tracker;
+  assert_int_equal(
+      az_iot_hub_client_properties_tracker_init(
+          &tracker, entries, TEST_ENTRY_COUNT, AZ_SPAN_FROM_BUFFER(snapshot_buffer)),
+      AZ_OK);
+
+  // Everything is new at first.
+  test_get_patch(
+      &tracker,
+      &client,
+      test_snapshot,
+      AZ_SPAN_FROM_STR("{\"serial\":\"abc\",\"temperature\":21.5,\"thermostat1\":"
+                       "{\"__t\":\"c\",\"maxTemp\":30,\"range\":{\"lo\":1,\"hi\":2}},"
+                       "\"config\":{\"mode\":\"eco\"}}"));
+  assert_true(az_iot_hub_client_properties_tracker_is_patch_in_flight(&tracker));
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_NO_CONTENT);
+  assert_false(az_iot_hub_client_properties_tracker_is_patch_in_flight(&tracker));
+
+  test_get_patch(&tracker, &client, test_snapshot, AZ_SPAN_FROM_STR(""));
+  assert_false(az_iot_hub_client_properties_tracker_is_patch_in_flight(&tracker));
+
+  // Only the changed properties are reported, with their component.
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"serial\":\"abc\",\"temperature\":22,\"thermostat1\":"
+                       "{\"__t\":\"c\",\"maxTemp\":30,\"range\":{\"lo\":0,\"hi\":2}},"
+                       "\"config\":{\"mode\":\"eco\"}}"),
+      AZ_SPAN_FROM_STR("{\"temperature\":22,"
+                       "\"thermostat1\":{\"__t\":\"c\",\"range\":{\"lo\":0,\"hi\":2}}}"));
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_NO_CONTENT);
+
+  // A property of a component is distinct from a property of the same name elsewhere, and the
+  // properties missing from the snapshot are removed.
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"maxTemp\":30,\"thermostat1\":{\"__t\":\"c\",\"maxTemp\":30}}"),
+      AZ_SPAN_FROM_STR("{\"maxTemp\":30,\"thermostat1\":{\"__t\":\"c\",\"range\":null},"
+                       "\"serial\":null,\"temperature\":null,\"config\":null}"));
+}
+
+static void test_az_iot_hub_client_properties_tracker_coalesce_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_properties_tracker_entry entries[TEST_ENTRY_COUNT];
+  uint8_t snapshot_buffer[TEST_SNAPSHOT_BUFFER_SIZE];
+  az_iot_hub_client_properties_tracker tracker;
+  assert_int_equal(
+      az_iot_hub_client_properties_tracker_init(
+          &tracker, entries, TEST_ENTRY_COUNT, AZ_SPAN_FROM_BUFFER(snapshot_buffer)),
+      AZ_OK);
+
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"a\":1,\"b\":1}"),
+      AZ_SPAN_FROM_STR("{\"a\":1,\"b\":1}"));
+
+  // Snapshots taken while the patch is in flight produce no patch.
+  test_get_patch(&tracker, &client, AZ_SPAN_FROM_STR("{\"a\":2,\"b\":1}"), AZ_SPAN_FROM_STR(""));
+  test_get_patch(&tracker, &client, AZ_SPAN_FROM_STR("{\"a\":3,\"b\":1}"), AZ_SPAN_FROM_STR(""));
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_NO_CONTENT);
+
+  // The next patch carries the latest values only.
+  test_get_patch(
+      &tracker, &client, AZ_SPAN_FROM_STR("{\"a\":3,\"b\":1}"), AZ_SPAN_FROM_STR("{\"a\":3}"));
+
+  // A rejected patch is reported again, along with newer changes.
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_SERVER_ERROR);
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"a\":3,\"b\":4}"),
+      AZ_SPAN_FROM_STR("{\"a\":3,\"b\":4}"));
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_NO_CONTENT);
+  test_get_patch(&tracker, &client, AZ_SPAN_FROM_STR("{\"b\":4,\"a\":3}"), AZ_SPAN_FROM_STR(""));
+}
+
+static void test_az_iot_hub_client_properties_tracker_not_enough_space_fails(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_properties_tracker_entry entries[2];
+  uint8_t snapshot_buffer[48];
+  az_iot_hub_client_properties_tracker tracker;
+  assert_int_equal(
+      az_iot_hub_client_properties_tracker_init(
+          &tracker, entries, 2, AZ_SPAN_FROM_BUFFER(snapshot_buffer)),
+      AZ_OK);
+
+  uint8_t patch_buffer[TEST_PATCH_BUFFER_SIZE];
+  az_span patch = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_hub_client_properties_tracker_get_patch(
+          &tracker,
+          &client,
+          AZ_SPAN_FROM_STR("{\"a\":1,\"b\":1,\"c\":1}"),
+          AZ_SPAN_FROM_BUFFER(patch_buffer),
+          &patch),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_span_size(patch), 0);
+  assert_false(az_iot_hub_client_properties_tracker_is_patch_in_flight(&tracker));
+
+  // Each half of the snapshot buffer must hold the snapshot.
+  assert_int_equal(
+      az_iot_hub_client_properties_tracker_get_patch(
+          &tracker,
+          &client,
+          AZ_SPAN_FROM_STR("{\"a\":1,\"b\":\"0123456789abcdef\"}"),
+          AZ_SPAN_FROM_BUFFER(patch_buffer),
+          &patch),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_false(az_iot_hub_client_properties_tracker_is_patch_in_flight(&tracker));
+
+  // The properties that fit are still reported once the snapshot fits.
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"a\":1,\"b\":1}"),
+      AZ_SPAN_FROM_STR("{\"a\":1,\"b\":1}"));
+}
+
+static void test_az_iot_hub_client_properties_tracker_hash_collision_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  az_iot_hub_client_properties_tracker_entry entries[TEST_ENTRY_COUNT];
+  uint8_t snapshot_buffer[TEST_SNAPSHOT_BUFFER_SIZE];
+  az_iot_hub_client_properties_tracker tracker;
+  assert_int_equal(
+      az_iot_hub_client_properties_tracker_init(
+          &tracker, entries, TEST_ENTRY_COUNT, AZ_SPAN_FROM_BUFFER(snapshot_buffer)),
+      AZ_OK);
+
+  // The property names p58458 and p905806 have the same FNV-1a hash, as do the values 40189 and
+  // 797186. A root property may also be named like a component property.
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"p58458\":40189,\"p905806\":1,\"c/p\":1,"
+                       "\"c\":{\"__t\":\"c\",\"p\":1}}"),
+      AZ_SPAN_FROM_STR("{\"p58458\":40189,\"p905806\":1,\"c/p\":1,"
+                       "\"c\":{\"__t\":\"c\",\"p\":1}}"));
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_NO_CONTENT);
+
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"p58458\":797186,\"p905806\":1,\"c/p\":1,"
+                       "\"c\":{\"__t\":\"c\",\"p\":2}}"),
+      AZ_SPAN_FROM_STR("{\"p58458\":797186,\"c\":{\"__t\":\"c\",\"p\":2}}"));
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_NO_CONTENT);
+
+  // A removed property is reported once, and a component is removed with each of its properties.
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"p58458\":797186,\"c/p\":1}"),
+      AZ_SPAN_FROM_STR("{\"p905806\":null,\"c\":{\"__t\":\"c\",\"p\":null}}"));
+  az_iot_hub_client_properties_tracker_complete(&tracker, AZ_IOT_STATUS_NO_CONTENT);
+  test_get_patch(
+      &tracker,
+      &client,
+      AZ_SPAN_FROM_STR("{\"p58458\":797186,\"c/p\":1}"),
+      AZ_SPAN_FROM_STR(""));
+}
+
+int test_az_iot_hub_client_properties_tracker()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_hub_client_properties_tracker_get_patch_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_tracker_coalesce_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_properties_tracker_not_enough_space_fails),
+    cmocka_unit_test(test_az_iot_hub_client_properties_tracker_hash_collision_succeed),
+  };
+  return cmocka_run_group_tests_name("az_iot_hub_client_properties_tracker", tests, NULL, NULL);
+}
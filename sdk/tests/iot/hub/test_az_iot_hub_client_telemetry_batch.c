@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client.h>
+#include <azure/iot/az_iot_hub_client_telemetry_batch.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#define TEST_PAYLOAD_BUFFER_SIZE 128
+#define TEST_SPAN_BUFFER_SIZE 128
+
+static const az_span test_device_id = AZ_SPAN_LITERAL_FROM_STR("my_device");
+static const az_span test_device_hostname = AZ_SPAN_LITERAL_FROM_STR("myiothub.azure-devices.net");
+
+static void test_az_iot_hub_client_telemetry_batch_empty_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  uint8_t payload_buffer[TEST_PAYLOAD_BUFFER_SIZE];
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, AZ_SPAN_FROM_BUFFER(payload_buffer), AZ_SPAN_EMPTY, NULL),
+      AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_get_count(&batch), 0);
+  assert_null(az_iot_hub_client_telemetry_batch_get_properties(&batch));
+
+  char topic[TEST_SPAN_BUFFER_SIZE];
+  az_span payload = AZ_SPAN_EMPTY;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_publish_message(
+          &batch, &client, topic, sizeof(topic), NULL, &payload),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // An empty batch is never ready, and doesn't read the clock.
+  bool should_publish = true;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_should_publish(&batch, &should_publish), AZ_OK);
+  assert_false(should_publish);
+}
+
+#ifdef _az_MOCK_ENABLED
+
+static const az_span test_reading = AZ_SPAN_LITERAL_FROM_STR("{\"temperature\":21.5}");
+
+az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec);
+az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec)
+{
+  *out_clock_msec = (int64_t)mock();
+  return AZ_OK;
+}
+
+static void test_az_iot_hub_client_telemetry_batch_append_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  uint8_t payload_buffer[TEST_PAYLOAD_BUFFER_SIZE];
+  uint8_t properties_buffer[TEST_SPAN_BUFFER_SIZE];
+  az_span const payload_span = AZ_SPAN_FROM_BUFFER(payload_buffer);
+  az_span const properties_span = AZ_SPAN_FROM_BUFFER(properties_buffer);
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(&batch, payload_span, properties_span, NULL), AZ_OK);
+
+  char topic[TEST_SPAN_BUFFER_SIZE];
+  size_t topic_length = 0;
+  az_span payload = AZ_SPAN_EMPTY;
+
+  // Only the first reading of a batch reads the clock.
+  will_return(__wrap_az_platform_clock_msec, 100);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append(&batch, test_reading), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_append(&batch, AZ_SPAN_FROM_STR("{\"humidity\":40}")),
+      AZ_OK);
+
+  // Invalid JSON is rejected and leaves the batch unchanged.
+  assert_int_not_equal(
+      az_iot_hub_client_telemetry_batch_append(&batch, AZ_SPAN_FROM_STR("{\"humidity\"")), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_get_count(&batch), 2);
+
+  assert_int_equal(
+      az_iot_message_properties_append(
+          az_iot_hub_client_telemetry_batch_get_properties(&batch),
+          AZ_SPAN_FROM_STR(AZ_IOT_MESSAGE_PROPERTIES_CONTENT_TYPE),
+          AZ_SPAN_FROM_STR("application%2Fjson")),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_publish_message(
+          &batch, &client, topic, sizeof(topic), &topic_length, &payload),
+      AZ_OK);
+  assert_string_equal(topic, "devices/my_device/messages/events/%24.ct=application%2Fjson");
+  assert_true(az_span_is_content_equal(
+      payload, AZ_SPAN_FROM_STR("[{\"temperature\":21.5},{\"humidity\":40}]")));
+
+  // Readings can still be appended after getting the message.
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append(&batch, AZ_SPAN_FROM_STR("7")), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_publish_message(
+          &batch, &client, topic, sizeof(topic), &topic_length, &payload),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(
+      payload, AZ_SPAN_FROM_STR("[{\"temperature\":21.5},{\"humidity\":40},7]")));
+
+  // Resetting clears the readings and the properties.
+  assert_int_equal(az_iot_hub_client_telemetry_batch_reset(&batch), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_get_count(&batch), 0);
+
+  will_return(__wrap_az_platform_clock_msec, 200);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append(&batch, test_reading), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_get_publish_message(
+          &batch, &client, topic, sizeof(topic), &topic_length, &payload),
+      AZ_OK);
+  assert_string_equal(topic, "devices/my_device/messages/events/");
+  assert_true(az_span_is_content_equal(payload, AZ_SPAN_FROM_STR("[{\"temperature\":21.5}]")));
+}
+
+static void test_az_iot_hub_client_telemetry_batch_max_payload_size_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t payload_buffer[TEST_PAYLOAD_BUFFER_SIZE];
+  az_iot_hub_client_telemetry_batch_options options
+      = az_iot_hub_client_telemetry_batch_options_default();
+  options.max_payload_size = 44;
+
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, AZ_SPAN_FROM_BUFFER(payload_buffer), AZ_SPAN_EMPTY, &options),
+      AZ_OK);
+
+  // "[" + 2 * 20 bytes + "," + "]" is 43 bytes, and a third reading doesn't fit.
+  will_return(__wrap_az_platform_clock_msec, 0);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append(&batch, test_reading), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append(&batch, test_reading), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_append(&batch, test_reading), AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_get_count(&batch), 2);
+
+  // A reading larger than the maximum payload size never fits.
+  assert_int_equal(az_iot_hub_client_telemetry_batch_reset(&batch), AZ_OK);
+  will_return(__wrap_az_platform_clock_msec, 0);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_append(
+          &batch, AZ_SPAN_FROM_STR("\"a reading that is much longer than the payload limit\"")),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_get_count(&batch), 0);
+}
+
+static void test_az_iot_hub_client_telemetry_batch_should_publish_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t payload_buffer[TEST_PAYLOAD_BUFFER_SIZE];
+  az_iot_hub_client_telemetry_batch_options options
+      = az_iot_hub_client_telemetry_batch_options_default();
+  options.linger_msec = 500;
+
+  az_iot_hub_client_telemetry_batch batch;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_init(
+          &batch, AZ_SPAN_FROM_BUFFER(payload_buffer), AZ_SPAN_EMPTY, &options),
+      AZ_OK);
+
+  bool should_publish = true;
+  will_return(__wrap_az_platform_clock_msec, 1000);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append(&batch, test_reading), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_batch_append(&batch, test_reading), AZ_OK);
+
+  will_return(__wrap_az_platform_clock_msec, 1499);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_should_publish(&batch, &should_publish), AZ_OK);
+  assert_false(should_publish);
+
+  will_return(__wrap_az_platform_clock_msec, 1500);
+  assert_int_equal(
+      az_iot_hub_client_telemetry_batch_should_publish(&batch, &should_publish), AZ_OK);
+  assert_true(should_publish);
+}
+
+#endif // _az_MOCK_ENABLED
+
+int test_az_iot_hub_client_telemetry_batch()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_empty_succeed),
+#ifdef _az_MOCK_ENABLED
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_append_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_max_payload_size_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_batch_should_publish_succeed),
+#endif // _az_MOCK_ENABLED
+  };
+  return cmocka_run_group_tests_name("az_iot_hub_client_telemetry_batch", tests, NULL, NULL);
+}
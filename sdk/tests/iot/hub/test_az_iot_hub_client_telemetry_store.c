@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client_telemetry_store.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#define TEST_STORE_BUFFER_SIZE 256
+
+static const az_span test_topic = AZ_SPAN_LITERAL_FROM_STR("devices/my_device/messages/events/");
+
+static int test_sync_count = 0;
+
+static az_result test_sync_callback(void* context)
+{
+  (void)context;
+  test_sync_count++;
+  return AZ_OK;
+}
+
+static void test_store_append(az_iot_hub_client_telemetry_store* store, uint8_t value)
+{
+  uint8_t payload[8];
+  memset(payload, value, sizeof(payload));
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_append(
+          store, test_topic, az_span_create(payload, sizeof(payload))),
+      AZ_OK);
+}
+
+static void test_store_check_oldest(az_iot_hub_client_telemetry_store const* store, uint8_t value)
+{
+  az_iot_hub_client_telemetry_store_message message;
+  assert_int_equal(az_iot_hub_client_telemetry_store_peek(store, &message), AZ_OK);
+  assert_true(az_span_is_content_equal(message.topic, test_topic));
+  assert_int_equal(az_span_ptr(message.topic)[az_span_size(message.topic)], '\0');
+  assert_int_equal(az_span_size(message.payload), 8);
+  for (int32_t i = 0; i < 8; i++)
+  {
+    assert_int_equal(az_span_ptr(message.payload)[i], value);
+  }
+}
+
+static void test_az_iot_hub_client_telemetry_store_init_small_buffer_fails(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[AZ_IOT_HUB_CLIENT_TELEMETRY_STORE_MIN_BUFFER_SIZE - 1];
+  az_iot_hub_client_telemetry_store store;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&store, AZ_SPAN_FROM_BUFFER(buffer), NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_hub_client_telemetry_store_append_remove_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_STORE_BUFFER_SIZE] = { 0 };
+  az_iot_hub_client_telemetry_store store;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&store, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+
+  az_iot_hub_client_telemetry_store_message message;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_peek(&store, &message), AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(az_iot_hub_client_telemetry_store_remove(&store), AZ_ERROR_ITEM_NOT_FOUND);
+
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    test_store_append(&store, i);
+  }
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&store), 3);
+
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    test_store_check_oldest(&store, i);
+    assert_int_equal(az_iot_hub_client_telemetry_store_peek(&store, &message), AZ_OK);
+    assert_int_equal(message.sequence, i);
+    assert_int_equal(az_iot_hub_client_telemetry_store_remove(&store), AZ_OK);
+  }
+
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&store), 0);
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_evicted_count(&store), 0);
+
+  // A message larger than the store is rejected.
+  uint8_t large_payload[TEST_STORE_BUFFER_SIZE];
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_append(
+          &store, test_topic, AZ_SPAN_FROM_BUFFER(large_payload)),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_hub_client_telemetry_store_evicts_oldest_succeed(void** state)
+{
+  (void)state;
+
+  // Each record takes 20 + 35 + 8 bytes rounded up to 64, and the ring has 208 bytes, so three
+  // records fit and the fourth wraps around.
+  uint8_t buffer[TEST_STORE_BUFFER_SIZE] = { 0 };
+  az_iot_hub_client_telemetry_store store;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&store, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+
+  for (uint8_t i = 1; i <= 10; i++)
+  {
+    test_store_append(&store, i);
+  }
+
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&store), 3);
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_evicted_count(&store), 7);
+
+  for (uint8_t i = 8; i <= 10; i++)
+  {
+    test_store_check_oldest(&store, i);
+    assert_int_equal(az_iot_hub_client_telemetry_store_remove(&store), AZ_OK);
+  }
+}
+
+static void test_az_iot_hub_client_telemetry_store_recover_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_STORE_BUFFER_SIZE] = { 0 };
+  az_iot_hub_client_telemetry_store_options options
+      = az_iot_hub_client_telemetry_store_options_default();
+  options.sync_callback = test_sync_callback;
+  options.sync_interval = 2;
+  test_sync_count = 0;
+
+  az_iot_hub_client_telemetry_store store;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&store, AZ_SPAN_FROM_BUFFER(buffer), &options),
+      AZ_OK);
+
+  // Messages 1 and 2 are published, then messages 4 and 5 wrap around to the start of the ring.
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    test_store_append(&store, i);
+  }
+  assert_int_equal(az_iot_hub_client_telemetry_store_remove(&store), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_store_remove(&store), AZ_OK);
+  test_store_append(&store, 4);
+  test_store_append(&store, 5);
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_evicted_count(&store), 0);
+
+  // The first append syncs the new header, the append after the removals syncs the new head
+  // before reusing their space, and every second append syncs.
+  assert_int_equal(test_sync_count, 4);
+  assert_int_equal(az_iot_hub_client_telemetry_store_sync(&store), AZ_OK);
+  assert_int_equal(test_sync_count, 5);
+
+  // Reopening the buffer recovers messages 3 to 5, across the wrap.
+  az_iot_hub_client_telemetry_store recovered;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&recovered, AZ_SPAN_FROM_BUFFER(buffer), &options),
+      AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&recovered), 3);
+
+  for (uint8_t i = 3; i <= 5; i++)
+  {
+    az_iot_hub_client_telemetry_store_message message;
+    assert_int_equal(az_iot_hub_client_telemetry_store_peek(&recovered, &message), AZ_OK);
+    assert_int_equal(message.sequence, i);
+    test_store_check_oldest(&recovered, i);
+    assert_int_equal(az_iot_hub_client_telemetry_store_remove(&recovered), AZ_OK);
+  }
+
+  // Appending to the recovered store continues the sequence.
+  test_store_append(&recovered, 6);
+  az_iot_hub_client_telemetry_store_message message;
+  assert_int_equal(az_iot_hub_client_telemetry_store_peek(&recovered, &message), AZ_OK);
+  assert_int_equal(message.sequence, 6);
+
+  // A buffer of a different size is not recovered.
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(
+          &recovered, az_span_create(buffer, TEST_STORE_BUFFER_SIZE - 4), &options),
+      AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&recovered), 0);
+}
+
+static void test_az_iot_hub_client_telemetry_store_recover_torn_record_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_STORE_BUFFER_SIZE] = { 0 };
+  az_iot_hub_client_telemetry_store store;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&store, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    test_store_append(&store, i);
+  }
+
+  // Corrupt the payload of the second message, as if the write was interrupted: the second and
+  // third messages are discarded.
+  az_iot_hub_client_telemetry_store_message message;
+  assert_int_equal(az_iot_hub_client_telemetry_store_remove(&store), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_store_peek(&store, &message), AZ_OK);
+  az_span_ptr(message.payload)[0] ^= 0xFF;
+
+  az_iot_hub_client_telemetry_store recovered;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&recovered, AZ_SPAN_FROM_BUFFER(buffer), NULL),
+      AZ_OK);
+
+  // The removal of the first message was never synced, so it is recovered.
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&recovered), 1);
+  test_store_check_oldest(&recovered, 1);
+}
+
+static void test_az_iot_hub_client_telemetry_store_format_discards_records_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_STORE_BUFFER_SIZE] = { 0 };
+  az_iot_hub_client_telemetry_store store;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_init(&store, AZ_SPAN_FROM_BUFFER(buffer), NULL), AZ_OK);
+
+  for (uint8_t i = 1; i <= 3; i++)
+  {
+    test_store_append(&store, i);
+  }
+  assert_int_equal(az_iot_hub_client_telemetry_store_sync(&store), AZ_OK);
+
+  // A buffer of a different size has no valid header, so the store is formatted. Its records
+  // still start at the beginning of the ring, in sequence from 1, with valid CRCs.
+  az_span const smaller_buffer = az_span_create(buffer, TEST_STORE_BUFFER_SIZE - 4);
+  assert_int_equal(az_iot_hub_client_telemetry_store_init(&store, smaller_buffer, NULL), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&store), 0);
+  assert_int_equal(az_iot_hub_client_telemetry_store_sync(&store), AZ_OK);
+
+  // Reopening the formatted store must not recover them.
+  az_iot_hub_client_telemetry_store reopened;
+  assert_int_equal(az_iot_hub_client_telemetry_store_init(&reopened, smaller_buffer, NULL), AZ_OK);
+  assert_int_equal(az_iot_hub_client_telemetry_store_get_count(&reopened), 0);
+
+  az_iot_hub_client_telemetry_store_message message;
+  assert_int_equal(
+      az_iot_hub_client_telemetry_store_peek(&reopened, &message), AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+int test_az_iot_hub_client_telemetry_store()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_store_init_small_buffer_fails),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_store_append_remove_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_store_evicts_oldest_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_store_recover_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_store_recover_torn_record_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_telemetry_store_format_discards_records_succeed),
+  };
+  return cmocka_run_group_tests_name("az_iot_hub_client_telemetry_store", tests, NULL, NULL);
+}
@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client_twin_shadow.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#define TEST_SHADOW_BUFFER_SIZE 512
+
+static const az_span test_twin_document = AZ_SPAN_LITERAL_FROM_STR(
+    "{\"desired\":{\"a\":1,\"b\":{\"c\":\"x\",\"d\":[1,2]},\"e\":true,\"$version\":4},"
+    "\"reported\":{\"a\":1,\"$version\":7}}");
+
+static void test_assert_document(az_iot_hub_client_twin_shadow const* shadow, char const* expected)
+{
+  az_span const document = az_iot_hub_client_twin_shadow_get_document(shadow);
+  assert_int_equal(az_span_size(document), (int32_t)strlen(expected));
+  assert_memory_equal(az_span_ptr(document), expected, (size_t)az_span_size(document));
+}
+
+static void test_az_iot_hub_client_twin_shadow_apply_patch_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_SHADOW_BUFFER_SIZE];
+  az_iot_hub_client_twin_shadow shadow;
+  assert_int_equal(az_iot_hub_client_twin_shadow_init(&shadow, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  assert_int_equal(az_iot_hub_client_twin_shadow_get_version(&shadow), -1);
+
+  assert_int_equal(az_iot_hub_client_twin_shadow_set_document(&shadow, test_twin_document), AZ_OK);
+  assert_int_equal(az_iot_hub_client_twin_shadow_get_version(&shadow), 4);
+  test_assert_document(
+      &shadow, "{\"a\":1,\"b\":{\"c\":\"x\",\"d\":[1,2]},\"e\":true,\"$version\":4}");
+
+  // Removes "a", merges "b", keeps "e", and adds "i"; nulls in new objects are dropped.
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow,
+          AZ_SPAN_FROM_STR("{\"a\":null,\"b\":{\"c\":\"y\",\"f\":{\"g\":null,\"h\":2}},"
+                           "\"i\":\"new\",\"$version\":5}")),
+      AZ_OK);
+  assert_int_equal(az_iot_hub_client_twin_shadow_get_version(&shadow), 5);
+  test_assert_document(
+      &shadow,
+      "{\"b\":{\"c\":\"y\",\"d\":[1,2],\"f\":{\"h\":2}},\"e\":true,\"$version\":5,\"i\":\"new\"}");
+
+  // Arrays and objects are replaced by values of another kind, in both directions.
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"b\":[null],\"e\":{\"x\":null},\"$version\":6}")),
+      AZ_OK);
+  test_assert_document(&shadow, "{\"b\":[null],\"e\":{},\"$version\":6,\"i\":\"new\"}");
+
+  // Escaped names are matched by their unescaped text.
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"i\":\"tab\\t\",\"q\\\"\":1,\"$version\":7}")),
+      AZ_OK);
+  test_assert_document(
+      &shadow, "{\"b\":[null],\"e\":{},\"$version\":7,\"i\":\"tab\\t\",\"q\\\"\":1}");
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"q\\\"\":null,\"$version\":8}")),
+      AZ_OK);
+  test_assert_document(&shadow, "{\"b\":[null],\"e\":{},\"$version\":8,\"i\":\"tab\\t\"}");
+}
+
+static void test_az_iot_hub_client_twin_shadow_version_gap_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[TEST_SHADOW_BUFFER_SIZE];
+  az_iot_hub_client_twin_shadow shadow;
+  assert_int_equal(az_iot_hub_client_twin_shadow_init(&shadow, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+
+  // Without a document, every patch is a gap.
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(&shadow, AZ_SPAN_FROM_STR("{\"$version\":1}")),
+      AZ_ERROR_IOT_TWIN_VERSION_GAP);
+
+  assert_int_equal(az_iot_hub_client_twin_shadow_set_document(&shadow, test_twin_document), AZ_OK);
+  az_span const document = az_iot_hub_client_twin_shadow_get_document(&shadow);
+
+  // Old and duplicate patches are ignored.
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"a\":2,\"$version\":4}")),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"a\":2,\"$version\":3}")),
+      AZ_OK);
+
+  // A missed patch leaves the shadow unchanged.
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"a\":2,\"$version\":6}")),
+      AZ_ERROR_IOT_TWIN_VERSION_GAP);
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(&shadow, AZ_SPAN_FROM_STR("{\"a\":2}")),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  assert_int_equal(az_iot_hub_client_twin_shadow_get_version(&shadow), 4);
+  assert_true(
+      az_span_is_content_equal(az_iot_hub_client_twin_shadow_get_document(&shadow), document));
+
+  // The full twin resynchronizes the shadow.
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_set_document(
+          &shadow, AZ_SPAN_FROM_STR("{\"reported\":{},\"desired\":{\"a\":2,\"$version\":6}}")),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"a\":3,\"$version\":7}")),
+      AZ_OK);
+  test_assert_document(&shadow, "{\"a\":3,\"$version\":7}");
+
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_set_document(
+          &shadow, AZ_SPAN_FROM_STR("{\"reported\":{\"$version\":1}}")),
+      AZ_ERROR_ITEM_NOT_FOUND);
+}
+
+static void test_az_iot_hub_client_twin_shadow_not_enough_space_fails(void** state)
+{
+  (void)state;
+
+  // Each half holds the document, but not the 64 bytes of writer slack for a merge.
+  uint8_t buffer[2 * 96];
+  az_iot_hub_client_twin_shadow shadow;
+  assert_int_equal(az_iot_hub_client_twin_shadow_init(&shadow, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  assert_int_equal(az_iot_hub_client_twin_shadow_set_document(&shadow, test_twin_document), AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_apply_patch(
+          &shadow, AZ_SPAN_FROM_STR("{\"z\":\"a value that makes the document too long\","
+                                    "\"$version\":5}")),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_iot_hub_client_twin_shadow_get_version(&shadow), 4);
+  test_assert_document(
+      &shadow, "{\"a\":1,\"b\":{\"c\":\"x\",\"d\":[1,2]},\"e\":true,\"$version\":4}");
+
+  uint8_t small_buffer[2 * 32];
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_init(&shadow, AZ_SPAN_FROM_BUFFER(small_buffer)), AZ_OK);
+  assert_int_equal(
+      az_iot_hub_client_twin_shadow_set_document(&shadow, test_twin_document),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+int test_az_iot_hub_client_twin_shadow()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_hub_client_twin_shadow_apply_patch_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_twin_shadow_version_gap_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_twin_shadow_not_enough_space_fails),
+  };
+  return cmocka_run_group_tests_name("az_iot_hub_client_twin_shadow", tests, NULL, NULL);
+}
@@ -0,0 +1,395 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_hub_client.h"
+#include <azure/core/az_span.h>
+#include <azure/iot/az_iot_hub_client.h>
+#include <azure/iot/az_iot_hub_gateway.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmocka.h>
+
+#define TEST_DEVICE_COUNT 100
+#define TEST_BUCKET_COUNT 256
+#define TEST_DEVICE_ID_SIZE 16
+#define TEST_TOPIC_PREFIX_SLOT_SIZE 32
+
+static const az_span test_device_hostname = AZ_SPAN_LITERAL_FROM_STR("myiothub.azure-devices.net");
+
+static char test_device_ids[TEST_DEVICE_COUNT][TEST_DEVICE_ID_SIZE];
+
+static az_span test_get_device_id(int32_t i)
+{
+  int const length = snprintf(test_device_ids[i], TEST_DEVICE_ID_SIZE, "leaf-%d", (int)i);
+  return az_span_create((uint8_t*)test_device_ids[i], length);
+}
+
+static uint8_t test_topic_prefixes[TEST_DEVICE_COUNT * TEST_TOPIC_PREFIX_SLOT_SIZE];
+
+static void test_init_gateway(
+    az_iot_hub_gateway* gateway,
+    az_iot_hub_gateway_device* devices,
+    int32_t* buckets)
+{
+  assert_int_equal(
+      az_iot_hub_gateway_init(
+          gateway,
+          test_device_hostname,
+          devices,
+          TEST_DEVICE_COUNT,
+          AZ_SPAN_FROM_BUFFER(test_topic_prefixes),
+          buckets,
+          TEST_BUCKET_COUNT),
+      AZ_OK);
+}
+
+// Checks that the cached topic prefix of the device at device_index is the one of device i.
+static void
+test_check_topic_prefix(az_iot_hub_gateway const* gateway, int32_t device_index, int32_t i)
+{
+  char expected[TEST_TOPIC_PREFIX_SLOT_SIZE];
+  int const length = snprintf(expected, sizeof(expected), "devices/leaf-%d/", (int)i);
+  assert_true(az_span_is_content_equal(
+      az_iot_hub_gateway_get_device_topic_prefix(gateway, device_index),
+      az_span_create((uint8_t*)expected, length)));
+}
+
+static void test_add_devices(
+    az_iot_hub_gateway* gateway,
+    az_iot_hub_gateway_device* devices,
+    int32_t* buckets)
+{
+  test_init_gateway(gateway, devices, buckets);
+
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    int32_t device_index = -1;
+    assert_int_equal(
+        az_iot_hub_gateway_add_device(gateway, test_get_device_id(i), NULL, NULL, &device_index),
+        AZ_OK);
+    assert_int_equal(device_index, i);
+  }
+}
+
+static void test_az_iot_hub_gateway_add_find_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_gateway_device devices[TEST_DEVICE_COUNT];
+  int32_t buckets[TEST_BUCKET_COUNT];
+  az_iot_hub_gateway gateway;
+  test_add_devices(&gateway, devices, buckets);
+
+  assert_int_equal(az_iot_hub_gateway_get_device_count(&gateway), TEST_DEVICE_COUNT);
+
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    int32_t device_index = -1;
+    assert_int_equal(
+        az_iot_hub_gateway_find_device(
+            &gateway, test_get_device_id(i), AZ_SPAN_EMPTY, &device_index),
+        AZ_OK);
+    assert_int_equal(device_index, i);
+    assert_true(az_span_is_content_equal(
+        az_iot_hub_gateway_get_device_client(&gateway, i)->_internal.device_id,
+        test_get_device_id(i)));
+    test_check_topic_prefix(&gateway, i, i);
+  }
+
+  int32_t device_index = -1;
+  assert_int_equal(
+      az_iot_hub_gateway_find_device(
+          &gateway, AZ_SPAN_FROM_STR("leaf-100"), AZ_SPAN_EMPTY, &device_index),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      az_iot_hub_gateway_find_device(
+          &gateway, test_get_device_id(1), AZ_SPAN_FROM_STR("module"), &device_index),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // Duplicates are rejected, and so are new devices once the gateway is full.
+  assert_int_equal(
+      az_iot_hub_gateway_add_device(&gateway, test_get_device_id(7), NULL, NULL, NULL),
+      AZ_ERROR_ARG);
+  assert_int_equal(
+      az_iot_hub_gateway_add_device(&gateway, AZ_SPAN_FROM_STR("leaf-100"), NULL, NULL, NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_hub_gateway_remove_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_gateway_device devices[TEST_DEVICE_COUNT];
+  int32_t buckets[TEST_BUCKET_COUNT];
+  az_iot_hub_gateway gateway;
+  test_add_devices(&gateway, devices, buckets);
+
+  // Remove the even devices, always through their current index.
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i += 2)
+  {
+    int32_t device_index = -1;
+    assert_int_equal(
+        az_iot_hub_gateway_find_device(
+            &gateway, test_get_device_id(i), AZ_SPAN_EMPTY, &device_index),
+        AZ_OK);
+    assert_int_equal(az_iot_hub_gateway_remove_device(&gateway, device_index), AZ_OK);
+  }
+
+  assert_int_equal(az_iot_hub_gateway_get_device_count(&gateway), TEST_DEVICE_COUNT / 2);
+
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    int32_t device_index = -1;
+    az_result const result = az_iot_hub_gateway_find_device(
+        &gateway, test_get_device_id(i), AZ_SPAN_EMPTY, &device_index);
+    if (i % 2 == 0)
+    {
+      assert_int_equal(result, AZ_ERROR_ITEM_NOT_FOUND);
+    }
+    else
+    {
+      assert_int_equal(result, AZ_OK);
+      assert_true(az_span_is_content_equal(
+          az_iot_hub_gateway_get_device_client(&gateway, device_index)->_internal.device_id,
+          test_get_device_id(i)));
+      // The prefixes of the devices moved by the removals moved along.
+      test_check_topic_prefix(&gateway, device_index, i);
+    }
+  }
+
+  // Removed devices can be added again.
+  assert_int_equal(
+      az_iot_hub_gateway_add_device(&gateway, test_get_device_id(0), NULL, NULL, NULL), AZ_OK);
+}
+
+static void test_az_iot_hub_gateway_route_received_topic_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_gateway_device devices[4];
+  uint8_t topic_prefixes[4 * 48];
+  int32_t buckets[8];
+  az_iot_hub_gateway gateway;
+  assert_int_equal(
+      az_iot_hub_gateway_init(
+          &gateway,
+          test_device_hostname,
+          devices,
+          4,
+          AZ_SPAN_FROM_BUFFER(topic_prefixes),
+          buckets,
+          8),
+      AZ_OK);
+
+  int context = 0;
+  az_iot_hub_client_options options = az_iot_hub_client_options_default();
+  options.module_id = AZ_SPAN_FROM_STR("my_module");
+
+  int32_t device_index = -1;
+  int32_t module_index = -1;
+  assert_int_equal(
+      az_iot_hub_gateway_add_device(
+          &gateway, AZ_SPAN_FROM_STR("my_device"), NULL, &context, &device_index),
+      AZ_OK);
+  assert_int_equal(
+      az_iot_hub_gateway_add_device(
+          &gateway, AZ_SPAN_FROM_STR("my_device"), &options, NULL, &module_index),
+      AZ_OK);
+  assert_ptr_equal(az_iot_hub_gateway_get_device_user_context(&gateway, device_index), &context);
+  assert_true(az_span_is_content_equal(
+      az_iot_hub_gateway_get_device_topic_prefix(&gateway, device_index),
+      AZ_SPAN_FROM_STR("devices/my_device/")));
+  assert_true(az_span_is_content_equal(
+      az_iot_hub_gateway_get_device_topic_prefix(&gateway, module_index),
+      AZ_SPAN_FROM_STR("devices/my_device/modules/my_module/")));
+
+  // The topic prefix of a device must fit in its slot of 48 bytes.
+  az_iot_hub_client_options long_options = az_iot_hub_client_options_default();
+  long_options.module_id = AZ_SPAN_FROM_STR("a_module_with_a_long_name");
+  assert_int_equal(
+      az_iot_hub_gateway_add_device(
+          &gateway, AZ_SPAN_FROM_STR("my_device"), &long_options, NULL, NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_iot_hub_gateway_get_device_count(&gateway), 2);
+
+  int32_t routed_index = -1;
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway,
+          AZ_SPAN_FROM_STR("devices/my_device/messages/devicebound/%24.to=%2Fdevices%2Fmy_device"),
+          &routed_index),
+      AZ_OK);
+  assert_int_equal(routed_index, device_index);
+
+  // The routed device's client parses the topic.
+  az_iot_hub_client_c2d_request request;
+  assert_int_equal(
+      az_iot_hub_client_c2d_parse_received_topic(
+          az_iot_hub_gateway_get_device_client(&gateway, routed_index),
+          AZ_SPAN_FROM_STR("devices/my_device/messages/devicebound/%24.to=%2Fdevices%2Fmy_device"),
+          &request),
+      AZ_OK);
+
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway,
+          AZ_SPAN_FROM_STR("devices/my_device/modules/my_module/inputs/input1/"),
+          &routed_index),
+      AZ_OK);
+  assert_int_equal(routed_index, module_index);
+
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway, AZ_SPAN_FROM_STR("devices/other_device/messages/devicebound/"), &routed_index),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway, AZ_SPAN_FROM_STR("devices/my_device/modules/other/inputs/"), &routed_index),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway, AZ_SPAN_FROM_STR("devices/my_device/modules/"), &routed_index),
+      AZ_OK);
+  assert_int_equal(routed_index, device_index);
+
+  // Twin, method and command topics do not name the device.
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway, AZ_SPAN_FROM_STR("$iothub/methods/POST/reboot/?$rid=1"), &routed_index),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway, AZ_SPAN_FROM_STR("$iothub/twin/res/200/?$rid=2"), &routed_index),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+  assert_int_equal(
+      az_iot_hub_gateway_route_received_topic(
+          &gateway, AZ_SPAN_FROM_STR("devices/my_device"), &routed_index),
+      AZ_ERROR_IOT_TOPIC_NO_MATCH);
+}
+
+static void test_az_iot_hub_gateway_get_next_sas_expiration_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_gateway_device devices[TEST_DEVICE_COUNT];
+  int32_t buckets[TEST_BUCKET_COUNT];
+  az_iot_hub_gateway gateway;
+  test_init_gateway(&gateway, devices, buckets);
+
+  int32_t device_index = -1;
+  assert_int_equal(
+      az_iot_hub_gateway_get_next_sas_expiration(&gateway, &device_index),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  test_add_devices(&gateway, devices, buckets);
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    az_iot_hub_gateway_set_device_sas_expiration(&gateway, i, 1000U + (uint64_t)((i * 37) % 101));
+  }
+
+  // (i * 37) % 101 is 0 only for i == 0, then 1 for i == 71.
+  assert_int_equal(az_iot_hub_gateway_get_next_sas_expiration(&gateway, &device_index), AZ_OK);
+  assert_int_equal(device_index, 0);
+
+  az_iot_hub_gateway_set_device_sas_expiration(&gateway, 0, 5000);
+  assert_int_equal(az_iot_hub_gateway_get_next_sas_expiration(&gateway, &device_index), AZ_OK);
+  assert_int_equal(device_index, 71);
+  assert_int_equal(az_iot_hub_gateway_get_device_sas_expiration(&gateway, device_index), 1001);
+}
+
+// Checks that the device found to renew first has the earliest expiration of all devices.
+static void test_check_next_sas_expiration(az_iot_hub_gateway const* gateway)
+{
+  uint64_t earliest = UINT64_MAX;
+  for (int32_t i = 0; i < az_iot_hub_gateway_get_device_count(gateway); i++)
+  {
+    uint64_t const expiration = az_iot_hub_gateway_get_device_sas_expiration(gateway, i);
+    earliest = expiration < earliest ? expiration : earliest;
+  }
+
+  int32_t device_index = -1;
+  assert_int_equal(az_iot_hub_gateway_get_next_sas_expiration(gateway, &device_index), AZ_OK);
+  assert_int_equal(az_iot_hub_gateway_get_device_sas_expiration(gateway, device_index), earliest);
+}
+
+static void test_az_iot_hub_gateway_get_next_sas_expiration_after_changes_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_hub_gateway_device devices[TEST_DEVICE_COUNT];
+  int32_t buckets[TEST_BUCKET_COUNT];
+  az_iot_hub_gateway gateway;
+  test_add_devices(&gateway, devices, buckets);
+
+  // Renewing the device that expires first, as an application does, walks the devices in order of
+  // expiration.
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    az_iot_hub_gateway_set_device_sas_expiration(&gateway, i, 1000U + (uint64_t)((i * 37) % 101));
+  }
+  uint64_t previous = 0;
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    int32_t device_index = -1;
+    assert_int_equal(az_iot_hub_gateway_get_next_sas_expiration(&gateway, &device_index), AZ_OK);
+    uint64_t const expiration
+        = az_iot_hub_gateway_get_device_sas_expiration(&gateway, device_index);
+    assert_true(expiration > previous);
+    previous = expiration;
+    az_iot_hub_gateway_set_device_sas_expiration(&gateway, device_index, 5000U + (uint64_t)i);
+  }
+  test_check_next_sas_expiration(&gateway);
+
+  // Expirations set earlier or later, and devices removed and added again, keep the order.
+  uint32_t random = 1;
+  for (int32_t step = 0; step < 1000; step++)
+  {
+    random = (random * 1103515245U) + 12345U;
+    int32_t const count = az_iot_hub_gateway_get_device_count(&gateway);
+    int32_t const device_index = (int32_t)((random >> 8U) % (uint32_t)count);
+
+    if (step % 7 == 0 && count > 1)
+    {
+      assert_int_equal(az_iot_hub_gateway_remove_device(&gateway, device_index), AZ_OK);
+    }
+    else if (step % 11 == 0 && count < TEST_DEVICE_COUNT)
+    {
+      // A device removed before is added again, with no expiration.
+      int32_t added_index = -1;
+      az_span const device_id = test_get_device_id(step % TEST_DEVICE_COUNT);
+      if (az_iot_hub_gateway_find_device(&gateway, device_id, AZ_SPAN_EMPTY, &added_index)
+          == AZ_ERROR_ITEM_NOT_FOUND)
+      {
+        assert_int_equal(
+            az_iot_hub_gateway_add_device(&gateway, device_id, NULL, NULL, &added_index), AZ_OK);
+        assert_int_equal(az_iot_hub_gateway_get_device_sas_expiration(&gateway, added_index), 0);
+        test_check_next_sas_expiration(&gateway);
+        az_iot_hub_gateway_set_device_sas_expiration(&gateway, added_index, 3000U + random % 4096U);
+      }
+    }
+    else
+    {
+      az_iot_hub_gateway_set_device_sas_expiration(
+          &gateway, device_index, 3000U + (random >> 16U) % 4096U);
+    }
+
+    test_check_next_sas_expiration(&gateway);
+  }
+}
+
+int test_az_iot_hub_gateway()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_iot_hub_gateway_add_find_succeed),
+    cmocka_unit_test(test_az_iot_hub_gateway_remove_succeed),
+    cmocka_unit_test(test_az_iot_hub_gateway_route_received_topic_succeed),
+    cmocka_unit_test(test_az_iot_hub_gateway_get_next_sas_expiration_succeed),
+    cmocka_unit_test(test_az_iot_hub_gateway_get_next_sas_expiration_after_changes_succeed),
+  };
+  return cmocka_run_group_tests_name("az_iot_hub_gateway", tests, NULL, NULL);
+}
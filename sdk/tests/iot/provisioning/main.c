@@ -16,6 +16,7 @@ int main()
   int result = 0;
 
   result += test_az_iot_provisioning_client();
+  result += test_az_iot_provisioning_client_batch();
   result += test_az_iot_provisioning_client_sas_token();
   result += test_az_iot_provisioning_client_parser();
   result += test_az_iot_provisioning_client_register_get_request_payload();
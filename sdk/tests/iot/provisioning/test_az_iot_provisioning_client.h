@@ -4,6 +4,7 @@
 // Placeholder for int test_iot_provisioning_(); declarations
 
 int test_az_iot_provisioning_client();
+int test_az_iot_provisioning_client_batch();
 int test_az_iot_provisioning_client_sas_token();
 int test_az_iot_provisioning_client_parser();
 int test_az_iot_provisioning_client_register_get_request_payload();
@@ -0,0 +1,540 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_iot_provisioning_client.h"
+#include <az_test_precondition.h>
+#include <azure/core/az_precondition.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/iot/az_iot_provisioning_client.h>
+#include <azure/iot/az_iot_provisioning_client_batch.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#define TEST_ID_SCOPE "0neFEEDC0DE"
+#define TEST_DEVICE_COUNT 4
+#define TEST_TOPIC_BUFFER_SIZE 128
+#define TEST_PASSWORD_BUFFER_SIZE 256
+
+// 64 bytes, from 0x00 to 0x3F.
+#define TEST_GROUP_KEY                                                                     \
+  "AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8gISIjJCUmJygpKissLS4vMDEyMzQ1Njc4OTo7PD0+" \
+  "Pw=="
+
+static const az_span test_global_device_hostname
+    = AZ_SPAN_LITERAL_FROM_STR("global.azure-devices-provisioning.net");
+static const az_span test_id_scope = AZ_SPAN_LITERAL_FROM_STR(TEST_ID_SCOPE);
+static const az_span test_group_key = AZ_SPAN_LITERAL_FROM_STR(TEST_GROUP_KEY);
+static const az_span test_registration_ids[TEST_DEVICE_COUNT] = {
+  AZ_SPAN_LITERAL_FROM_STR("factory-device-0000"),
+  AZ_SPAN_LITERAL_FROM_STR("factory-device-0001"),
+  AZ_SPAN_LITERAL_FROM_STR("factory-device-0002"),
+  AZ_SPAN_LITERAL_FROM_STR("factory-device-0003"),
+};
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+ENABLE_PRECONDITION_CHECK_TESTS()
+
+static void test_az_iot_provisioning_client_batch_init_NULL_registrations_fails(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client_batch batch;
+  ASSERT_PRECONDITION_CHECKED(az_iot_provisioning_client_batch_init(
+      &batch, test_global_device_hostname, test_id_scope, NULL, TEST_DEVICE_COUNT, NULL));
+}
+
+static void test_az_iot_provisioning_client_batch_derive_device_key_empty_group_key_fails(
+    void** state)
+{
+  (void)state;
+
+  uint8_t device_key_buffer[AZ_IOT_PROVISIONING_CLIENT_BATCH_DEVICE_KEY_BUFFER_SIZE];
+  az_span device_key;
+  ASSERT_PRECONDITION_CHECKED(az_iot_provisioning_client_batch_derive_device_key(
+      AZ_SPAN_EMPTY,
+      test_registration_ids[0],
+      AZ_SPAN_FROM_BUFFER(device_key_buffer),
+      &device_key));
+}
+
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+static void test_az_iot_provisioning_client_batch_derive_device_key_succeed(void** state)
+{
+  (void)state;
+
+  uint8_t device_key_buffer[AZ_IOT_PROVISIONING_CLIENT_BATCH_DEVICE_KEY_BUFFER_SIZE];
+  az_span device_key;
+
+  // RFC 4231, test case 2: the key is "Jefe".
+  assert_int_equal(
+      az_iot_provisioning_client_batch_derive_device_key(
+          AZ_SPAN_FROM_STR("SmVmZQ=="),
+          AZ_SPAN_FROM_STR("what do ya want for nothing?"),
+          AZ_SPAN_FROM_BUFFER(device_key_buffer),
+          &device_key),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(
+      device_key, AZ_SPAN_FROM_STR("W9zBRr9gdU5qBCQmCJV1x1oAPwidJzmDnexYuWTsOEM=")));
+
+  assert_int_equal(
+      az_iot_provisioning_client_batch_derive_device_key(
+          test_group_key,
+          test_registration_ids[1],
+          AZ_SPAN_FROM_BUFFER(device_key_buffer),
+          &device_key),
+      AZ_OK);
+  assert_true(az_span_is_content_equal(
+      device_key, AZ_SPAN_FROM_STR("FdN15WsgTPu+3hjIawc5m2hIZXkIVtokKk+JFx5pXho=")));
+}
+
+static void test_az_iot_provisioning_client_batch_derive_device_key_fail(void** state)
+{
+  (void)state;
+
+  uint8_t device_key_buffer[AZ_IOT_PROVISIONING_CLIENT_BATCH_DEVICE_KEY_BUFFER_SIZE];
+  az_span device_key;
+
+  assert_int_equal(
+      az_iot_provisioning_client_batch_derive_device_key(
+          test_group_key,
+          test_registration_ids[0],
+          az_span_slice(AZ_SPAN_FROM_BUFFER(device_key_buffer), 0, 43),
+          &device_key),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_derive_device_key(
+          AZ_SPAN_FROM_STR("Sm*mZQ=="),
+          test_registration_ids[0],
+          AZ_SPAN_FROM_BUFFER(device_key_buffer),
+          &device_key),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  // A 96 byte key.
+  assert_int_equal(
+      az_iot_provisioning_client_batch_derive_device_key(
+          AZ_SPAN_FROM_STR(TEST_GROUP_KEY "AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8="),
+          test_registration_ids[0],
+          AZ_SPAN_FROM_BUFFER(device_key_buffer),
+          &device_key),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_iot_provisioning_client_batch_sas_get_password_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client_batch_registration registrations[TEST_DEVICE_COUNT];
+  az_iot_provisioning_client_batch batch;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_init(
+          &batch,
+          test_global_device_hostname,
+          test_id_scope,
+          registrations,
+          TEST_DEVICE_COUNT,
+          NULL),
+      AZ_OK);
+
+  // The registration is set up directly, as adding it reads the platform clock.
+  registrations[1]._internal.registration_id = test_registration_ids[1];
+  registrations[1]._internal.status = AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_PENDING;
+
+  char password[TEST_PASSWORD_BUFFER_SIZE];
+  size_t password_length = 0;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_sas_get_password(
+          &batch, 1, test_group_key, 1578941692, password, sizeof(password), &password_length),
+      AZ_OK);
+
+  char const expected_password[]
+      = "SharedAccessSignature sr=" TEST_ID_SCOPE "%2fregistrations%2ffactory-device-0001"
+        "&sig=gpWIp1afypE%2FY%2F0mT58alnkqgg5Ufs65nRLHpxdJlS4%3D&se=1578941692";
+  assert_int_equal(password_length, sizeof(expected_password) - 1);
+  assert_string_equal(password, expected_password);
+
+  assert_int_equal(
+      az_iot_provisioning_client_batch_sas_get_password(
+          &batch, 1, test_group_key, 1578941692, password, sizeof(expected_password) - 1, NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+#ifdef _az_MOCK_ENABLED
+
+static int64_t test_clock_msec = 0;
+
+az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec);
+az_result __wrap_az_platform_clock_msec(int64_t* out_clock_msec)
+{
+  *out_clock_msec = test_clock_msec;
+  return AZ_OK;
+}
+
+// A stand-in for the Device Provisioning Service, answering the requests of each test device its
+// own way:
+// 0. Assigned at the second query, the first one answered without retry-after.
+// 1. The first register request is throttled.
+// 2. The enrollment is disabled.
+// 3. The first register request gets no response.
+typedef struct
+{
+  int32_t register_count[TEST_DEVICE_COUNT];
+  int32_t query_count[TEST_DEVICE_COUNT];
+} test_dps;
+
+#define TEST_OPERATION_ID_0 "4.d0a671905ea5b2c8.00000000-0000-0000-0000-000000000000"
+#define TEST_OPERATION_ID_1 "4.d0a671905ea5b2c8.11111111-1111-1111-1111-111111111111"
+#define TEST_OPERATION_ID_2 "4.d0a671905ea5b2c8.22222222-2222-2222-2222-222222222222"
+#define TEST_OPERATION_ID_3 "4.d0a671905ea5b2c8.33333333-3333-3333-3333-333333333333"
+
+#define TEST_ASSIGNING_PAYLOAD(operation_id) \
+  "{\"operationId\":\"" operation_id "\",\"status\":\"assigning\"}"
+
+#define TEST_ASSIGNED_PAYLOAD(operation_id)                                                  \
+  "{\"operationId\":\"" operation_id "\",\"status\":\"assigned\",\"registrationState\":{" \
+  "\"assignedHub\":\"contoso.azure-devices.net\",\"deviceId\":\"device\","                   \
+  "\"status\":\"assigned\",\"substatus\":\"initialAssignment\"}}"
+
+static const char* const test_operation_ids[TEST_DEVICE_COUNT] = {
+  TEST_OPERATION_ID_0,
+  TEST_OPERATION_ID_1,
+  TEST_OPERATION_ID_2,
+  TEST_OPERATION_ID_3,
+};
+
+static const az_span test_assigning_payloads[TEST_DEVICE_COUNT] = {
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNING_PAYLOAD(TEST_OPERATION_ID_0)),
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNING_PAYLOAD(TEST_OPERATION_ID_1)),
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNING_PAYLOAD(TEST_OPERATION_ID_2)),
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNING_PAYLOAD(TEST_OPERATION_ID_3)),
+};
+
+static const az_span test_assigned_payloads[TEST_DEVICE_COUNT] = {
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNED_PAYLOAD(TEST_OPERATION_ID_0)),
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNED_PAYLOAD(TEST_OPERATION_ID_1)),
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNED_PAYLOAD(TEST_OPERATION_ID_2)),
+  AZ_SPAN_LITERAL_FROM_STR(TEST_ASSIGNED_PAYLOAD(TEST_OPERATION_ID_3)),
+};
+
+// Returns false when the request gets no response.
+static bool test_dps_respond(
+    test_dps* ref_dps,
+    int32_t device,
+    az_iot_provisioning_client_batch_request request,
+    char const* topic,
+    az_span* out_topic,
+    az_span* out_payload)
+{
+  if (request == AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_REGISTER)
+  {
+    assert_string_equal(topic, "$dps/registrations/PUT/iotdps-register/?$rid=1");
+    int32_t const count = ++ref_dps->register_count[device];
+    if (device == 1 && count == 1)
+    {
+      *out_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/429/?$rid=1&retry-after=5");
+      *out_payload = AZ_SPAN_FROM_STR(
+          "{\"errorCode\":429001,\"trackingId\":\"tracking\",\"message\":\"Throttled.\","
+          "\"timestampUtc\":\"2020-04-10T05:24:22.4718526Z\"}");
+      return true;
+    }
+    if (device == 2)
+    {
+      *out_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/200/?$rid=1");
+      *out_payload = AZ_SPAN_FROM_STR(
+          "{\"operationId\":\"" TEST_OPERATION_ID_2 "\",\"status\":\"disabled\"}");
+      return true;
+    }
+    if (device == 3 && count == 1)
+    {
+      return false;
+    }
+
+    *out_topic = device == 0 ? AZ_SPAN_FROM_STR("$dps/registrations/res/202/?$rid=1&retry-after=3")
+                             : AZ_SPAN_FROM_STR("$dps/registrations/res/202/?$rid=1&retry-after=1");
+    *out_payload = test_assigning_payloads[device];
+    return true;
+  }
+
+  assert_non_null(strstr(topic, test_operation_ids[device]));
+  int32_t const count = ++ref_dps->query_count[device];
+  if (device == 0 && count == 1)
+  {
+    *out_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/202/?$rid=1");
+    *out_payload = test_assigning_payloads[device];
+    return true;
+  }
+
+  *out_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/200/?$rid=1");
+  *out_payload = test_assigned_payloads[device];
+  return true;
+}
+
+typedef struct
+{
+  int64_t time_msec;
+  az_iot_provisioning_client_batch_request request;
+} test_request;
+
+static void test_az_iot_provisioning_client_batch_register_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client_batch_options options
+      = az_iot_provisioning_client_batch_options_default();
+  options.max_in_flight = 2;
+  options.response_timeout_msec = 10000;
+
+  az_iot_provisioning_client_batch_registration registrations[TEST_DEVICE_COUNT];
+  az_iot_provisioning_client_batch batch;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_init(
+          &batch,
+          test_global_device_hostname,
+          test_id_scope,
+          registrations,
+          TEST_DEVICE_COUNT,
+          &options),
+      AZ_OK);
+
+  test_clock_msec = 0;
+  for (int32_t i = 0; i < TEST_DEVICE_COUNT; i++)
+  {
+    int32_t index = -1;
+    assert_int_equal(
+        az_iot_provisioning_client_batch_add(&batch, test_registration_ids[i], NULL, &index),
+        AZ_OK);
+    assert_int_equal(index, i);
+  }
+  assert_int_equal(az_iot_provisioning_client_batch_get_pending_count(&batch), TEST_DEVICE_COUNT);
+
+  int32_t index = -1;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_add(&batch, test_registration_ids[0], NULL, &index),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  test_dps dps = { 0 };
+  test_request requests[TEST_DEVICE_COUNT][4] = { 0 };
+  int32_t request_counts[TEST_DEVICE_COUNT] = { 0 };
+
+  // Every half second, publish the requests due, then receive their responses.
+  for (test_clock_msec = 0; test_clock_msec <= 20000; test_clock_msec += 500)
+  {
+    int32_t published[TEST_DEVICE_COUNT];
+    char topics[TEST_DEVICE_COUNT][TEST_TOPIC_BUFFER_SIZE];
+    az_iot_provisioning_client_batch_request published_requests[TEST_DEVICE_COUNT];
+    int32_t published_count = 0;
+
+    az_result result;
+    while (az_result_succeeded(
+        result = az_iot_provisioning_client_batch_get_next_request(
+            &batch,
+            &published[published_count],
+            &published_requests[published_count],
+            topics[published_count],
+            TEST_TOPIC_BUFFER_SIZE,
+            NULL)))
+    {
+      int32_t const device = published[published_count];
+      assert_int_equal(
+          az_iot_provisioning_client_batch_get_status(&batch, device),
+          AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_IN_FLIGHT);
+      requests[device][request_counts[device]++]
+          = (test_request){ test_clock_msec, published_requests[published_count] };
+      published_count++;
+    }
+    assert_true(result == AZ_ERROR_ITEM_NOT_FOUND || result == AZ_ERROR_NOT_ENOUGH_SPACE);
+    assert_true(published_count <= options.max_in_flight);
+
+    for (int32_t i = 0; i < published_count; i++)
+    {
+      az_span topic;
+      az_span payload;
+      if (!test_dps_respond(&dps, published[i], published_requests[i], topics[i], &topic, &payload))
+      {
+        continue;
+      }
+
+      az_iot_provisioning_client client;
+      assert_int_equal(
+          az_iot_provisioning_client_batch_get_client(&batch, published[i], &client), AZ_OK);
+      az_iot_provisioning_client_register_response response;
+      assert_int_equal(
+          az_iot_provisioning_client_parse_received_topic_and_payload(
+              &client, topic, payload, &response),
+          AZ_OK);
+      assert_int_equal(
+          az_iot_provisioning_client_batch_handle_response(&batch, published[i], &response),
+          AZ_OK);
+    }
+  }
+
+  assert_int_equal(az_iot_provisioning_client_batch_get_pending_count(&batch), 0);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_status(&batch, 0),
+      AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_ASSIGNED);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_status(&batch, 1),
+      AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_ASSIGNED);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_status(&batch, 2),
+      AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_FAILED);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_status(&batch, 3),
+      AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_ASSIGNED);
+
+  // Two requests fit in flight at first, and device 3 keeps one in flight until its timeout.
+  az_iot_provisioning_client_batch_request const reg
+      = AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_REGISTER;
+  az_iot_provisioning_client_batch_request const query
+      = AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_QUERY_STATUS;
+  test_request const expected[TEST_DEVICE_COUNT][4] = {
+    { { 1000, reg }, { 4000, query }, { 7000, query } },
+    { { 500, reg }, { 5500, reg }, { 6500, query } },
+    { { 0, reg } },
+    { { 0, reg }, { 10000, reg }, { 11000, query } },
+  };
+  int32_t const expected_counts[TEST_DEVICE_COUNT] = { 3, 3, 1, 3 };
+
+  for (int32_t device = 0; device < TEST_DEVICE_COUNT; device++)
+  {
+    assert_int_equal(request_counts[device], expected_counts[device]);
+    for (int32_t i = 0; i < expected_counts[device]; i++)
+    {
+      assert_int_equal(requests[device][i].time_msec, expected[device][i].time_msec);
+      assert_int_equal(requests[device][i].request, expected[device][i].request);
+    }
+  }
+
+  // A late response for a complete registration is ignored.
+  az_iot_provisioning_client_register_response response = { 0 };
+  assert_int_equal(
+      az_iot_provisioning_client_batch_handle_response(&batch, 0, &response),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // Removing a registration frees its entry.
+  az_iot_provisioning_client_batch_remove(&batch, 2);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_status(&batch, 2),
+      AZ_IOT_PROVISIONING_CLIENT_BATCH_STATUS_UNUSED);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_add(&batch, test_registration_ids[2], NULL, &index), AZ_OK);
+  assert_int_equal(index, 2);
+  assert_int_equal(az_iot_provisioning_client_batch_get_pending_count(&batch), 1);
+}
+
+static void test_az_iot_provisioning_client_batch_in_flight_timeout_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client_batch_options options
+      = az_iot_provisioning_client_batch_options_default();
+  options.max_in_flight = 1;
+  options.response_timeout_msec = 10000;
+
+  az_iot_provisioning_client_batch_registration registrations[TEST_DEVICE_COUNT];
+  az_iot_provisioning_client_batch batch;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_init(
+          &batch,
+          test_global_device_hostname,
+          test_id_scope,
+          registrations,
+          TEST_DEVICE_COUNT,
+          &options),
+      AZ_OK);
+
+  int context = 0;
+  int32_t first = -1;
+  int32_t second = -1;
+  test_clock_msec = 100000;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_add(&batch, test_registration_ids[0], &context, &first),
+      AZ_OK);
+  assert_ptr_equal(az_iot_provisioning_client_batch_get_user_context(&batch, first), &context);
+
+  char topic[TEST_TOPIC_BUFFER_SIZE];
+  int32_t index = -1;
+  az_iot_provisioning_client_batch_request request;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_next_request(
+          &batch, &index, &request, topic, sizeof(topic), NULL),
+      AZ_OK);
+  assert_int_equal(index, first);
+
+  test_clock_msec = 101000;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_add(&batch, test_registration_ids[1], NULL, &second),
+      AZ_OK);
+
+  // The window is full until the response to the first request times out.
+  test_clock_msec = 105000;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_next_request(
+          &batch, &index, &request, topic, sizeof(topic), NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // The timed out request is published again, ahead of the pending one.
+  test_clock_msec = 110000;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_next_request(
+          &batch, &index, &request, topic, sizeof(topic), NULL),
+      AZ_OK);
+  assert_int_equal(index, first);
+  assert_int_equal(request, AZ_IOT_PROVISIONING_CLIENT_BATCH_REQUEST_REGISTER);
+
+  // Once the first registration is removed, the pending one is published.
+  az_iot_provisioning_client_batch_remove(&batch, first);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_next_request(
+          &batch, &index, &request, topic, sizeof(topic), NULL),
+      AZ_OK);
+  assert_int_equal(index, second);
+
+  // Long after, only the in flight request is due again.
+  test_clock_msec = 1000000;
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_next_request(
+          &batch, &index, &request, topic, sizeof(topic), NULL),
+      AZ_OK);
+  assert_int_equal(index, second);
+  assert_int_equal(
+      az_iot_provisioning_client_batch_get_next_request(
+          &batch, &index, &request, topic, sizeof(topic), NULL),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+#endif // _az_MOCK_ENABLED
+
+#ifdef _MSC_VER
+// warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
+#pragma warning(disable : 4113)
+#endif
+
+int test_az_iot_provisioning_client_batch()
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  SETUP_PRECONDITION_CHECK_TESTS();
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  const struct CMUnitTest tests[] = {
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_provisioning_client_batch_init_NULL_registrations_fails),
+    cmocka_unit_test(test_az_iot_provisioning_client_batch_derive_device_key_empty_group_key_fails),
+#endif // AZ_NO_PRECONDITION_CHECKING
+    cmocka_unit_test(test_az_iot_provisioning_client_batch_derive_device_key_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_batch_derive_device_key_fail),
+    cmocka_unit_test(test_az_iot_provisioning_client_batch_sas_get_password_succeed),
+#ifdef _az_MOCK_ENABLED
+    cmocka_unit_test(test_az_iot_provisioning_client_batch_register_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_batch_in_flight_timeout_succeed),
+#endif // _az_MOCK_ENABLED
+  };
+  return cmocka_run_group_tests_name("az_iot_provisioning_client_batch", tests, NULL, NULL);
+}
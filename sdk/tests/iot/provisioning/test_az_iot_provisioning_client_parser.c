@@ -589,6 +589,277 @@ static void test_az_iot_provisioning_client_parse_operation_status_translate_suc
   assert_int_equal(AZ_IOT_PROVISIONING_STATUS_DISABLED, response.operation_status);
 }
 
+static void test_az_iot_provisioning_client_parse_operation_status_near_miss_fails(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client_register_response response;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  az_span received_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/202/?$rid=1&retry-after=3");
+
+  // Statuses of the length of a known one, or sharing its first character, are not matched.
+  az_span const received_payloads[] = {
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"assignee\"}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"disablex\"}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"Assigned\"}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"faile\"}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"\"}"),
+  };
+
+  for (size_t i = 0; i < sizeof(received_payloads) / sizeof(received_payloads[0]); i++)
+  {
+    ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+        &client, received_topic, received_payloads[i], &response);
+    assert_int_equal(AZ_ERROR_UNEXPECTED_CHAR, ret);
+  }
+}
+
+static void test_az_iot_provisioning_client_parse_unknown_keys_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  // Unknown keys with the length of a known key, escaped or not, are skipped.
+  az_span received_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/200/?$rid=1");
+  az_span received_payload = AZ_SPAN_FROM_STR(
+      "{\"operationXx\":\"other\",\"operationId\":\"" TEST_OPERATION_ID "\","
+      "\"st\\/tus\":\"failed\",\"status\":\"" TEST_STATUS_ASSIGNED "\","
+      "\"statu5\":{\"status\":1},\"messag\\n\":\"other\","
+      "\"registrationState\":{\"assignedHub\":\"" TEST_HUB_HOSTNAME "\","
+      "\"deviceId\":\"" TEST_DEVICE_ID "\",\"deviceIx\":\"other\",\"device\\tI\":1}}");
+
+  az_iot_provisioning_client_register_response response;
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client, received_topic, received_payload, &response);
+  assert_int_equal(AZ_OK, ret);
+
+  assert_true(az_span_is_content_equal(response.operation_id, AZ_SPAN_FROM_STR(TEST_OPERATION_ID)));
+  assert_int_equal(AZ_IOT_PROVISIONING_STATUS_ASSIGNED, response.operation_status);
+  assert_true(az_span_is_content_equal(
+      response.registration_state.assigned_hub_hostname, AZ_SPAN_FROM_STR(TEST_HUB_HOSTNAME)));
+  assert_true(az_span_is_content_equal(
+      response.registration_state.device_id, AZ_SPAN_FROM_STR(TEST_DEVICE_ID)));
+}
+
+static void test_az_iot_provisioning_client_parse_wrong_value_type_fails(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  az_span received_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/200/?$rid=1");
+
+  // A string property with a value of the wrong type is missing, and a custom payload that is not
+  // an object is a JSON error.
+  az_span const received_payloads[] = {
+    AZ_SPAN_FROM_STR("{\"operationId\":1,\"status\":\"" TEST_STATUS_ASSIGNING "\"}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":true}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNED
+                     "\",\"registrationState\":{\"assignedHub\":1,"
+                     "\"deviceId\":\"" TEST_DEVICE_ID "\"}}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNED
+                     "\",\"registrationState\":{\"assignedHub\":\"" TEST_HUB_HOSTNAME "\","
+                     "\"deviceId\":\"" TEST_DEVICE_ID "\",\"payload\":1}}"),
+  };
+  az_result const expected_results[] = {
+    AZ_ERROR_ITEM_NOT_FOUND,
+    AZ_ERROR_ITEM_NOT_FOUND,
+    AZ_ERROR_ITEM_NOT_FOUND,
+    AZ_ERROR_UNEXPECTED_CHAR,
+  };
+
+  for (size_t i = 0; i < sizeof(received_payloads) / sizeof(received_payloads[0]); i++)
+  {
+    az_iot_provisioning_client_register_response response;
+    ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+        &client, received_topic, received_payloads[i], &response);
+    assert_int_equal(expected_results[i], ret);
+  }
+}
+
+static void test_az_iot_provisioning_client_parse_null_values_fails(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  az_span received_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/202/?$rid=1&retry-after=3");
+
+  // A null value is of the wrong type for its property, except for the custom payload.
+  az_span const received_payloads[] = {
+    AZ_SPAN_FROM_STR("{\"operationId\":null,\"status\":\"" TEST_STATUS_ASSIGNING "\"}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\","
+                     "\"status\":\"" TEST_STATUS_ASSIGNING "\",\"trackingId\":null}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\","
+                     "\"status\":\"" TEST_STATUS_ASSIGNING "\",\"registrationState\":null}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_FAILED
+                     "\",\"registrationState\":{\"errorCode\":400207,\"errorMessage\":null}}"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_FAILED
+                     "\",\"registrationState\":{\"errorCode\":null}}"),
+  };
+  az_result const expected_results[] = {
+    AZ_ERROR_ITEM_NOT_FOUND,
+    AZ_ERROR_ITEM_NOT_FOUND,
+    AZ_ERROR_UNEXPECTED_CHAR,
+    AZ_ERROR_ITEM_NOT_FOUND,
+    AZ_ERROR_JSON_INVALID_STATE,
+  };
+
+  for (size_t i = 0; i < sizeof(received_payloads) / sizeof(received_payloads[0]); i++)
+  {
+    az_iot_provisioning_client_register_response response;
+    ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+        &client, received_topic, received_payloads[i], &response);
+    assert_int_equal(expected_results[i], ret);
+  }
+
+  az_iot_provisioning_client_register_response response;
+  az_span received_payload = AZ_SPAN_FROM_STR(
+      "{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNED "\","
+      "\"registrationState\":{\"assignedHub\":\"" TEST_HUB_HOSTNAME "\","
+      "\"deviceId\":\"" TEST_DEVICE_ID "\",\"payload\":null}}");
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client, received_topic, received_payload, &response);
+  assert_int_equal(AZ_OK, ret);
+  assert_int_equal(0, az_span_size(response.registration_state.payload));
+}
+
+static void
+test_az_iot_provisioning_client_parse_syntax_error_after_properties_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  az_span received_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/202/?$rid=1&retry-after=3");
+
+  // A syntax error where a property name is expected ends the payload, which is judged by the
+  // properties read before it.
+  az_span const received_payloads[] = {
+    AZ_SPAN_FROM_STR(
+        "{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNING "\",}"),
+    AZ_SPAN_FROM_STR(
+        "{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNING "\" "
+        "\"trackingId\":\"" TEST_ERROR_TRACKING_ID "\"}"),
+  };
+
+  for (size_t i = 0; i < sizeof(received_payloads) / sizeof(received_payloads[0]); i++)
+  {
+    az_iot_provisioning_client_register_response response;
+    ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+        &client, received_topic, received_payloads[i], &response);
+    assert_int_equal(AZ_OK, ret);
+    assert_true(
+        az_span_is_content_equal(response.operation_id, AZ_SPAN_FROM_STR(TEST_OPERATION_ID)));
+    assert_int_equal(AZ_IOT_PROVISIONING_STATUS_ASSIGNING, response.operation_status);
+    assert_int_equal(0, az_span_size(response.registration_state.error_tracking_id));
+  }
+}
+
+static void test_az_iot_provisioning_client_parse_truncated_payload_fails(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  az_span received_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/202/?$rid=1&retry-after=3");
+  az_iot_provisioning_client_register_response response;
+
+  // A payload cut short between properties is judged by the properties read before its end.
+  az_span received_payload = AZ_SPAN_FROM_STR(
+      "{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNING "\"");
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client, received_topic, received_payload, &response);
+  assert_int_equal(AZ_OK, ret);
+  assert_int_equal(AZ_IOT_PROVISIONING_STATUS_ASSIGNING, response.operation_status);
+
+  // A payload cut short within a value fails.
+  az_span const received_payloads[] = {
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"assi"),
+    AZ_SPAN_FROM_STR("{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNED
+                     "\",\"registrationState\":{\"assignedHub\":"),
+  };
+
+  for (size_t i = 0; i < sizeof(received_payloads) / sizeof(received_payloads[0]); i++)
+  {
+    ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+        &client, received_topic, received_payloads[i], &response);
+    assert_int_equal(AZ_ERROR_UNEXPECTED_END, ret);
+  }
+}
+
+static void test_az_iot_provisioning_client_parse_received_topic_properties_succeed(void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  az_span received_payload = AZ_SPAN_FROM_STR(
+      "{\"errorCode\":429001,\"trackingId\":\"" TEST_ERROR_TRACKING_ID "\","
+      "\"message\":\"Operations are being throttled for this tenant.\","
+      "\"timestampUtc\":\"" TEST_ERROR_TIMESTAMP "\"}");
+
+  az_iot_provisioning_client_register_response response;
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client,
+      AZ_SPAN_FROM_STR("$dps/registrations/res/429/?$rid=1&x=retry-after=9&retry-after=5"),
+      received_payload,
+      &response);
+  assert_int_equal(AZ_OK, ret);
+  assert_int_equal(AZ_IOT_STATUS_THROTTLED, response.status);
+  assert_int_equal(5, response.retry_after_seconds);
+  assert_int_equal(AZ_IOT_PROVISIONING_STATUS_FAILED, response.operation_status);
+  assert_int_equal(429001, response.registration_state.extended_error_code);
+
+  // Without properties.
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client, AZ_SPAN_FROM_STR("$dps/registrations/res/429"), received_payload, &response);
+  assert_int_equal(AZ_OK, ret);
+  assert_int_equal(AZ_IOT_STATUS_THROTTLED, response.status);
+  assert_int_equal(0, response.retry_after_seconds);
+
+  // An invalid retry-after fails.
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client,
+      AZ_SPAN_FROM_STR("$dps/registrations/res/429/?retry-after=x&$rid=1"),
+      received_payload,
+      &response);
+  assert_int_equal(AZ_ERROR_UNEXPECTED_CHAR, ret);
+
+  // A topic shorter than the prefix, or differing from it, doesn't match.
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client, AZ_SPAN_FROM_STR("$dps/registrations/re"), received_payload, &response);
+  assert_int_equal(AZ_ERROR_IOT_TOPIC_NO_MATCH, ret);
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client, AZ_SPAN_FROM_STR("$dps/registrations/rex/429/"), received_payload, &response);
+  assert_int_equal(AZ_ERROR_IOT_TOPIC_NO_MATCH, ret);
+}
+
 static void test_az_iot_provisioning_client_operation_complete_translate_succeed(void** state)
 {
   (void)state;
@@ -865,6 +1136,30 @@ test_az_iot_provisioning_client_parse_received_topic_and_payload_json_custom_pay
   assert_int_equal(0, az_span_size(response.registration_state.error_message));
 }
 
+static void
+test_az_iot_provisioning_client_parse_received_topic_and_payload_json_custom_payload_array_fails(
+    void** state)
+{
+  (void)state;
+
+  az_iot_provisioning_client client = { 0 };
+  az_result ret = az_iot_provisioning_client_init(
+      &client, test_global_device_hostname, test_id_scope, test_registration_id, NULL);
+  assert_int_equal(AZ_OK, ret);
+
+  // A custom payload is a JSON object.
+  az_span received_topic = AZ_SPAN_FROM_STR("$dps/registrations/res/200/?$rid=1");
+  az_span received_payload = AZ_SPAN_FROM_STR(
+      "{\"operationId\":\"" TEST_OPERATION_ID "\",\"status\":\"" TEST_STATUS_ASSIGNED "\","
+      "\"registrationState\":{\"assignedHub\":\"" TEST_HUB_HOSTNAME "\","
+      "\"deviceId\":\"" TEST_DEVICE_ID "\",\"payload\":[1,{\"a\":2}]}}");
+
+  az_iot_provisioning_client_register_response response;
+  ret = az_iot_provisioning_client_parse_received_topic_and_payload(
+      &client, received_topic, received_payload, &response);
+  assert_int_equal(AZ_ERROR_UNEXPECTED_CHAR, ret);
+}
+
 #ifdef _MSC_VER
 // warning C4113: 'void (__cdecl *)()' differs in parameter lists from 'CMUnitTestFunction'
 #pragma warning(disable : 4113)
@@ -904,6 +1199,13 @@ int test_az_iot_provisioning_client_parser()
     cmocka_unit_test(
         test_az_iot_provisioning_client_received_topic_and_payload_parse_device_not_found_fails),
     cmocka_unit_test(test_az_iot_provisioning_client_parse_operation_status_translate_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_parse_operation_status_near_miss_fails),
+    cmocka_unit_test(test_az_iot_provisioning_client_parse_unknown_keys_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_parse_wrong_value_type_fails),
+    cmocka_unit_test(test_az_iot_provisioning_client_parse_null_values_fails),
+    cmocka_unit_test(test_az_iot_provisioning_client_parse_syntax_error_after_properties_succeed),
+    cmocka_unit_test(test_az_iot_provisioning_client_parse_truncated_payload_fails),
+    cmocka_unit_test(test_az_iot_provisioning_client_parse_received_topic_properties_succeed),
     cmocka_unit_test(test_az_iot_provisioning_client_operation_complete_translate_succeed),
     cmocka_unit_test(test_az_iot_provisioning_client_logging_succeed),
     cmocka_unit_test(test_az_iot_provisioning_client_no_logging_succeed),
@@ -913,6 +1215,8 @@ int test_az_iot_provisioning_client_parser()
         test_az_iot_provisioning_client_parse_received_topic_and_payload_json_custom_payload_empty_succeed),
     cmocka_unit_test(
         test_az_iot_provisioning_client_parse_received_topic_and_payload_json_custom_payload_null_succeed),
+    cmocka_unit_test(
+        test_az_iot_provisioning_client_parse_received_topic_and_payload_json_custom_payload_array_fails),
   };
 
   return cmocka_run_group_tests_name("az_iot_provisioning_client_parser", tests, NULL, NULL);
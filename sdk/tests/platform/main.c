@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+#include <stdlib.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include "test_az_platform.h"
+
+#include <azure/core/_az_cfg.h>
+
+int main()
+{
+  int result = 0;
+
+  result += test_az_curl();
+
+  return result;
+}
@@ -0,0 +1,337 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "test_az_platform.h"
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/platform/az_curl.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_EXPECT_SUCCESS(exp) assert_true(az_result_succeeded(exp))
+
+// Nothing listens on port 1, so connecting fails right away without leaving the host.
+static az_span const test_unreachable_url = AZ_SPAN_LITERAL_FROM_STR("http://127.0.0.1:1/");
+
+static int test_lock_count = 0;
+static int test_unlock_count = 0;
+static int test_timing_count = 0;
+static az_result test_timing_result = AZ_OK;
+
+static void test_lock(void* user_context)
+{
+  assert_ptr_equal(user_context, &test_lock_count);
+  test_lock_count++;
+}
+
+static void test_unlock(void* user_context)
+{
+  assert_ptr_equal(user_context, &test_lock_count);
+  test_unlock_count++;
+}
+
+static void test_timing(
+    az_http_request const* request,
+    az_result result,
+    az_http_client_curl_timing const* timing,
+    void* user_context)
+{
+  assert_non_null(request);
+  assert_non_null(timing);
+  assert_ptr_equal(user_context, &test_timing_count);
+  assert_true(timing->name_lookup_usec >= 0);
+  assert_true(timing->total_usec >= timing->name_lookup_usec);
+  test_timing_result = result;
+  test_timing_count++;
+}
+
+static az_result test_send_request(az_span url)
+{
+  uint8_t url_buffer[64];
+  az_span_copy(AZ_SPAN_FROM_BUFFER(url_buffer), url);
+  uint8_t headers_buffer[64];
+  uint8_t response_buffer[256];
+
+  az_http_request request;
+  az_result result = az_http_request_init(
+      &request,
+      &az_context_application,
+      az_http_method_get(),
+      AZ_SPAN_FROM_BUFFER(url_buffer),
+      az_span_size(url),
+      AZ_SPAN_FROM_BUFFER(headers_buffer),
+      AZ_SPAN_EMPTY);
+  assert_int_equal(result, AZ_OK);
+
+  az_http_response response;
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buffer)));
+
+  return az_http_client_send_request(&request, &response);
+}
+
+static az_result test_send_unreachable_request(void)
+{
+  return test_send_request(test_unreachable_url);
+}
+
+static void test_az_http_client_curl_options_default_succeed(void** state)
+{
+  (void)state;
+
+  az_http_client_curl_options const options = az_http_client_curl_options_default();
+  assert_true(options.share_dns_cache);
+  assert_true(options.share_ssl_sessions);
+  assert_true(options.share_connections);
+  assert_true(options.enable_http2);
+  assert_null(options.lock);
+  assert_null(options.unlock);
+  assert_null(options.lock_context);
+  assert_null(options.timing_callback);
+  assert_null(options.timing_context);
+
+  TEST_EXPECT_SUCCESS(az_http_client_curl_init(NULL));
+  az_http_client_curl_deinit();
+  TEST_EXPECT_SUCCESS(az_http_client_curl_init(&options));
+  az_http_client_curl_deinit();
+}
+
+static void test_az_http_client_curl_init_shared_connections_with_lock_fails(void** state)
+{
+  (void)state;
+
+  az_http_client_curl_options options = az_http_client_curl_options_default();
+  options.lock = test_lock;
+  options.unlock = test_unlock;
+  options.lock_context = &test_lock_count;
+
+  // The connection cache cannot be shared between threads.
+  assert_int_equal(az_http_client_curl_init(&options), AZ_ERROR_ARG);
+
+  options.share_connections = false;
+  TEST_EXPECT_SUCCESS(az_http_client_curl_init(&options));
+  az_http_client_curl_deinit();
+}
+
+static void test_az_http_client_curl_send_request_uses_share_succeed(void** state)
+{
+  (void)state;
+
+  az_http_client_curl_options options = az_http_client_curl_options_default();
+  options.share_connections = false;
+  options.lock = test_lock;
+  options.unlock = test_unlock;
+  options.lock_context = &test_lock_count;
+  options.timing_callback = test_timing;
+  options.timing_context = &test_timing_count;
+
+  test_lock_count = 0;
+  test_unlock_count = 0;
+  test_timing_count = 0;
+  test_timing_result = AZ_OK;
+
+  TEST_EXPECT_SUCCESS(az_http_client_curl_init(&options));
+
+  // The request fails, but it runs on an easy handle attached to the share, which libcurl locks.
+  az_result const result = test_send_unreachable_request();
+  assert_int_equal(result, AZ_ERROR_HTTP_ADAPTER);
+  assert_int_equal(test_timing_count, 1);
+  assert_int_equal(test_timing_result, result);
+  assert_true(test_lock_count > 0);
+  assert_int_equal(test_lock_count, test_unlock_count);
+
+  // Without any sharing, requests run on independent handles, and the timing callback is still
+  // called.
+  options.share_dns_cache = false;
+  options.share_ssl_sessions = false;
+  TEST_EXPECT_SUCCESS(az_http_client_curl_init(&options));
+
+  test_lock_count = 0;
+  assert_int_equal(test_send_unreachable_request(), AZ_ERROR_HTTP_ADAPTER);
+  assert_int_equal(test_timing_count, 2);
+  assert_int_equal(test_lock_count, 0);
+
+  az_http_client_curl_deinit();
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#define TEST_LOOPBACK_REQUEST_COUNT 3
+
+static int32_t test_new_connections[TEST_LOOPBACK_REQUEST_COUNT];
+static int test_new_connections_count = 0;
+
+static void test_record_new_connections(
+    az_http_request const* request,
+    az_result result,
+    az_http_client_curl_timing const* timing,
+    void* user_context)
+{
+  (void)request;
+  (void)user_context;
+  assert_int_equal(result, AZ_OK);
+  assert_true(test_new_connections_count < TEST_LOOPBACK_REQUEST_COUNT);
+  test_new_connections[test_new_connections_count++] = timing->new_connections;
+}
+
+// Answers request_count HTTP/1.1 requests with an empty 200 response, keeping each connection open
+// until the client closes it, then writes the number of connections it accepted to result_fd.
+static void test_serve_loopback_requests(int listen_fd, int request_count, int result_fd)
+{
+  // Give up if the client never sends all its requests.
+  alarm(10);
+
+  static char const response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+  int accepted = 0;
+  int served = 0;
+
+  while (served < request_count)
+  {
+    int const connection_fd = accept(listen_fd, NULL, NULL);
+    if (connection_fd < 0)
+    {
+      break;
+    }
+    accepted++;
+
+    // A request is complete at the empty line that ends its headers, as it has no body.
+    char buffer[1024];
+    size_t length = 0;
+    ssize_t received = 0;
+    while (served < request_count
+           && (received = recv(connection_fd, buffer + length, sizeof(buffer) - length - 1, 0))
+               > 0)
+    {
+      length += (size_t)received;
+      buffer[length] = '\0';
+      char const* const end = strstr(buffer, "\r\n\r\n");
+      if (end != NULL)
+      {
+        (void)send(connection_fd, response, sizeof(response) - 1, 0);
+        served++;
+        size_t const request_length = (size_t)(end + 4 - buffer);
+        memmove(buffer, end + 4, length - request_length);
+        length -= request_length;
+      }
+    }
+
+    (void)close(connection_fd);
+  }
+
+  ssize_t const written = write(result_fd, &accepted, sizeof(accepted));
+  (void)written;
+}
+
+// Sends TEST_LOOPBACK_REQUEST_COUNT requests to a server on the loopback interface, run by a
+// child process, and returns the number of connections it accepted.
+static int test_count_loopback_connections(az_http_client_curl_options const* options)
+{
+  int const listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  assert_true(listen_fd >= 0);
+
+  struct sockaddr_in address = { 0 };
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0;
+  socklen_t address_length = sizeof(address);
+  assert_int_equal(bind(listen_fd, (struct sockaddr*)&address, address_length), 0);
+  assert_int_equal(listen(listen_fd, TEST_LOOPBACK_REQUEST_COUNT), 0);
+  assert_int_equal(getsockname(listen_fd, (struct sockaddr*)&address, &address_length), 0);
+
+  int result_fds[2];
+  assert_int_equal(pipe(result_fds), 0);
+
+  pid_t const server = fork();
+  assert_true(server >= 0);
+  if (server == 0)
+  {
+    (void)close(result_fds[0]);
+    test_serve_loopback_requests(listen_fd, TEST_LOOPBACK_REQUEST_COUNT, result_fds[1]);
+    _exit(0);
+  }
+  (void)close(result_fds[1]);
+  (void)close(listen_fd);
+
+  char url[64];
+  int const url_length
+      = snprintf(url, sizeof(url), "http://127.0.0.1:%d/", (int)ntohs(address.sin_port));
+
+  test_new_connections_count = 0;
+  TEST_EXPECT_SUCCESS(az_http_client_curl_init(options));
+  for (int i = 0; i < TEST_LOOPBACK_REQUEST_COUNT; i++)
+  {
+    assert_int_equal(test_send_request(az_span_create((uint8_t*)url, url_length)), AZ_OK);
+  }
+  // Closing the shared connections lets the server see the end of the last one.
+  az_http_client_curl_deinit();
+
+  int accepted = 0;
+  assert_int_equal(read(result_fds[0], &accepted, sizeof(accepted)), sizeof(accepted));
+  (void)close(result_fds[0]);
+
+  int status = 0;
+  assert_int_equal(waitpid(server, &status, 0), server);
+  assert_true(WIFEXITED(status));
+  assert_int_equal(test_new_connections_count, TEST_LOOPBACK_REQUEST_COUNT);
+
+  return accepted;
+}
+
+static void test_az_http_client_curl_send_request_reuses_connection_succeed(void** state)
+{
+  (void)state;
+
+  az_http_client_curl_options options = az_http_client_curl_options_default();
+  options.timing_callback = test_record_new_connections;
+
+  // With the shared connection cache, every request after the first reuses its connection.
+  assert_int_equal(test_count_loopback_connections(&options), 1);
+  assert_int_equal(test_new_connections[0], 1);
+  for (int i = 1; i < TEST_LOOPBACK_REQUEST_COUNT; i++)
+  {
+    assert_int_equal(test_new_connections[i], 0);
+  }
+
+  // Without it, every request opens its own connection.
+  options.share_connections = false;
+  assert_int_equal(test_count_loopback_connections(&options), TEST_LOOPBACK_REQUEST_COUNT);
+  for (int i = 0; i < TEST_LOOPBACK_REQUEST_COUNT; i++)
+  {
+    assert_int_equal(test_new_connections[i], 1);
+  }
+}
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+int test_az_curl()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_http_client_curl_options_default_succeed),
+    cmocka_unit_test(test_az_http_client_curl_init_shared_connections_with_lock_fails),
+    cmocka_unit_test(test_az_http_client_curl_send_request_uses_share_succeed),
+#if defined(__unix__) || defined(__APPLE__)
+    cmocka_unit_test(test_az_http_client_curl_send_request_reuses_connection_succeed),
+#endif // defined(__unix__) || defined(__APPLE__)
+  };
+  return cmocka_run_group_tests_name("az_platform_curl", tests, NULL, NULL);
+}